@@ -5,9 +5,12 @@
 #include "core/AITypes.h"
 #include "core/AIClient.h"
 #include "conversation/Conversation.h"
+#include "conversation/ConversationLog.h"
 #include "providers/AIProvider.h"
 #include "providers/OpenAICompatibleProvider.h"
 #include "providers/ProviderFactory.h"
+#include "providers/StepRequest.h"
+#include "providers/StreamMultiplexer.h"
 
 #if ESPAI_PROVIDER_OPENAI
 #include "providers/OpenAIProvider.h"
@@ -27,6 +30,8 @@
 
 #if ESPAI_ENABLE_STREAMING
 #include "http/SSEParser.h"
+#include "http/StreamStopDetector.h"
+#include "async/StreamChunkRing.h"
 #endif
 
 #include "http/HttpTransport.h"
@@ -36,10 +41,23 @@
 
 #if ESPAI_ENABLE_TOOLS
 #include "tools/ToolRegistry.h"
+#include "tools/ToolCompletion.h"
+#include "tools/ToolArgs.h"
+#include "tools/StaticToolTable.h"
+#include "tools/ToolSelector.h"
+#include "tools/ParallelToolExecutor.h"
+#include "tools/ToolLoop.h"
 #endif
 
 #if ESPAI_ENABLE_ASYNC
 #include "async/AsyncTaskRunner.h"
+#include "async/AsyncRequestQueue.h"
+#include "async/ChatFuture.h"
+#include "async/StreamPipeline.h"
+#endif
+
+#if ESPAI_ENABLE_COROUTINES
+#include "async/ChatCoroutine.h"
 #endif
 
 #define ESPAI_VERSION ESPAI_VERSION_STRING
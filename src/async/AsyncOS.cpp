@@ -0,0 +1,225 @@
+#include "AsyncOS.h"
+
+#if ESPAI_ENABLE_ASYNC && !defined(ARDUINO) && ESPAI_ASYNC_STD_THREADS
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct StdSemaphore {
+    std::mutex mutex;
+    std::condition_variable available;
+    int count;
+
+    explicit StdSemaphore(int initialCount) : count(initialCount) {}
+};
+
+struct StdStreamBuffer {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<uint8_t> ring;
+    size_t head = 0;        // Next byte to read
+    size_t count = 0;
+    size_t triggerLevel;
+
+    StdStreamBuffer(size_t size, size_t trigger) : ring(size), triggerLevel(trigger ? trigger : 1) {}
+};
+
+// Waits on s->changed until ready() or ticksToWait pass; false on timeout
+template <typename Ready>
+bool waitFor(StdStreamBuffer* s, std::unique_lock<std::mutex>& guard, TickType_t ticksToWait, Ready ready) {
+    if (ticksToWait == portMAX_DELAY) {
+        s->changed.wait(guard, ready);
+        return true;
+    }
+    return s->changed.wait_for(guard, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), ready);
+}
+
+struct StdTask {
+    TaskFunction_t code;
+    void* parameters;
+};
+
+TaskHandle_t startTask(TaskFunction_t code, void* parameters) {
+    StdTask* task = new StdTask{code, parameters};
+    std::thread([task]() {
+        task->code(task->parameters);
+        delete task;
+    }).detach();
+    return static_cast<TaskHandle_t>(task);
+}
+
+} // namespace
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return static_cast<SemaphoreHandle_t>(new StdSemaphore(1));
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return static_cast<SemaphoreHandle_t>(new StdSemaphore(0));
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+    if (!semaphore) {
+        return pdFAIL;
+    }
+    auto* s = static_cast<StdSemaphore*>(semaphore);
+    std::unique_lock<std::mutex> guard(s->mutex);
+    auto given = [s]() { return s->count > 0; };
+
+    if (ticksToWait == portMAX_DELAY) {
+        s->available.wait(guard, given);
+    } else if (!s->available.wait_for(guard, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), given)) {
+        return pdFAIL;
+    }
+    s->count--;
+    return pdPASS;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    if (!semaphore) {
+        return pdFAIL;
+    }
+    auto* s = static_cast<StdSemaphore*>(semaphore);
+    // Notify under the lock: the taker may delete the semaphore as soon as it wakes
+    std::lock_guard<std::mutex> guard(s->mutex);
+    if (s->count > 0) {
+        return pdFAIL;
+    }
+    s->count = 1;
+    s->available.notify_one();
+    return pdPASS;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete static_cast<StdSemaphore*>(semaphore);
+}
+
+StreamBufferHandle_t xStreamBufferCreate(size_t bufferSize, size_t triggerLevel) {
+    if (bufferSize == 0) {
+        return nullptr;
+    }
+    return static_cast<StreamBufferHandle_t>(new StdStreamBuffer(bufferSize, triggerLevel));
+}
+
+size_t xStreamBufferSend(StreamBufferHandle_t buffer, const void* data, size_t length, TickType_t ticksToWait) {
+    if (!buffer || length == 0) {
+        return 0;
+    }
+    auto* s = static_cast<StdStreamBuffer*>(buffer);
+    std::unique_lock<std::mutex> guard(s->mutex);
+    size_t wanted = (length < s->ring.size()) ? length : s->ring.size();
+    waitFor(s, guard, ticksToWait, [s, wanted]() { return s->ring.size() - s->count >= wanted; });
+
+    size_t space = s->ring.size() - s->count;
+    size_t written = (length < space) ? length : space;
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < written; i++) {
+        s->ring[(s->head + s->count + i) % s->ring.size()] = bytes[i];
+    }
+    s->count += written;
+    if (written > 0) {
+        s->changed.notify_all();
+    }
+    return written;
+}
+
+size_t xStreamBufferReceive(StreamBufferHandle_t buffer, void* data, size_t length, TickType_t ticksToWait) {
+    if (!buffer || length == 0) {
+        return 0;
+    }
+    auto* s = static_cast<StdStreamBuffer*>(buffer);
+    std::unique_lock<std::mutex> guard(s->mutex);
+    waitFor(s, guard, ticksToWait, [s]() { return s->count >= s->triggerLevel; });
+
+    size_t read = (length < s->count) ? length : s->count;
+    uint8_t* bytes = static_cast<uint8_t*>(data);
+    for (size_t i = 0; i < read; i++) {
+        bytes[i] = s->ring[(s->head + i) % s->ring.size()];
+    }
+    s->head = (s->head + read) % s->ring.size();
+    s->count -= read;
+    if (read > 0) {
+        s->changed.notify_all();
+    }
+    return read;
+}
+
+size_t xStreamBufferBytesAvailable(StreamBufferHandle_t buffer) {
+    auto* s = static_cast<StdStreamBuffer*>(buffer);
+    std::lock_guard<std::mutex> guard(s->mutex);
+    return s->count;
+}
+
+size_t xStreamBufferSpacesAvailable(StreamBufferHandle_t buffer) {
+    auto* s = static_cast<StdStreamBuffer*>(buffer);
+    std::lock_guard<std::mutex> guard(s->mutex);
+    return s->ring.size() - s->count;
+}
+
+void vStreamBufferDelete(StreamBufferHandle_t buffer) {
+    delete static_cast<StdStreamBuffer*>(buffer);
+}
+
+BaseType_t xTaskCreatePinnedToCore(
+    TaskFunction_t taskCode,
+    const char* name,
+    configSTACK_DEPTH_TYPE stackDepth,
+    void* parameters,
+    UBaseType_t priority,
+    TaskHandle_t* createdTask,
+    BaseType_t coreId
+) {
+    (void)name;
+    (void)stackDepth;
+    (void)priority;
+    (void)coreId;
+
+    TaskHandle_t handle = startTask(taskCode, parameters);
+    if (createdTask) {
+        *createdTask = handle;
+    }
+    return pdPASS;
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(
+    TaskFunction_t taskCode,
+    const char* name,
+    uint32_t stackDepth,
+    void* parameters,
+    UBaseType_t priority,
+    StackType_t* stackBuffer,
+    StaticTask_t* taskBuffer,
+    BaseType_t coreId
+) {
+    (void)name;
+    (void)stackDepth;
+    (void)priority;
+    (void)coreId;
+
+    if (!stackBuffer || !taskBuffer) {
+        return nullptr;
+    }
+    return startTask(taskCode, parameters);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // The calling task's thread ends when its function returns, right after this.
+    // Threads cannot be stopped from outside.
+    (void)task;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    (void)task;
+    return 0;
+}
+
+#endif // ESPAI_ENABLE_ASYNC && !ARDUINO && ESPAI_ASYNC_STD_THREADS
@@ -0,0 +1,105 @@
+#ifndef ESPAI_ASYNC_OS_H
+#define ESPAI_ASYNC_OS_H
+
+#include "../core/AIConfig.h"
+
+#if ESPAI_ENABLE_ASYNC
+
+/**
+ * OS layer of the async API: the FreeRTOS task, semaphore and stream
+ * buffer calls it uses.
+ *
+ * On Arduino these are FreeRTOS itself. Elsewhere, with
+ * ESPAI_ASYNC_STD_THREADS, the same calls are implemented on std::thread,
+ * std::mutex and std::condition_variable (AsyncOS.cpp), so the async code
+ * runs unchanged under real concurrency on a desktop, e.g. for stress tests
+ * and ThreadSanitizer. Differences from FreeRTOS on that backend:
+ *   - tasks are detached threads; priority, core and stack size are ignored,
+ *     and a static stack buffer is accepted but not used
+ *   - vTaskDelete() only supports deleting the calling task (nullptr)
+ *   - uxTaskGetStackHighWaterMark() returns 0 (unknown)
+ *   - one tick is one millisecond
+ */
+
+#if defined(ARDUINO) || !ESPAI_ASYNC_STD_THREADS
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#ifdef ARDUINO
+#include <freertos/stream_buffer.h>
+#endif
+
+#else
+
+#include <cstddef>
+#include <cstdint>
+
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;
+
+typedef struct {
+    void* reserved;
+} StaticTask_t;
+
+typedef void* SemaphoreHandle_t;
+typedef void* TaskHandle_t;
+typedef void* StreamBufferHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdPASS                  1
+#define pdFAIL                  0
+#define portMAX_DELAY           0xFFFFFFFF
+#define portTICK_PERIOD_MS      1
+#define tskNO_AFFINITY          0x7FFFFFFF
+#define configSTACK_DEPTH_TYPE  uint32_t
+#ifndef pdMS_TO_TICKS
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+#endif
+
+// Mutexes and binary semaphores (count of at most 1)
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateBinary();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait);
+// pdFAIL when already given
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+// Byte stream buffers. Send waits for room for all bytes, then writes what fits;
+// receive waits for triggerLevel bytes, then reads what is there.
+StreamBufferHandle_t xStreamBufferCreate(size_t bufferSize, size_t triggerLevel);
+size_t xStreamBufferSend(StreamBufferHandle_t buffer, const void* data, size_t length, TickType_t ticksToWait);
+size_t xStreamBufferReceive(StreamBufferHandle_t buffer, void* data, size_t length, TickType_t ticksToWait);
+size_t xStreamBufferBytesAvailable(StreamBufferHandle_t buffer);
+size_t xStreamBufferSpacesAvailable(StreamBufferHandle_t buffer);
+void vStreamBufferDelete(StreamBufferHandle_t buffer);
+
+BaseType_t xTaskCreatePinnedToCore(
+    TaskFunction_t taskCode,
+    const char* name,
+    configSTACK_DEPTH_TYPE stackDepth,
+    void* parameters,
+    UBaseType_t priority,
+    TaskHandle_t* createdTask,
+    BaseType_t coreId
+);
+TaskHandle_t xTaskCreateStaticPinnedToCore(
+    TaskFunction_t taskCode,
+    const char* name,
+    uint32_t stackDepth,
+    void* parameters,
+    UBaseType_t priority,
+    StackType_t* stackBuffer,
+    StaticTask_t* taskBuffer,
+    BaseType_t coreId
+);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+#endif // ARDUINO || !ESPAI_ASYNC_STD_THREADS
+
+#endif // ESPAI_ENABLE_ASYNC
+#endif // ESPAI_ASYNC_OS_H
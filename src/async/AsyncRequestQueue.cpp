@@ -0,0 +1,591 @@
+#include "AsyncRequestQueue.h"
+
+#if ESPAI_ENABLE_ASYNC
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#ifdef ARDUINO
+#include <esp_heap_caps.h>
+#endif
+
+namespace ESPAI {
+
+namespace {
+    bool isPending(AsyncStatus status) {
+        return status == AsyncStatus::Queued || status == AsyncStatus::Running;
+    }
+}
+
+AsyncRequestQueue::AsyncRequestQueue(uint8_t maxWorkers) {
+    _mutex = xSemaphoreCreateMutex();
+    _work = xSemaphoreCreateBinary();
+    _finished = xSemaphoreCreateBinary();
+    setMaxWorkers(maxWorkers);
+    for (auto& slot : _slots) {
+        slot.request._mutex = xSemaphoreCreateMutex();
+    }
+    for (auto& worker : _workers) {
+        worker.queue = this;
+    }
+}
+
+AsyncRequestQueue::~AsyncRequestQueue() {
+    detach(nullptr);
+    lock();
+    _stopping = true;
+    unlock();
+    while (getWorkerCount() > 0) {
+        xSemaphoreGive(_work);
+        xSemaphoreTake(_finished, pdMS_TO_TICKS(10));
+    }
+    releaseWorkers();
+    for (auto& slot : _slots) {
+        if (slot.request._mutex) {
+            vSemaphoreDelete(slot.request._mutex);
+            slot.request._mutex = nullptr;
+        }
+    }
+    if (_finished) vSemaphoreDelete(_finished);
+    if (_work) vSemaphoreDelete(_work);
+    if (_mutex) vSemaphoreDelete(_mutex);
+}
+
+AsyncRequestQueue& AsyncRequestQueue::shared() {
+    static AsyncRequestQueue queue;
+    return queue;
+}
+
+void AsyncRequestQueue::lock() const {
+    if (_mutex) xSemaphoreTake(_mutex, portMAX_DELAY);
+}
+
+void AsyncRequestQueue::unlock() const {
+    if (_mutex) xSemaphoreGive(_mutex);
+}
+
+ChatRequest* AsyncRequestQueue::submit(
+    const void* owner,
+    Task task,
+    AsyncChatCallback onComplete,
+    const AsyncRequestOptions& options,
+    const char* cancelMessage
+) {
+    return enqueue(owner, std::move(task), onComplete, options, cancelMessage, nullptr, nullptr);
+}
+
+ChatFuture AsyncRequestQueue::submitFuture(
+    const void* owner,
+    Task task,
+    const AsyncRequestOptions& options,
+    const char* cancelMessage
+) {
+    ChatFuture future = ChatFuture::pending();
+    uint32_t sequence = 0;
+    ChatRequest* req = enqueue(owner, std::move(task), nullptr, options, cancelMessage,
+                               [future](const Response& response) { future.resolve(response); },
+                               &sequence);
+    if (req == nullptr) {
+        // First call wins, so this keeps a worker-start failure already reported
+        future.resolve(Response::fail(ErrorCode::OutOfMemory, "Async queue full"));
+        return future;
+    }
+    // A no-op if the request already finished
+    future.setCanceller([this, req, sequence]() { cancelRequest(req, sequence); });
+    return future;
+}
+
+ChatRequest* AsyncRequestQueue::enqueue(
+    const void* owner,
+    Task task,
+    AsyncChatCallback onComplete,
+    const AsyncRequestOptions& options,
+    const char* cancelMessage,
+    FinishedHook onFinished,
+    uint32_t* sequence
+) {
+    if (!task) return nullptr;
+
+    lock();
+    Slot* slot = findFreeSlot();
+    if (slot == nullptr) {
+        unlock();
+        return nullptr;
+    }
+
+    slot->owner = owner;
+    slot->task = std::move(task);
+    slot->priority = options.priority;
+    slot->conversationId = options.conversationId;
+    slot->sequence = _nextSequence++;
+    slot->cancelMessage = cancelMessage;
+    slot->onFinished = std::move(onFinished);
+    if (sequence != nullptr) {
+        *sequence = slot->sequence;
+    }
+
+    ChatRequest& req = slot->request;
+    req.lock();
+    req._status = AsyncStatus::Queued;
+    req._result = Response();
+    req._cancelRequested.store(false, std::memory_order_relaxed);
+    req._onComplete = onComplete;
+    req._callbackInvoked = false;
+    req._stackHighWater = 0;
+#if ESPAI_ENABLE_STREAMING
+    req._streamBuffered = (options.streamBufferSize > 0);
+    if (req._streamBuffered) {
+        if (!req._streamBuffer || req._streamBuffer->capacity() != options.streamBufferSize) {
+            req._streamBuffer.reset(new (std::nothrow) StreamChunkRing(options.streamBufferSize));
+            req._streamBuffered = (req._streamBuffer != nullptr);
+        } else {
+            req._streamBuffer->reset();
+        }
+    }
+#endif
+    req.unlock();
+
+    bool started = dispatch();
+    if (!started && _workerCount == 0) {
+        // No worker will ever pick it up
+        Finished finished = finish(*slot, Response::fail(ErrorCode::OutOfMemory, "Failed to create async task"));
+        req.lock();
+        req._callbackInvoked = true;
+        req.unlock();
+        unlock();
+        if (onComplete) onComplete(finished.result);
+        finished.run();
+        return nullptr;
+    }
+    unlock();
+
+    return &req;
+}
+
+AsyncRequestQueue::Slot* AsyncRequestQueue::findFreeSlot() {
+    Slot* best = nullptr;
+    int bestRank = -1;
+    for (auto& slot : _slots) {
+        AsyncStatus status = slot.request._status;
+        if (isPending(status)) {
+            continue;
+        }
+        if (status == AsyncStatus::Idle) {
+            return &slot;
+        }
+        // Delivered results first, then the oldest
+        int rank = slot.request._callbackInvoked || !slot.request._onComplete ? 1 : 0;
+        if (best == nullptr || rank > bestRank ||
+            (rank == bestRank && slot.finishedAt < best->finishedAt)) {
+            best = &slot;
+            bestRank = rank;
+        }
+    }
+    return best;
+}
+
+AsyncRequestQueue::Slot* AsyncRequestQueue::nextEligible() {
+    Slot* best = nullptr;
+    for (auto& slot : _slots) {
+        if (slot.request._status != AsyncStatus::Queued) {
+            continue;
+        }
+
+        // The owner is in use by a blocking call (holdOwner())
+        if (std::find(_heldOwners.begin(), _heldOwners.end(), slot.owner) != _heldOwners.end()) {
+            continue;
+        }
+
+        bool blocked = false;
+        for (const auto& other : _slots) {
+            if (&other == &slot || !isPending(other.request._status)) {
+                continue;
+            }
+            if (other.request._status == AsyncStatus::Running && other.owner == slot.owner) {
+                blocked = true;
+            } else if (slot.conversationId != 0 && other.conversationId == slot.conversationId &&
+                       other.sequence < slot.sequence) {
+                blocked = true;
+            }
+            if (blocked) {
+                break;
+            }
+        }
+        if (blocked) {
+            continue;
+        }
+
+        if (best == nullptr || slot.priority > best->priority ||
+            (slot.priority == best->priority && slot.sequence < best->sequence)) {
+            best = &slot;
+        }
+    }
+    return best;
+}
+
+// Called with the queue locked: wakes an idle worker, or starts one, when
+// a request can run. Returns false only if a needed worker failed to start.
+bool AsyncRequestQueue::dispatch() {
+    if (_stopping || _busyWorkers >= _maxWorkers || nextEligible() == nullptr) {
+        return true;
+    }
+    if (_idleWorkers > 0) {
+        xSemaphoreGive(_work);
+        return true;
+    }
+    if (_workerCount >= _maxWorkers) {
+        return true;    // A starting worker will pick it up
+    }
+    for (size_t i = 0; i < ESPAI_ASYNC_MAX_WORKERS; i++) {
+        if (_workers[i].handle == nullptr) {
+            return spawnWorker(_workers[i], i);
+        }
+    }
+    return true;
+}
+
+bool AsyncRequestQueue::spawnWorker(Worker& worker, size_t index) {
+#if defined(CONFIG_FREERTOS_UNICORE)
+    BaseType_t core = tskNO_AFFINITY;
+#else
+    BaseType_t core = 1;
+#endif
+
+    StackType_t* stack = nullptr;
+    bool ownsStack = false;
+    if (_stackBuffer != nullptr && (index + 1) * _stackSize <= _stackBufferSize) {
+        stack = reinterpret_cast<StackType_t*>(_stackBuffer + index * _stackSize);
+    } else if (_stackInPSRAM) {
+#ifdef ARDUINO
+        stack = static_cast<StackType_t*>(heap_caps_malloc(_stackSize, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+#else
+        stack = static_cast<StackType_t*>(malloc(_stackSize));
+#endif
+        ownsStack = (stack != nullptr);
+    }
+
+    if (stack != nullptr) {
+        // The TCB must stay in internal RAM even when the stack is in PSRAM
+        StaticTask_t* tcb = new (std::nothrow) StaticTask_t();
+        TaskHandle_t handle = nullptr;
+        if (tcb != nullptr) {
+            handle = xTaskCreateStaticPinnedToCore(
+                workerTask,
+                "espai_async",
+                _stackSize,
+                &worker,
+                ESPAI_ASYNC_TASK_PRIORITY,
+                stack,
+                tcb,
+                core
+            );
+        }
+        if (handle != nullptr) {
+            worker.tcb = tcb;
+            worker.stack = stack;
+            worker.ownsStack = ownsStack;
+            worker.handle = handle;
+            _workerCount++;
+            return true;
+        }
+        delete tcb;
+        if (ownsStack) free(stack);
+        ESPAI_LOG_W("AsyncQueue", "Static worker stack failed, using the heap");
+    }
+
+    TaskHandle_t handle = nullptr;
+    BaseType_t ret = xTaskCreatePinnedToCore(
+        workerTask,
+        "espai_async",
+        _stackSize,
+        &worker,
+        ESPAI_ASYNC_TASK_PRIORITY,
+        &handle,
+        core
+    );
+    if (ret != pdPASS) {
+        return false;
+    }
+    worker.handle = handle;
+    _workerCount++;
+    return true;
+}
+
+void AsyncRequestQueue::releaseWorkers() {
+    for (auto& worker : _workers) {
+        if (worker.handle == nullptr) {
+            continue;
+        }
+#ifdef ARDUINO
+        // Static memory may only be reused once the task is really gone
+        if (worker.tcb != nullptr) {
+            while (eTaskGetState(worker.handle) != eDeleted) {
+                vTaskDelay(1);
+            }
+        }
+#endif
+        delete worker.tcb;
+        if (worker.ownsStack) free(worker.stack);
+        worker = Worker();
+        worker.queue = this;
+    }
+}
+
+void AsyncRequestQueue::workerTask(void* param) {
+    Worker* worker = static_cast<Worker*>(param);
+    worker->queue->runWorker(*worker);
+    vTaskDelete(nullptr);
+}
+
+void AsyncRequestQueue::runWorker(Worker& worker) {
+    lock();
+    while (true) {
+        Slot* slot = (_busyWorkers < _maxWorkers) ? nextEligible() : nullptr;
+        if (slot == nullptr) {
+            if (_stopping) {
+                break;
+            }
+            _idleWorkers++;
+            unlock();
+            xSemaphoreTake(_work, portMAX_DELAY);
+            lock();
+            _idleWorkers--;
+            continue;
+        }
+
+        slot->request.lock();
+        slot->request._status = AsyncStatus::Running;
+        slot->request.unlock();
+        Task task = std::move(slot->task);
+        slot->task = nullptr;
+        _busyWorkers++;
+        dispatch();     // Hand any other runnable request to an idle worker
+        unlock();
+
+        Response result = task(slot->request);
+        task = nullptr;
+        uint32_t freeStack = uxTaskGetStackHighWaterMark(nullptr);
+
+        lock();
+        _busyWorkers--;
+        if (worker.minFreeStack == 0 || freeStack < worker.minFreeStack) {
+            worker.minFreeStack = freeStack;
+        }
+        ESPAI_LOG_D("AsyncQueue", "Request done, worker stack free: %u bytes", (unsigned)freeStack);
+        Finished finished = finish(*slot, result, freeStack);
+        xSemaphoreGive(_finished);
+        if (finished.hook) {
+            // Continuations run here, so a follow-up step is queued without a round trip
+            unlock();
+            finished.run();
+            lock();
+        }
+    }
+
+    _workerCount--;
+    xSemaphoreGive(_work);      // Pass the stop on to the next idle worker
+    xSemaphoreGive(_finished);
+    unlock();
+}
+
+// Called with the queue locked
+AsyncRequestQueue::Finished AsyncRequestQueue::finish(Slot& slot, const Response& result, uint32_t freeStack) {
+    ChatRequest& req = slot.request;
+    req.lock();
+    req._stackHighWater = freeStack;
+    if (req._cancelRequested.load(std::memory_order_relaxed)) {
+        req._status = AsyncStatus::Cancelled;
+        req._result = Response::fail(ErrorCode::NetworkError, slot.cancelMessage);
+    } else {
+        req._status = result.success ? AsyncStatus::Completed : AsyncStatus::Error;
+        req._result = result;
+    }
+#if ESPAI_ENABLE_STREAMING
+    if (req._streamBuffered) {
+        req._streamBuffer->markDone();
+    }
+#endif
+    Finished finished;
+    finished.result = req._result;
+    req.unlock();
+    finished.hook = std::move(slot.onFinished);
+    slot.onFinished = nullptr;
+    slot.task = nullptr;
+    slot.finishedAt = _nextFinished++;
+    return finished;
+}
+
+size_t AsyncRequestQueue::pendingCount(const void* owner) const {
+    size_t count = 0;
+    lock();
+    for (const auto& slot : _slots) {
+        if (isPending(slot.request._status) && (owner == nullptr || slot.owner == owner)) {
+            count++;
+        }
+    }
+    unlock();
+    return count;
+}
+
+void AsyncRequestQueue::cancelAll(const void* owner) {
+    std::vector<Finished> finished;
+    lock();
+    for (auto& slot : _slots) {
+        if (owner != nullptr && slot.owner != owner) {
+            continue;
+        }
+        AsyncStatus status = slot.request._status;
+        if (!isPending(status)) {
+            continue;
+        }
+        slot.request._cancelRequested.store(true, std::memory_order_relaxed);
+        if (status == AsyncStatus::Queued) {
+            finished.push_back(finish(slot, Response()));
+        }
+    }
+    unlock();
+    for (auto& done : finished) {
+        done.run();
+    }
+}
+
+void AsyncRequestQueue::cancelRequest(ChatRequest* request, uint32_t sequence) {
+    Finished finished;
+    lock();
+    for (auto& slot : _slots) {
+        if (&slot.request != request || slot.sequence != sequence) {
+            continue;
+        }
+        AsyncStatus status = slot.request._status;
+        if (isPending(status)) {
+            slot.request._cancelRequested.store(true, std::memory_order_relaxed);
+            if (status == AsyncStatus::Queued) {
+                finished = finish(slot, Response());
+            }
+        }
+        break;
+    }
+    unlock();
+    finished.run();
+}
+
+void AsyncRequestQueue::detach(const void* owner) {
+    cancelAll(owner);
+    while (true) {
+        bool running = false;
+        lock();
+        for (const auto& slot : _slots) {
+            if (slot.request._status == AsyncStatus::Running && (owner == nullptr || slot.owner == owner)) {
+                running = true;
+                break;
+            }
+        }
+        unlock();
+        if (!running) {
+            return;
+        }
+        xSemaphoreTake(_finished, pdMS_TO_TICKS(10));
+    }
+}
+
+void AsyncRequestQueue::holdOwner(const void* owner) {
+    while (true) {
+        lock();
+        bool busy = std::find(_heldOwners.begin(), _heldOwners.end(), owner) != _heldOwners.end();
+        for (const auto& slot : _slots) {
+            if (busy) {
+                break;
+            }
+            busy = slot.request._status == AsyncStatus::Running && slot.owner == owner;
+        }
+        if (!busy) {
+            _heldOwners.push_back(owner);
+            unlock();
+            return;
+        }
+        unlock();
+        xSemaphoreTake(_finished, pdMS_TO_TICKS(10));
+    }
+}
+
+void AsyncRequestQueue::releaseOwner(const void* owner) {
+    lock();
+    auto it = std::find(_heldOwners.begin(), _heldOwners.end(), owner);
+    if (it != _heldOwners.end()) {
+        _heldOwners.erase(it);
+    }
+    dispatch();
+    unlock();
+    xSemaphoreGive(_finished);
+}
+
+void AsyncRequestQueue::setMaxWorkers(uint8_t workers) {
+    if (workers == 0) workers = 1;
+    if (workers > ESPAI_ASYNC_MAX_WORKERS) workers = ESPAI_ASYNC_MAX_WORKERS;
+    lock();
+    _maxWorkers = workers;
+    dispatch();
+    unlock();
+}
+
+uint8_t AsyncRequestQueue::getActiveWorkers() const {
+    lock();
+    uint8_t workers = _busyWorkers;
+    unlock();
+    return workers;
+}
+
+uint8_t AsyncRequestQueue::getWorkerCount() const {
+    lock();
+    uint8_t workers = _workerCount;
+    unlock();
+    return workers;
+}
+
+bool AsyncRequestQueue::setStackSize(uint32_t bytes) {
+    lock();
+    bool ok = (_workerCount == 0 && bytes >= 1024);
+    if (ok) {
+        _stackSize = bytes & ~static_cast<uint32_t>(15);   // Keep buffer stacks aligned
+    }
+    unlock();
+    return ok;
+}
+
+bool AsyncRequestQueue::setStackBuffer(uint8_t* buffer, size_t bytes) {
+    lock();
+    bool ok = (_workerCount == 0);
+    if (ok) {
+        _stackBuffer = buffer;
+        _stackBufferSize = buffer != nullptr ? bytes : 0;
+    }
+    unlock();
+    return ok;
+}
+
+bool AsyncRequestQueue::setStackInPSRAM(bool enable) {
+    lock();
+    bool ok = (_workerCount == 0);
+    if (ok) {
+        _stackInPSRAM = enable;
+    }
+    unlock();
+    return ok;
+}
+
+uint32_t AsyncRequestQueue::getMinFreeStack() const {
+    uint32_t minFree = 0;
+    lock();
+    for (const auto& worker : _workers) {
+        if (worker.minFreeStack != 0 && (minFree == 0 || worker.minFreeStack < minFree)) {
+            minFree = worker.minFreeStack;
+        }
+    }
+    unlock();
+    return minFree;
+}
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_ASYNC
@@ -0,0 +1,223 @@
+#ifndef ESPAI_ASYNC_REQUEST_QUEUE_H
+#define ESPAI_ASYNC_REQUEST_QUEUE_H
+
+#include "../core/AIConfig.h"
+
+#if ESPAI_ENABLE_ASYNC
+
+#include "AsyncOS.h"
+#include "AsyncTaskRunner.h"
+#include "ChatFuture.h"
+#include <functional>
+#include <vector>
+
+#ifndef ESPAI_ASYNC_QUEUE_SIZE
+#define ESPAI_ASYNC_QUEUE_SIZE      8
+#endif
+
+#ifndef ESPAI_ASYNC_WORKERS
+#define ESPAI_ASYNC_WORKERS         2
+#endif
+
+#ifndef ESPAI_ASYNC_MAX_WORKERS
+#define ESPAI_ASYNC_MAX_WORKERS     4
+#endif
+
+namespace ESPAI {
+
+struct AsyncRequestOptions {
+    uint8_t priority = 0;         // Higher runs first among waiting requests
+    uint32_t conversationId = 0;  // Requests sharing a non-zero id run in submission order
+    size_t streamBufferSize = 0;  // >0: chatStreamAsync() buffers chunks for ChatRequest::readChunks()
+
+    AsyncRequestOptions() = default;
+    AsyncRequestOptions(uint8_t p, uint32_t conversation = 0)
+        : priority(p), conversationId(conversation) {}
+};
+
+/**
+ * Bounded queue of async requests served by a small pool of FreeRTOS
+ * tasks, shared by all providers (see shared()).
+ *
+ * Each submit() takes one of ESPAI_ASYNC_QUEUE_SIZE ChatRequest slots and
+ * returns it as the handle, or nullptr when every slot is queued or
+ * running. The next request to run is the highest-priority one, oldest
+ * first, that is eligible: requests of one owner (a provider, whose state
+ * is not thread-safe) never run concurrently, and a request waits for
+ * every earlier one with the same conversationId.
+ *
+ * Worker tasks are created on demand, at most getMaxWorkers() of them
+ * running requests at once, and then stay alive, blocked until the next
+ * submit(). Their stacks are allocated once: from the heap by default,
+ * from PSRAM (setStackInPSRAM()) or from a caller buffer
+ * (setStackBuffer()), the last two through xTaskCreateStatic. Stack
+ * settings apply only before the first worker starts.
+ *
+ * After each request, the worker's stack high-water mark (the least
+ * free stack it has had so far, in bytes) is stored in the request and
+ * in getMinFreeStack(), to size ESPAI_ASYNC_STACK_SIZE from real runs.
+ *
+ * Cancelling a queued request completes it at once as Cancelled.
+ *
+ * A finished slot is reused by a later submit(), preferring slots whose
+ * callback poll() already delivered, then the ones finished longest ago.
+ * A handle stays valid until then.
+ */
+class AsyncRequestQueue {
+public:
+    using Task = std::function<Response(const ChatRequest& request)>;
+
+    explicit AsyncRequestQueue(uint8_t maxWorkers = ESPAI_ASYNC_WORKERS);
+    ~AsyncRequestQueue();
+
+    // Queue used by every provider unless AIProvider::setAsyncQueue() is called
+    static AsyncRequestQueue& shared();
+
+    ChatRequest* submit(
+        const void* owner,
+        Task task,
+        AsyncChatCallback onComplete = nullptr,
+        const AsyncRequestOptions& options = AsyncRequestOptions(),
+        const char* cancelMessage = "Request cancelled"
+    );
+
+    // Like submit(), with the result delivered through a future. A full
+    // queue gives a future that has already failed.
+    ChatFuture submitFuture(
+        const void* owner,
+        Task task,
+        const AsyncRequestOptions& options = AsyncRequestOptions(),
+        const char* cancelMessage = "Request cancelled"
+    );
+
+    // Requests queued or running for owner (nullptr = any owner)
+    size_t pendingCount(const void* owner = nullptr) const;
+    bool isBusy(const void* owner = nullptr) const { return pendingCount(owner) > 0; }
+
+    // Cancels the owner's requests; queued ones complete at once
+    void cancelAll(const void* owner);
+    // Cancels the owner's requests and blocks until none is running
+    void detach(const void* owner);
+
+    // Lets a blocking call use owner outside the queue: waits until none of
+    // the owner's requests is running (or another hold is released), then
+    // keeps its queued requests waiting until releaseOwner(). Must not be
+    // called from one of the owner's own requests.
+    void holdOwner(const void* owner);
+    void releaseOwner(const void* owner);
+
+    // Scoped holdOwner()
+    class OwnerLock {
+    public:
+        OwnerLock(AsyncRequestQueue& queue, const void* owner) : _queue(queue), _owner(owner) {
+            _queue.holdOwner(_owner);
+        }
+        ~OwnerLock() { _queue.releaseOwner(_owner); }
+
+    private:
+        AsyncRequestQueue& _queue;
+        const void* _owner;
+
+        OwnerLock(const OwnerLock&) = delete;
+        OwnerLock& operator=(const OwnerLock&) = delete;
+    };
+
+    // Requests run concurrently, 1..ESPAI_ASYNC_MAX_WORKERS
+    uint8_t getMaxWorkers() const { return _maxWorkers; }
+    void setMaxWorkers(uint8_t workers);
+    // Workers running a request / worker tasks started
+    uint8_t getActiveWorkers() const;
+    uint8_t getWorkerCount() const;
+
+    // Worker stack size in bytes (default ESPAI_ASYNC_STACK_SIZE)
+    uint32_t getStackSize() const { return _stackSize; }
+    bool setStackSize(uint32_t bytes);
+    // Stacks for the first bytes / getStackSize() workers; the buffer must
+    // outlive the queue. Workers that do not fit use the heap or PSRAM.
+    bool setStackBuffer(uint8_t* buffer, size_t bytes);
+    // Allocate worker stacks from PSRAM, falling back to the heap
+    bool setStackInPSRAM(bool enable);
+
+    // Least free stack in bytes of any worker so far (0 = no request run)
+    uint32_t getMinFreeStack() const;
+
+private:
+    using FinishedHook = std::function<void(const Response& result)>;
+
+    struct Slot {
+        ChatRequest request;
+        const void* owner = nullptr;
+        Task task;
+        uint8_t priority = 0;
+        uint32_t conversationId = 0;
+        uint32_t sequence = 0;      // Submission order
+        uint32_t finishedAt = 0;    // Completion order, for slot reuse
+        const char* cancelMessage = nullptr;
+        FinishedHook onFinished;    // Resolves a ChatFuture, on the finishing task
+    };
+
+    // A finished request's hook, run once the queue is unlocked
+    struct Finished {
+        FinishedHook hook;
+        Response result;
+        void run() { if (hook) hook(result); }
+    };
+
+    struct Worker {
+        AsyncRequestQueue* queue = nullptr;
+        TaskHandle_t handle = nullptr;
+        StaticTask_t* tcb = nullptr;    // Set for static workers
+        StackType_t* stack = nullptr;
+        bool ownsStack = false;         // PSRAM stack freed by the queue
+        uint32_t minFreeStack = 0;
+    };
+
+    Slot _slots[ESPAI_ASYNC_QUEUE_SIZE];
+    Worker _workers[ESPAI_ASYNC_MAX_WORKERS];
+    SemaphoreHandle_t _mutex = nullptr;
+    SemaphoreHandle_t _work = nullptr;      // Wakes an idle worker
+    SemaphoreHandle_t _finished = nullptr;  // Given after every finished request
+    uint8_t _maxWorkers = 1;
+    uint8_t _workerCount = 0;
+    uint8_t _idleWorkers = 0;
+    uint8_t _busyWorkers = 0;
+    bool _stopping = false;
+    uint32_t _stackSize = ESPAI_ASYNC_STACK_SIZE;
+    uint8_t* _stackBuffer = nullptr;
+    size_t _stackBufferSize = 0;
+    bool _stackInPSRAM = false;
+    uint32_t _nextSequence = 1;
+    uint32_t _nextFinished = 1;
+    std::vector<const void*> _heldOwners;   // Owners in use by a blocking call
+
+    void lock() const;
+    void unlock() const;
+    Slot* findFreeSlot();
+    Slot* nextEligible();
+    bool dispatch();
+    bool spawnWorker(Worker& worker, size_t index);
+    void releaseWorkers();
+    ChatRequest* enqueue(
+        const void* owner,
+        Task task,
+        AsyncChatCallback onComplete,
+        const AsyncRequestOptions& options,
+        const char* cancelMessage,
+        FinishedHook onFinished,
+        uint32_t* sequence
+    );
+    // Cancels one request unless its slot has been reused since
+    void cancelRequest(ChatRequest* request, uint32_t sequence);
+    Finished finish(Slot& slot, const Response& result, uint32_t freeStack = 0);
+    void runWorker(Worker& worker);
+
+    static void workerTask(void* param);
+
+    AsyncRequestQueue(const AsyncRequestQueue&) = delete;
+    AsyncRequestQueue& operator=(const AsyncRequestQueue&) = delete;
+};
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_ASYNC
+#endif // ESPAI_ASYNC_REQUEST_QUEUE_H
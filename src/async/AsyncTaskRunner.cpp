@@ -39,6 +39,25 @@ void ChatRequest::cancel() {
     _cancelRequested.store(true, std::memory_order_relaxed);
 }
 
+uint32_t ChatRequest::getStackHighWaterMark() const {
+    lock();
+    uint32_t free = _stackHighWater;
+    unlock();
+    return free;
+}
+
+#if ESPAI_ENABLE_STREAMING
+size_t ChatRequest::readChunks(char* buffer, size_t size) {
+    StreamChunkRing* ring = getStreamBuffer();
+    return ring ? ring->read(buffer, size) : 0;
+}
+
+size_t ChatRequest::readChunks(String& out) {
+    StreamChunkRing* ring = getStreamBuffer();
+    return ring ? ring->read(out) : 0;
+}
+#endif
+
 bool ChatRequest::poll() {
     if (!isComplete()) return false;
 
@@ -143,6 +162,23 @@ bool AsyncTaskRunner::launchStream(
     std::function<bool(StreamCallback)> streamTask,
     StreamCallback streamCb,
     AsyncDoneCallback onDone
+) {
+    return launchStream(
+        [streamTask](StreamCallback cb) -> Response {
+            if (streamTask(cb)) {
+                return Response::ok("");
+            }
+            return Response::fail(ErrorCode::StreamingError, "Stream failed");
+        },
+        std::move(streamCb),
+        std::move(onDone)
+    );
+}
+
+bool AsyncTaskRunner::launchStream(
+    std::function<Response(StreamCallback)> streamTask,
+    StreamCallback streamCb,
+    AsyncDoneCallback onDone
 ) {
     if (isBusy()) return false;
 
@@ -220,7 +256,7 @@ void AsyncTaskRunner::streamTaskFunction(void* param) {
         params->streamCb(chunk, done);
     };
 
-    bool success = params->streamTask(wrappedCb);
+    Response result = params->streamTask(wrappedCb);
     delete params;
 
     req.lock();
@@ -228,12 +264,8 @@ void AsyncTaskRunner::streamTaskFunction(void* param) {
         req._status = AsyncStatus::Cancelled;
         req._result = Response::fail(ErrorCode::NetworkError, "Stream cancelled");
     } else {
-        req._status = success ? AsyncStatus::Completed : AsyncStatus::Error;
-        if (success) {
-            req._result = Response::ok("");
-        } else {
-            req._result = Response::fail(ErrorCode::StreamingError, "Stream failed");
-        }
+        req._status = result.success ? AsyncStatus::Completed : AsyncStatus::Error;
+        req._result = result;
     }
     req.unlock();
 
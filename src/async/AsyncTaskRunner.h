@@ -6,13 +6,12 @@
 #if ESPAI_ENABLE_ASYNC
 
 #include "../core/AITypes.h"
+#include "AsyncOS.h"
+#include "StreamChunkRing.h"
 #include <functional>
 #include <vector>
 #include <atomic>
-
-#include <freertos/FreeRTOS.h>
-#include <freertos/task.h>
-#include <freertos/semphr.h>
+#include <memory>
 
 namespace ESPAI {
 
@@ -21,7 +20,8 @@ enum class AsyncStatus : uint8_t {
     Running,
     Completed,
     Cancelled,
-    Error
+    Error,
+    Queued      // Waiting in an AsyncRequestQueue
 };
 
 struct ChatRequest {
@@ -31,9 +31,22 @@ struct ChatRequest {
     Response getResult() const;
     void cancel();
     bool poll();
+    // Least free stack in bytes of the worker that ran this request, as of
+    // its completion (0 = unknown, e.g. not run by an AsyncRequestQueue)
+    uint32_t getStackHighWaterMark() const;
+
+#if ESPAI_ENABLE_STREAMING
+    // Streamed text buffered with AsyncRequestOptions::streamBufferSize.
+    // Never blocks; once isComplete(), one more call drains the rest.
+    size_t readChunks(char* buffer, size_t size);
+    size_t readChunks(String& out);
+    // The request's chunk ring, nullptr when not buffered
+    StreamChunkRing* getStreamBuffer() const { return _streamBuffered ? _streamBuffer.get() : nullptr; }
+#endif
 
 private:
     friend class AsyncTaskRunner;
+    friend class AsyncRequestQueue;
 
     AsyncStatus _status = AsyncStatus::Idle;
     Response _result;
@@ -41,6 +54,11 @@ private:
     SemaphoreHandle_t _mutex = nullptr;
     std::function<void(const Response&)> _onComplete;
     bool _callbackInvoked = false;
+    uint32_t _stackHighWater = 0;
+#if ESPAI_ENABLE_STREAMING
+    std::unique_ptr<StreamChunkRing> _streamBuffer;   // Kept across reuse of a queue slot
+    bool _streamBuffered = false;
+#endif
 
     void lock() const;
     void unlock() const;
@@ -65,6 +83,11 @@ public:
         StreamCallback streamCb,
         AsyncDoneCallback onDone = nullptr
     );
+    bool launchStream(
+        std::function<Response(StreamCallback)> streamTask,
+        StreamCallback streamCb,
+        AsyncDoneCallback onDone = nullptr
+    );
 
 private:
     ChatRequest _request;
@@ -78,7 +101,7 @@ private:
 
     struct StreamTaskParams {
         AsyncTaskRunner* runner;
-        std::function<bool(StreamCallback)> streamTask;
+        std::function<Response(StreamCallback)> streamTask;
         StreamCallback streamCb;
     };
 
@@ -0,0 +1,114 @@
+#include "ChatCoroutine.h"
+
+#if ESPAI_ENABLE_COROUTINES
+
+namespace ESPAI {
+
+bool ChatAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    _arrived = std::make_shared<std::atomic<bool>>(false);
+    auto arrived = _arrived;
+    _future.onComplete([arrived, handle](const Response&) {
+        if (arrived->exchange(true)) {
+            handle.resume();
+        }
+    });
+    // Already complete (possibly inside onComplete above): don't suspend
+    return !arrived->exchange(true);
+}
+
+#if ESPAI_ENABLE_STREAMING
+struct ChatStream::NextAwaiter::State {
+    String pending;
+    bool done = false;
+    std::coroutine_handle<> waiter;
+    SemaphoreHandle_t mutex = nullptr;
+
+    State() { mutex = xSemaphoreCreateMutex(); }
+    ~State() {
+        if (mutex) vSemaphoreDelete(mutex);
+    }
+    void lock() { xSemaphoreTake(mutex, portMAX_DELAY); }
+    void unlock() { xSemaphoreGive(mutex); }
+
+    // Called locked
+    bool hasNext() const { return pending.length() > 0 || done; }
+
+    State(const State&) = delete;
+    State& operator=(const State&) = delete;
+};
+
+std::shared_ptr<ChatStream::State> ChatStream::makeState() {
+    return std::make_shared<State>();
+}
+
+void ChatStream::push(const std::shared_ptr<State>& state, const String& chunk) {
+    if (chunk.length() == 0) {
+        return;
+    }
+    state->lock();
+    state->pending += chunk;
+    std::coroutine_handle<> waiter = state->waiter;
+    state->waiter = nullptr;
+    state->unlock();
+    if (waiter) {
+        waiter.resume();
+    }
+}
+
+void ChatStream::finish(const std::shared_ptr<State>& state) {
+    state->lock();
+    state->done = true;
+    std::coroutine_handle<> waiter = state->waiter;
+    state->waiter = nullptr;
+    state->unlock();
+    if (waiter) {
+        waiter.resume();
+    }
+}
+
+ChatStream::NextAwaiter ChatStream::next() const {
+    NextAwaiter awaiter;
+    awaiter._state = _state;
+    return awaiter;
+}
+
+bool ChatStream::NextAwaiter::await_ready() const {
+    if (!_state) {
+        return true;
+    }
+    _state->lock();
+    bool ready = _state->hasNext();
+    _state->unlock();
+    return ready;
+}
+
+bool ChatStream::NextAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    _state->lock();
+    if (_state->hasNext()) {
+        _state->unlock();
+        return false;
+    }
+    _state->waiter = handle;
+    _state->unlock();
+    return true;
+}
+
+std::optional<String> ChatStream::NextAwaiter::await_resume() {
+    if (!_state) {
+        return std::nullopt;
+    }
+    _state->lock();
+    if (_state->pending.length() == 0) {
+        _state->unlock();
+        return std::nullopt;
+    }
+    String chunk;
+    std::swap(chunk, _state->pending);
+    _state->unlock();
+    return chunk;
+}
+#endif // ESPAI_ENABLE_STREAMING
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_COROUTINES
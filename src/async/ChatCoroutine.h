@@ -0,0 +1,139 @@
+#ifndef ESPAI_CHAT_COROUTINE_H
+#define ESPAI_CHAT_COROUTINE_H
+
+#include "../core/AIConfig.h"
+
+#if ESPAI_ENABLE_COROUTINES
+
+#include "ChatFuture.h"
+#include <atomic>
+#include <coroutine>
+#include <memory>
+#include <optional>
+
+namespace ESPAI {
+
+/**
+ * C++20 coroutine layer over ChatFuture.
+ *
+ * A ChatFuture can be co_await-ed. The coroutine suspends without blocking
+ * and is resumed on the worker task that finishes the request, so a
+ * multi-step exchange reads top to bottom without extra tasks or callbacks:
+ *
+ *   ChatTask summarizeThenAsk(AIProvider& provider, std::vector<Message> msgs) {
+ *       Response summary = co_await provider.chatCo(msgs, options);
+ *       if (!summary.success) co_return summary;
+ *       co_return co_await provider.chatCo(buildQuestion(summary.content), options);
+ *   }
+ *
+ *   ChatFuture answer = summarizeThenAsk(provider, msgs);
+ *
+ * The body up to the first co_await runs on the calling task. Everything
+ * after it runs on async workers, with the same rules as a then()
+ * continuation: keep it short and never block on another future.
+ * Arguments are copied into the coroutine frame, so take them by value.
+ */
+class ChatTask {
+public:
+    struct promise_type {
+        ChatFuture future = ChatTask::makePending();
+
+        ChatTask get_return_object() { return ChatTask(future); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_value(const Response& response) { ChatTask::resolve(future, response); }
+        void unhandled_exception() {
+            ChatTask::resolve(future, Response::fail(ErrorCode::InvalidRequest, "Unhandled exception in coroutine"));
+        }
+    };
+
+    ChatFuture future() const { return _future; }
+    operator ChatFuture() const { return _future; }
+
+    bool isReady() const { return _future.isReady(); }
+    bool waitFor(uint32_t timeoutMs) const { return _future.waitFor(timeoutMs); }
+    Response get() const { return _future.get(); }
+
+private:
+    ChatFuture _future;
+
+    explicit ChatTask(const ChatFuture& future) : _future(future) {}
+    static ChatFuture makePending() { return ChatFuture::pending(); }
+    static void resolve(const ChatFuture& future, const Response& response) { future.resolve(response); }
+};
+
+// Awaiter for co_await on a ChatFuture or ChatTask
+class ChatAwaiter {
+public:
+    explicit ChatAwaiter(ChatFuture future) : _future(std::move(future)) {}
+
+    bool await_ready() const { return !_future.valid() || _future.isReady(); }
+    bool await_suspend(std::coroutine_handle<> handle);
+    Response await_resume() const { return _future.get(); }
+
+private:
+    ChatFuture _future;
+    // Whichever of await_suspend() and the completion gets here second resumes
+    std::shared_ptr<std::atomic<bool>> _arrived;
+};
+
+inline ChatAwaiter operator co_await(ChatFuture future) { return ChatAwaiter(std::move(future)); }
+inline ChatAwaiter operator co_await(const ChatTask& task) { return ChatAwaiter(task.future()); }
+
+#if ESPAI_ENABLE_STREAMING
+/**
+ * Async generator over a streamed response.
+ *
+ *   ChatStream stream = provider.chatStreamCo(msgs, options);
+ *   while (auto chunk = co_await stream.next()) {
+ *       display.print(*chunk);
+ *   }
+ *   Response full = stream.result();
+ *
+ * The consumer is resumed on the worker task from inside the stream
+ * callback, so each chunk is handled as it arrives with no copy through a
+ * queue. Chunks that arrive while the consumer is busy elsewhere are joined
+ * and returned by the next next(). next() yields std::nullopt once the
+ * stream is over; result() then holds the final response. One consumer only.
+ */
+class ChatStream {
+public:
+    class NextAwaiter {
+    public:
+        bool await_ready() const;
+        bool await_suspend(std::coroutine_handle<> handle);
+        std::optional<String> await_resume();
+
+    private:
+        friend class ChatStream;
+        struct State;
+        std::shared_ptr<State> _state;
+    };
+
+    ChatStream() = default;  // Invalid until assigned
+
+    bool valid() const { return _state != nullptr; }
+    NextAwaiter next() const;
+    // Final response; complete once next() has yielded std::nullopt
+    Response result() const { return _future.get(); }
+    ChatFuture future() const { return _future; }
+    void cancel() { _future.cancel(); }
+
+private:
+    friend class AIProvider;
+    using State = NextAwaiter::State;
+
+    std::shared_ptr<State> _state;
+    ChatFuture _future;
+
+    static std::shared_ptr<State> makeState();
+    // Producer side, on the worker task
+    static void push(const std::shared_ptr<State>& state, const String& chunk);
+    static void finish(const std::shared_ptr<State>& state);
+};
+#endif // ESPAI_ENABLE_STREAMING
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_COROUTINES
+#endif // ESPAI_CHAT_COROUTINE_H
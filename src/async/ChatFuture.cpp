@@ -0,0 +1,281 @@
+#include "ChatFuture.h"
+
+#if ESPAI_ENABLE_ASYNC
+
+#include <atomic>
+
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+namespace ESPAI {
+
+namespace {
+    uint32_t nowMs() {
+#ifdef ARDUINO
+        return millis();
+#else
+        static auto start = std::chrono::steady_clock::now();
+        auto now = std::chrono::steady_clock::now();
+        return static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count());
+#endif
+    }
+}
+
+struct ChatFuture::State {
+    Response result;
+    bool done = false;
+    bool cancelRequested = false;
+    std::vector<std::function<void(const Response&)>> callbacks;
+    std::function<void()> canceller;
+    SemaphoreHandle_t mutex = nullptr;
+    SemaphoreHandle_t signal = nullptr;  // Given when done
+
+    State() {
+        mutex = xSemaphoreCreateMutex();
+        signal = xSemaphoreCreateBinary();
+    }
+    ~State() {
+        if (mutex) vSemaphoreDelete(mutex);
+        if (signal) vSemaphoreDelete(signal);
+    }
+    void lock() { xSemaphoreTake(mutex, portMAX_DELAY); }
+    void unlock() { xSemaphoreGive(mutex); }
+    void notify() { xSemaphoreGive(signal); }
+
+    State(const State&) = delete;
+    State& operator=(const State&) = delete;
+};
+
+ChatFuture ChatFuture::pending() {
+    ChatFuture future;
+    future._state = std::make_shared<State>();
+    return future;
+}
+
+ChatFuture ChatFuture::ready(const Response& response) {
+    ChatFuture future = pending();
+    future.resolve(response);
+    return future;
+}
+
+void ChatFuture::resolve(const Response& response) const {
+    if (!_state) {
+        return;
+    }
+    _state->lock();
+    if (_state->done) {
+        _state->unlock();
+        return;
+    }
+    _state->result = response;
+    _state->done = true;
+    _state->canceller = nullptr;
+    std::vector<std::function<void(const Response&)>> callbacks;
+    callbacks.swap(_state->callbacks);
+    _state->unlock();
+    _state->notify();
+
+    for (auto& callback : callbacks) {
+        callback(response);
+    }
+}
+
+void ChatFuture::setCanceller(std::function<void()> canceller) const {
+    _state->lock();
+    if (_state->done) {
+        _state->unlock();
+        return;
+    }
+    bool cancelNow = _state->cancelRequested;
+    if (!cancelNow) {
+        _state->canceller = canceller;
+    }
+    _state->unlock();
+    if (cancelNow && canceller) {
+        canceller();
+    }
+}
+
+bool ChatFuture::isCancelRequested() const {
+    _state->lock();
+    bool cancelled = _state->cancelRequested;
+    _state->unlock();
+    return cancelled;
+}
+
+bool ChatFuture::isReady() const {
+    if (!_state) {
+        return false;
+    }
+    _state->lock();
+    bool done = _state->done;
+    _state->unlock();
+    return done;
+}
+
+bool ChatFuture::waitFor(uint32_t timeoutMs) const {
+    if (!_state) {
+        return false;
+    }
+    uint32_t startMs = nowMs();
+    while (true) {
+        if (isReady()) {
+            // Pass the signal on to any other waiter
+            _state->notify();
+            return true;
+        }
+
+        TickType_t wait = portMAX_DELAY;
+        if (timeoutMs > 0) {
+            uint32_t elapsed = nowMs() - startMs;
+            if (elapsed >= timeoutMs) {
+                return false;
+            }
+            wait = pdMS_TO_TICKS(timeoutMs - elapsed);
+            if (wait == 0) {
+                wait = 1;
+            }
+        }
+        xSemaphoreTake(_state->signal, wait);
+    }
+}
+
+Response ChatFuture::get() const {
+    if (!_state) {
+        return Response::fail(ErrorCode::InvalidRequest, "Invalid future");
+    }
+    waitFor(0);
+    _state->lock();
+    Response result = _state->result;
+    _state->unlock();
+    return result;
+}
+
+void ChatFuture::cancel() {
+    if (!_state) {
+        return;
+    }
+    _state->lock();
+    if (_state->done) {
+        _state->unlock();
+        return;
+    }
+    _state->cancelRequested = true;
+    std::function<void()> canceller = _state->canceller;
+    _state->unlock();
+    if (canceller) {
+        canceller();
+    }
+}
+
+void ChatFuture::onComplete(std::function<void(const Response& response)> callback) const {
+    if (!_state || !callback) {
+        return;
+    }
+    _state->lock();
+    if (!_state->done) {
+        _state->callbacks.push_back(std::move(callback));
+        _state->unlock();
+        return;
+    }
+    Response result = _state->result;
+    _state->unlock();
+    callback(result);
+}
+
+ChatFuture ChatFuture::then(Continuation next) const {
+    if (!_state) {
+        return ready(Response::fail(ErrorCode::InvalidRequest, "Invalid future"));
+    }
+
+    ChatFuture result = pending();
+    ChatFuture source = *this;
+    result.setCanceller([source]() mutable { source.cancel(); });
+
+    onComplete([result, next](const Response& previous) {
+        if (!previous.success) {
+            result.resolve(previous);
+            return;
+        }
+        if (result.isCancelRequested()) {
+            result.resolve(Response::fail(ErrorCode::NetworkError, "Request cancelled"));
+            return;
+        }
+        ChatFuture step = next(previous);
+        if (!step.valid()) {
+            result.resolve(Response::fail(ErrorCode::InvalidRequest, "Continuation returned no future"));
+            return;
+        }
+        result.setCanceller([step]() mutable { step.cancel(); });
+        step.onComplete([result](const Response& response) { result.resolve(response); });
+    });
+    return result;
+}
+
+ChatFuture ChatFuture::then(Transform next) const {
+    if (!_state) {
+        return ready(Response::fail(ErrorCode::InvalidRequest, "Invalid future"));
+    }
+
+    ChatFuture result = pending();
+    ChatFuture source = *this;
+    result.setCanceller([source]() mutable { source.cancel(); });
+
+    onComplete([result, next](const Response& previous) {
+        result.resolve(previous.success ? next(previous) : previous);
+    });
+    return result;
+}
+
+ChatFuture ChatFuture::whenAll(const std::vector<ChatFuture>& futures) {
+    if (futures.empty()) {
+        return ready(Response::ok(""));
+    }
+
+    ChatFuture result = pending();
+    auto inputs = std::make_shared<std::vector<ChatFuture>>(futures);
+    auto remaining = std::make_shared<std::atomic<size_t>>(futures.size());
+    result.setCanceller([inputs]() {
+        for (auto& future : *inputs) future.cancel();
+    });
+
+    for (const auto& future : futures) {
+        future.onComplete([result, inputs, remaining](const Response&) {
+            if (remaining->fetch_sub(1) != 1) {
+                return;
+            }
+            for (const auto& input : *inputs) {
+                Response response = input.get();
+                if (!response.success) {
+                    result.resolve(response);
+                    return;
+                }
+            }
+            result.resolve(Response::ok(""));
+        });
+    }
+    return result;
+}
+
+ChatFuture ChatFuture::whenAny(const std::vector<ChatFuture>& futures) {
+    if (futures.empty()) {
+        return ready(Response::fail(ErrorCode::InvalidRequest, "No futures"));
+    }
+
+    ChatFuture result = pending();
+    auto inputs = std::make_shared<std::vector<ChatFuture>>(futures);
+    result.setCanceller([inputs]() {
+        for (auto& future : *inputs) future.cancel();
+    });
+
+    for (const auto& future : futures) {
+        future.onComplete([result](const Response& response) { result.resolve(response); });
+    }
+    return result;
+}
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_ASYNC
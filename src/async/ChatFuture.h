@@ -0,0 +1,82 @@
+#ifndef ESPAI_CHAT_FUTURE_H
+#define ESPAI_CHAT_FUTURE_H
+
+#include "../core/AIConfig.h"
+
+#if ESPAI_ENABLE_ASYNC
+
+#include "AsyncTaskRunner.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace ESPAI {
+
+/**
+ * Result of an async request, or of a chain of them.
+ *
+ * Unlike a ChatRequest handle, a future owns its result: it stays valid
+ * after the queue slot is reused, and copies share one state. It is
+ * resolved on the worker task that finishes the request, and
+ * continuations run right there, so a multi-step pipeline goes from one
+ * step to the next without a round trip through loop():
+ *
+ *   ChatFuture answer = provider.chatFuture(summarizeMsgs, options)
+ *       .then([&](const Response& summary) {
+ *           return provider.chatFuture(buildQuestion(summary.content), options);
+ *       });
+ *   if (answer.waitFor(30000)) Serial.println(answer.get().content);
+ *
+ * then() continuations run only when the previous step succeeded; a
+ * failure or cancellation skips them and is passed down the chain.
+ * Continuations must not block on other futures. Not for use from ISRs.
+ */
+class ChatFuture {
+public:
+    using Continuation = std::function<ChatFuture(const Response& previous)>;
+    using Transform = std::function<Response(const Response& previous)>;
+
+    ChatFuture() = default;  // Invalid until assigned
+
+    static ChatFuture ready(const Response& response);
+    // Ready once every future is; fails with the first failed result (by position)
+    static ChatFuture whenAll(const std::vector<ChatFuture>& futures);
+    // Ready with the first result of any future
+    static ChatFuture whenAny(const std::vector<ChatFuture>& futures);
+
+    bool valid() const { return _state != nullptr; }
+    bool isReady() const;
+    // Blocks until ready or for timeoutMs (0 = no limit). Returns isReady().
+    bool waitFor(uint32_t timeoutMs) const;
+    // Blocks until ready
+    Response get() const;
+
+    // Cancels the step currently running; the future then fails
+    void cancel();
+
+    // Starts another async step with this result
+    ChatFuture then(Continuation next) const;
+    // Maps this result on the resolving task
+    ChatFuture then(Transform next) const;
+    // Runs on the resolving task for any result; at once if already ready
+    void onComplete(std::function<void(const Response& response)> callback) const;
+
+private:
+    friend class AsyncRequestQueue;
+    friend class ChatTask;
+
+    struct State;
+    std::shared_ptr<State> _state;
+
+    static ChatFuture pending();
+    // First call wins
+    void resolve(const Response& response) const;
+    // Called by cancel() until the future is resolved
+    void setCanceller(std::function<void()> canceller) const;
+    bool isCancelRequested() const;
+};
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_ASYNC
+#endif // ESPAI_CHAT_FUTURE_H
@@ -0,0 +1,122 @@
+#include "StreamChunkRing.h"
+#include <cstring>
+#include <new>
+
+#if ESPAI_ENABLE_STREAMING
+
+namespace ESPAI {
+
+namespace {
+    void appendBytes(String& out, const char* data, size_t length) {
+#ifdef ARDUINO
+        out.concat(data, length);
+#else
+        out.append(data, length);
+#endif
+    }
+}
+
+StreamChunkRing::StreamChunkRing(size_t capacity) {
+    _buffer = new (std::nothrow) char[capacity > 0 ? capacity : 1];
+    _capacity = (_buffer != nullptr) ? capacity : 0;
+}
+
+StreamChunkRing::~StreamChunkRing() {
+    delete[] _buffer;
+}
+
+bool StreamChunkRing::write(const char* data, size_t length) {
+    if (length == 0) {
+        return true;
+    }
+
+    size_t head = _head.load(std::memory_order_relaxed);
+    size_t tail = _tail.load(std::memory_order_acquire);
+    size_t used = head - tail;
+    if (length > _capacity - used) {
+        _dropped.fetch_add(length, std::memory_order_relaxed);
+        return false;
+    }
+
+    size_t offset = head % _capacity;
+    size_t first = _capacity - offset;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(_buffer + offset, data, first);
+    memcpy(_buffer, data + first, length - first);
+    _head.store(head + length, std::memory_order_release);
+
+    used += length;
+    if (used > _highWater.load(std::memory_order_relaxed)) {
+        _highWater.store(used, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void StreamChunkRing::markDone() {
+    _done.store(true, std::memory_order_release);
+}
+
+size_t StreamChunkRing::read(char* buffer, size_t size) {
+    size_t tail = _tail.load(std::memory_order_relaxed);
+    size_t head = _head.load(std::memory_order_acquire);
+    size_t count = head - tail;
+    if (count > size) {
+        count = size;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    size_t offset = tail % _capacity;
+    size_t first = _capacity - offset;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(buffer, _buffer + offset, first);
+    memcpy(buffer + first, _buffer, count - first);
+    _tail.store(tail + count, std::memory_order_release);
+    return count;
+}
+
+size_t StreamChunkRing::read(String& out) {
+    size_t tail = _tail.load(std::memory_order_relaxed);
+    size_t head = _head.load(std::memory_order_acquire);
+    size_t count = head - tail;
+    if (count == 0) {
+        return 0;
+    }
+
+    size_t offset = tail % _capacity;
+    size_t first = _capacity - offset;
+    if (first > count) {
+        first = count;
+    }
+    out.reserve(out.length() + count);
+    appendBytes(out, _buffer + offset, first);
+    appendBytes(out, _buffer, count - first);
+    _tail.store(tail + count, std::memory_order_release);
+    return count;
+}
+
+size_t StreamChunkRing::available() const {
+    return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+}
+
+bool StreamChunkRing::isDone() const {
+    // Check done first: every write happens before markDone()
+    return _done.load(std::memory_order_acquire) && available() == 0;
+}
+
+void StreamChunkRing::reset() {
+    _head.store(0, std::memory_order_relaxed);
+    _tail.store(0, std::memory_order_relaxed);
+    _highWater.store(0, std::memory_order_relaxed);
+    _dropped.store(0, std::memory_order_relaxed);
+    _done.store(false, std::memory_order_release);
+}
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_STREAMING
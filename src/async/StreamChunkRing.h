@@ -0,0 +1,70 @@
+#ifndef ESPAI_STREAM_CHUNK_RING_H
+#define ESPAI_STREAM_CHUNK_RING_H
+
+#include "../core/AIConfig.h"
+#include "../core/AITypes.h"
+#include <atomic>
+
+#if ESPAI_ENABLE_STREAMING
+
+#ifndef ESPAI_STREAM_RING_SIZE
+#define ESPAI_STREAM_RING_SIZE      1024
+#endif
+
+namespace ESPAI {
+
+/**
+ * Lock-free single-producer single-consumer byte ring for streamed text.
+ *
+ * The network task write()s each chunk and markDone()s at the end; one
+ * application task (loop() or a UI task) read()s without locking, so
+ * neither side ever blocks the other. A chunk that does not fit whole is
+ * dropped and counted in getDroppedBytes() rather than stalling the
+ * producer, so a slow consumer loses text but never slows the stream.
+ *
+ * Producer-only: write(), markDone(). Consumer-only: read(). reset() is
+ * for when neither side is active.
+ */
+class StreamChunkRing {
+public:
+    explicit StreamChunkRing(size_t capacity = ESPAI_STREAM_RING_SIZE);
+    ~StreamChunkRing();
+
+    // Appends a whole chunk; returns false (and counts it) if it did not fit
+    bool write(const char* data, size_t length);
+    bool write(const String& chunk) { return write(chunk.c_str(), chunk.length()); }
+    void markDone();
+
+    // Copies up to size buffered bytes into buffer; returns the count
+    size_t read(char* buffer, size_t size);
+    // Appends everything buffered to out; returns the count
+    size_t read(String& out);
+
+    size_t available() const;
+    size_t capacity() const { return _capacity; }
+    // markDone() was called and every byte has been read
+    bool isDone() const;
+
+    // Most bytes buffered at once since the last reset()
+    size_t getHighWaterMark() const { return _highWater.load(std::memory_order_relaxed); }
+    size_t getDroppedBytes() const { return _dropped.load(std::memory_order_relaxed); }
+
+    void reset();
+
+private:
+    char* _buffer = nullptr;
+    size_t _capacity = 0;
+    std::atomic<size_t> _head{0};   // Total bytes written
+    std::atomic<size_t> _tail{0};   // Total bytes read
+    std::atomic<size_t> _highWater{0};
+    std::atomic<size_t> _dropped{0};
+    std::atomic<bool> _done{false};
+
+    StreamChunkRing(const StreamChunkRing&) = delete;
+    StreamChunkRing& operator=(const StreamChunkRing&) = delete;
+};
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_STREAMING
+#endif // ESPAI_STREAM_CHUNK_RING_H
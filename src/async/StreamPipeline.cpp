@@ -0,0 +1,148 @@
+#include "StreamPipeline.h"
+
+#if ESPAI_ENABLE_STREAM_PIPELINE
+
+#include "../http/SSEParser.h"
+
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+namespace ESPAI {
+
+namespace {
+    // Longest either side waits before re-checking for stop or end of input
+    const TickType_t kPollTicks = pdMS_TO_TICKS(10);
+    const size_t kParseChunkSize = 512;
+
+    uint32_t nowMs() {
+#ifdef ARDUINO
+        return millis();
+#else
+        static auto start = std::chrono::steady_clock::now();
+        auto now = std::chrono::steady_clock::now();
+        return static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count());
+#endif
+    }
+
+    BaseType_t parserCoreFor(int configured) {
+        if (configured >= 0) {
+            return configured;
+        }
+#if defined(ARDUINO) && portNUM_PROCESSORS > 1
+        return xPortGetCoreID() == 0 ? 1 : 0;
+#else
+        return tskNO_AFFINITY;
+#endif
+    }
+}
+
+StreamPipeline::StreamPipeline(SSEParser& parser, const StreamPipelineConfig& config)
+    : _parser(parser)
+    , _config(config) {
+    _stats.bufferSize = config.bufferSize;
+}
+
+StreamPipeline::~StreamPipeline() {
+    finish();
+    if (_buffer) {
+        vStreamBufferDelete(_buffer);
+    }
+    if (_exited) {
+        vSemaphoreDelete(_exited);
+    }
+}
+
+bool StreamPipeline::start() {
+    _buffer = xStreamBufferCreate(_config.bufferSize, 1);
+    _exited = xSemaphoreCreateBinary();
+    if (!_buffer || !_exited) {
+        return false;
+    }
+    if (xTaskCreatePinnedToCore(parserTask, "espai_parse", _config.parserStackSize, this,
+                                _config.parserPriority, nullptr,
+                                parserCoreFor(_config.parserCore)) != pdPASS) {
+        return false;
+    }
+    _running = true;
+    return true;
+}
+
+bool StreamPipeline::push(const uint8_t* data, size_t length) {
+    size_t sent = 0;
+    bool stalled = false;
+    uint32_t stallStart = 0;
+
+    while (sent < length) {
+        if (_stopped.load(std::memory_order_acquire)) {
+            return false;
+        }
+        if (!stalled && xStreamBufferSpacesAvailable(_buffer) < length - sent) {
+            stalled = true;
+            stallStart = nowMs();
+        }
+        sent += xStreamBufferSend(_buffer, data + sent, length - sent, kPollTicks);
+        size_t buffered = _config.bufferSize - xStreamBufferSpacesAvailable(_buffer);
+        if (buffered > _stats.peakBuffered) {
+            _stats.peakBuffered = buffered;
+        }
+    }
+
+    _stats.bytes += static_cast<uint32_t>(length);
+    if (stalled) {
+        _stats.readerStalls++;
+        _stats.readerStallMs += nowMs() - stallStart;
+    }
+    return !_stopped.load(std::memory_order_acquire);
+}
+
+void StreamPipeline::finish() {
+    if (!_running) {
+        return;
+    }
+    _inputDone.store(true, std::memory_order_release);
+    xSemaphoreTake(_exited, portMAX_DELAY);
+    _running = false;
+    _stats.parserStarved = _parserStarved;
+}
+
+void StreamPipeline::parserTask(void* param) {
+    StreamPipeline* self = static_cast<StreamPipeline*>(param);
+    self->parse();
+    // The reader may destroy the pipeline as soon as this is given
+    xSemaphoreGive(self->_exited);
+    vTaskDelete(nullptr);
+}
+
+void StreamPipeline::parse() {
+    char chunk[kParseChunkSize];
+    bool waiting = false;
+    for (;;) {
+        // Read the flag first: bytes sent before it was set are then visible below
+        bool inputDone = _inputDone.load(std::memory_order_acquire);
+        if (xStreamBufferBytesAvailable(_buffer) == 0) {
+            if (inputDone) {
+                return;
+            }
+            if (!waiting) {
+                _parserStarved++;
+                waiting = true;
+            }
+        }
+        size_t received = xStreamBufferReceive(_buffer, chunk, sizeof(chunk), kPollTicks);
+        if (received == 0) {
+            continue;
+        }
+        waiting = false;
+        _parser.feed(chunk, received);
+        if (_parser.isDone() || _parser.hasError() || _parser.isCancelled()) {
+            _stopped.store(true, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_STREAM_PIPELINE
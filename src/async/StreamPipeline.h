@@ -0,0 +1,97 @@
+#ifndef ESPAI_STREAM_PIPELINE_H
+#define ESPAI_STREAM_PIPELINE_H
+
+#include "../core/AIConfig.h"
+
+#if ESPAI_ENABLE_STREAM_PIPELINE
+
+#include "AsyncOS.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef ESPAI_PIPELINE_BUFFER_SIZE
+#define ESPAI_PIPELINE_BUFFER_SIZE  4096
+#endif
+
+#ifndef ESPAI_PIPELINE_STACK_SIZE
+#define ESPAI_PIPELINE_STACK_SIZE   8192
+#endif
+
+#ifndef ESPAI_PIPELINE_PRIORITY
+#define ESPAI_PIPELINE_PRIORITY     ESPAI_ASYNC_TASK_PRIORITY
+#endif
+
+namespace ESPAI {
+
+class SSEParser;
+
+// AIProvider::setStreamPipeline()
+struct StreamPipelineConfig {
+    bool enabled = false;
+    size_t bufferSize = ESPAI_PIPELINE_BUFFER_SIZE;
+    uint32_t parserStackSize = ESPAI_PIPELINE_STACK_SIZE;
+    UBaseType_t parserPriority = ESPAI_PIPELINE_PRIORITY;
+    int parserCore = -1;          // -1: the core the calling task is not on
+};
+
+// AIProvider::getLastPipelineStats(); all zero when the last stream ran inline
+struct StreamPipelineStats {
+    uint32_t bytes = 0;           // Passed from the reader to the parser
+    size_t bufferSize = 0;
+    size_t peakBuffered = 0;      // Most bytes waiting at once
+    uint32_t readerStalls = 0;    // Reads that found the buffer full (backpressure)
+    uint32_t readerStallMs = 0;   // Time the reader spent waiting for room
+    uint32_t parserStarved = 0;   // Times the parser ran out of input (network bound)
+};
+
+/**
+ * Two-stage chatStream(): the calling task only reads the socket and
+ * push()es raw bytes into a stream buffer, while a parser task pinned to
+ * the other core runs SSEParser::feed() and therefore every stream, tool
+ * and argument callback. A slow callback then no longer delays reading,
+ * so the TCP window stays open until the buffer is full; when it is, the
+ * reader blocks, which shows up as readerStalls.
+ *
+ * Used by AIProvider::chatStream() when enabled; one pipeline per stream.
+ */
+class StreamPipeline {
+public:
+    StreamPipeline(SSEParser& parser, const StreamPipelineConfig& config);
+    ~StreamPipeline();
+
+    // False when the buffer or task could not be created; parse inline instead
+    bool start();
+
+    // Reader side. Waits for room as needed; false once the parser has stopped
+    // (done, error or cancelled) and wants no more input.
+    bool push(const uint8_t* data, size_t length);
+
+    // Reader side: no more input. Returns once the parser task has consumed
+    // everything and exited; the parser may then be used from this task again.
+    void finish();
+
+    const StreamPipelineStats& getStats() const { return _stats; }
+
+private:
+    SSEParser& _parser;
+    StreamPipelineConfig _config;
+    StreamBufferHandle_t _buffer = nullptr;
+    SemaphoreHandle_t _exited = nullptr;
+    bool _running = false;
+    std::atomic<bool> _inputDone{false};
+    std::atomic<bool> _stopped{false};
+    StreamPipelineStats _stats;
+    uint32_t _parserStarved = 0;  // Written by the parser task only
+
+    static void parserTask(void* param);
+    void parse();
+
+    StreamPipeline(const StreamPipeline&) = delete;
+    StreamPipeline& operator=(const StreamPipeline&) = delete;
+};
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_STREAM_PIPELINE
+#endif // ESPAI_STREAM_PIPELINE_H
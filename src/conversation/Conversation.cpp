@@ -1,16 +1,50 @@
 #include "Conversation.h"
+#include "ConversationLog.h"
 #include <ArduinoJson.h>
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#if ESPAI_ENABLE_ASYNC
+#include "../providers/AIProvider.h"
+#endif
 
 namespace ESPAI {
 
+#if ESPAI_ENABLE_ASYNC
+namespace {
+    const char* kDefaultSummaryInstructions =
+        "Summarize the conversation below in a few sentences. Keep the facts, names, numbers, "
+        "decisions and open questions that later turns may need. Reply with the summary only.";
+}
+#endif
+
+uint32_t Conversation::InstanceId::next() {
+    static std::atomic<uint32_t> counter(0);
+    uint32_t id = ++counter;
+    return id != 0 ? id : ++counter;
+}
+
 Conversation::Conversation(size_t maxMessages)
-    : _messages()
+    : _slots()
+    , _slotTokens()
     , _systemPrompt()
     , _maxMessages(maxMessages) {
 }
 
+Conversation::~Conversation() {
+    if (_log.log) {
+        _log.log->detached();
+    }
+}
+
 void Conversation::setSystemPrompt(const String& prompt) {
     _systemPrompt = prompt;
+    _systemTokens = (prompt.length() + 3) / 4;
+    _fitTokenBudget();
+    if (_log.log) {
+        _log.log->logSystemPrompt(prompt);
+    }
 }
 
 const String& Conversation::getSystemPrompt() const {
@@ -18,8 +52,20 @@ const String& Conversation::getSystemPrompt() const {
 }
 
 void Conversation::addMessage(Role role, const String& content) {
-    _messages.push_back(Message(role, content));
-    _pruneIfNeeded();
+    addMessage(Message(role, content));
+}
+
+void Conversation::addMessage(const Message& message) {
+#if ESPAI_ENABLE_ASYNC
+    pollCompaction();
+#endif
+    _append(message);
+    if (_log.log) {
+        _log.log->logMessage(message);
+    }
+#if ESPAI_ENABLE_ASYNC
+    _startCompaction();
+#endif
 }
 
 void Conversation::addUserMessage(const String& content) {
@@ -30,34 +76,56 @@ void Conversation::addAssistantMessage(const String& content) {
     addMessage(Role::Assistant, content);
 }
 
-const std::vector<Message>& Conversation::getMessages() const {
-    return _messages;
+MessageView Conversation::getMessages() const {
+    size_t firstSize = std::min(_count, _slots.size() - _head);
+    return MessageView(_slots.data() + _head, firstSize, _slots.data(), _count - firstSize);
 }
 
 size_t Conversation::size() const {
-    return _messages.size();
+    return _count;
 }
 
 void Conversation::clear() {
-    _messages.clear();
+    _frontSeq += _count;
+    _clearSlots();
+    if (_log.log) {
+        _log.log->logClear();
+    }
+#if ESPAI_ENABLE_ASYNC
+    // A summary of the cleared history must not come back
+    _cancelCompaction();
+#endif
 }
 
 void Conversation::setMaxMessages(size_t max) {
-    _maxMessages = max;
-    _pruneIfNeeded();
+    _rebuild(max);
+    if (_log.log) {
+        _log.log->logSnapshot();
+    }
 }
 
 size_t Conversation::getMaxMessages() const {
     return _maxMessages;
 }
 
-size_t Conversation::estimateTokens() const {
-    size_t chars = _systemPrompt.length();
-    for (const auto& msg : _messages) {
-        chars += msg.content.length();
+void Conversation::setTokenBudget(size_t tokens) {
+    _tokenBudget = tokens;
+    _fitTokenBudget();
+    if (_log.log) {
+        _log.log->logSnapshot();
     }
-    // Rough estimate: 1 token per 4 characters
-    return chars / 4;
+}
+
+size_t Conversation::getTokenBudget() const {
+    return _tokenBudget;
+}
+
+size_t Conversation::estimateTokens() const {
+    return _systemTokens + _messageTokens;
+}
+
+size_t Conversation::estimateTokens(const Message& message) {
+    return (message.content.length() + message.toolCallsJson.length() + 3) / 4;
 }
 
 String Conversation::toJson() const {
@@ -65,9 +133,12 @@ String Conversation::toJson() const {
 
     doc["systemPrompt"] = _systemPrompt.c_str();
     doc["maxMessages"] = _maxMessages;
+    if (_tokenBudget > 0) {
+        doc["tokenBudget"] = _tokenBudget;
+    }
 
     JsonArray messagesArray = doc["messages"].to<JsonArray>();
-    for (const auto& msg : _messages) {
+    for (const auto& msg : getMessages()) {
         JsonObject msgObj = messagesArray.add<JsonObject>();
         msgObj["role"] = static_cast<int>(msg.role);
         msgObj["content"] = msg.content.c_str();
@@ -92,9 +163,14 @@ bool Conversation::fromJson(const String& json) {
         return false;
     }
 
-    _systemPrompt = doc["systemPrompt"].as<const char*>();
+    // Logged as one snapshot once loaded rather than record by record
+    ConversationLog* log = _log.log;
+    _log.log = nullptr;
+
+    clear();
     _maxMessages = doc["maxMessages"] | 20;
-    _messages.clear();
+    _tokenBudget = doc["tokenBudget"] | 0;
+    setSystemPrompt(doc["systemPrompt"].as<const char*>());
 
     JsonArray messagesArray = doc["messages"].as<JsonArray>();
     for (JsonObject msgObj : messagesArray) {
@@ -108,16 +184,245 @@ bool Conversation::fromJson(const String& json) {
         if (msgObj["toolCallsJson"]) {
             msg.toolCallsJson = msgObj["toolCallsJson"].as<const char*>();
         }
-        _messages.push_back(msg);
+        _append(msg);
+    }
+
+    _log.log = log;
+    if (_log.log) {
+        _log.log->logSnapshot();
+    }
+    return true;
+}
+
+void Conversation::_append(const Message& message) {
+    if (_maxMessages == 0) {
+        return;
+    }
+
+    bool full = _count == _maxMessages;
+    if (full) {
+        _dropOldest();
+    }
+
+    uint32_t tokens = static_cast<uint32_t>(estimateTokens(message));
+    if (_count < _slots.size()) {
+        // The slot just freed, or room left behind by earlier drops
+        size_t slot = (_head + _count) % _slots.size();
+        _slots[slot] = message;
+        _slotTokens[slot] = tokens;
+    } else {
+        _linearize();
+        _slots.push_back(message);
+        _slotTokens.push_back(tokens);
+    }
+    _count++;
+    _messageTokens += tokens;
+
+    // Tool results cannot be sent without the assistant message that requested them
+    if (full) {
+        while (_count > 0 && _at(0).role == Role::Tool) {
+            _dropOldest();
+        }
+    }
+    _fitTokenBudget();
+}
+
+void Conversation::_prepend(const Message& message) {
+    if (_maxMessages == 0) {
+        return;
+    }
+    if (_count == _maxMessages) {
+        _dropOldestTurn();
+    }
+
+    uint32_t tokens = static_cast<uint32_t>(estimateTokens(message));
+    if (_count < _slots.size()) {
+        _head = (_head + _slots.size() - 1) % _slots.size();
+        _slots[_head] = message;
+        _slotTokens[_head] = tokens;
+    } else {
+        _linearize();
+        _slots.insert(_slots.begin(), message);
+        _slotTokens.insert(_slotTokens.begin(), tokens);
+    }
+    _count++;
+    _messageTokens += tokens;
+    _frontSeq--;
+}
+
+void Conversation::_dropOldest() {
+    _messageTokens -= _slotTokens[_head];
+    _head = (_head + 1) % _slots.size();
+    _count--;
+    _frontSeq++;
+}
+
+void Conversation::_dropOldestTurn() {
+    _dropOldest();
+    while (_count > 0 && _at(0).role == Role::Tool) {
+        _dropOldest();
+    }
+}
+
+void Conversation::_linearize() {
+    if (_head != 0) {
+        std::rotate(_slots.begin(), _slots.begin() + _head, _slots.end());
+        std::rotate(_slotTokens.begin(), _slotTokens.begin() + _head, _slotTokens.end());
+        _head = 0;
+    }
+}
+
+void Conversation::_clearSlots() {
+    _slots.clear();
+    _slotTokens.clear();
+    _head = 0;
+    _count = 0;
+    _messageTokens = 0;
+}
+
+void Conversation::_fitTokenBudget() {
+    if (_tokenBudget == 0) {
+        return;
+    }
+    while (_systemTokens + _messageTokens > _tokenBudget) {
+        // The oldest message and the tool results that follow it go together
+        size_t turn = 1;
+        while (turn < _count && _at(turn).role == Role::Tool) {
+            turn++;
+        }
+        if (turn >= _count) {
+            break;  // Only the newest turn is left: keep it even over budget
+        }
+        for (size_t i = 0; i < turn; i++) {
+            _dropOldest();
+        }
     }
+}
 
+void Conversation::_rebuild(size_t maxMessages) {
+    std::vector<Message> live;
+    live.reserve(_count);
+    for (size_t i = 0; i < _count; i++) {
+        live.push_back(std::move(_slots[(_head + i) % _slots.size()]));
+    }
+    // Same messages, same sequence numbers: a running summary still applies
+    _clearSlots();
+    _maxMessages = maxMessages;
+    for (const Message& message : live) {
+        _append(message);
+    }
+}
+
+#if ESPAI_ENABLE_ASYNC
+void Conversation::setCompaction(AIProvider* provider, const CompactionPolicy& policy) {
+    if (provider != _compactionProvider) {
+        _cancelCompaction();
+    }
+    _compactionProvider = provider;
+    _compactionPolicy = policy;
+}
+
+bool Conversation::pollCompaction() {
+    if (!_compaction.valid() || !_compaction.isReady()) {
+        return false;
+    }
+    Response response = _compaction.get();
+    _compaction = ChatFuture();
+
+    _compactionStats.promptTokens += response.promptTokens;
+    _compactionStats.completionTokens += response.completionTokens;
+    if (!response.success || response.content.isEmpty()) {
+        _compactionStats.failures++;
+        return false;
+    }
+    _applySummary(response.content);
     return true;
 }
 
-void Conversation::_pruneIfNeeded() {
-    while (_messages.size() > _maxMessages) {
-        _messages.erase(_messages.begin());
+bool Conversation::waitForCompaction(uint32_t timeoutMs) {
+    if (!_compaction.valid()) {
+        return false;
+    }
+    _compaction.waitFor(timeoutMs);
+    return pollCompaction();
+}
+
+void Conversation::_startCompaction() {
+    if (!_compactionProvider || _compaction.valid()) {
+        return;
+    }
+    const CompactionPolicy& policy = _compactionPolicy;
+    bool due = (policy.triggerMessages > 0 && _count >= policy.triggerMessages) ||
+               (policy.triggerTokens > 0 && estimateTokens() >= policy.triggerTokens);
+    if (!due) {
+        return;
+    }
+
+    // Never split a tool call from its results, and keep the newest turn
+    size_t compacted = std::min(policy.compactMessages, _count);
+    while (compacted < _count && _at(compacted).role == Role::Tool) {
+        compacted++;
+    }
+    if (compacted == 0 || compacted >= _count) {
+        return;
+    }
+
+    // The worker only sees this copy; the conversation is updated on apply
+    String transcript;
+    for (size_t i = 0; i < compacted; i++) {
+        const Message& msg = _at(i);
+        transcript += roleToString(msg.role);
+        transcript += ": ";
+        transcript += msg.content;
+        if (msg.hasToolCalls()) {
+            transcript += " [tool calls: ";
+            transcript += msg.toolCallsJson;
+            transcript += "]";
+        }
+        transcript += "\n";
+    }
+
+    std::vector<Message> request;
+    request.push_back(Message(Role::System,
+        policy.instructions.isEmpty() ? String(kDefaultSummaryInstructions) : policy.instructions));
+    request.push_back(Message(Role::User, transcript));
+
+    ChatOptions options;
+    options.maxTokens = policy.summaryMaxTokens;
+
+    _compactionEndSeq = _frontSeq + compacted;
+    _compaction = _compactionProvider->chatFuture(request, options);
+}
+
+void Conversation::_applySummary(const String& summary) {
+    // Some summarized messages may have been pruned meanwhile; drop the rest
+    size_t replaced = 0;
+    while (_count > 0 && _frontSeq < _compactionEndSeq) {
+        _dropOldest();
+        replaced++;
+    }
+    while (_count > 0 && _at(0).role == Role::Tool) {
+        _dropOldest();
+        replaced++;
+    }
+
+    _prepend(Message(Role::User, _compactionPolicy.summaryPrefix + summary));
+    _fitTokenBudget();
+
+    _compactionStats.runs++;
+    _compactionStats.messagesCompacted += static_cast<uint32_t>(replaced);
+
+    if (_log.log) {
+        _log.log->logSnapshot();
+    }
+}
+
+void Conversation::_cancelCompaction() {
+    if (_compaction.valid()) {
+        _compaction.cancel();
+        _compaction = ChatFuture();
     }
 }
+#endif
 
 } // namespace ESPAI
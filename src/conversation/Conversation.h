@@ -4,37 +4,158 @@
 #include "../core/AITypes.h"
 #include <vector>
 
+#if ESPAI_ENABLE_ASYNC
+#include "../async/ChatFuture.h"
+#endif
+
 namespace ESPAI {
 
+class AIProvider;
+class ConversationLog;
+
+#if ESPAI_ENABLE_ASYNC
+// Conversation::setCompaction()
+struct CompactionPolicy {
+    size_t triggerMessages = 16;  // Compact at this many messages (0: no message trigger)
+    size_t triggerTokens = 0;     // ...or at this many estimated tokens (0: no token trigger)
+    size_t compactMessages = 8;   // Oldest messages replaced by the summary
+    int16_t summaryMaxTokens = 256;
+    String instructions;          // Summarization prompt; empty for the built-in one
+    String summaryPrefix = "Summary of the earlier conversation:\n";
+};
+
+// Conversation::getCompactionStats()
+struct CompactionStats {
+    uint32_t runs = 0;            // Summaries applied
+    uint32_t failures = 0;        // Summarization requests that failed
+    uint32_t messagesCompacted = 0;
+    uint32_t promptTokens = 0;    // Cost of all summarization requests
+    uint32_t completionTokens = 0;
+};
+#endif
+
+/**
+ * Message history with a fixed capacity of getMaxMessages().
+ *
+ * Messages live in a ring: once full, each add overwrites the oldest slot
+ * (reusing its String buffers) instead of shifting the history, so adding
+ * and pruning are O(1). getMessages() returns a view over the ring that
+ * chat() and chatStream() take directly.
+ *
+ * With a token budget set, the oldest messages are also dropped until the
+ * system prompt and history fit under it. An assistant tool-call message
+ * and its tool results are dropped together, and the newest turn is always
+ * kept. Token estimates are computed once per message when it is added.
+ */
 class Conversation {
 public:
     explicit Conversation(size_t maxMessages = 20);
+    ~Conversation();
 
     void setSystemPrompt(const String& prompt);
     const String& getSystemPrompt() const;
 
     void addMessage(Role role, const String& content);
+    void addMessage(const Message& message);
     void addUserMessage(const String& content);
     void addAssistantMessage(const String& content);
 
-    const std::vector<Message>& getMessages() const;
+    // Oldest first; valid until the conversation is next modified
+    MessageView getMessages() const;
     size_t size() const;
     void clear();
 
     void setMaxMessages(size_t max);
     size_t getMaxMessages() const;
 
+    // 0 (default): prune by message count only
+    void setTokenBudget(size_t tokens);
+    size_t getTokenBudget() const;
+
+    // System prompt plus history, from the cached per-message estimates
     size_t estimateTokens() const;
+    // Rough estimate: 1 token per 4 characters of content and tool calls
+    static size_t estimateTokens(const Message& message);
 
     String toJson() const;
     bool fromJson(const String& json);
 
+    // Non-zero and unique per instance (a copy gets its own); e.g. for
+    // AsyncRequestOptions::conversationId
+    uint32_t getId() const { return _id.value; }
+
+#if ESPAI_ENABLE_ASYNC
+    // Opt-in: once a threshold of the policy is reached, the oldest messages
+    // are summarized in the background through provider->chatFuture() and
+    // replaced by one user message holding the summary. Adding messages never
+    // waits for it; the summary is applied by the next add or
+    // pollCompaction(), on the caller's task. The provider must outlive the
+    // conversation. runWithTools() may share it: the loop holds the provider
+    // (AsyncRequestQueue::OwnerLock), so a summary runs before or after it.
+    // Other blocking calls on it need the same lock, or a dedicated provider.
+    // nullptr disables compaction.
+    void setCompaction(AIProvider* provider, const CompactionPolicy& policy = CompactionPolicy());
+    // Applies a finished summary; true if one was applied
+    bool pollCompaction();
+    // Waits up to timeoutMs (0: no limit) for a running summary, then applies it
+    bool waitForCompaction(uint32_t timeoutMs = 0);
+    bool isCompacting() const { return _compaction.valid(); }
+    const CompactionStats& getCompactionStats() const { return _compactionStats; }
+#endif
+
 private:
-    std::vector<Message> _messages;
+    friend class ConversationLog;
+
+    // Set by ConversationLog::open(); a copy is not attached to the log
+    struct LogLink {
+        ConversationLog* log = nullptr;
+        LogLink() = default;
+        LogLink(const LogLink&) {}
+        LogLink& operator=(const LogLink&) { return *this; }
+    };
+
+    struct InstanceId {
+        uint32_t value;
+        InstanceId() : value(next()) {}
+        InstanceId(const InstanceId&) : value(next()) {}
+        InstanceId& operator=(const InstanceId&) { return *this; }
+        static uint32_t next();
+    };
+
+    std::vector<Message> _slots;    // Grows to _maxMessages, then wraps
+    std::vector<uint32_t> _slotTokens;  // Parallel to _slots
+    size_t _head = 0;               // Slot of the oldest message
+    size_t _count = 0;
     String _systemPrompt;
     size_t _maxMessages;
+    size_t _tokenBudget = 0;
+    size_t _systemTokens = 0;
+    size_t _messageTokens = 0;      // Sum over the live messages
+    size_t _frontSeq = 0;           // Sequence number of the oldest message
+    LogLink _log;
+    InstanceId _id;
+
+#if ESPAI_ENABLE_ASYNC
+    AIProvider* _compactionProvider = nullptr;
+    CompactionPolicy _compactionPolicy;
+    CompactionStats _compactionStats;
+    ChatFuture _compaction;
+    size_t _compactionEndSeq = 0;   // Messages before this one are being summarized
+
+    void _startCompaction();
+    void _applySummary(const String& summary);
+    void _cancelCompaction();
+#endif
 
-    void _pruneIfNeeded();
+    const Message& _at(size_t index) const { return _slots[(_head + index) % _slots.size()]; }
+    void _append(const Message& message);
+    void _prepend(const Message& message);
+    void _dropOldest();
+    void _dropOldestTurn();
+    void _linearize();
+    void _clearSlots();
+    void _fitTokenBudget();
+    void _rebuild(size_t maxMessages);
 };
 
 } // namespace ESPAI
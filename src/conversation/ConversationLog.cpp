@@ -0,0 +1,506 @@
+#include "ConversationLog.h"
+#include "Conversation.h"
+#include <cstring>
+#include <unistd.h>
+
+namespace ESPAI {
+
+namespace {
+    // File: magic, version, 3 reserved bytes, then records.
+    // Record: type, role, payload length (LE u32), CRC-32 of type, role and
+    // payload (LE u32), payload.
+    const uint8_t kMagic[4] = {'E', 'A', 'L', 'G'};
+    const uint8_t kVersion = 1;
+    const size_t kFileHeaderSize = 8;
+    const size_t kRecordHeaderSize = 10;
+
+    uint32_t crc32(uint32_t crc, const uint8_t* data, size_t length) {
+        crc = ~crc;
+        for (size_t i = 0; i < length; i++) {
+            crc ^= data[i];
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+            }
+        }
+        return ~crc;
+    }
+
+    uint32_t recordCrc(uint8_t type, uint8_t role, const std::vector<uint8_t>& payload) {
+        uint8_t head[2] = {type, role};
+        uint32_t crc = crc32(0, head, sizeof(head));
+        return crc32(crc, payload.data(), payload.size());
+    }
+
+    void putU32(uint8_t* out, uint32_t value) {
+        out[0] = static_cast<uint8_t>(value);
+        out[1] = static_cast<uint8_t>(value >> 8);
+        out[2] = static_cast<uint8_t>(value >> 16);
+        out[3] = static_cast<uint8_t>(value >> 24);
+    }
+
+    uint32_t getU32(const uint8_t* in) {
+        return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+               (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+    }
+
+    void addU32(std::vector<uint8_t>& out, uint32_t value) {
+        uint8_t bytes[4];
+        putU32(bytes, value);
+        out.insert(out.end(), bytes, bytes + 4);
+    }
+
+    void addString(std::vector<uint8_t>& out, const String& value) {
+        addU32(out, static_cast<uint32_t>(value.length()));
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(value.c_str());
+        out.insert(out.end(), data, data + value.length());
+    }
+
+    // Reads a string written by addString() at pos; false if it overruns
+    bool takeString(const std::vector<uint8_t>& in, size_t& pos, String& value) {
+        if (in.size() - pos < 4) {
+            return false;
+        }
+        uint32_t length = getU32(in.data() + pos);
+        pos += 4;
+        if (in.size() - pos < length) {
+            return false;
+        }
+        value = String();
+        const char* data = reinterpret_cast<const char*>(in.data() + pos);
+#ifdef ARDUINO
+        value.concat(data, length);
+#else
+        value.append(data, length);
+#endif
+        pos += length;
+        return true;
+    }
+
+    std::vector<uint8_t> encodeMessage(const Message& message) {
+        std::vector<uint8_t> payload;
+        payload.reserve(12 + message.content.length() + message.name.length() + message.toolCallsJson.length());
+        addString(payload, message.content);
+        addString(payload, message.name);
+        addString(payload, message.toolCallsJson);
+        return payload;
+    }
+
+    bool decodeMessage(uint8_t role, const std::vector<uint8_t>& payload, Message& message) {
+        size_t pos = 0;
+        message.role = static_cast<Role>(role);
+        return takeString(payload, pos, message.content) &&
+               takeString(payload, pos, message.name) &&
+               takeString(payload, pos, message.toolCallsJson);
+    }
+
+    std::vector<uint8_t> encodeSettings(size_t maxMessages, size_t tokenBudget) {
+        std::vector<uint8_t> payload;
+        addU32(payload, static_cast<uint32_t>(maxMessages));
+        addU32(payload, static_cast<uint32_t>(tokenBudget));
+        return payload;
+    }
+
+    bool writeRecord(FILE* file, uint8_t type, uint8_t role, const std::vector<uint8_t>& payload) {
+        uint8_t head[kRecordHeaderSize];
+        head[0] = type;
+        head[1] = role;
+        putU32(head + 2, static_cast<uint32_t>(payload.size()));
+        putU32(head + 6, recordCrc(type, role, payload));
+        return fwrite(head, 1, sizeof(head), file) == sizeof(head) &&
+               (payload.empty() || fwrite(payload.data(), 1, payload.size(), file) == payload.size());
+    }
+
+    bool sync(FILE* file) {
+        return fflush(file) == 0 && fsync(fileno(file)) == 0;
+    }
+}
+
+ConversationLog::ConversationLog(const String& path, const ConversationLogConfig& config)
+    : _path(path)
+    , _config(config) {
+}
+
+ConversationLog::~ConversationLog() {
+    close();
+}
+
+bool ConversationLog::open(Conversation& conversation) {
+    close();
+    _stats = ConversationLogStats();
+
+    // Left over from an interrupted compaction. Without the log itself it is
+    // the complete snapshot that compact() was moving into place; otherwise
+    // it may be partial.
+    String tmpPath = _path + ".tmp";
+    FILE* existing = fopen(_path.c_str(), "rb");
+    if (existing) {
+        fclose(existing);
+        remove(tmpPath.c_str());
+    } else {
+        rename(tmpPath.c_str(), _path.c_str());
+    }
+
+    _file = fopen(_path.c_str(), "r+b");
+    if (!_file) {
+        _file = fopen(_path.c_str(), "w+b");
+        if (!_file) {
+            return fail("Cannot open log file");
+        }
+    }
+    fseek(_file, 0, SEEK_END);
+    long size = ftell(_file);
+    _fileSize = size > 0 ? static_cast<size_t>(size) : 0;
+
+    if (conversation._log.log && conversation._log.log != this) {
+        conversation._log.log->close();
+    }
+
+    if (_fileSize < kFileHeaderSize) {
+        // New log: start it with the conversation as it is
+        _conversation = &conversation;
+        if (!compact()) {
+            close();
+            return false;
+        }
+    } else {
+        if (!replay(conversation)) {
+            close();
+            return false;
+        }
+        _conversation = &conversation;
+        _compactedSize = _fileSize;
+    }
+
+    conversation._log.log = this;
+    return true;
+}
+
+void ConversationLog::close() {
+    if (_conversation) {
+        _conversation->_log.log = nullptr;
+        _conversation = nullptr;
+    }
+    if (_file) {
+        fclose(_file);
+        _file = nullptr;
+    }
+    _messageOffsets.clear();
+    _dirty = false;
+}
+
+bool ConversationLog::compact() {
+    if (!_file || !_conversation) {
+        return fail("Log not open");
+    }
+
+    String tmpPath = _path + ".tmp";
+    FILE* tmp = fopen(tmpPath.c_str(), "wb");
+    if (!tmp) {
+        return fail("Cannot create temporary log file");
+    }
+    std::vector<uint32_t> offsets;
+    size_t size = 0;
+    bool written = writeSnapshot(tmp, offsets, size) && sync(tmp);
+    fclose(tmp);
+    if (!written) {
+        remove(tmpPath.c_str());
+        return fail("Cannot write temporary log file");
+    }
+
+    // The rename replaces the old log in one step: a reset leaves either file whole
+    fclose(_file);
+    _file = nullptr;
+    bool replaced = rename(tmpPath.c_str(), _path.c_str()) == 0;
+    if (!replaced && remove(_path.c_str()) == 0) {
+        // FAT cannot rename onto an existing file. Until the second rename only
+        // the temporary file holds the log, and open() takes it from there.
+        if (rename(tmpPath.c_str(), _path.c_str()) != 0) {
+            return fail("Cannot replace log file");
+        }
+        replaced = true;
+    }
+    if (!replaced) {
+        remove(tmpPath.c_str());
+        _file = fopen(_path.c_str(), "r+b");
+        return fail("Cannot replace log file");
+    }
+    _file = fopen(_path.c_str(), "r+b");
+    if (!_file) {
+        return fail("Cannot reopen log file");
+    }
+
+    _messageOffsets.swap(offsets);
+    _fileSize = size;
+    _compactedSize = size;
+    _dirty = false;
+    _stats.compactions++;
+    _stats.bytesWritten += static_cast<uint32_t>(size);
+    return true;
+}
+
+bool ConversationLog::readMessage(size_t index, Message& message) {
+    if (index >= _messageOffsets.size()) {
+        return fail("No such message");
+    }
+    RecordType type;
+    uint8_t role;
+    std::vector<uint8_t> payload;
+    if (!readRecord(_messageOffsets[index], type, role, payload) || type != RecordType::Message ||
+        !decodeMessage(role, payload, message)) {
+        return fail("Corrupt message record");
+    }
+    return true;
+}
+
+void ConversationLog::logMessage(const Message& message) {
+    // A rewrite already holds the new message: the conversation has it
+    if (_dirty || (_fileSize > _config.compactBytes && _fileSize > 2 * _compactedSize)) {
+        if (compact()) {
+            return;
+        }
+        _dirty = true;
+    }
+    size_t offset = _fileSize;
+    if (append(RecordType::Message, static_cast<uint8_t>(message.role), encodeMessage(message))) {
+        _messageOffsets.push_back(static_cast<uint32_t>(offset));
+    }
+}
+
+void ConversationLog::logSystemPrompt(const String& prompt) {
+    // Under a token budget the prompt's size decides which messages are kept
+    if (_dirty || (_conversation && _conversation->getTokenBudget() > 0)) {
+        if (compact()) {
+            return;
+        }
+        _dirty = true;
+    }
+    std::vector<uint8_t> payload;
+    addString(payload, prompt);
+    append(RecordType::SystemPrompt, 0, payload);
+}
+
+void ConversationLog::logSnapshot() {
+    if (compact() || !_conversation) {
+        return;
+    }
+    // E.g. no room for the temporary file: append the state as records, which
+    // replay the same way, and rewrite on a later change
+    _dirty = true;
+    appendSnapshot();
+}
+
+bool ConversationLog::appendSnapshot() {
+    const Conversation& conversation = *_conversation;
+    std::vector<uint8_t> prompt;
+    addString(prompt, conversation.getSystemPrompt());
+    if (!append(RecordType::Clear, 0, std::vector<uint8_t>())) {
+        return false;
+    }
+    _messageOffsets.clear();
+    if (!append(RecordType::Settings, 0, encodeSettings(conversation.getMaxMessages(), conversation.getTokenBudget())) ||
+        !append(RecordType::SystemPrompt, 0, prompt)) {
+        return false;
+    }
+    for (const Message& message : conversation.getMessages()) {
+        size_t offset = _fileSize;
+        if (!append(RecordType::Message, static_cast<uint8_t>(message.role), encodeMessage(message))) {
+            return false;
+        }
+        _messageOffsets.push_back(static_cast<uint32_t>(offset));
+    }
+    return true;
+}
+
+void ConversationLog::logClear() {
+    if (append(RecordType::Clear, 0, std::vector<uint8_t>())) {
+        _messageOffsets.clear();
+    }
+}
+
+bool ConversationLog::append(RecordType type, uint8_t role, const std::vector<uint8_t>& payload) {
+    if (!_file) {
+        return fail("Log not open");
+    }
+    if (fseek(_file, static_cast<long>(_fileSize), SEEK_SET) != 0 ||
+        !writeRecord(_file, static_cast<uint8_t>(type), role, payload) ||
+        (_config.syncEachWrite ? !sync(_file) : fflush(_file) != 0)) {
+        // A partial record is dropped by the next open(); later appends go after it
+        fseek(_file, 0, SEEK_END);
+        long size = ftell(_file);
+        _fileSize = size > 0 ? static_cast<size_t>(size) : _fileSize;
+        return fail("Cannot append to log file");
+    }
+    size_t written = kRecordHeaderSize + payload.size();
+    _fileSize += written;
+    _stats.recordsWritten++;
+    _stats.bytesWritten += static_cast<uint32_t>(written);
+    return true;
+}
+
+bool ConversationLog::readRecord(size_t offset, RecordType& type, uint8_t& role, std::vector<uint8_t>& payload) {
+    uint8_t head[kRecordHeaderSize];
+    if (offset + kRecordHeaderSize > _fileSize || fseek(_file, static_cast<long>(offset), SEEK_SET) != 0 ||
+        fread(head, 1, sizeof(head), _file) != sizeof(head)) {
+        return false;
+    }
+    uint32_t length = getU32(head + 2);
+    if (length > _fileSize - offset - kRecordHeaderSize) {
+        return false;
+    }
+    payload.resize(length);
+    if (length > 0 && fread(payload.data(), 1, length, _file) != length) {
+        return false;
+    }
+    type = static_cast<RecordType>(head[0]);
+    role = head[1];
+    return recordCrc(head[0], head[1], payload) == getU32(head + 6);
+}
+
+bool ConversationLog::writeSnapshot(FILE* file, std::vector<uint32_t>& offsets, size_t& size) {
+    uint8_t header[kFileHeaderSize] = {kMagic[0], kMagic[1], kMagic[2], kMagic[3], kVersion, 0, 0, 0};
+    if (fwrite(header, 1, sizeof(header), file) != sizeof(header)) {
+        return false;
+    }
+    size = kFileHeaderSize;
+
+    const Conversation& conversation = *_conversation;
+    std::vector<uint8_t> settings = encodeSettings(conversation.getMaxMessages(), conversation.getTokenBudget());
+    std::vector<uint8_t> prompt;
+    addString(prompt, conversation.getSystemPrompt());
+    if (!writeRecord(file, static_cast<uint8_t>(RecordType::Settings), 0, settings) ||
+        !writeRecord(file, static_cast<uint8_t>(RecordType::SystemPrompt), 0, prompt)) {
+        return false;
+    }
+    size += 2 * kRecordHeaderSize + settings.size() + prompt.size();
+
+    for (const Message& message : conversation.getMessages()) {
+        std::vector<uint8_t> payload = encodeMessage(message);
+        if (!writeRecord(file, static_cast<uint8_t>(RecordType::Message), static_cast<uint8_t>(message.role), payload)) {
+            return false;
+        }
+        offsets.push_back(static_cast<uint32_t>(size));
+        size += kRecordHeaderSize + payload.size();
+    }
+    return true;
+}
+
+bool ConversationLog::replay(Conversation& conversation) {
+    uint8_t header[kFileHeaderSize];
+    if (fseek(_file, 0, SEEK_SET) != 0 || fread(header, 1, sizeof(header), _file) != sizeof(header) ||
+        memcmp(header, kMagic, sizeof(kMagic)) != 0 || header[4] != kVersion) {
+        return fail("Not a conversation log");
+    }
+
+    for (;;) {
+        // Pass 1: headers only. Settings and the system prompt survive a clear.
+        std::vector<uint32_t> offsets;
+        std::vector<uint8_t> roles;
+        size_t settingsAt = 0;
+        size_t promptAt = 0;
+        size_t lastAt = 0;
+        size_t end = kFileHeaderSize;
+        uint8_t head[kRecordHeaderSize];
+        while (end + kRecordHeaderSize <= _fileSize) {
+            if (fseek(_file, static_cast<long>(end), SEEK_SET) != 0 ||
+                fread(head, 1, sizeof(head), _file) != sizeof(head)) {
+                return fail("Cannot read log file");
+            }
+            uint32_t length = getU32(head + 2);
+            if (length > _fileSize - end - kRecordHeaderSize) {
+                break;  // Cut short
+            }
+            RecordType type = static_cast<RecordType>(head[0]);
+            if (type == RecordType::Message) {
+                offsets.push_back(static_cast<uint32_t>(end));
+                roles.push_back(head[1]);
+            } else if (type == RecordType::SystemPrompt) {
+                promptAt = end;
+            } else if (type == RecordType::Settings) {
+                settingsAt = end;
+            } else if (type == RecordType::Clear) {
+                offsets.clear();
+                roles.clear();
+            } else {
+                break;  // Garbage
+            }
+            lastAt = end;
+            end += kRecordHeaderSize + length;
+        }
+
+        // Pass 2: read and check only what the conversation will hold, and the
+        // last record, which a reset may have torn
+        RecordType type;
+        uint8_t role;
+        std::vector<uint8_t> payload;
+        size_t badAt = 0;
+        if (lastAt != 0 && !readRecord(lastAt, type, role, payload)) {
+            badAt = lastAt;
+        }
+
+        conversation.clear();
+        if (!badAt && settingsAt) {
+            if (readRecord(settingsAt, type, role, payload) && payload.size() == 8) {
+                conversation.setMaxMessages(getU32(payload.data()));
+                conversation.setTokenBudget(getU32(payload.data() + 4));
+            } else {
+                badAt = settingsAt;
+            }
+        }
+        if (!badAt && promptAt) {
+            size_t pos = 0;
+            String prompt;
+            if (readRecord(promptAt, type, role, payload) && takeString(payload, pos, prompt)) {
+                conversation.setSystemPrompt(prompt);
+            } else {
+                badAt = promptAt;
+            }
+        }
+
+        size_t first = offsets.size() > conversation.getMaxMessages() ? offsets.size() - conversation.getMaxMessages() : 0;
+        while (first < offsets.size() && roles[first] == static_cast<uint8_t>(Role::Tool)) {
+            first++;
+        }
+        uint32_t replayed = 0;
+        for (size_t i = first; i < offsets.size() && !badAt; i++) {
+            Message message;
+            if (readRecord(offsets[i], type, role, payload) && decodeMessage(role, payload, message)) {
+                conversation._append(message);
+                replayed++;
+            } else {
+                badAt = offsets[i];
+            }
+        }
+
+        if (badAt) {
+            // Everything from the first bad record on is lost; replay what is left
+            if (!truncateAt(badAt)) {
+                return false;
+            }
+            continue;
+        }
+        if (end < _fileSize && !truncateAt(end)) {
+            return false;
+        }
+        _messageOffsets.swap(offsets);
+        _stats.replayedMessages = replayed;
+        return true;
+    }
+}
+
+bool ConversationLog::truncateAt(size_t size) {
+    fflush(_file);
+    if (ftruncate(fileno(_file), static_cast<off_t>(size)) != 0) {
+        return fail("Cannot truncate log file");
+    }
+    _stats.truncatedBytes += static_cast<uint32_t>(_fileSize - size);
+    _fileSize = size;
+    return true;
+}
+
+bool ConversationLog::fail(const char* error) {
+    _lastError = error;
+    ESPAI_LOG_W("ConversationLog", "%s: %s", _path.c_str(), error);
+    return false;
+}
+
+} // namespace ESPAI
@@ -0,0 +1,131 @@
+#ifndef ESPAI_CONVERSATION_LOG_H
+#define ESPAI_CONVERSATION_LOG_H
+
+#include "../core/AITypes.h"
+#include <cstdio>
+#include <vector>
+
+#ifndef ESPAI_LOG_COMPACT_BYTES
+#define ESPAI_LOG_COMPACT_BYTES 16384
+#endif
+
+namespace ESPAI {
+
+class Conversation;
+
+// ConversationLog constructor
+struct ConversationLogConfig {
+    // Rewrite the log once it grows past this and past twice its size after the
+    // last rewrite
+    size_t compactBytes = ESPAI_LOG_COMPACT_BYTES;
+    bool syncEachWrite = true;    // fsync() after every record
+};
+
+// ConversationLog::getStats()
+struct ConversationLogStats {
+    uint32_t recordsWritten = 0;
+    uint32_t bytesWritten = 0;
+    uint32_t compactions = 0;
+    uint32_t replayedMessages = 0;  // Read into the conversation by open()
+    uint32_t truncatedBytes = 0;    // Torn or corrupt tail dropped by open()
+};
+
+/**
+ * Append-only persistence for a Conversation, as a file of length-prefixed,
+ * CRC-checked binary records. Every change to the attached conversation
+ * appends one record, so persisting a turn costs about the size of the new
+ * message rather than the whole history as with toJson().
+ *
+ * Uses stdio, so on ESP32 the path is on a mounted VFS filesystem:
+ *
+ *   LittleFS.begin(true);
+ *   ConversationLog log("/littlefs/chat.log");
+ *   log.open(conversation);        // Replays what is there, then logs changes
+ *   conversation.addUserMessage("Hi");   // One record appended
+ *
+ * open() reads record headers and skips messages that would not fit in
+ * the conversation's window; only those that do are read and parsed. A
+ * record cut short by a reset or failing its CRC ends the log, and the
+ * file is truncated there. Messages before the window stay on flash and
+ * can be read with readMessage() until the log is compacted, which
+ * rewrites it as a snapshot of the conversation (temporary file, then
+ * rename). Changes that are not appends, such as an applied summary,
+ * fromJson() or a new window size, also compact.
+ *
+ * When a rewrite fails (e.g. the filesystem is full), the change is
+ * appended instead and the log is marked dirty; the next change retries the
+ * rewrite. On FAT, which cannot rename onto an existing file, the old log is
+ * removed first; a reset in between leaves only the temporary file, which
+ * open() then takes as the log.
+ *
+ * One log per conversation; close it or destroy it before the conversation.
+ */
+class ConversationLog {
+public:
+    explicit ConversationLog(const String& path, const ConversationLogConfig& config = ConversationLogConfig());
+    ~ConversationLog();
+
+    // Replaces the conversation's content with the log's (a missing file is
+    // an empty log) and logs its changes from now on
+    bool open(Conversation& conversation);
+    void close();
+    bool isOpen() const { return _file != nullptr; }
+
+    // Rewrites the log as a snapshot of the attached conversation
+    bool compact();
+
+    // Messages on flash since the last clear, including ones no longer in the
+    // conversation; index 0 is the oldest
+    size_t getStoredCount() const { return _messageOffsets.size(); }
+    bool readMessage(size_t index, Message& message);
+
+    size_t getFileSize() const { return _fileSize; }
+    // A rewrite failed and its changes were appended instead
+    bool isDirty() const { return _dirty; }
+    const ConversationLogStats& getStats() const { return _stats; }
+    const String& getLastError() const { return _lastError; }
+
+private:
+    friend class Conversation;
+
+    enum class RecordType : uint8_t {
+        Message = 1,
+        SystemPrompt = 2,
+        Settings = 3,
+        Clear = 4
+    };
+
+    String _path;
+    ConversationLogConfig _config;
+    FILE* _file = nullptr;
+    Conversation* _conversation = nullptr;
+    size_t _fileSize = 0;
+    size_t _compactedSize = 0;
+    bool _dirty = false;                // Compaction failed, retried by the next write
+    std::vector<uint32_t> _messageOffsets;
+    ConversationLogStats _stats;
+    String _lastError;
+
+    // Called by the attached conversation
+    void logMessage(const Message& message);
+    void logSystemPrompt(const String& prompt);
+    void logClear();
+    // A change that is not an append (new window, summary, fromJson())
+    void logSnapshot();
+    void detached() { _conversation = nullptr; }
+
+    bool append(RecordType type, uint8_t role, const std::vector<uint8_t>& payload);
+    bool readRecord(size_t offset, RecordType& type, uint8_t& role, std::vector<uint8_t>& payload);
+    bool writeSnapshot(FILE* file, std::vector<uint32_t>& offsets, size_t& size);
+    bool appendSnapshot();
+    bool replay(Conversation& conversation);
+    bool truncateAt(size_t size);
+    bool fail(const char* error);
+
+    ConversationLog(const ConversationLog&) = delete;
+    ConversationLog& operator=(const ConversationLog&) = delete;
+};
+
+} // namespace ESPAI
+
+#endif // ESPAI_CONVERSATION_LOG_H
@@ -152,12 +152,13 @@ Response AIClient::chatStream(const String& message, const ChatOptions& options,
     }
     messages.push_back(Message(Role::User, message));
 
-    bool success = _providerInstance->chatStream(messages, options, callback);
-    if (success) {
-        return Response::ok("");
+    _providerInstance->chatStream(messages, options, callback);
+    Response response = _providerInstance->getLastStreamResponse();
+    _lastHttpStatus = response.httpStatus;
+    if (!response.success) {
+        _lastError = response.errorMessage.isEmpty() ? String("Streaming failed") : response.errorMessage;
     }
-    _lastError = "Streaming failed";
-    return Response::fail(ErrorCode::StreamingError, _lastError);
+    return response;
 }
 #endif
 
@@ -198,6 +199,50 @@ ChatRequest* AIClient::chatStreamAsync(const String& message, const ChatOptions&
     return _providerInstance->chatStreamAsync(messages, options, streamCb, onDone);
 }
 
+ChatRequest* AIClient::chatStreamBufferedAsync(const String& message, AsyncDoneCallback onDone) {
+    ChatOptions options;
+    return chatStreamBufferedAsync(message, options, onDone);
+}
+
+ChatRequest* AIClient::chatStreamBufferedAsync(const String& message, const ChatOptions& options, AsyncDoneCallback onDone) {
+    if (!_configured || !_providerInstance) return nullptr;
+    if (message.isEmpty()) return nullptr;
+
+    std::vector<Message> messages;
+    if (!options.systemPrompt.isEmpty()) {
+        messages.push_back(Message(Role::System, options.systemPrompt));
+    }
+    messages.push_back(Message(Role::User, message));
+
+    AsyncRequestOptions queueOptions;
+    queueOptions.streamBufferSize = ESPAI_STREAM_RING_SIZE;
+    return _providerInstance->chatStreamAsync(messages, options, nullptr, onDone, queueOptions);
+}
+
+ChatFuture AIClient::chatFuture(const String& message) {
+    ChatOptions options;
+    return chatFuture(message, options);
+}
+
+ChatFuture AIClient::chatFuture(const String& message, const ChatOptions& options) {
+    if (!_configured || !_providerInstance) {
+        _lastError = "Client not configured. Call setProvider() first.";
+        return ChatFuture::ready(Response::fail(ErrorCode::NotConfigured, _lastError));
+    }
+    if (message.isEmpty()) {
+        _lastError = "Message cannot be empty";
+        return ChatFuture::ready(Response::fail(ErrorCode::InvalidRequest, _lastError));
+    }
+
+    std::vector<Message> messages;
+    if (!options.systemPrompt.isEmpty()) {
+        messages.push_back(Message(Role::System, options.systemPrompt));
+    }
+    messages.push_back(Message(Role::User, message));
+
+    return _providerInstance->chatFuture(messages, options);
+}
+
 bool AIClient::isAsyncBusy() const {
     if (!_providerInstance) return false;
     return _providerInstance->isAsyncBusy();
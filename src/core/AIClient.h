@@ -37,6 +37,11 @@ public:
     ChatRequest* chatAsync(const String& message, const ChatOptions& options, AsyncChatCallback onComplete = nullptr);
     ChatRequest* chatStreamAsync(const String& message, StreamCallback streamCb, AsyncDoneCallback onDone = nullptr);
     ChatRequest* chatStreamAsync(const String& message, const ChatOptions& options, StreamCallback streamCb, AsyncDoneCallback onDone = nullptr);
+    // Chunks are buffered for request->readChunks() instead of a callback on the worker task
+    ChatRequest* chatStreamBufferedAsync(const String& message, AsyncDoneCallback onDone = nullptr);
+    ChatRequest* chatStreamBufferedAsync(const String& message, const ChatOptions& options, AsyncDoneCallback onDone = nullptr);
+    ChatFuture chatFuture(const String& message);
+    ChatFuture chatFuture(const String& message, const ChatOptions& options);
     bool isAsyncBusy() const;
     void cancelAsync();
 #endif
@@ -33,6 +33,38 @@
     #endif
 #endif
 
+// Off Arduino, async runs on std::thread (AsyncOS.h). Set to 0 to use
+// FreeRTOS headers from the include path instead, e.g. test/mocks/freertos.
+#ifndef ESPAI_ASYNC_STD_THREADS
+    #ifdef ARDUINO
+        #define ESPAI_ASYNC_STD_THREADS  0
+    #else
+        #define ESPAI_ASYNC_STD_THREADS  1
+    #endif
+#endif
+
+// C++20 coroutine layer over the async API; on when the toolchain supports it
+#ifndef ESPAI_ENABLE_COROUTINES
+    #if ESPAI_ENABLE_ASYNC && defined(__cpp_impl_coroutine) && defined(__has_include)
+        #if __has_include(<coroutine>)
+            #define ESPAI_ENABLE_COROUTINES  1
+        #endif
+    #endif
+    #ifndef ESPAI_ENABLE_COROUTINES
+        #define ESPAI_ENABLE_COROUTINES  0
+    #endif
+#endif
+
+// Opt-in reader/parser task pipeline for chatStream() (StreamPipeline.h);
+// needs stream buffers, so not on the native_async FreeRTOS mock
+#ifndef ESPAI_ENABLE_STREAM_PIPELINE
+    #if ESPAI_ENABLE_ASYNC && ESPAI_ENABLE_STREAMING && (defined(ARDUINO) || ESPAI_ASYNC_STD_THREADS)
+        #define ESPAI_ENABLE_STREAM_PIPELINE  1
+    #else
+        #define ESPAI_ENABLE_STREAM_PIPELINE  0
+    #endif
+#endif
+
 #ifndef ESPAI_ASYNC_STACK_SIZE
 #define ESPAI_ASYNC_STACK_SIZE      20480
 #endif
@@ -4,9 +4,15 @@
 #ifdef ARDUINO
     #include <Arduino.h>
     #include <functional>
+    #include <vector>
+    #include <cstddef>
+    #include <iterator>
 #else
     #include <string>
     #include <functional>
+    #include <vector>
+    #include <cstddef>
+    #include <iterator>
     #include <cstdint>
     #include <cstring>
 
@@ -109,6 +115,10 @@
 
 #include "AIConfig.h"
 
+#if ESPAI_ENABLE_TOOLS
+#include <ArduinoJson.h>
+#endif
+
 namespace ESPAI {
 
 enum class Provider : uint8_t {
@@ -139,7 +149,8 @@ enum class ErrorCode : uint8_t {
     ProviderNotSupported,
     NotConfigured,
     StreamingError,
-    ResponseTooLarge
+    ResponseTooLarge,
+    ToolLimitReached
 };
 
 struct Message {
@@ -155,6 +166,89 @@ struct Message {
     bool hasToolCalls() const { return !toolCallsJson.isEmpty(); }
 };
 
+/**
+ * Read-only, non-owning sequence of messages in at most two contiguous runs,
+ * as held by a ring buffer (Conversation). Converts implicitly from a
+ * std::vector<Message>, so providers take this instead of a vector and a
+ * Conversation can be sent without copying its history.
+ *
+ * Valid until the underlying storage changes.
+ */
+class MessageView {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Message;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Message*;
+        using reference = const Message&;
+
+        const_iterator(const Message* first, size_t firstSize, const Message* second, size_t index)
+            : _first(first), _firstSize(firstSize), _second(second), _index(index) {}
+        reference operator*() const { return _index < _firstSize ? _first[_index] : _second[_index - _firstSize]; }
+        pointer operator->() const { return &**this; }
+        const_iterator& operator++() { _index++; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; _index++; return old; }
+        bool operator==(const const_iterator& other) const { return _index == other._index; }
+        bool operator!=(const const_iterator& other) const { return _index != other._index; }
+
+    private:
+        const Message* _first;
+        size_t _firstSize;
+        const Message* _second;
+        size_t _index;
+    };
+    using iterator = const_iterator;
+
+    MessageView() = default;
+    MessageView(const std::vector<Message>& messages)
+        : _first(messages.data()), _firstSize(messages.size()) {}
+    MessageView(const Message* first, size_t firstSize, const Message* second = nullptr, size_t secondSize = 0)
+        : _first(first), _firstSize(firstSize), _second(second), _secondSize(secondSize) {}
+
+    size_t size() const { return _firstSize + _secondSize; }
+    bool empty() const { return size() == 0; }
+    const Message& operator[](size_t i) const { return i < _firstSize ? _first[i] : _second[i - _firstSize]; }
+    const Message& front() const { return (*this)[0]; }
+    const Message& back() const { return (*this)[size() - 1]; }
+    const_iterator begin() const { return const_iterator(_first, _firstSize, _second, 0); }
+    const_iterator end() const { return const_iterator(_first, _firstSize, _second, size()); }
+
+    // The runs themselves, oldest first; the second is empty unless the ring wrapped
+    const Message* firstRun() const { return _first; }
+    size_t firstRunSize() const { return _firstSize; }
+    const Message* secondRun() const { return _second; }
+    size_t secondRunSize() const { return _secondSize; }
+
+    std::vector<Message> toVector() const { return std::vector<Message>(begin(), end()); }
+
+private:
+    const Message* _first = nullptr;
+    size_t _firstSize = 0;
+    const Message* _second = nullptr;
+    size_t _secondSize = 0;
+};
+
+#if ESPAI_ENABLE_TOOLS
+/**
+ * Represents a tool call from the AI response.
+ *
+ * - OpenAI: maps to tool_calls[].function
+ * - Anthropic: maps to tool_use content block
+ * - Gemini: maps to functionCall part (id is synthesized as gemini_tc_N)
+ */
+struct ToolCall {
+    String id;
+    String name;
+    String arguments;
+
+    ToolCall() : id(), name(), arguments() {}
+    ToolCall(const String& i, const String& n, const String& a)
+        : id(i), name(n), arguments(a) {}
+};
+#endif
+
 struct Response {
     bool success;
     String content;
@@ -163,6 +257,10 @@ struct Response {
     int16_t httpStatus;
     uint32_t promptTokens;
     uint32_t completionTokens;
+    String stopReason;  // Provider-reported finish reason (e.g. "stop", "end_turn", "STOP")
+#if ESPAI_ENABLE_TOOLS
+    std::vector<ToolCall> toolCalls;
+#endif
 
     Response()
         : success(false)
@@ -171,7 +269,8 @@ struct Response {
         , errorMessage()
         , httpStatus(0)
         , promptTokens(0)
-        , completionTokens(0) {}
+        , completionTokens(0)
+        , stopReason() {}
 
     uint32_t totalTokens() const {
         return promptTokens + completionTokens;
@@ -194,6 +293,11 @@ struct Response {
     }
 };
 
+#if ESPAI_ENABLE_STREAMING
+// Client-side stop check, called with each chunk of streamed text. Return true to end the stream.
+using StreamStopPredicate = std::function<bool(const String& text)>;
+#endif
+
 struct ChatOptions {
     float temperature;
     int16_t maxTokens;
@@ -204,6 +308,12 @@ struct ChatOptions {
     float frequencyPenalty;
     float presencePenalty;
     int32_t thinkingBudget; // Gemini 2.5+: thinking token budget. -1 = provider default, 0 = disable thinking.
+#if ESPAI_ENABLE_STREAMING
+    // Client-side stream stop conditions, checked as text arrives. The connection is closed as soon as one fires.
+    std::vector<String> stopStrings;   // End the stream at the first occurrence (the stop string is not delivered)
+    uint32_t maxOutputBytes;           // End the stream after this many bytes of text. 0 = unlimited.
+    StreamStopPredicate stopPredicate; // End the stream when this returns true
+#endif
 
     ChatOptions()
         : temperature(-1.0f)
@@ -214,7 +324,13 @@ struct ChatOptions {
         , topP(-1.0f)
         , frequencyPenalty(0.0f)
         , presencePenalty(0.0f)
-        , thinkingBudget(-1) {}
+        , thinkingBudget(-1)
+#if ESPAI_ENABLE_STREAMING
+        , stopStrings()
+        , maxOutputBytes(0)
+        , stopPredicate()
+#endif
+    {}
 };
 
 struct RetryConfig {
@@ -272,6 +388,7 @@ inline const char* errorCodeToString(ErrorCode code) {
         case ErrorCode::NotConfigured:       return "NotConfigured";
         case ErrorCode::StreamingError:      return "StreamingError";
         case ErrorCode::ResponseTooLarge:    return "ResponseTooLarge";
+        case ErrorCode::ToolLimitReached:    return "ToolLimitReached";
         default:                             return "Unknown";
     }
 }
@@ -283,6 +400,16 @@ inline double roundFloat(float val) {
 #if ESPAI_ENABLE_TOOLS
 using ToolHandler = std::function<String(const String& args)>;
 
+// Receives the arguments parsed once by ToolRegistry and writes the result
+// object in place. Returns false to report a failed call.
+using JsonToolHandler = std::function<bool(JsonVariantConst args, JsonObject result)>;
+
+class ToolCompletion;  // tools/ToolCompletion.h
+
+// Starts the call and returns without waiting for it. The result is
+// delivered later, from any task, through completion.complete().
+using AsyncToolHandler = std::function<void(const String& args, ToolCompletion completion)>;
+
 /**
  * Unified tool definition for all providers.
  *
@@ -297,29 +424,17 @@ struct Tool {
     String description;
     String parametersJson;  // JSON schema (same format for all providers)
     ToolHandler handler;    // Optional: for local tool execution via ToolRegistry
+    JsonToolHandler jsonHandler;  // Optional: pre-parsed variant, used instead of handler when set
+    AsyncToolHandler asyncHandler;  // Optional: for I/O-bound tools, used instead of the others when set
+    bool parallelSafe;      // Handler may run concurrently with other tools (ParallelToolExecutor)
+    uint32_t timeoutMs;     // Parallel and async execution: give up waiting after this long (0 = ESPAI_TOOL_TIMEOUT_MS)
+    uint32_t cacheTtlMs;    // Reuse results for identical arguments this long (0 = never cached)
 
-    Tool() : name(), description(), parametersJson(), handler(nullptr) {}
+    Tool() : name(), description(), parametersJson(), handler(nullptr), jsonHandler(nullptr), asyncHandler(nullptr), parallelSafe(false), timeoutMs(0), cacheTtlMs(0) {}
     Tool(const String& n, const String& d, const String& p)
-        : name(n), description(d), parametersJson(p), handler(nullptr) {}
+        : name(n), description(d), parametersJson(p), handler(nullptr), jsonHandler(nullptr), asyncHandler(nullptr), parallelSafe(false), timeoutMs(0), cacheTtlMs(0) {}
     Tool(const String& n, const String& d, const String& p, ToolHandler h)
-        : name(n), description(d), parametersJson(p), handler(h) {}
-};
-
-/**
- * Represents a tool call from the AI response.
- *
- * - OpenAI: maps to tool_calls[].function
- * - Anthropic: maps to tool_use content block
- * - Gemini: maps to functionCall part (id is synthesized as gemini_tc_N)
- */
-struct ToolCall {
-    String id;
-    String name;
-    String arguments;
-
-    ToolCall() : id(), name(), arguments() {}
-    ToolCall(const String& i, const String& n, const String& a)
-        : id(i), name(n), arguments(a) {}
+        : name(n), description(d), parametersJson(p), handler(h), jsonHandler(nullptr), asyncHandler(nullptr), parallelSafe(false), timeoutMs(0), cacheTtlMs(0) {}
 };
 
 /**
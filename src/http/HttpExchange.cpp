@@ -0,0 +1,74 @@
+#include "HttpExchange.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace ESPAI {
+
+bool parseHttpUrl(const String& url, HttpUrl& out) {
+    const char* text = url.c_str();
+    const char* rest;
+    if (strncmp(text, "https://", 8) == 0) {
+        out.https = true;
+        out.port = 443;
+        rest = text + 8;
+    } else if (strncmp(text, "http://", 7) == 0) {
+        out.https = false;
+        out.port = 80;
+        rest = text + 7;
+    } else {
+        return false;
+    }
+
+    const char* pathStart = strchr(rest, '/');
+    size_t authorityLength = pathStart ? static_cast<size_t>(pathStart - rest) : strlen(rest);
+    String authority = String(rest).substring(0, authorityLength);
+    out.path = pathStart ? String(pathStart) : String("/");
+
+    int colon = authority.indexOf(':');
+    if (colon >= 0) {
+        long port = strtol(authority.c_str() + colon + 1, nullptr, 10);
+        if (port <= 0 || port > 65535) {
+            return false;
+        }
+        out.port = static_cast<uint16_t>(port);
+        out.host = authority.substring(0, colon);
+    } else {
+        out.host = authority;
+    }
+    return out.host.length() > 0;
+}
+
+String formatHttpRequestHead(const HttpRequest& request, const HttpUrl& url, bool stream) {
+    String head;
+    head.reserve(256 + url.path.length());
+    head += request.method;
+    head += " ";
+    head += url.path;
+    head += " HTTP/1.1\r\nHost: ";
+    head += url.host;
+    if (url.port != (url.https ? 443 : 80)) {
+        head += ":";
+        head += String(static_cast<unsigned int>(url.port));
+    }
+    head += "\r\nUser-Agent: ESPAI/" ESPAI_VERSION_STRING "\r\nConnection: close\r\n";
+    if (stream) {
+        head += "Accept: text/event-stream\r\n";
+    }
+    if (!request.contentType.isEmpty()) {
+        head += "Content-Type: ";
+        head += request.contentType;
+        head += "\r\n";
+    }
+    for (const auto& header : request.headers) {
+        head += header.first;
+        head += ": ";
+        head += header.second;
+        head += "\r\n";
+    }
+    head += "Content-Length: ";
+    head += String(static_cast<unsigned int>(request.body.length()));
+    head += "\r\n\r\n";
+    return head;
+}
+
+} // namespace ESPAI
@@ -0,0 +1,61 @@
+#ifndef ESPAI_HTTP_EXCHANGE_H
+#define ESPAI_HTTP_EXCHANGE_H
+
+#include "../core/AIConfig.h"
+#include "../core/AITypes.h"
+#include "../providers/AIProvider.h"
+
+namespace ESPAI {
+
+/**
+ * One HTTP request/response driven in bounded, non-blocking slices.
+ *
+ * Created by HttpTransport::openExchange(). Each step() does at most one
+ * piece of work (a connect attempt, one write, one read) and returns right
+ * away. Destroying the exchange closes its connection.
+ */
+class HttpExchange {
+public:
+    enum class Phase : uint8_t {
+        Connecting,     // DNS, TCP and TLS
+        Sending,
+        Receiving,
+        Done,
+        Failed
+    };
+
+    virtual ~HttpExchange() = default;
+
+    // Response body bytes (de-chunked) are copied to buffer, at most size;
+    // received is their count. Once Done or Failed, keeps returning that.
+    virtual Phase step(uint8_t* buffer, size_t size, size_t& received) = 0;
+
+    // 0 until the status line has arrived
+    virtual int16_t getStatusCode() const = 0;
+    virtual int32_t getRetryAfterSeconds() const { return -1; }
+    virtual const String& getLastError() const = 0;
+
+    // Socket to wait on with select(); -1 when there is none (yet), in which
+    // case step() should simply be called again
+    virtual int getSocket() const { return -1; }
+    // Bytes already received but not yet returned by step(), e.g. decrypted
+    // TLS records; select() does not see these
+    virtual bool hasBufferedData() const { return false; }
+};
+
+struct HttpUrl {
+    bool https = false;
+    String host;
+    uint16_t port = 80;
+    String path;
+};
+
+// Splits an http:// or https:// URL; false for anything else
+bool parseHttpUrl(const String& url, HttpUrl& out);
+
+// Request line and headers, ending with the blank line. The body follows as is.
+String formatHttpRequestHead(const HttpRequest& request, const HttpUrl& url, bool stream);
+
+} // namespace ESPAI
+
+#endif // ESPAI_HTTP_EXCHANGE_H
@@ -0,0 +1,200 @@
+#include "HttpResponseParser.h"
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+namespace ESPAI {
+
+namespace {
+    const size_t kMaxLineLength = 1024;
+
+    // Value of "Name: value" when line has that header name, else nullptr
+    const char* headerValue(const String& line, const char* name) {
+        size_t nameLength = strlen(name);
+        if (line.length() <= nameLength || line.c_str()[nameLength] != ':' ||
+            strncasecmp(line.c_str(), name, nameLength) != 0) {
+            return nullptr;
+        }
+        const char* value = line.c_str() + nameLength + 1;
+        while (*value == ' ' || *value == '\t') {
+            value++;
+        }
+        return value;
+    }
+
+    bool containsIgnoreCase(const char* text, const char* word) {
+        size_t wordLength = strlen(word);
+        for (; *text != '\0'; text++) {
+            if (strncasecmp(text, word, wordLength) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+void HttpResponseParser::reset() {
+    _state = State::StatusLine;
+    _line = "";
+    _statusCode = 0;
+    _retryAfterSeconds = -1;
+    _contentLength = -1;
+    _chunked = false;
+    _remaining = 0;
+    _error = "";
+}
+
+void HttpResponseParser::fail(const char* message) {
+    _state = State::Error;
+    _error = message;
+}
+
+bool HttpResponseParser::takeLine(uint8_t byte) {
+    if (byte == '\n') {
+        if (_line.length() > 0 && _line.c_str()[_line.length() - 1] == '\r') {
+            _line = _line.substring(0, _line.length() - 1);
+        }
+        return true;
+    }
+    if (_line.length() >= kMaxLineLength) {
+        fail("HTTP header line too long");
+        return false;
+    }
+    _line += static_cast<char>(byte);
+    return false;
+}
+
+size_t HttpResponseParser::decode(uint8_t* data, size_t len) {
+    size_t out = 0;
+    size_t pos = 0;
+
+    while (pos < len && _state != State::Done && _state != State::Error) {
+        switch (_state) {
+            case State::Body:
+            case State::ChunkData: {
+                size_t count = len - pos;
+                if ((_contentLength >= 0 || _chunked) && count > _remaining) {
+                    count = _remaining;
+                }
+                // out never passes pos, so moving within the buffer is safe
+                memmove(data + out, data + pos, count);
+                out += count;
+                pos += count;
+                if (_contentLength >= 0 || _chunked) {
+                    _remaining -= count;
+                    if (_remaining == 0) {
+                        _state = _chunked ? State::ChunkDataEnd : State::Done;
+                    }
+                }
+                break;
+            }
+            case State::ChunkDataEnd:
+                if (data[pos] == '\n') {
+                    _state = State::ChunkSize;
+                } else if (data[pos] != '\r') {
+                    fail("Malformed chunked body");
+                }
+                pos++;
+                break;
+            default:
+                if (takeLine(data[pos++])) {
+                    handleLine();
+                    _line = "";
+                }
+                break;
+        }
+    }
+    return out;
+}
+
+void HttpResponseParser::handleLine() {
+    switch (_state) {
+        case State::StatusLine: {
+            if (_line.length() == 0) {
+                return;  // Tolerate a stray CRLF before the status line
+            }
+            if (strncmp(_line.c_str(), "HTTP/1.", 7) != 0) {
+                fail("Malformed HTTP status line");
+                return;
+            }
+            const char* code = strchr(_line.c_str(), ' ');
+            long status = code ? strtol(code + 1, nullptr, 10) : 0;
+            if (status < 100 || status > 999) {
+                fail("Malformed HTTP status line");
+                return;
+            }
+            _statusCode = static_cast<int16_t>(status);
+            _state = State::Headers;
+            return;
+        }
+        case State::Headers: {
+            if (_line.length() == 0) {
+                headersComplete();
+                return;
+            }
+            const char* value;
+            if ((value = headerValue(_line, "Content-Length")) != nullptr) {
+                _contentLength = static_cast<int32_t>(strtol(value, nullptr, 10));
+            } else if ((value = headerValue(_line, "Transfer-Encoding")) != nullptr) {
+                _chunked = containsIgnoreCase(value, "chunked");
+            } else if ((value = headerValue(_line, "Retry-After")) != nullptr) {
+                _retryAfterSeconds = static_cast<int32_t>(strtol(value, nullptr, 10));
+            }
+            return;
+        }
+        case State::ChunkSize: {
+            if (_line.length() == 0) {
+                return;
+            }
+            char* end = nullptr;
+            unsigned long size = strtoul(_line.c_str(), &end, 16);
+            if (end == _line.c_str()) {
+                fail("Malformed chunk size");
+                return;
+            }
+            _remaining = static_cast<uint32_t>(size);
+            _state = (size == 0) ? State::Trailers : State::ChunkData;
+            return;
+        }
+        case State::Trailers:
+            if (_line.length() == 0) {
+                _state = State::Done;
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+void HttpResponseParser::headersComplete() {
+    if (_statusCode >= 100 && _statusCode < 200) {
+        // Interim response (e.g. 100 Continue); the real one follows
+        _statusCode = 0;
+        _contentLength = -1;
+        _chunked = false;
+        _state = State::StatusLine;
+        return;
+    }
+    if (_chunked) {
+        _contentLength = -1;
+        _state = State::ChunkSize;
+    } else if (_statusCode == 204 || _statusCode == 304 || _contentLength == 0) {
+        _state = State::Done;
+    } else {
+        _remaining = (_contentLength > 0) ? static_cast<uint32_t>(_contentLength) : 0;
+        _state = State::Body;
+    }
+}
+
+void HttpResponseParser::onClosed() {
+    if (_state == State::Done || _state == State::Error) {
+        return;
+    }
+    if (_state == State::Body && _contentLength < 0) {
+        _state = State::Done;  // Body delimited by connection close
+        return;
+    }
+    fail("Connection closed before the response ended");
+}
+
+} // namespace ESPAI
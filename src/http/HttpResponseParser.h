@@ -0,0 +1,71 @@
+#ifndef ESPAI_HTTP_RESPONSE_PARSER_H
+#define ESPAI_HTTP_RESPONSE_PARSER_H
+
+#include "../core/AIConfig.h"
+#include "../core/AITypes.h"
+
+namespace ESPAI {
+
+/**
+ * Incremental HTTP/1.1 response parser for step-driven exchanges.
+ *
+ * Raw socket bytes go through decode() in whatever pieces they arrive.
+ * Status line and headers are consumed; body bytes are de-chunked in place
+ * and moved to the front of the same buffer, so no second buffer is
+ * needed. Bodies framed by Content-Length, chunked encoding or connection
+ * close are supported; 1xx interim responses are skipped.
+ */
+class HttpResponseParser {
+public:
+    HttpResponseParser() = default;
+
+    // Consumes len bytes of data; returns the body bytes now at data[0..n)
+    size_t decode(uint8_t* data, size_t len);
+    // The server closed the connection
+    void onClosed();
+
+    bool headersDone() const { return _state >= State::Body; }
+    bool isDone() const { return _state == State::Done; }
+    bool hasError() const { return _state == State::Error; }
+    const String& getError() const { return _error; }
+
+    int16_t getStatusCode() const { return _statusCode; }
+    int32_t getRetryAfterSeconds() const { return _retryAfterSeconds; }
+    // -1 when not sent
+    int32_t getContentLength() const { return _contentLength; }
+    bool isChunked() const { return _chunked; }
+
+    void reset();
+
+private:
+    enum class State : uint8_t {
+        StatusLine,
+        Headers,
+        Body,           // Content-Length or until close
+        ChunkSize,
+        ChunkData,
+        ChunkDataEnd,   // CRLF after chunk data
+        Trailers,
+        Done,
+        Error
+    };
+
+    State _state = State::StatusLine;
+    String _line;
+    int16_t _statusCode = 0;
+    int32_t _retryAfterSeconds = -1;
+    int32_t _contentLength = -1;
+    bool _chunked = false;
+    uint32_t _remaining = 0;    // Bytes left in the body or current chunk
+    String _error;
+
+    // Collects a CRLF-terminated line; true when _line is complete
+    bool takeLine(uint8_t byte);
+    void handleLine();
+    void headersComplete();
+    void fail(const char* message);
+};
+
+} // namespace ESPAI
+
+#endif // ESPAI_HTTP_RESPONSE_PARSER_H
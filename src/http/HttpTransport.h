@@ -4,7 +4,9 @@
 #include "../core/AIConfig.h"
 #include "../core/AITypes.h"
 #include "../providers/AIProvider.h"
+#include "HttpExchange.h"
 #include <functional>
+#include <memory>
 
 namespace ESPAI {
 
@@ -20,6 +22,18 @@ public:
     virtual const String& getLastError() const = 0;
     virtual void setCACert(const char* cert) = 0;
     virtual void setInsecure(bool insecure) = 0;
+
+    // Called from a stream data callback that is about to return false before the
+    // response has ended. The connection is then closed instead of kept for reuse.
+    virtual void abortStream() {}
+
+    // Non-blocking exchange for StepRequest; nullptr when the transport has none.
+    // Connection failures are reported by the exchange's step().
+    virtual std::unique_ptr<HttpExchange> openExchange(const HttpRequest& request, bool stream) {
+        (void)request;
+        (void)stream;
+        return nullptr;
+    }
 };
 
 HttpTransport* getDefaultTransport();
@@ -1,12 +1,176 @@
 #include "HttpTransportESP32.h"
+#include "HttpResponseParser.h"
 #include "RootCACerts.h"
 
 #ifdef ARDUINO
 
 #include <WiFi.h>
+#include <esp_idf_version.h>
+#include <esp_tls.h>
+#include <errno.h>
 
 namespace ESPAI {
 
+namespace {
+
+class ESP32Exchange : public HttpExchange {
+public:
+    ESP32Exchange(const HttpRequest& request, bool stream, const char* caCert, bool insecure) {
+        if (!parseHttpUrl(request.url, _url)) {
+            fail("Invalid URL: " + request.url);
+            return;
+        }
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
+        if (!_url.https) {
+            fail("Step requests over plain HTTP need ESP-IDF 5");
+            return;
+        }
+#endif
+        if (_url.https && insecure) {
+            fail("Step requests do not support setInsecure()");
+            return;
+        }
+
+        _tls = esp_tls_init();
+        if (_tls == nullptr) {
+            fail("Out of memory for TLS");
+            return;
+        }
+        _cfg = {};
+        _cfg.non_block = true;
+        _cfg.timeout_ms = static_cast<int>(request.timeout);
+        if (_url.https) {
+            const char* cert = (caCert != nullptr) ? caCert : ESPAI_CA_BUNDLE;
+            _cfg.cacert_buf = reinterpret_cast<const unsigned char*>(cert);
+            _cfg.cacert_bytes = strlen(cert) + 1;
+        } else {
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+            _cfg.is_plain_tcp = true;
+#endif
+        }
+
+        _head = formatHttpRequestHead(request, _url, stream);
+        _body = request.body;
+    }
+
+    ~ESP32Exchange() override {
+        if (_tls != nullptr) {
+            esp_tls_conn_destroy(_tls);
+        }
+    }
+
+    Phase step(uint8_t* buffer, size_t size, size_t& received) override {
+        received = 0;
+        switch (_phase) {
+            case Phase::Connecting:
+                connect();
+                break;
+            case Phase::Sending:
+                send();
+                break;
+            case Phase::Receiving:
+                receive(buffer, size, received);
+                break;
+            default:
+                break;
+        }
+        return _phase;
+    }
+
+    int16_t getStatusCode() const override { return _parser.getStatusCode(); }
+    int32_t getRetryAfterSeconds() const override { return _parser.getRetryAfterSeconds(); }
+    const String& getLastError() const override { return _lastError; }
+
+    int getSocket() const override {
+        int fd = -1;
+        if (_tls == nullptr || esp_tls_get_conn_sockfd(_tls, &fd) != ESP_OK) {
+            return -1;
+        }
+        return fd;
+    }
+
+    bool hasBufferedData() const override {
+        return _tls != nullptr && _url.https && _phase == Phase::Receiving && esp_tls_get_bytes_avail(_tls) > 0;
+    }
+
+private:
+    esp_tls_t* _tls = nullptr;
+    esp_tls_cfg_t _cfg;
+    HttpUrl _url;
+    String _head;
+    String _body;
+    size_t _sent = 0;           // Bytes of _head, then _body, already written
+    HttpResponseParser _parser;
+    Phase _phase = Phase::Connecting;
+    String _lastError;
+
+    void fail(const String& message) {
+        _lastError = message;
+        _phase = Phase::Failed;
+        ESPAI_LOG_E("HTTP", "Step request failed: %s", message.c_str());
+    }
+
+    bool wouldBlock(ssize_t result) const {
+        if (result == ESP_TLS_ERR_SSL_WANT_READ || result == ESP_TLS_ERR_SSL_WANT_WRITE) {
+            return true;
+        }
+        // Plain sockets report EAGAIN instead
+        return !_url.https && result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+
+    void connect() {
+        // The DNS lookup inside the first attempt still blocks
+        int result = esp_tls_conn_new_async(_url.host.c_str(), static_cast<int>(_url.host.length()),
+                                            _url.port, &_cfg, _tls);
+        if (result < 0) {
+            fail("Failed to connect to " + _url.host);
+        } else if (result == 1) {
+            _phase = Phase::Sending;
+        }
+    }
+
+    void send() {
+        const String& part = (_sent < _head.length()) ? _head : _body;
+        size_t offset = (_sent < _head.length()) ? _sent : _sent - _head.length();
+        if (offset < part.length()) {
+            ssize_t written = esp_tls_conn_write(_tls, part.c_str() + offset, part.length() - offset);
+            if (written > 0) {
+                _sent += static_cast<size_t>(written);
+            } else if (!wouldBlock(written)) {
+                fail("Send failed (" + String(static_cast<int>(written)) + ")");
+                return;
+            }
+        }
+        if (_sent >= _head.length() + _body.length()) {
+            _head = String();
+            _body = String();
+            _phase = Phase::Receiving;
+        }
+    }
+
+    void receive(uint8_t* buffer, size_t size, size_t& received) {
+        ssize_t count = esp_tls_conn_read(_tls, buffer, size);
+        if (count > 0) {
+            received = _parser.decode(buffer, static_cast<size_t>(count));
+        } else if (count == 0) {
+            _parser.onClosed();
+        } else if (wouldBlock(count)) {
+            return;
+        } else {
+            fail("Receive failed (" + String(static_cast<int>(count)) + ")");
+            return;
+        }
+
+        if (_parser.hasError()) {
+            fail(_parser.getError());
+        } else if (_parser.isDone()) {
+            _phase = Phase::Done;
+        }
+    }
+};
+
+} // namespace
+
 HttpTransportESP32* getESP32Transport() {
     static HttpTransportESP32 instance;
     return &instance;
@@ -21,6 +185,7 @@ HttpTransportESP32::HttpTransportESP32()
     , _insecure(false)
     , _reuseConnection(true)
     , _followRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS)
+    , _abortStream(false)
 {
 #if ESPAI_ENABLE_ASYNC
     _transportMutex = xSemaphoreCreateMutex();
@@ -243,11 +408,16 @@ HttpResponse HttpTransportESP32::execute(const HttpRequest& request) {
     return response;
 }
 
+std::unique_ptr<HttpExchange> HttpTransportESP32::openExchange(const HttpRequest& request, bool stream) {
+    return std::unique_ptr<HttpExchange>(new ESP32Exchange(request, stream, _caCert, _insecure));
+}
+
 bool HttpTransportESP32::executeStream(const HttpRequest& request, StreamDataCallback callback) {
 #if ESPAI_ENABLE_ASYNC
     lockTransport();
 #endif
     bool success = false;
+    _abortStream = false;
 
     if (!isReady()) {
         _lastError = "WiFi not connected";
@@ -296,12 +466,17 @@ bool HttpTransportESP32::executeStream(const HttpRequest& request, StreamDataCal
                             size_t bytesRead = stream->readBytes(buffer, toRead);
 
                             if (bytesRead > 0) {
-                                startTime = millis();
-
                                 if (!callback(buffer, bytesRead)) {
                                     ESPAI_LOG_D("HTTP", "Stream stopped by callback");
+                                    if (_abortStream) {
+                                        // Drop the socket instead of draining the rest of the response
+                                        stream->stop();
+                                    }
                                     break;
                                 }
+
+                                // After the callback, so slow callbacks (e.g. tools) do not count as idle time
+                                startTime = millis();
                             }
                         } else {
                             delay(1);
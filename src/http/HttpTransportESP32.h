@@ -32,6 +32,9 @@ public:
     const String& getLastError() const override { return _lastError; }
     void setCACert(const char* cert) override;
     void setInsecure(bool insecure) override;
+    void abortStream() override { _abortStream = true; }
+    // Own socket through esp_tls; does not share the blocking client or its lock
+    std::unique_ptr<HttpExchange> openExchange(const HttpRequest& request, bool stream) override;
 
     void setReuse(bool reuse) { _reuseConnection = reuse; }
     void setFollowRedirects(followRedirects_t follow) { _followRedirects = follow; }
@@ -44,6 +47,7 @@ private:
     bool _insecure;
     bool _reuseConnection;
     followRedirects_t _followRedirects;
+    bool _abortStream;
 
 #if ESPAI_ENABLE_ASYNC
     SemaphoreHandle_t _transportMutex = nullptr;
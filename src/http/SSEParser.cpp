@@ -19,6 +19,8 @@ SSEParser::SSEParser()
 #endif
     , _timeoutMs(ESPAI_HTTP_TIMEOUT_MS)
     , _lastActivityMs(0)
+    , _promptTokens(0)
+    , _completionTokens(0)
     , _errorCode(ErrorCode::None)
     , _done(false)
     , _cancelled(false)
@@ -34,6 +36,8 @@ SSEParser::SSEParser(SSEFormat format)
 #endif
     , _timeoutMs(ESPAI_HTTP_TIMEOUT_MS)
     , _lastActivityMs(0)
+    , _promptTokens(0)
+    , _completionTokens(0)
     , _errorCode(ErrorCode::None)
     , _done(false)
     , _cancelled(false)
@@ -65,6 +69,9 @@ void SSEParser::reset() {
     _accumulatedContent = "";
     _currentEventType = "";
     _errorMessage = "";
+    _stopReason = "";
+    _promptTokens = 0;
+    _completionTokens = 0;
     _errorCode = ErrorCode::None;
     _done = false;
     _cancelled = false;
@@ -188,6 +195,13 @@ bool SSEParser::parseOpenAIChunk(const String& data, String& content, bool& done
         return false;
     }
 
+    // Sent as a final chunk with empty choices when stream_options.include_usage is set
+    if (!doc["usage"].isNull()) {
+        JsonObject usage = doc["usage"];
+        _promptTokens = usage["prompt_tokens"] | 0;
+        _completionTokens = usage["completion_tokens"] | 0;
+    }
+
     if (doc["choices"].isNull()) {
         return false;
     }
@@ -198,7 +212,17 @@ bool SSEParser::parseOpenAIChunk(const String& data, String& content, bool& done
     }
 
     JsonObject firstChoice = choices[0];
+    bool finished = firstChoice["finish_reason"].is<const char*>();
+    if (finished) {
+        _stopReason = firstChoice["finish_reason"].as<String>();
+    }
+
     if (firstChoice["delta"].isNull()) {
+#if ESPAI_ENABLE_TOOLS
+        if (finished) {
+            finalizeToolCalls();
+        }
+#endif
         return true;
     }
 
@@ -216,6 +240,11 @@ bool SSEParser::parseOpenAIChunk(const String& data, String& content, bool& done
                 continue;
             }
 
+            // Tool calls are streamed one after another, so a new index completes the earlier ones
+            for (int i = 0; i < index && i < static_cast<int>(_pendingToolCalls.size()); i++) {
+                reportToolCall(_pendingToolCalls[i]);
+            }
+
             while (static_cast<int>(_pendingToolCalls.size()) <= index) {
                 _pendingToolCalls.push_back(PendingToolCall());
             }
@@ -231,11 +260,15 @@ bool SSEParser::parseOpenAIChunk(const String& data, String& content, bool& done
                     pending.name = func["name"].as<String>();
                 }
                 if (!func["arguments"].isNull()) {
-                    pending.arguments += func["arguments"].as<String>();
+                    appendToolArguments(pending, func["arguments"].as<String>());
                 }
             }
         }
     }
+
+    if (finished) {
+        finalizeToolCalls();
+    }
 #endif
 
     return true;
@@ -268,6 +301,29 @@ bool SSEParser::parseAnthropicChunk(const String& data, String& content, bool& d
         return true;
     }
 
+    if (strcmp(type, "message_start") == 0) {
+        JsonObject usage = doc["message"]["usage"];
+        _promptTokens = usage["input_tokens"] | 0;
+        _completionTokens = usage["output_tokens"] | 0;
+        return true;
+    }
+
+    if (strcmp(type, "message_delta") == 0) {
+        const char* stopReason = doc["delta"]["stop_reason"] | "";
+        if (strlen(stopReason) > 0) {
+            _stopReason = stopReason;
+        }
+        // message_delta usage counts are cumulative for the whole message
+        JsonObject usage = doc["usage"];
+        if (!usage["input_tokens"].isNull()) {
+            _promptTokens = usage["input_tokens"] | 0;
+        }
+        if (!usage["output_tokens"].isNull()) {
+            _completionTokens = usage["output_tokens"] | 0;
+        }
+        return true;
+    }
+
 #if ESPAI_ENABLE_TOOLS
     if (strcmp(type, "content_block_start") == 0) {
         JsonObject block = doc["content_block"];
@@ -297,8 +353,8 @@ bool SSEParser::parseAnthropicChunk(const String& data, String& content, bool& d
         else if (strcmp(deltaType, "input_json_delta") == 0) {
             if (_currentToolCallIndex >= 0 &&
                 _currentToolCallIndex < static_cast<int16_t>(_pendingToolCalls.size())) {
-                _pendingToolCalls[_currentToolCallIndex].arguments +=
-                    delta["partial_json"].as<String>();
+                appendToolArguments(_pendingToolCalls[_currentToolCallIndex],
+                                    delta["partial_json"].as<String>());
             }
         }
 #endif
@@ -308,10 +364,7 @@ bool SSEParser::parseAnthropicChunk(const String& data, String& content, bool& d
     if (strcmp(type, "content_block_stop") == 0) {
         if (_currentToolCallIndex >= 0 &&
             _currentToolCallIndex < static_cast<int16_t>(_pendingToolCalls.size())) {
-            PendingToolCall& tc = _pendingToolCalls[_currentToolCallIndex];
-            if (!tc.name.isEmpty() && _toolCallCallback) {
-                _toolCallCallback(tc.id, tc.name, tc.arguments);
-            }
+            reportToolCall(_pendingToolCalls[_currentToolCallIndex]);
             _currentToolCallIndex = -1;
         }
     }
@@ -321,13 +374,28 @@ bool SSEParser::parseAnthropicChunk(const String& data, String& content, bool& d
 }
 
 #if ESPAI_ENABLE_TOOLS
-void SSEParser::finalizeToolCalls() {
+void SSEParser::appendToolArguments(PendingToolCall& tc, const String& fragment) {
+    tc.arguments += fragment;
+    if (_toolArgumentCallback) {
+        tc.argumentParser.feed(fragment, [this, &tc](const String& key, const String& value) {
+            _toolArgumentCallback(tc.id, tc.name, key, value);
+        });
+    }
+}
+
+void SSEParser::reportToolCall(PendingToolCall& tc) {
+    if (tc.reported || tc.name.isEmpty()) {
+        return;
+    }
+    tc.reported = true;
     if (_toolCallCallback) {
-        for (const auto& tc : _pendingToolCalls) {
-            if (!tc.name.isEmpty()) {
-                _toolCallCallback(tc.id, tc.name, tc.arguments);
-            }
-        }
+        _toolCallCallback(tc.id, tc.name, tc.arguments);
+    }
+}
+
+void SSEParser::finalizeToolCalls() {
+    for (auto& tc : _pendingToolCalls) {
+        reportToolCall(tc);
     }
 }
 #endif
@@ -351,6 +419,12 @@ bool SSEParser::parseGeminiChunk(const String& data, String& content, bool& done
         return false;
     }
 
+    if (!doc["usageMetadata"].isNull()) {
+        JsonObject usage = doc["usageMetadata"];
+        _promptTokens = usage["promptTokenCount"] | 0;
+        _completionTokens = usage["candidatesTokenCount"] | 0;
+    }
+
     if (doc["candidates"].isNull()) {
         return false;
     }
@@ -380,10 +454,12 @@ bool SSEParser::parseGeminiChunk(const String& data, String& content, bool& done
                     tc.name = fc["name"].as<String>();
                     String argsStr;
                     serializeJson(fc["args"], argsStr);
-                    tc.arguments = argsStr;
                     tc.id = "gemini_tc_" + String(static_cast<int>(_pendingToolCalls.size()));
                     if (!tc.name.isEmpty()) {
+                        // Gemini sends complete arguments, so all fields are reported at once
+                        appendToolArguments(tc, argsStr);
                         _pendingToolCalls.push_back(tc);
+                        reportToolCall(_pendingToolCalls.back());
                     }
                 }
 #endif
@@ -393,6 +469,7 @@ bool SSEParser::parseGeminiChunk(const String& data, String& content, bool& done
 
     const char* finishReason = firstCandidate["finishReason"] | "";
     if (strlen(finishReason) > 0) {
+        _stopReason = finishReason;
 #if ESPAI_ENABLE_TOOLS
         finalizeToolCalls();
 #endif
@@ -3,6 +3,7 @@
 
 #include "../core/AIConfig.h"
 #include "../core/AITypes.h"
+#include "ToolArgumentParser.h"
 #include <functional>
 #include <vector>
 
@@ -29,9 +30,12 @@ struct PendingToolCall {
     String id;
     String name;
     String arguments;
+    ToolArgumentParser argumentParser;
+    bool reported;  // Already passed to the tool call callback
 
-    PendingToolCall() : id(), name(), arguments() {}
-    PendingToolCall(const String& i, const String& n) : id(i), name(n), arguments() {}
+    PendingToolCall() : id(), name(), arguments(), argumentParser(), reported(false) {}
+    PendingToolCall(const String& i, const String& n)
+        : id(i), name(n), arguments(), argumentParser(), reported(false) {}
 };
 #endif
 
@@ -42,6 +46,9 @@ public:
     using ErrorCallback = std::function<void(ErrorCode code, const String& message)>;
 #if ESPAI_ENABLE_TOOLS
     using ToolCallCallback = std::function<void(const String& id, const String& name, const String& arguments)>;
+    // Called for each top-level argument field as soon as its value is complete (value is raw JSON)
+    using ToolArgumentCallback = std::function<void(const String& id, const String& name,
+                                                    const String& key, const String& value)>;
 #endif
 
     SSEParser();
@@ -55,6 +62,7 @@ public:
     void setErrorCallback(ErrorCallback cb) { _errorCallback = cb; }
 #if ESPAI_ENABLE_TOOLS
     void setToolCallCallback(ToolCallCallback cb) { _toolCallCallback = cb; }
+    void setToolArgumentCallback(ToolArgumentCallback cb) { _toolArgumentCallback = cb; }
     const std::vector<PendingToolCall>& getToolCalls() const { return _pendingToolCalls; }
 #endif
 
@@ -74,6 +82,10 @@ public:
     ErrorCode getError() const { return _errorCode; }
     const String& getErrorMessage() const { return _errorMessage; }
 
+    uint32_t getPromptTokens() const { return _promptTokens; }
+    uint32_t getCompletionTokens() const { return _completionTokens; }
+    const String& getStopReason() const { return _stopReason; }
+
     const String& getAccumulatedContent() const { return _accumulatedContent; }
     void clearAccumulatedContent() { _accumulatedContent = ""; }
     void setAccumulateContent(bool accumulate) { _accumulateContent = accumulate; }
@@ -87,18 +99,22 @@ private:
     String _accumulatedContent;
     String _currentEventType;
     String _errorMessage;
+    String _stopReason;
 
     EventCallback _eventCallback;
     ContentCallback _contentCallback;
     ErrorCallback _errorCallback;
 #if ESPAI_ENABLE_TOOLS
     ToolCallCallback _toolCallCallback;
+    ToolArgumentCallback _toolArgumentCallback;
     std::vector<PendingToolCall> _pendingToolCalls;
     int16_t _currentToolCallIndex;
 #endif
 
     uint32_t _timeoutMs;
     uint32_t _lastActivityMs;
+    uint32_t _promptTokens;
+    uint32_t _completionTokens;
 
     ErrorCode _errorCode;
 
@@ -116,7 +132,9 @@ private:
     bool parseGeminiChunk(const String& data, String& content, bool& done);
     void setError(ErrorCode code, const String& message);
 #if ESPAI_ENABLE_TOOLS
+    void reportToolCall(PendingToolCall& tc);
     void finalizeToolCalls();
+    void appendToolArguments(PendingToolCall& tc, const String& fragment);
 #endif
 
     uint32_t millis() const;
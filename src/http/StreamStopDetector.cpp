@@ -0,0 +1,206 @@
+#include "StreamStopDetector.h"
+
+#if ESPAI_ENABLE_STREAMING
+
+namespace ESPAI {
+
+StreamStopDetector::StreamStopDetector()
+    : _nodes(1)
+    , _built(true)
+    , _state(0)
+    , _held()
+    , _maxOutputBytes(0)
+    , _outputBytes(0)
+    , _predicate()
+    , _stopped(false)
+    , _stopReason("") {}
+
+StreamStopDetector::StreamStopDetector(const ChatOptions& options)
+    : StreamStopDetector() {
+    for (const auto& stop : options.stopStrings) {
+        addStopString(stop);
+    }
+    _maxOutputBytes = options.maxOutputBytes;
+    _predicate = options.stopPredicate;
+}
+
+void StreamStopDetector::addStopString(const String& stop) {
+    size_t len = stop.length();
+    if (len == 0 || len > 255) {
+        return;
+    }
+
+    int16_t node = 0;
+    for (size_t i = 0; i < len; i++) {
+        char c = stop[i];
+        int16_t next = child(node, c);
+        if (next < 0) {
+            if (_nodes.size() >= 0x7FFF) {
+                return;
+            }
+            next = static_cast<int16_t>(_nodes.size());
+            _nodes.emplace_back();
+            _nodes[next].depth = static_cast<uint8_t>(i + 1);
+            _nodes[node].next.emplace_back(c, next);
+        }
+        node = next;
+    }
+    _nodes[node].matchLen = static_cast<uint8_t>(len);
+    _built = false;
+}
+
+bool StreamStopDetector::isActive() const {
+    return _nodes.size() > 1 || _maxOutputBytes > 0 || static_cast<bool>(_predicate);
+}
+
+void StreamStopDetector::reset() {
+    _state = 0;
+    _held = "";
+    _outputBytes = 0;
+    _stopped = false;
+    _stopReason = "";
+}
+
+int16_t StreamStopDetector::child(int16_t node, char c) const {
+    for (const auto& edge : _nodes[node].next) {
+        if (edge.first == c) {
+            return edge.second;
+        }
+    }
+    return -1;
+}
+
+int16_t StreamStopDetector::step(int16_t state, char c) const {
+    while (true) {
+        int16_t next = child(state, c);
+        if (next >= 0) {
+            return next;
+        }
+        if (state == 0) {
+            return 0;
+        }
+        state = _nodes[state].fail;
+    }
+}
+
+void StreamStopDetector::build() {
+    // Breadth-first so every failure target is finished before its dependents
+    std::vector<int16_t> queue;
+    queue.reserve(_nodes.size());
+    for (const auto& edge : _nodes[0].next) {
+        _nodes[edge.second].fail = 0;
+        queue.push_back(edge.second);
+    }
+
+    for (size_t i = 0; i < queue.size(); i++) {
+        int16_t node = queue[i];
+        if (_nodes[node].matchLen == 0) {
+            _nodes[node].matchLen = _nodes[_nodes[node].fail].matchLen;
+        }
+
+        for (const auto& edge : _nodes[node].next) {
+            int16_t fail = _nodes[node].fail;
+            while (fail != 0 && child(fail, edge.first) < 0) {
+                fail = _nodes[fail].fail;
+            }
+            int16_t target = child(fail, edge.first);
+            _nodes[edge.second].fail = (target >= 0 && target != edge.second) ? target : 0;
+            queue.push_back(edge.second);
+        }
+    }
+
+    _built = true;
+}
+
+void StreamStopDetector::stop(const char* reason) {
+    _stopped = true;
+    _stopReason = reason;
+    _held = "";
+}
+
+bool StreamStopDetector::emit(const String& text, String& out) {
+    size_t len = text.length();
+    if (len == 0) {
+        return _stopped;
+    }
+
+    bool capped = false;
+    if (_maxOutputBytes > 0 && _outputBytes + len >= _maxOutputBytes) {
+        size_t room = _maxOutputBytes - _outputBytes;
+        if (room < len) {
+            // Never split a UTF-8 sequence
+            while (room > 0 && (static_cast<uint8_t>(text[room]) & 0xC0) == 0x80) {
+                room--;
+            }
+            len = room;
+        }
+        capped = true;
+    }
+
+    String part = (len == text.length()) ? text : text.substring(0, len);
+    out += part;
+    _outputBytes += len;
+
+    if (capped) {
+        stop("max_output_bytes");
+        return true;
+    }
+    if (_predicate && _predicate(part)) {
+        stop("predicate");
+        return true;
+    }
+    return false;
+}
+
+bool StreamStopDetector::process(const String& chunk, String& out) {
+    if (_stopped) {
+        return true;
+    }
+    if (!_built) {
+        build();
+    }
+
+    // _held always holds exactly the last depth(_state) characters, the part
+    // that may still turn out to be the start of a stop string
+    size_t heldLen = _held.length();
+    size_t len = chunk.length();
+    for (size_t i = 0; i < len; i++) {
+        _state = step(_state, chunk[i]);
+        uint8_t matchLen = _nodes[_state].matchLen;
+        if (matchLen > 0) {
+            size_t end = heldLen + i + 1;
+            String text = _held;
+            text += chunk.substring(0, i + 1);
+            if (!emit(text.substring(0, end - matchLen), out)) {
+                stop("stop_sequence");
+            }
+            return true;
+        }
+    }
+
+    size_t keep = _nodes[_state].depth;
+    if (heldLen == 0 && keep == 0) {
+        return emit(chunk, out);
+    }
+
+    String text = _held;
+    text += chunk;
+    size_t ready = text.length() - keep;
+    _held = text.substring(ready);
+    return emit(text.substring(0, ready), out);
+}
+
+String StreamStopDetector::flush() {
+    String out;
+    if (!_stopped && _held.length() > 0) {
+        String text = _held;
+        _held = "";
+        emit(text, out);
+    }
+    _state = 0;
+    return out;
+}
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_STREAMING
@@ -0,0 +1,77 @@
+#ifndef ESPAI_STREAM_STOP_DETECTOR_H
+#define ESPAI_STREAM_STOP_DETECTOR_H
+
+#include "../core/AIConfig.h"
+#include "../core/AITypes.h"
+#include <vector>
+
+#if ESPAI_ENABLE_STREAMING
+
+namespace ESPAI {
+
+/**
+ * Client-side stop conditions for streamed text.
+ *
+ * Sits between SSEParser's content callback and the user callback. Stop
+ * strings are matched with an Aho-Corasick automaton, so a marker split
+ * across chunks is still found. Text that could be the beginning of a stop
+ * string is held back until the next chunk decides it, so the stop string
+ * itself never reaches the callback.
+ */
+class StreamStopDetector {
+public:
+    StreamStopDetector();
+    explicit StreamStopDetector(const ChatOptions& options);
+
+    void addStopString(const String& stop);
+    void setMaxOutputBytes(uint32_t maxBytes) { _maxOutputBytes = maxBytes; }
+    void setPredicate(StreamStopPredicate predicate) { _predicate = predicate; }
+
+    bool isActive() const;
+
+    // Feeds one content chunk. Text that is safe to deliver is appended to
+    // out. Returns true once a stop condition has fired.
+    bool process(const String& chunk, String& out);
+
+    // Returns text still held back for a partial stop-string match.
+    String flush();
+
+    void reset();
+
+    bool isStopped() const { return _stopped; }
+    const char* getStopReason() const { return _stopReason; }
+    uint32_t getOutputBytes() const { return _outputBytes; }
+
+private:
+    struct Node {
+        int16_t fail;
+        uint8_t depth;
+        uint8_t matchLen;  // Longest stop string ending at this node (0 = none)
+        std::vector<std::pair<char, int16_t>> next;
+
+        Node() : fail(0), depth(0), matchLen(0), next() {}
+    };
+
+    std::vector<Node> _nodes;
+    bool _built;
+    int16_t _state;
+    String _held;
+
+    uint32_t _maxOutputBytes;
+    uint32_t _outputBytes;
+    StreamStopPredicate _predicate;
+
+    bool _stopped;
+    const char* _stopReason;
+
+    void build();
+    int16_t child(int16_t node, char c) const;
+    int16_t step(int16_t state, char c) const;
+    bool emit(const String& text, String& out);
+    void stop(const char* reason);
+};
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_STREAMING
+#endif // ESPAI_STREAM_STOP_DETECTOR_H
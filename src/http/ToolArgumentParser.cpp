@@ -0,0 +1,187 @@
+#include "ToolArgumentParser.h"
+
+#if ESPAI_ENABLE_STREAMING && ESPAI_ENABLE_TOOLS
+
+namespace ESPAI {
+
+static bool isJsonWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+ToolArgumentParser::ToolArgumentParser()
+    : _state(State::Start)
+    , _key()
+    , _value()
+    , _fieldCount(0)
+    , _depth(0)
+    , _inString(false)
+    , _escape(false)
+    , _scalar(false) {}
+
+void ToolArgumentParser::reset() {
+    _state = State::Start;
+    _key = "";
+    _value = "";
+    _fieldCount = 0;
+    _depth = 0;
+    _inString = false;
+    _escape = false;
+    _scalar = false;
+}
+
+void ToolArgumentParser::feed(const String& fragment, const FieldCallback& onField) {
+    feed(fragment.c_str(), fragment.length(), onField);
+}
+
+void ToolArgumentParser::feed(const char* data, size_t len, const FieldCallback& onField) {
+    if (data == nullptr) {
+        return;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (_state == State::Done || _state == State::Error) {
+            return;
+        }
+        processChar(data[i], onField);
+    }
+}
+
+void ToolArgumentParser::emitField(const FieldCallback& onField) {
+    _fieldCount++;
+    if (onField) {
+        onField(_key, _value);
+    }
+    _value = "";
+    _state = State::CommaOrEnd;
+}
+
+void ToolArgumentParser::processChar(char c, const FieldCallback& onField) {
+    switch (_state) {
+        case State::Start:
+            if (c == '{') {
+                _state = State::KeyOrEnd;
+            } else if (!isJsonWhitespace(c)) {
+                _state = State::Error;
+            }
+            break;
+
+        case State::KeyOrEnd:
+            if (c == '"') {
+                _key = "";
+                _escape = false;
+                _state = State::Key;
+            } else if (c == '}') {
+                _state = State::Done;
+            } else if (!isJsonWhitespace(c)) {
+                _state = State::Error;
+            }
+            break;
+
+        case State::Key:
+            if (_escape) {
+                _escape = false;
+                if (c == 'n') {
+                    _key += '\n';
+                } else if (c == 't') {
+                    _key += '\t';
+                } else {
+                    _key += c;
+                }
+            } else if (c == '\\') {
+                _escape = true;
+            } else if (c == '"') {
+                _state = State::Colon;
+            } else {
+                _key += c;
+            }
+            break;
+
+        case State::Colon:
+            if (c == ':') {
+                _value = "";
+                _depth = 0;
+                _inString = false;
+                _escape = false;
+                _scalar = false;
+                _state = State::Value;
+            } else if (!isJsonWhitespace(c)) {
+                _state = State::Error;
+            }
+            break;
+
+        case State::Value:
+            if (_value.isEmpty()) {
+                if (isJsonWhitespace(c)) {
+                    break;
+                }
+                if (c == ',' || c == '}' || c == ']' || c == ':') {
+                    _state = State::Error;
+                    break;
+                }
+                _value += c;
+                if (c == '"') {
+                    _inString = true;
+                } else if (c == '{' || c == '[') {
+                    _depth = 1;
+                } else {
+                    _scalar = true;
+                }
+                break;
+            }
+
+            if (_scalar) {
+                if (c == ',' || c == '}' || isJsonWhitespace(c)) {
+                    emitField(onField);
+                    processChar(c, onField);
+                } else {
+                    _value += c;
+                }
+                break;
+            }
+
+            _value += c;
+            if (_inString) {
+                if (_escape) {
+                    _escape = false;
+                } else if (c == '\\') {
+                    _escape = true;
+                } else if (c == '"') {
+                    _inString = false;
+                    if (_depth == 0) {
+                        emitField(onField);
+                    }
+                }
+            } else if (c == '"') {
+                _inString = true;
+            } else if (c == '{' || c == '[') {
+                if (_depth >= ESPAI_TOOL_ARG_MAX_DEPTH) {
+                    _state = State::Error;
+                    break;
+                }
+                _depth++;
+            } else if (c == '}' || c == ']') {
+                _depth--;
+                if (_depth == 0) {
+                    emitField(onField);
+                }
+            }
+            break;
+
+        case State::CommaOrEnd:
+            if (c == ',') {
+                _state = State::KeyOrEnd;
+            } else if (c == '}') {
+                _state = State::Done;
+            } else if (!isJsonWhitespace(c)) {
+                _state = State::Error;
+            }
+            break;
+
+        case State::Done:
+        case State::Error:
+            break;
+    }
+}
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_STREAMING && ESPAI_ENABLE_TOOLS
@@ -0,0 +1,70 @@
+#ifndef ESPAI_TOOL_ARGUMENT_PARSER_H
+#define ESPAI_TOOL_ARGUMENT_PARSER_H
+
+#include "../core/AIConfig.h"
+#include "../core/AITypes.h"
+#include <functional>
+
+#if ESPAI_ENABLE_STREAMING && ESPAI_ENABLE_TOOLS
+
+// Deepest nesting of objects and arrays inside an argument value
+#ifndef ESPAI_TOOL_ARG_MAX_DEPTH
+#define ESPAI_TOOL_ARG_MAX_DEPTH 32
+#endif
+
+namespace ESPAI {
+
+/**
+ * Incremental parser for streamed tool-call arguments.
+ *
+ * Fed with the raw argument fragments as they arrive, it reports each
+ * top-level field of the argument object as soon as its value is closed.
+ * Values are passed as raw JSON text ("\"red\"", "90", "{\"x\":1}").
+ * Strings, objects and arrays complete on their closing character; numbers
+ * and literals complete on the following ',' or '}'. Nesting deeper than
+ * ESPAI_TOOL_ARG_MAX_DEPTH is an error.
+ */
+class ToolArgumentParser {
+public:
+    using FieldCallback = std::function<void(const String& key, const String& value)>;
+
+    ToolArgumentParser();
+
+    void feed(const String& fragment, const FieldCallback& onField);
+    void feed(const char* data, size_t len, const FieldCallback& onField);
+
+    void reset();
+
+    bool isComplete() const { return _state == State::Done; }
+    bool hasError() const { return _state == State::Error; }
+    uint16_t getFieldCount() const { return _fieldCount; }
+
+private:
+    enum class State : uint8_t {
+        Start,
+        KeyOrEnd,
+        Key,
+        Colon,
+        Value,
+        CommaOrEnd,
+        Done,
+        Error
+    };
+
+    State _state;
+    String _key;
+    String _value;
+    uint16_t _fieldCount;
+    uint8_t _depth;
+    bool _inString;
+    bool _escape;
+    bool _scalar;
+
+    void processChar(char c, const FieldCallback& onField);
+    void emitField(const FieldCallback& onField);
+};
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_STREAMING && ESPAI_ENABLE_TOOLS
+#endif // ESPAI_TOOL_ARGUMENT_PARSER_H
@@ -2,12 +2,37 @@
 #include <cmath>
 #include <memory>
 
+#include "../http/HttpTransport.h"
+#include "StepRequest.h"
+
 #ifdef ARDUINO
 #include "../http/HttpTransportESP32.h"
+#else
+#include <chrono>
+#include <thread>
 #endif
 
 namespace ESPAI {
 
+static void retryDelay(uint32_t ms) {
+#ifdef ARDUINO
+    delay(ms);
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+#endif
+}
+
+HttpTransport* AIProvider::resolveTransport() const {
+    if (_transport != nullptr) {
+        return _transport;
+    }
+#ifdef ARDUINO
+    return getDefaultTransport();
+#else
+    return nullptr;
+#endif
+}
+
 bool AIProvider::isRetryableStatus(int16_t statusCode) {
     return statusCode == 429 || (statusCode >= 500 && statusCode < 600);
 }
@@ -26,17 +51,22 @@ uint32_t AIProvider::calculateRetryDelay(const RetryConfig& config, uint8_t atte
 }
 
 Response AIProvider::chat(
-    const std::vector<Message>& messages,
+    MessageView messages,
     const ChatOptions& options
 ) {
     if (!isConfigured()) {
         return Response::fail(ErrorCode::NotConfigured, "Provider not configured");
     }
 
-#ifdef ARDUINO
-    HttpTransport* transport = getDefaultTransport();
+    HttpTransport* transport = resolveTransport();
     if (transport == nullptr) {
+#ifdef ARDUINO
         return Response::fail(ErrorCode::NotConfigured, "HTTP transport not available");
+#else
+        (void)messages;
+        (void)options;
+        return Response::fail(ErrorCode::NotConfigured, "HTTP client not available in native build");
+#endif
     }
 
     if (!transport->isReady()) {
@@ -64,13 +94,17 @@ Response AIProvider::chat(
         uint32_t delayMs = calculateRetryDelay(_retryConfig, attempt, httpResp.retryAfterSeconds);
         ESPAI_LOG_W(getName(), "Retry %d/%d after %lums (HTTP %d)",
                     attempt + 1, _retryConfig.maxRetries, (unsigned long)delayMs, httpResp.statusCode);
-        delay(delayMs);
+        retryDelay(delayMs);
 
         if (!transport->isReady()) {
             return Response::fail(ErrorCode::NetworkError, "Network lost during retry");
         }
     }
 
+    return chatResult(httpResp);
+}
+
+Response AIProvider::chatResult(const HttpResponse& httpResp) {
     if (!httpResp.success) {
         if (httpResp.responseTooLarge) {
             return Response::fail(ErrorCode::ResponseTooLarge, httpResp.body, httpResp.statusCode);
@@ -80,164 +114,437 @@ Response AIProvider::chat(
 
     Response response = parseResponse(httpResp.body);
     response.httpStatus = httpResp.statusCode;
+#if ESPAI_ENABLE_TOOLS
+    response.toolCalls = _lastToolCalls;
+#endif
 
     return response;
-#else
-    (void)messages;
-    (void)options;
-    return Response::fail(ErrorCode::NotConfigured, "HTTP client not available in native build");
-#endif
 }
 
 #if ESPAI_ENABLE_STREAMING
-bool AIProvider::chatStream(
-    const std::vector<Message>& messages,
+bool AIProvider::buildStreamHttpRequest(
+    MessageView messages,
     const ChatOptions& options,
-    StreamCallback callback
+    HttpRequest& req,
+    Response& error
 ) {
-    if (!isConfigured()) {
-        return false;
-    }
-
-#ifdef ARDUINO
-    HttpTransport* transport = getDefaultTransport();
-    if (transport == nullptr || !transport->isReady()) {
-        return false;
-    }
-
     _streamingRequest = true;
-    HttpRequest req = buildHttpRequest(messages, options);
+    req = buildHttpRequest(messages, options);
     _streamingRequest = false;
 
     // Gemini uses URL endpoint for streaming, not "stream":true in body
     if (getSSEFormat() != SSEFormat::Gemini) {
         JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, req.body);
-        if (error) {
+        DeserializationError jsonError = deserializeJson(doc, req.body);
+        if (jsonError) {
+            error = Response::fail(ErrorCode::InvalidRequest, jsonError.c_str());
             return false;
         }
         doc["stream"] = true;
         req.body = "";
         serializeJson(doc, req.body);
     }
+    return true;
+}
+
+void AIProvider::setupStreamParser(SSEParser& parser, StreamStopDetector& stopDetector,
+                                   StreamCallback callback, StreamToolState& tools) {
+    parser.setTimeout(_timeout);
+    parser.setAccumulateContent(false);
+    if (stopDetector.isActive()) {
+        SSEParser* parserPtr = &parser;
+        StreamStopDetector* detector = &stopDetector;
+        parser.setContentCallback([callback, detector, parserPtr](const String& content, bool done) {
+            if (detector->isStopped()) {
+                return;
+            }
+            String text;
+            bool stopped = detector->process(content, text);
+            if (done && !stopped) {
+                text += detector->flush();
+            }
+            if (!text.isEmpty()) {
+                callback(text, false);
+            }
+            if (stopped) {
+                // Closes the connection through the transport's callback-abort path
+                parserPtr->cancel();
+                callback("", true);
+            } else if (done) {
+                callback("", true);
+            }
+        });
+    } else {
+        parser.setContentCallback([callback](const String& content, bool done) {
+            callback(content, done);
+        });
+    }
+
+#if ESPAI_ENABLE_TOOLS
+    StreamToolState* state = &tools;
+    const ToolRegistry* earlyRegistry = _earlyToolRegistry;
+    if (earlyRegistry != nullptr) {
+        tools.early.setMaxWorkers(earlyRegistry->getParallelWorkers());
+        tools.early.setDefaultTimeout(earlyRegistry->getDefaultTimeout());
+    }
+    parser.setToolCallCallback(
+        [state, earlyRegistry](const String& id, const String& name, const String& arguments) {
+            state->calls.push_back(ToolCall(id, name, arguments));
+            if (earlyRegistry != nullptr) {
+                // Only hands the call over: the socket keeps being read meanwhile
+                state->early.submit(*earlyRegistry, state->calls.back());
+            }
+        });
+    if (_toolArgumentCallback) {
+        parser.setToolArgumentCallback(_toolArgumentCallback);
+    }
+#else
+    (void)tools;
+#endif
+}
+
+Response AIProvider::streamResult(const SSEParser& parser, const StreamStopDetector& stopDetector,
+                                  const StreamToolState& tools) const {
+    Response response = Response::ok("");
+    response.httpStatus = 200;
+    response.promptTokens = parser.getPromptTokens();
+    response.completionTokens = parser.getCompletionTokens();
+    response.stopReason = stopDetector.isStopped()
+        ? String(stopDetector.getStopReason())
+        : parser.getStopReason();
+#if ESPAI_ENABLE_TOOLS
+    response.toolCalls = tools.calls;
+#else
+    (void)tools;
+#endif
+    return response;
+}
+
+bool AIProvider::chatStream(
+    MessageView messages,
+    const ChatOptions& options,
+    StreamCallback callback
+) {
+    _lastStreamResponse = Response();
+
+    if (!isConfigured()) {
+        _lastStreamResponse = Response::fail(ErrorCode::NotConfigured, "Provider not configured");
+        return false;
+    }
+
+    HttpTransport* transport = resolveTransport();
+    if (transport == nullptr) {
+        (void)messages;
+        (void)options;
+        (void)callback;
+#ifdef ARDUINO
+        _lastStreamResponse = Response::fail(ErrorCode::NetworkError, "Network not ready");
+#else
+        _lastStreamResponse = Response::fail(ErrorCode::NotConfigured, "HTTP client not available in native build");
+#endif
+        return false;
+    }
+    if (!transport->isReady()) {
+        _lastStreamResponse = Response::fail(ErrorCode::NetworkError, "Network not ready");
+        return false;
+    }
+
+    HttpRequest req;
+    if (!buildStreamHttpRequest(messages, options, req, _lastStreamResponse)) {
+        return false;
+    }
 
     ESPAI_LOG_D(getName(), "Starting streaming chat to %s", req.url.c_str());
 
     uint16_t maxAttempts = (_retryConfig.enabled) ? static_cast<uint16_t>(_retryConfig.maxRetries) + 1 : 1;
 
+    StreamToolState tools;
     for (uint16_t attempt = 0; attempt < maxAttempts; attempt++) {
-#if ESPAI_ENABLE_TOOLS
-        _lastToolCalls.clear();
-#endif
+        tools = StreamToolState();
         SSEParser parser(getSSEFormat());
-        parser.setTimeout(_timeout);
-        parser.setAccumulateContent(false);
-        parser.setContentCallback([&callback](const String& content, bool done) {
-            callback(content, done);
-        });
-
-#if ESPAI_ENABLE_TOOLS
-        parser.setToolCallCallback(
-            [this](const String& id, const String& name, const String& arguments) {
-                _lastToolCalls.push_back(ToolCall(id, name, arguments));
-            });
+        StreamStopDetector stopDetector(options);
+        setupStreamParser(parser, stopDetector, callback, tools);
+
+#if ESPAI_ENABLE_STREAM_PIPELINE
+        _lastPipelineStats = StreamPipelineStats();
+        std::unique_ptr<StreamPipeline> pipeline;
+        if (_pipelineConfig.enabled) {
+            pipeline.reset(new StreamPipeline(parser, _pipelineConfig));
+            if (!pipeline->start()) {
+                ESPAI_LOG_W(getName(), "Stream pipeline unavailable, parsing inline");
+                pipeline.reset();
+            }
+        }
 #endif
 
-        bool success = transport->executeStream(req, [&parser](const uint8_t* data, size_t len) -> bool {
+        bool success = transport->executeStream(req, [&](const uint8_t* data, size_t len) -> bool {
+#if ESPAI_ENABLE_STREAM_PIPELINE
+            if (pipeline) {
+                if (pipeline->push(data, len)) {
+                    return true;
+                }
+                // The parser task has stopped, so its state is safe to read here
+                if (parser.isCancelled()) {
+                    transport->abortStream();
+                }
+                return false;
+            }
+#endif
             parser.feed(reinterpret_cast<const char*>(data), len);
+            if (parser.isCancelled()) {
+                // Stopped early: the rest of the response is unread, so the connection cannot be reused
+                transport->abortStream();
+                return false;
+            }
             return !parser.isDone() && !parser.hasError();
         });
 
+#if ESPAI_ENABLE_STREAM_PIPELINE
+        if (pipeline) {
+            pipeline->finish();
+            _lastPipelineStats = pipeline->getStats();
+        }
+#endif
+
+#if ESPAI_ENABLE_TOOLS
+        tools.collect();
+        _lastToolCalls = tools.calls;
+        _lastToolResults = tools.results;
+#endif
         if (success && !parser.hasError()) {
+            _lastStreamResponse = streamResult(parser, stopDetector, tools);
             return true;
         }
 
+        if (parser.hasError()) {
+            _lastStreamResponse = Response::fail(parser.getError(), parser.getErrorMessage());
+        } else {
+            _lastStreamResponse = Response::fail(ErrorCode::StreamingError, transport->getLastError());
+        }
+
         bool lastAttempt = (attempt + 1 >= maxAttempts);
         if (!_retryConfig.enabled || lastAttempt) {
             break;
         }
+#if ESPAI_ENABLE_TOOLS
+        // Tools already ran with side effects; a retry would run them again
+        if (!tools.results.empty()) {
+            break;
+        }
+#endif
 
         uint32_t delayMs = calculateRetryDelay(_retryConfig, attempt, -1);
         ESPAI_LOG_W(getName(), "Stream retry %d/%d after %lums",
                     attempt + 1, _retryConfig.maxRetries, (unsigned long)delayMs);
-        delay(delayMs);
+        retryDelay(delayMs);
 
         if (!transport->isReady()) {
+            _lastStreamResponse = Response::fail(ErrorCode::NetworkError, "Network lost during retry");
             return false;
         }
     }
 
     return false;
-#else
-    (void)messages;
-    (void)options;
-    (void)callback;
-    return false;
+}
 #endif
+
+StepRequest AIProvider::beginChat(
+    MessageView messages,
+    const ChatOptions& options
+) {
+    StepRequest request;
+    HttpTransport* transport = resolveTransport();
+    if (request.prepare(this, transport)) {
+        request.start(transport, buildHttpRequest(messages, options), false);
+    }
+    return request;
+}
+
+#if ESPAI_ENABLE_STREAMING
+StepRequest AIProvider::beginChatStream(
+    MessageView messages,
+    const ChatOptions& options,
+    StreamCallback callback
+) {
+    StepRequest request;
+    HttpTransport* transport = resolveTransport();
+    if (!request.prepare(this, transport)) {
+        return request;
+    }
+
+    HttpRequest req;
+    Response error;
+    if (!buildStreamHttpRequest(messages, options, req, error)) {
+        request.finish(error);
+        return request;
+    }
+
+    request._parser.reset(new SSEParser(getSSEFormat()));
+    request._stopDetector.reset(new StreamStopDetector(options));
+    request._toolState.reset(new StreamToolState());
+    setupStreamParser(*request._parser, *request._stopDetector, callback, *request._toolState);
+    request.start(transport, req, true);
+    return request;
 }
 #endif
 
 #if ESPAI_ENABLE_ASYNC
 ChatRequest* AIProvider::chatAsync(
-    const std::vector<Message>& messages,
+    MessageView messages,
     const ChatOptions& options,
-    AsyncChatCallback onComplete
+    AsyncChatCallback onComplete,
+    const AsyncRequestOptions& queueOptions
 ) {
-    if (_asyncRunner.isBusy()) return nullptr;
-
-    auto msgsCopy = std::make_shared<std::vector<Message>>(messages);
+    auto msgsCopy = std::make_shared<std::vector<Message>>(messages.begin(), messages.end());
     auto optsCopy = std::make_shared<ChatOptions>(options);
 
-    bool launched = _asyncRunner.launch(
-        [this, msgsCopy, optsCopy]() -> Response {
+    return getAsyncQueue().submit(
+        this,
+        [this, msgsCopy, optsCopy](const ChatRequest&) -> Response {
             return this->chat(*msgsCopy, *optsCopy);
         },
-        onComplete
+        onComplete,
+        queueOptions
     );
-
-    return launched ? _asyncRunner.getRequest() : nullptr;
 }
 
 ChatRequest* AIProvider::chatStreamAsync(
-    const std::vector<Message>& messages,
+    MessageView messages,
     const ChatOptions& options,
     StreamCallback streamCb,
-    AsyncDoneCallback onDone
+    AsyncDoneCallback onDone,
+    const AsyncRequestOptions& queueOptions
+) {
+    auto msgsCopy = std::make_shared<std::vector<Message>>(messages.begin(), messages.end());
+    auto optsCopy = std::make_shared<ChatOptions>(options);
+
+    return getAsyncQueue().submit(
+        this,
+        [this, msgsCopy, optsCopy, streamCb](const ChatRequest& request) -> Response {
+            const ChatRequest* req = &request;
+            StreamChunkRing* ring = request.getStreamBuffer();
+            this->chatStream(*msgsCopy, *optsCopy, [req, ring, &streamCb](const String& chunk, bool done) {
+                if (req->isCancelled()) {
+                    // Nothing more is written: a reader waiting on isDone() can stop now
+                    if (ring) ring->markDone();
+                    return;
+                }
+                if (ring) ring->write(chunk);
+                if (streamCb) streamCb(chunk, done);
+            });
+            // This task is the ring's producer; ends it on success, error and cancellation
+            if (ring) ring->markDone();
+            return this->getLastStreamResponse();
+        },
+        onDone,
+        queueOptions,
+        "Stream cancelled"
+    );
+}
+
+ChatRequest* AIProvider::launchAsync(
+    std::function<Response(const ChatRequest& request)> task,
+    AsyncChatCallback onComplete,
+    const AsyncRequestOptions& queueOptions
 ) {
-    if (_asyncRunner.isBusy()) return nullptr;
+    return getAsyncQueue().submit(this, task, onComplete, queueOptions);
+}
 
-    auto msgsCopy = std::make_shared<std::vector<Message>>(messages);
+ChatFuture AIProvider::chatFuture(
+    MessageView messages,
+    const ChatOptions& options,
+    const AsyncRequestOptions& queueOptions
+) {
+    auto msgsCopy = std::make_shared<std::vector<Message>>(messages.begin(), messages.end());
     auto optsCopy = std::make_shared<ChatOptions>(options);
 
-    bool launched = _asyncRunner.launchStream(
-        [this, msgsCopy, optsCopy](StreamCallback cb) -> bool {
-            return this->chatStream(*msgsCopy, *optsCopy, cb);
+    return getAsyncQueue().submitFuture(
+        this,
+        [this, msgsCopy, optsCopy](const ChatRequest&) -> Response {
+            return this->chat(*msgsCopy, *optsCopy);
         },
-        streamCb,
-        onDone
+        queueOptions
     );
+}
 
-    return launched ? _asyncRunner.getRequest() : nullptr;
+ChatFuture AIProvider::launchFuture(
+    std::function<Response(const ChatRequest& request)> task,
+    const AsyncRequestOptions& queueOptions
+) {
+    return getAsyncQueue().submitFuture(this, task, queueOptions);
+}
+
+#if ESPAI_ENABLE_COROUTINES && ESPAI_ENABLE_STREAMING
+ChatStream AIProvider::chatStreamCo(
+    MessageView messages,
+    const ChatOptions& options,
+    const AsyncRequestOptions& queueOptions
+) {
+    auto msgsCopy = std::make_shared<std::vector<Message>>(messages.begin(), messages.end());
+    auto optsCopy = std::make_shared<ChatOptions>(options);
+
+    ChatStream stream;
+    stream._state = ChatStream::makeState();
+    auto state = stream._state;
+    stream._future = getAsyncQueue().submitFuture(
+        this,
+        [this, msgsCopy, optsCopy, state](const ChatRequest& request) -> Response {
+            const ChatRequest* req = &request;
+            this->chatStream(*msgsCopy, *optsCopy, [req, &state](const String& chunk, bool) {
+                if (req->isCancelled()) return;
+                ChatStream::push(state, chunk);
+            });
+            return this->getLastStreamResponse();
+        },
+        queueOptions,
+        "Stream cancelled"
+    );
+    // Also covers a full queue, where the future is already failed
+    stream._future.onComplete([state](const Response&) { ChatStream::finish(state); });
+    return stream;
 }
+#endif
 
 bool AIProvider::isAsyncBusy() const {
-    return _asyncRunner.isBusy();
+    return getAsyncQueue().isBusy(this);
 }
 
 void AIProvider::cancelAsync() {
-    _asyncRunner.cancel();
+    getAsyncQueue().cancelAll(this);
 }
 #endif // ESPAI_ENABLE_ASYNC
 
 #if ESPAI_ENABLE_TOOLS
-void AIProvider::addTool(const Tool& tool) {
-    if (_tools.size() < ESPAI_MAX_TOOLS) {
-        _tools.push_back(tool);
+bool AIProvider::addTool(const Tool& tool) {
+    String schema;
+    String error;
+    if (!normalizeToolSchema(tool.parametersJson, getSchemaDialect(), schema, &error)) {
+        ESPAI_LOG_W(getName(), "Tool %s rejected: %s", tool.name.c_str(), error.c_str());
+        return false;
     }
+    return addTool(tool, schema);
+}
+
+bool AIProvider::addTool(const Tool& tool, const String& normalizedSchema) {
+    if (_tools.size() >= ESPAI_MAX_TOOLS) {
+        ESPAI_LOG_W(getName(), "Tool %s not added: ESPAI_MAX_TOOLS reached", tool.name.c_str());
+        return false;
+    }
+    _tools.push_back(tool);
+    _toolSchemas.push_back(normalizedSchema);
+    return true;
+}
+
+void AIProvider::addStaticTool(const StaticTool& tool, const String& normalizedSchema) {
+    _staticTools.push_back(&tool);
+    _staticToolSchemas.push_back(normalizedSchema);
 }
 
 void AIProvider::clearTools() {
     _tools.clear();
+    _toolSchemas.clear();
+    _staticTools.clear();
+    _staticToolSchemas.clear();
     _lastToolCalls.clear();
 }
 #endif
@@ -4,15 +4,32 @@
 #include "../core/AIConfig.h"
 #include "../core/AITypes.h"
 #include "../http/SSEParser.h"
+#include "../http/StreamStopDetector.h"
 #include <ArduinoJson.h>
 #include <vector>
 
+#if ESPAI_ENABLE_TOOLS
+#include "../tools/ToolRegistry.h"
+#include "../tools/ParallelToolExecutor.h"
+#endif
+
 #if ESPAI_ENABLE_ASYNC
-#include "../async/AsyncTaskRunner.h"
+#include "../async/AsyncRequestQueue.h"
+#endif
+
+#if ESPAI_ENABLE_COROUTINES
+#include "../async/ChatCoroutine.h"
+#endif
+
+#if ESPAI_ENABLE_STREAM_PIPELINE
+#include "../async/StreamPipeline.h"
 #endif
 
 namespace ESPAI {
 
+class HttpTransport;
+class StepRequest;
+
 struct HttpRequest {
     String url;
     String method;
@@ -43,20 +60,47 @@ class AIProvider {
 public:
     virtual ~AIProvider() {
 #if ESPAI_ENABLE_ASYNC
-        // Wait for async task to complete before members are destroyed.
-        // This prevents use-after-free if the task captures 'this'.
-        _asyncRunner.waitForCompletion();
+        // Cancel and wait for this provider's async requests before members are destroyed.
+        // This prevents use-after-free if a task captures 'this'.
+        getAsyncQueue().detach(this);
 #endif
     }
 
     Response chat(
-        const std::vector<Message>& messages,
+        MessageView messages,
         const ChatOptions& options
     );
 
 #if ESPAI_ENABLE_STREAMING
     bool chatStream(
-        const std::vector<Message>& messages,
+        MessageView messages,
+        const ChatOptions& options,
+        StreamCallback callback
+    );
+
+    // Usage, stop reason and tool calls of the last chatStream() call.
+    // Content is empty: streamed text is only delivered through the callback.
+    const Response& getLastStreamResponse() const { return _lastStreamResponse; }
+#endif
+
+#if ESPAI_ENABLE_STREAM_PIPELINE
+    // Opt-in: chatStream() reads the socket on the calling task and parses on
+    // a second task (callbacks run there). See StreamPipeline.h.
+    void setStreamPipeline(const StreamPipelineConfig& config) { _pipelineConfig = config; }
+    const StreamPipelineConfig& getStreamPipeline() const { return _pipelineConfig; }
+    // Buffer occupancy and stalls of the last chatStream() with the pipeline
+    const StreamPipelineStats& getLastPipelineStats() const { return _lastPipelineStats; }
+#endif
+
+    // Step-driven variants of chat() and chatStream(): nothing happens until
+    // StepRequest::step() is called from loop(). No retries. See StepRequest.h.
+    StepRequest beginChat(
+        MessageView messages,
+        const ChatOptions& options
+    );
+#if ESPAI_ENABLE_STREAMING
+    StepRequest beginChatStream(
+        MessageView messages,
         const ChatOptions& options,
         StreamCallback callback
     );
@@ -77,6 +121,9 @@ public:
     virtual void setBaseUrl(const String& url) { _baseUrl = url; }
     virtual void setTimeout(uint32_t timeoutMs) { _timeout = timeoutMs; }
     void setRetryConfig(const RetryConfig& config) { _retryConfig = config; }
+
+    // Uses this transport instead of the platform default. Not owned; nullptr restores the default.
+    void setTransport(HttpTransport* transport) { _transport = transport; }
     const RetryConfig& getRetryConfig() const { return _retryConfig; }
 
     const String& getApiKey() const { return _apiKey; }
@@ -89,60 +136,202 @@ public:
     }
 
 #if ESPAI_ENABLE_ASYNC
+    // Requests are queued on getAsyncQueue(); nullptr only when the queue is full.
+    // This provider's requests run one at a time, highest priority first.
     ChatRequest* chatAsync(
-        const std::vector<Message>& messages,
+        MessageView messages,
         const ChatOptions& options,
-        AsyncChatCallback onComplete = nullptr
+        AsyncChatCallback onComplete = nullptr,
+        const AsyncRequestOptions& queueOptions = AsyncRequestOptions()
     );
 
+    // streamCb runs on the worker task. With queueOptions.streamBufferSize set,
+    // chunks are also buffered for ChatRequest::readChunks() from any one task,
+    // and streamCb may be nullptr.
     ChatRequest* chatStreamAsync(
-        const std::vector<Message>& messages,
+        MessageView messages,
         const ChatOptions& options,
         StreamCallback streamCb,
-        AsyncDoneCallback onDone = nullptr
+        AsyncDoneCallback onDone = nullptr,
+        const AsyncRequestOptions& queueOptions = AsyncRequestOptions()
     );
 
+    // True while any of this provider's requests is queued or running
     bool isAsyncBusy() const;
+    // Cancels all of this provider's queued and running requests
     void cancelAsync();
+
+    // Queues a custom job like chatAsync(). The job can poll request.isCancelled() between steps.
+    ChatRequest* launchAsync(
+        std::function<Response(const ChatRequest& request)> task,
+        AsyncChatCallback onComplete = nullptr,
+        const AsyncRequestOptions& queueOptions = AsyncRequestOptions()
+    );
+
+    // Like chatAsync() and launchAsync(), with the result delivered through a
+    // future that can be chained with then() on the worker task.
+    ChatFuture chatFuture(
+        MessageView messages,
+        const ChatOptions& options,
+        const AsyncRequestOptions& queueOptions = AsyncRequestOptions()
+    );
+    ChatFuture launchFuture(
+        std::function<Response(const ChatRequest& request)> task,
+        const AsyncRequestOptions& queueOptions = AsyncRequestOptions()
+    );
+
+#if ESPAI_ENABLE_COROUTINES
+    // co_await provider.chatCo(msgs, options) inside a ChatTask coroutine
+    ChatFuture chatCo(
+        MessageView messages,
+        const ChatOptions& options,
+        const AsyncRequestOptions& queueOptions = AsyncRequestOptions()
+    ) { return chatFuture(messages, options, queueOptions); }
+#if ESPAI_ENABLE_STREAMING
+    // Chunks are pulled with co_await stream.next() and resume the consumer on the worker task
+    ChatStream chatStreamCo(
+        MessageView messages,
+        const ChatOptions& options,
+        const AsyncRequestOptions& queueOptions = AsyncRequestOptions()
+    );
+#endif
+#endif
+
+    // AsyncRequestQueue::shared() unless set. Set it before submitting requests.
+    AsyncRequestQueue& getAsyncQueue() const { return _asyncQueue ? *_asyncQueue : AsyncRequestQueue::shared(); }
+    void setAsyncQueue(AsyncRequestQueue* queue) { _asyncQueue = queue; }
 #endif
 
 #if ESPAI_ENABLE_TOOLS
-    void addTool(const Tool& tool);
+    // Validates and normalizes the tool's schema once, for getSchemaDialect().
+    // Returns false (tool not added) for an invalid schema or when full.
+    bool addTool(const Tool& tool);
+    // Takes a schema already normalized for getSchemaDialect(), e.g. from
+    // ToolRegistry::getToolSchema()
+    bool addTool(const Tool& tool, const String& normalizedSchema);
+    // Declares a flash-resident tool without copying it to the heap. Not
+    // counted against ESPAI_MAX_TOOLS; the table must outlive the provider's use of it.
+    void addStaticTool(const StaticTool& tool, const String& normalizedSchema);
     void clearTools();
+    virtual SchemaDialect getSchemaDialect() const { return SchemaDialect::OpenAI; }
     const std::vector<ToolCall>& getLastToolCalls() const { return _lastToolCalls; }
     bool hasToolCalls() const { return !_lastToolCalls.empty(); }
     virtual Message getAssistantMessageWithToolCalls(const String& content = "") const = 0;
 #endif
 
+#if ESPAI_ENABLE_TOOLS && ESPAI_ENABLE_STREAMING
+    // Reports tool-call argument fields during chatStream() as soon as each one is complete
+    void setToolArgumentCallback(SSEParser::ToolArgumentCallback cb) { _toolArgumentCallback = cb; }
+
+    // Opt-in: start each tool call through the registry as soon as the stream completes it,
+    // while the model is still generating. Handlers never run on the task reading the
+    // stream: async and parallelSafe tools start on the registry's workers, the others
+    // run when the stream ends (see ParallelToolExecutor::submit()). Results of
+    // chatStream() are kept in getLastToolResults(), those of beginChatStream() in
+    // StepRequest::getToolResults(). The registry must outlive the stream. Pass nullptr to disable.
+    void setEarlyToolDispatch(const ToolRegistry* registry) { _earlyToolRegistry = registry; }
+    const std::vector<ToolResult>& getLastToolResults() const { return _lastToolResults; }
+#endif
+
 protected:
+    friend class StepRequest;
+
     String _apiKey;
     String _model;
     String _baseUrl;
     uint32_t _timeout = ESPAI_HTTP_TIMEOUT_MS;
     RetryConfig _retryConfig;
     bool _streamingRequest = false;
+    HttpTransport* _transport = nullptr;
+
+#if ESPAI_ENABLE_STREAMING
+    Response _lastStreamResponse;
+#endif
+
+#if ESPAI_ENABLE_STREAM_PIPELINE
+    StreamPipelineConfig _pipelineConfig;
+    StreamPipelineStats _lastPipelineStats;
+#endif
 
 #if ESPAI_ENABLE_ASYNC
-    AsyncTaskRunner _asyncRunner;
+    AsyncRequestQueue* _asyncQueue = nullptr;
 #endif
 
+    HttpTransport* resolveTransport() const;
+    // Maps a finished HTTP exchange to the chat() result
+    Response chatResult(const HttpResponse& httpResp);
     static bool isRetryableStatus(int16_t statusCode);
     static uint32_t calculateRetryDelay(const RetryConfig& config, uint8_t attempt, int32_t retryAfterSeconds);
 
 #if ESPAI_ENABLE_TOOLS
     std::vector<Tool> _tools;
+    std::vector<String> _toolSchemas;  // Normalized parametersJson, parallel to _tools
+    std::vector<const StaticTool*> _staticTools;
+    std::vector<String> _staticToolSchemas;  // Parallel to _staticTools
+
+    bool hasTools() const { return !_tools.empty() || !_staticTools.empty(); }
+
+    // Calls fn(name, description, normalizedSchema) for each declared tool, runtime tools first
+    template <typename Fn>
+    void forEachTool(Fn fn) const {
+        for (size_t i = 0; i < _tools.size(); i++) {
+            fn(_tools[i].name.c_str(), _tools[i].description.c_str(), _toolSchemas[i]);
+        }
+        for (size_t i = 0; i < _staticTools.size(); i++) {
+            const char* description = _staticTools[i]->description;
+            fn(_staticTools[i]->name, description != nullptr ? description : "", _staticToolSchemas[i]);
+        }
+    }
     std::vector<ToolCall> _lastToolCalls;
 #endif
 
+#if ESPAI_ENABLE_STREAMING
+    // Tool calls of one stream. Each stream owns one, so step-driven streams
+    // of the same provider can run side by side.
+    struct StreamToolState {
+#if ESPAI_ENABLE_TOOLS
+        std::vector<ToolCall> calls;
+        std::vector<ToolResult> results;  // From early dispatch, once collected
+        ParallelToolExecutor early;       // Calls handed over by early dispatch
+
+        // Waits for the early-dispatched calls; at the end of the stream
+        void collect() {
+            if (early.getSubmittedCount() > 0) {
+                results = early.collect();
+            }
+        }
+#endif
+    };
+
+    // Shared by chatStream() and step-driven streams
+    bool buildStreamHttpRequest(
+        MessageView messages,
+        const ChatOptions& options,
+        HttpRequest& req,
+        Response& error
+    );
+    // tools must outlive the parser
+    void setupStreamParser(SSEParser& parser, StreamStopDetector& stopDetector,
+                           StreamCallback callback, StreamToolState& tools);
+    Response streamResult(const SSEParser& parser, const StreamStopDetector& stopDetector,
+                          const StreamToolState& tools) const;
+#endif
+
+#if ESPAI_ENABLE_TOOLS && ESPAI_ENABLE_STREAMING
+    SSEParser::ToolArgumentCallback _toolArgumentCallback;
+    const ToolRegistry* _earlyToolRegistry = nullptr;
+    std::vector<ToolResult> _lastToolResults;
+#endif
+
     virtual String buildRequestBody(
-        const std::vector<Message>& messages,
+        MessageView messages,
         const ChatOptions& options
     ) = 0;
 
     virtual Response parseResponse(const String& json) = 0;
 
     virtual HttpRequest buildHttpRequest(
-        const std::vector<Message>& messages,
+        MessageView messages,
         const ChatOptions& options
     ) {
         HttpRequest req;
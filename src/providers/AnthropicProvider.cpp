@@ -13,7 +13,7 @@ AnthropicProvider::AnthropicProvider(const String& apiKey, const String& model)
 }
 
 HttpRequest AnthropicProvider::buildHttpRequest(
-    const std::vector<Message>& messages,
+    MessageView messages,
     const ChatOptions& options
 ) {
     HttpRequest req;
@@ -28,7 +28,7 @@ HttpRequest AnthropicProvider::buildHttpRequest(
     return req;
 }
 
-String AnthropicProvider::extractSystemPrompt(const std::vector<Message>& messages) {
+String AnthropicProvider::extractSystemPrompt(MessageView messages) {
     for (const auto& msg : messages) {
         if (msg.role == Role::System) {
             return msg.content;
@@ -38,7 +38,7 @@ String AnthropicProvider::extractSystemPrompt(const std::vector<Message>& messag
 }
 
 String AnthropicProvider::buildRequestBody(
-    const std::vector<Message>& messages,
+    MessageView messages,
     const ChatOptions& options
 ) {
     JsonDocument doc;
@@ -96,20 +96,19 @@ String AnthropicProvider::buildRequestBody(
     }
 
 #if ESPAI_ENABLE_TOOLS
-    if (!_tools.empty()) {
+    if (hasTools()) {
         JsonArray toolsArr = doc["tools"].to<JsonArray>();
-        for (const auto& tool : _tools) {
+        forEachTool([&toolsArr](const char* name, const char* description, const String& schema) {
             JsonObject t = toolsArr.add<JsonObject>();
-            t["name"] = tool.name.c_str();
-            if (!tool.description.isEmpty()) {
-                t["description"] = tool.description.c_str();
+            t["name"] = name;
+            if (description[0] != '\0') {
+                t["description"] = description;
             }
-            if (!tool.parametersJson.isEmpty()) {
-                JsonDocument schemaDoc;
-                deserializeJson(schemaDoc, tool.parametersJson);
-                t["input_schema"] = schemaDoc.as<JsonObject>();
+            // Normalized once by addTool()
+            if (!schema.isEmpty()) {
+                t["input_schema"] = serialized(schema);
             }
-        }
+        });
     }
 #endif
 
@@ -178,6 +177,10 @@ Response AnthropicProvider::parseResponse(const String& json) {
 
     response.content = textContent;
 
+    if (doc["stop_reason"].is<const char*>()) {
+        response.stopReason = doc["stop_reason"].as<String>();
+    }
+
     if (!doc["usage"].isNull()) {
         JsonObject usage = doc["usage"];
         response.promptTokens = usage["input_tokens"] | 0;
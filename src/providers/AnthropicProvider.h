@@ -17,6 +17,7 @@ public:
     bool supportsTools() const override { return true; }
 
 #if ESPAI_ENABLE_TOOLS
+    SchemaDialect getSchemaDialect() const override { return SchemaDialect::Anthropic; }
     Message getAssistantMessageWithToolCalls(const String& content = "") const override;
 #endif
 
@@ -24,12 +25,12 @@ public:
     const String& getApiVersion() const { return _apiVersion; }
 
     HttpRequest buildHttpRequest(
-        const std::vector<Message>& messages,
+        MessageView messages,
         const ChatOptions& options
     ) override;
 
     String buildRequestBody(
-        const std::vector<Message>& messages,
+        MessageView messages,
         const ChatOptions& options
     ) override;
 
@@ -39,7 +40,7 @@ public:
     SSEFormat getSSEFormat() const override { return SSEFormat::Anthropic; }
 #endif
 
-    String extractSystemPrompt(const std::vector<Message>& messages);
+    String extractSystemPrompt(MessageView messages);
 
 private:
     String _apiVersion;
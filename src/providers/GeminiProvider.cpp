@@ -16,7 +16,7 @@ String GeminiProvider::buildApiUrl(const String& model, const String& action) co
 }
 
 HttpRequest GeminiProvider::buildHttpRequest(
-    const std::vector<Message>& messages,
+    MessageView messages,
     const ChatOptions& options
 ) {
     HttpRequest req;
@@ -38,7 +38,7 @@ HttpRequest GeminiProvider::buildHttpRequest(
 }
 
 String GeminiProvider::buildRequestBody(
-    const std::vector<Message>& messages,
+    MessageView messages,
     const ChatOptions& options
 ) {
     JsonDocument doc;
@@ -173,23 +173,22 @@ String GeminiProvider::buildRequestBody(
     }
 
 #if ESPAI_ENABLE_TOOLS
-    if (!_tools.empty()) {
+    if (hasTools()) {
         JsonArray toolsArr = doc["tools"].to<JsonArray>();
         JsonObject toolObj = toolsArr.add<JsonObject>();
         JsonArray funcDecls = toolObj["functionDeclarations"].to<JsonArray>();
 
-        for (const auto& tool : _tools) {
+        forEachTool([&funcDecls](const char* name, const char* description, const String& schema) {
             JsonObject func = funcDecls.add<JsonObject>();
-            func["name"] = tool.name.c_str();
-            if (!tool.description.isEmpty()) {
-                func["description"] = tool.description.c_str();
+            func["name"] = name;
+            if (description[0] != '\0') {
+                func["description"] = description;
             }
-            if (!tool.parametersJson.isEmpty()) {
-                JsonDocument paramsDoc;
-                deserializeJson(paramsDoc, tool.parametersJson);
-                func["parameters"] = paramsDoc.as<JsonObject>();
+            // Normalized once by addTool()
+            if (!schema.isEmpty()) {
+                func["parameters"] = serialized(schema);
             }
-        }
+        });
     }
 #endif
 
@@ -281,6 +280,11 @@ Response GeminiProvider::parseSingleResponse(const String& json) {
 
     response.content = textContent;
 
+    const char* finishReason = firstCandidate["finishReason"] | "";
+    if (strlen(finishReason) > 0) {
+        response.stopReason = finishReason;
+    }
+
     if (!doc["usageMetadata"].isNull()) {
         JsonObject usage = doc["usageMetadata"];
         response.promptTokens = usage["promptTokenCount"] | 0;
@@ -337,6 +341,11 @@ Response GeminiProvider::parseResponse(const String& responseBody) {
                             }
                         }
 
+                        const char* finishReason = firstCandidate["finishReason"] | "";
+                        if (strlen(finishReason) > 0) {
+                            lastChunkResponse.stopReason = finishReason;
+                        }
+
                         foundAny = true;
                     }
 
@@ -360,6 +369,7 @@ Response GeminiProvider::parseResponse(const String& responseBody) {
         response.content = allText;
         response.promptTokens = lastChunkResponse.promptTokens;
         response.completionTokens = lastChunkResponse.completionTokens;
+        response.stopReason = lastChunkResponse.stopReason;
         return response;
     }
 
@@ -21,16 +21,17 @@ public:
     bool supportsTools() const override { return true; }
 
 #if ESPAI_ENABLE_TOOLS
+    SchemaDialect getSchemaDialect() const override { return SchemaDialect::Gemini; }
     Message getAssistantMessageWithToolCalls(const String& content = "") const override;
 #endif
 
     HttpRequest buildHttpRequest(
-        const std::vector<Message>& messages,
+        MessageView messages,
         const ChatOptions& options
     ) override;
 
     String buildRequestBody(
-        const std::vector<Message>& messages,
+        MessageView messages,
         const ChatOptions& options
     ) override;
 
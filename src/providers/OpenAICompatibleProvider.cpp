@@ -57,7 +57,7 @@ void OpenAICompatibleProvider::addProviderHeaders(HttpRequest& req) {
 }
 
 HttpRequest OpenAICompatibleProvider::buildHttpRequest(
-    const std::vector<Message>& messages,
+    MessageView messages,
     const ChatOptions& options
 ) {
     HttpRequest req;
@@ -77,7 +77,7 @@ HttpRequest OpenAICompatibleProvider::buildHttpRequest(
 }
 
 String OpenAICompatibleProvider::buildRequestBody(
-    const std::vector<Message>& messages,
+    MessageView messages,
     const ChatOptions& options
 ) {
     JsonDocument doc;
@@ -86,7 +86,18 @@ String OpenAICompatibleProvider::buildRequestBody(
     doc["model"] = model.c_str();
 
     JsonArray messagesArr = doc["messages"].to<JsonArray>();
+    bool systemOverride = !options.systemPrompt.isEmpty();
+    if (systemOverride) {
+        JsonObject m = messagesArr.add<JsonObject>();
+        m["role"] = "system";
+        m["content"] = options.systemPrompt.c_str();
+    }
+
     for (const auto& msg : messages) {
+        // options.systemPrompt replaces system messages, as with the other providers
+        if (systemOverride && msg.role == Role::System) {
+            continue;
+        }
         JsonObject m = messagesArr.add<JsonObject>();
         m["role"] = roleToString(msg.role);
 
@@ -133,23 +144,26 @@ String OpenAICompatibleProvider::buildRequestBody(
         doc["presence_penalty"] = roundFloat(options.presencePenalty);
     }
 
+    if (_streamingRequest && _config.streamUsageSupported) {
+        doc["stream_options"]["include_usage"] = true;
+    }
+
 #if ESPAI_ENABLE_TOOLS
-    if (_config.toolCallingSupported && !_tools.empty()) {
+    if (_config.toolCallingSupported && hasTools()) {
         JsonArray toolsArr = doc["tools"].to<JsonArray>();
-        for (const auto& tool : _tools) {
+        forEachTool([&toolsArr](const char* name, const char* description, const String& schema) {
             JsonObject t = toolsArr.add<JsonObject>();
             t["type"] = "function";
             JsonObject func = t["function"].to<JsonObject>();
-            func["name"] = tool.name.c_str();
-            if (!tool.description.isEmpty()) {
-                func["description"] = tool.description.c_str();
+            func["name"] = name;
+            if (description[0] != '\0') {
+                func["description"] = description;
             }
-            if (!tool.parametersJson.isEmpty()) {
-                JsonDocument paramsDoc;
-                deserializeJson(paramsDoc, tool.parametersJson);
-                func["parameters"] = paramsDoc.as<JsonObject>();
+            // Normalized once by addTool()
+            if (!schema.isEmpty()) {
+                func["parameters"] = serialized(schema);
             }
-        }
+        });
     }
 #endif
 
@@ -195,6 +209,10 @@ Response OpenAICompatibleProvider::parseResponse(const String& json) {
 
     JsonObject message = firstChoice["message"];
 
+    if (firstChoice["finish_reason"].is<const char*>()) {
+        response.stopReason = firstChoice["finish_reason"].as<String>();
+    }
+
 #if ESPAI_ENABLE_TOOLS
     if (!message["tool_calls"].isNull()) {
         JsonArray toolCalls = message["tool_calls"];
@@ -22,6 +22,7 @@ struct OpenAICompatibleConfig {
     String authHeaderValuePrefix;
     bool requiresApiKey;
     bool toolCallingSupported;
+    bool streamUsageSupported;  // Send stream_options.include_usage on streaming requests
     Provider providerType;
 
     OpenAICompatibleConfig()
@@ -33,6 +34,7 @@ struct OpenAICompatibleConfig {
         , authHeaderValuePrefix("Bearer ")
         , requiresApiKey(true)
         , toolCallingSupported(true)
+        , streamUsageSupported(true)
         , providerType(Provider::Custom) {}
 };
 
@@ -64,12 +66,12 @@ public:
 #endif
 
     HttpRequest buildHttpRequest(
-        const std::vector<Message>& messages,
+        MessageView messages,
         const ChatOptions& options
     ) override;
 
     String buildRequestBody(
-        const std::vector<Message>& messages,
+        MessageView messages,
         const ChatOptions& options
     ) override;
 
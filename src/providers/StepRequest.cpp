@@ -0,0 +1,201 @@
+#include "StepRequest.h"
+#include "../http/HttpTransport.h"
+
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+namespace ESPAI {
+
+namespace {
+    uint32_t nowMicros() {
+#ifdef ARDUINO
+        return micros();
+#else
+        static auto start = std::chrono::steady_clock::now();
+        auto now = std::chrono::steady_clock::now();
+        return static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - start).count());
+#endif
+    }
+
+    uint32_t nowMs() {
+        return nowMicros() / 1000;
+    }
+}
+
+bool StepRequest::prepare(AIProvider* provider, HttpTransport* transport) {
+    _provider = provider;
+    if (!provider->isConfigured()) {
+        finish(Response::fail(ErrorCode::NotConfigured, "Provider not configured"));
+        return false;
+    }
+    if (transport == nullptr) {
+        finish(Response::fail(ErrorCode::NotConfigured, "HTTP transport not available"));
+        return false;
+    }
+    if (!transport->isReady()) {
+        finish(Response::fail(ErrorCode::NetworkError, "Network not ready"));
+        return false;
+    }
+    return true;
+}
+
+void StepRequest::start(HttpTransport* transport, const HttpRequest& request, bool stream) {
+    _stream = stream;
+    _timeoutMs = request.timeout;
+    _maxResponseSize = request.maxResponseSize;
+    _exchange = transport->openExchange(request, stream);
+    if (!_exchange) {
+        finish(Response::fail(ErrorCode::NotConfigured, "Transport does not support step requests"));
+        return;
+    }
+    _phase = Phase::Connecting;
+    _lastActivityMs = nowMs();
+}
+
+bool StepRequest::step() {
+    if (_phase == Phase::Idle || _phase == Phase::Done) {
+        return false;
+    }
+    if (!_buffer) {
+        _buffer.reset(new uint8_t[ESPAI_STEP_BUFFER_SIZE]);
+    }
+    return stepWith(_buffer.get());
+}
+
+bool StepRequest::stepWith(uint8_t* buffer) {
+    uint32_t started = nowMicros();
+    _steps++;
+
+    size_t received = 0;
+    HttpExchange::Phase phase = _exchange->step(buffer, ESPAI_STEP_BUFFER_SIZE, received);
+    Phase previous = _phase;
+    if (received > 0) {
+        _lastActivityMs = nowMs();
+        consume(buffer, received);
+    }
+
+    if (_phase != Phase::Done) {
+        switch (phase) {
+            case HttpExchange::Phase::Connecting:
+                break;
+            case HttpExchange::Phase::Sending:
+                _phase = Phase::Sending;
+                break;
+            case HttpExchange::Phase::Receiving:
+                _phase = Phase::Receiving;
+                break;
+            case HttpExchange::Phase::Done:
+                complete();
+                break;
+            case HttpExchange::Phase::Failed:
+                finish(Response::fail(_stream ? ErrorCode::StreamingError : ErrorCode::NetworkError,
+                                      _exchange->getLastError(), _exchange->getStatusCode()));
+                break;
+        }
+    }
+
+    if (_phase != Phase::Done) {
+        if (_phase != previous) {
+            _lastActivityMs = nowMs();
+        } else {
+            checkTimeout();
+        }
+    }
+
+    uint32_t elapsed = nowMicros() - started;
+    if (elapsed > _longestStepUs) {
+        _longestStepUs = elapsed;
+    }
+    return _phase != Phase::Done;
+}
+
+bool StepRequest::checkTimeout() {
+    if (_phase == Phase::Idle || _phase == Phase::Done) {
+        return false;
+    }
+    if (_timeoutMs > 0 && nowMs() - _lastActivityMs >= _timeoutMs) {
+        finish(Response::fail(ErrorCode::Timeout, "Request timed out"));
+        return false;
+    }
+    return true;
+}
+
+void StepRequest::cancel() {
+    if (_phase == Phase::Done) {
+        return;
+    }
+    finish(Response::fail(ErrorCode::NetworkError, "Request cancelled"));
+}
+
+void StepRequest::consume(const uint8_t* data, size_t received) {
+#if ESPAI_ENABLE_STREAMING
+    if (_stream && _exchange->getStatusCode() == 200) {
+        _parser->feed(reinterpret_cast<const char*>(data), received);
+        if (_parser->hasError()) {
+            finish(Response::fail(_parser->getError(), _parser->getErrorMessage()));
+        } else if (_parser->isDone() || _parser->isCancelled()) {
+            // A cancelled parser hit a stop sequence; dropping the exchange closes the connection
+            finish(_provider->streamResult(*_parser, *_stopDetector, *_toolState));
+        }
+        return;
+    }
+#endif
+
+#ifdef ARDUINO
+    _body.concat(reinterpret_cast<const char*>(data), received);
+#else
+    _body.append(reinterpret_cast<const char*>(data), received);
+#endif
+    if (_body.length() > _maxResponseSize) {
+        finish(Response::fail(ErrorCode::ResponseTooLarge,
+                              "Response too large: more than " + String(_maxResponseSize) + " bytes",
+                              _exchange->getStatusCode()));
+    }
+}
+
+void StepRequest::complete() {
+    int16_t statusCode = _exchange->getStatusCode();
+
+#if ESPAI_ENABLE_STREAMING
+    if (_stream) {
+        if (statusCode != 200) {
+            finish(_provider->handleHttpError(statusCode, _body));
+        } else if (_parser->hasError()) {
+            finish(Response::fail(_parser->getError(), _parser->getErrorMessage()));
+        } else {
+            finish(_provider->streamResult(*_parser, *_stopDetector, *_toolState));
+        }
+        return;
+    }
+#endif
+
+    HttpResponse httpResp;
+    httpResp.statusCode = statusCode;
+    httpResp.success = (statusCode >= 200 && statusCode < 300);
+    httpResp.retryAfterSeconds = _exchange->getRetryAfterSeconds();
+    httpResp.body = _body;
+    finish(_provider->chatResult(httpResp));
+}
+
+void StepRequest::finish(const Response& result) {
+    _result = result;
+    _phase = Phase::Done;
+    _exchange.reset();
+    _buffer.reset();
+    _body = String();
+#if ESPAI_ENABLE_STREAMING
+#if ESPAI_ENABLE_TOOLS
+    if (_toolState) {
+        _toolState->collect();
+        _toolResults = _toolState->results;
+    }
+#endif
+    _parser.reset();
+    _stopDetector.reset();
+    _toolState.reset();
+#endif
+}
+
+} // namespace ESPAI
@@ -0,0 +1,124 @@
+#ifndef ESPAI_STEP_REQUEST_H
+#define ESPAI_STEP_REQUEST_H
+
+#include "../core/AIConfig.h"
+#include "../core/AITypes.h"
+#include "../http/HttpExchange.h"
+#include "AIProvider.h"
+#include <memory>
+
+#if ESPAI_ENABLE_STREAMING
+#include "../http/SSEParser.h"
+#include "../http/StreamStopDetector.h"
+#endif
+
+#ifndef ESPAI_STEP_BUFFER_SIZE
+#define ESPAI_STEP_BUFFER_SIZE      512
+#endif
+
+namespace ESPAI {
+
+class HttpTransport;
+
+/**
+ * A chat request driven from loop(), without a task.
+ *
+ * Each step() does one bounded, non-blocking slice of the exchange (a
+ * connect attempt covering DNS, TCP and TLS, one write, or one read of at
+ * most ESPAI_STEP_BUFFER_SIZE bytes that is parsed on the spot) and
+ * returns. One loop() can then run UI, sensors and an LLM stream side by
+ * side with predictable latency, which suits single-core parts where a
+ * 20 KB async task is too expensive:
+ *
+ *   StepRequest req = provider.beginChatStream(messages, options, onChunk);
+ *
+ *   void loop() {
+ *       if (req.step()) { ... }    // Still running
+ *       else if (req.isDone()) handle(req.getResult());
+ *       updateDisplay();
+ *   }
+ *
+ * Stream chunks are delivered from inside step(). There are no retries.
+ * The provider must outlive the request. Tool calls are tracked per
+ * request, in getResult().toolCalls and getToolResults(), not in the
+ * provider's getLastToolCalls(). Needs a transport with openExchange();
+ * the ESP32 transport has one.
+ */
+class StepRequest {
+public:
+    enum class Phase : uint8_t {
+        Idle,           // Not started
+        Connecting,
+        Sending,
+        Receiving,
+        Done
+    };
+
+    StepRequest() = default;
+    StepRequest(StepRequest&&) = default;
+    StepRequest& operator=(StepRequest&&) = default;
+
+    // Advances by one slice; returns true while the request is still running
+    bool step();
+    // Fails the request and closes its connection
+    void cancel();
+
+    Phase getPhase() const { return _phase; }
+    bool isDone() const { return _phase == Phase::Done; }
+    const Response& getResult() const { return _result; }
+
+    uint32_t getStepCount() const { return _steps; }
+    // Longest single step() so far, in microseconds
+    uint32_t getLongestStepMicros() const { return _longestStepUs; }
+
+#if ESPAI_ENABLE_TOOLS && ESPAI_ENABLE_STREAMING
+    // Results of this stream's early tool dispatch (AIProvider::setEarlyToolDispatch())
+    const std::vector<ToolResult>& getToolResults() const { return _toolResults; }
+#endif
+
+private:
+    friend class AIProvider;
+    friend class StreamMultiplexer;
+
+    AIProvider* _provider = nullptr;
+    std::unique_ptr<HttpExchange> _exchange;
+    std::unique_ptr<uint8_t[]> _buffer;   // Allocated on the first step()
+    Phase _phase = Phase::Idle;
+    Response _result;
+    bool _stream = false;
+    String _body;               // Non-streamed body, or an error body
+    uint32_t _maxResponseSize = ESPAI_MAX_RESPONSE_SIZE;
+    uint32_t _timeoutMs = ESPAI_HTTP_TIMEOUT_MS;
+    uint32_t _lastActivityMs = 0;
+    uint32_t _steps = 0;
+    uint32_t _longestStepUs = 0;
+
+#if ESPAI_ENABLE_STREAMING
+    std::unique_ptr<SSEParser> _parser;
+    std::unique_ptr<StreamStopDetector> _stopDetector;
+    std::unique_ptr<AIProvider::StreamToolState> _toolState;
+#endif
+#if ESPAI_ENABLE_TOOLS && ESPAI_ENABLE_STREAMING
+    std::vector<ToolResult> _toolResults;
+#endif
+
+    // Fails the request unless the provider and transport can run it
+    bool prepare(AIProvider* provider, HttpTransport* transport);
+    void start(HttpTransport* transport, const HttpRequest& request, bool stream);
+    // step() with a caller's buffer of ESPAI_STEP_BUFFER_SIZE bytes
+    bool stepWith(uint8_t* buffer);
+    // Fails the request when it has been idle for its timeout; true while running
+    bool checkTimeout();
+    int socket() const { return _exchange ? _exchange->getSocket() : -1; }
+    bool hasBufferedData() const { return _exchange && _exchange->hasBufferedData(); }
+    void consume(const uint8_t* data, size_t received);
+    void complete();
+    void finish(const Response& result);
+
+    StepRequest(const StepRequest&) = delete;
+    StepRequest& operator=(const StepRequest&) = delete;
+};
+
+} // namespace ESPAI
+
+#endif // ESPAI_STEP_REQUEST_H
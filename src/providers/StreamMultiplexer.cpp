@@ -0,0 +1,126 @@
+#include "StreamMultiplexer.h"
+
+#if defined(ARDUINO) || defined(__unix__) || defined(__APPLE__)
+#include <sys/select.h>
+#define ESPAI_MULTIPLEXER_SELECT 1
+#else
+#define ESPAI_MULTIPLEXER_SELECT 0
+#endif
+
+namespace ESPAI {
+
+namespace {
+    bool isRunning(const StepRequest& request) {
+        return request.getPhase() != StepRequest::Phase::Idle && !request.isDone();
+    }
+}
+
+size_t StreamMultiplexer::add(StepRequest&& request) {
+    _requests.push_back(std::move(request));
+    return _requests.size() - 1;
+}
+
+size_t StreamMultiplexer::getRunningCount() const {
+    size_t running = 0;
+    for (const StepRequest& request : _requests) {
+        if (isRunning(request)) {
+            running++;
+        }
+    }
+    return running;
+}
+
+size_t StreamMultiplexer::poll(uint32_t waitMs) {
+    if (!_buffer) {
+        _buffer.reset(new uint8_t[ESPAI_STEP_BUFFER_SIZE]);
+    }
+
+#if ESPAI_MULTIPLEXER_SELECT
+    fd_set readSet;
+    fd_set writeSet;
+    FD_ZERO(&readSet);
+    FD_ZERO(&writeSet);
+    int maxFd = -1;
+    bool readyNow = false;
+
+    for (StepRequest& request : _requests) {
+        if (!isRunning(request)) {
+            continue;
+        }
+        int fd = request.socket();
+        if (fd < 0 || fd >= FD_SETSIZE || request.hasBufferedData()) {
+            readyNow = true;
+            continue;
+        }
+        // A TLS handshake needs both directions while connecting
+        if (request.getPhase() != StepRequest::Phase::Sending) {
+            FD_SET(fd, &readSet);
+        }
+        if (request.getPhase() != StepRequest::Phase::Receiving) {
+            FD_SET(fd, &writeSet);
+        }
+        if (fd > maxFd) {
+            maxFd = fd;
+        }
+    }
+
+    if (maxFd >= 0) {
+        struct timeval timeout;
+        uint32_t wait = readyNow ? 0 : waitMs;
+        timeout.tv_sec = wait / 1000;
+        timeout.tv_usec = (wait % 1000) * 1000;
+        if (select(maxFd + 1, &readSet, &writeSet, nullptr, &timeout) < 0) {
+            // Interrupted or a socket went bad: let step() find out which
+            for (int fd = 0; fd <= maxFd; fd++) {
+                FD_SET(fd, &readSet);
+            }
+        }
+    }
+
+    for (StepRequest& request : _requests) {
+        if (!isRunning(request)) {
+            continue;
+        }
+        int fd = request.socket();
+        bool ready = fd < 0 || fd >= FD_SETSIZE || request.hasBufferedData() ||
+                     FD_ISSET(fd, &readSet) || FD_ISSET(fd, &writeSet);
+        if (ready) {
+            request.stepWith(_buffer.get());
+        } else {
+            request.checkTimeout();
+        }
+    }
+#else
+    (void)waitMs;
+    for (StepRequest& request : _requests) {
+        if (isRunning(request)) {
+            request.stepWith(_buffer.get());
+        }
+    }
+#endif
+
+    return getRunningCount();
+}
+
+void StreamMultiplexer::removeFinished() {
+    size_t kept = 0;
+    for (size_t i = 0; i < _requests.size(); i++) {
+        if (!_requests[i].isDone()) {
+            if (kept != i) {
+                _requests[kept] = std::move(_requests[i]);
+            }
+            kept++;
+        }
+    }
+    while (_requests.size() > kept) {
+        _requests.pop_back();
+    }
+}
+
+void StreamMultiplexer::cancelAll() {
+    for (StepRequest& request : _requests) {
+        request.cancel();
+    }
+}
+
+} // namespace ESPAI
@@ -0,0 +1,64 @@
+#ifndef ESPAI_STREAM_MULTIPLEXER_H
+#define ESPAI_STREAM_MULTIPLEXER_H
+
+#include "../core/AIConfig.h"
+#include "StepRequest.h"
+#include <memory>
+#include <vector>
+
+namespace ESPAI {
+
+/**
+ * Runs many StepRequests from one task with a single select().
+ *
+ * poll() waits until any request's socket can make progress, then steps
+ * only those requests. Each request keeps its own connection and
+ * SSEParser; there is no task or stack per request, and all requests
+ * share one ESPAI_STEP_BUFFER_SIZE read buffer, so a stream costs its TLS
+ * context plus parser state:
+ *
+ *   StreamMultiplexer hub;
+ *   hub.add(provider.beginChatStream(kitchen, options, onKitchenChunk));
+ *   hub.add(provider.beginChatStream(office, options, onOfficeChunk));
+ *
+ *   void loop() {
+ *       hub.poll(20);           // Sleeps at most 20 ms when all are idle
+ *       hub.removeFinished();   // After reading their results with at()
+ *   }
+ *
+ * Requests whose exchange has no socket (e.g. test transports) are
+ * stepped on every poll(). Use from one task only.
+ */
+class StreamMultiplexer {
+public:
+    StreamMultiplexer() = default;
+
+    // Takes over a request from beginChat() or beginChatStream(); returns its
+    // index. References from at() stay valid only until the next add().
+    size_t add(StepRequest&& request);
+
+    // Waits up to waitMs for a socket to be ready, then steps each ready
+    // request once. Idle requests are only checked for their timeout.
+    // Returns how many requests are still running.
+    size_t poll(uint32_t waitMs = 0);
+
+    size_t size() const { return _requests.size(); }
+    StepRequest& at(size_t index) { return _requests[index]; }
+    const StepRequest& at(size_t index) const { return _requests[index]; }
+    size_t getRunningCount() const;
+
+    // Drops finished requests; the indices of the others shift down
+    void removeFinished();
+    void cancelAll();
+
+private:
+    std::vector<StepRequest> _requests;
+    std::unique_ptr<uint8_t[]> _buffer;     // Shared: requests step one at a time
+
+    StreamMultiplexer(const StreamMultiplexer&) = delete;
+    StreamMultiplexer& operator=(const StreamMultiplexer&) = delete;
+};
+
+} // namespace ESPAI
+
+#endif // ESPAI_STREAM_MULTIPLEXER_H
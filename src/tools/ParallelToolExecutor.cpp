@@ -0,0 +1,616 @@
+#include "ParallelToolExecutor.h"
+#include <ArduinoJson.h>
+#include <atomic>
+#include <deque>
+#include <memory>
+
+#if ESPAI_ENABLE_TOOLS
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace ESPAI {
+
+namespace {
+    String makeErrorJson(const char* message) {
+        JsonDocument doc;
+        doc["error"] = message;
+        String output;
+        serializeJson(doc, output);
+        return output;
+    }
+
+    uint32_t nowMs() {
+#ifdef ARDUINO
+        return millis();
+#else
+        static auto start = std::chrono::steady_clock::now();
+        auto now = std::chrono::steady_clock::now();
+        return static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count());
+#endif
+    }
+
+    struct Job {
+        size_t callIndex;
+        ToolHandler handler;
+        JsonToolHandler jsonHandler;
+        String arguments;
+        uint32_t timeoutMs;
+        String result;
+        bool success = false;
+        bool done = false;
+        bool abandoned = false;  // Timed out before a worker picked it up: never run
+    };
+
+    // Shared with the workers, which may outlive execute() when a call times out
+    struct Batch {
+        std::vector<Job> jobs;
+        std::atomic<size_t> next{0};
+#ifdef ARDUINO
+        SemaphoreHandle_t mutex = nullptr;
+        SemaphoreHandle_t signal = nullptr;  // Given after each finished job
+
+        Batch() {
+            mutex = xSemaphoreCreateMutex();
+            signal = xSemaphoreCreateBinary();
+        }
+        ~Batch() {
+            if (mutex) vSemaphoreDelete(mutex);
+            if (signal) vSemaphoreDelete(signal);
+        }
+        void lock() { xSemaphoreTake(mutex, portMAX_DELAY); }
+        void unlock() { xSemaphoreGive(mutex); }
+#else
+        std::mutex mutex;
+        std::condition_variable signal;
+
+        void lock() { mutex.lock(); }
+        void unlock() { mutex.unlock(); }
+#endif
+
+        void runJobs() {
+            for (size_t i = next.fetch_add(1); i < jobs.size(); i = next.fetch_add(1)) {
+                lock();
+                bool skip = jobs[i].abandoned;
+                unlock();
+                if (skip) {
+                    continue;
+                }
+
+                String result;
+                bool success = invokeToolHandler(jobs[i].handler, jobs[i].jsonHandler, jobs[i].arguments, result);
+
+                lock();
+                jobs[i].result = result;
+                jobs[i].success = success;
+                jobs[i].done = true;
+                unlock();
+#ifdef ARDUINO
+                xSemaphoreGive(signal);
+#else
+                signal.notify_all();
+#endif
+            }
+        }
+
+        // Copies the job's result once done. Returns false if timeoutMs after startMs passed first.
+        bool waitFor(size_t i, uint32_t startMs, uint32_t timeoutMs, String& result, bool& success) {
+#ifdef ARDUINO
+            while (true) {
+                lock();
+                bool done = jobs[i].done;
+                if (done) {
+                    result = jobs[i].result;
+                    success = jobs[i].success;
+                }
+                unlock();
+                if (done) {
+                    return true;
+                }
+
+                TickType_t wait = portMAX_DELAY;
+                if (timeoutMs > 0) {
+                    uint32_t elapsed = nowMs() - startMs;
+                    if (elapsed >= timeoutMs) {
+                        return false;
+                    }
+                    wait = pdMS_TO_TICKS(timeoutMs - elapsed);
+                    if (wait == 0) {
+                        wait = 1;
+                    }
+                }
+                xSemaphoreTake(signal, wait);
+            }
+#else
+            std::unique_lock<std::mutex> guard(mutex);
+            auto isDone = [this, i]() { return jobs[i].done; };
+            if (timeoutMs > 0) {
+                uint32_t elapsed = nowMs() - startMs;
+                uint32_t remaining = (elapsed < timeoutMs) ? timeoutMs - elapsed : 0;
+                if (!signal.wait_for(guard, std::chrono::milliseconds(remaining), isDone)) {
+                    return false;
+                }
+            } else {
+                signal.wait(guard, isDone);
+            }
+            result = jobs[i].result;
+            success = jobs[i].success;
+            return true;
+#endif
+        }
+    };
+
+    // Returns false if timeoutMs (0 = no limit) after dispatch passed first.
+    // Cancels the call, and sets cancelled, once cancelCheck returns true.
+    bool awaitAsync(
+        ToolCompletion& completion,
+        uint32_t timeoutMs,
+        const std::function<bool()>& cancelCheck,
+        bool& cancelled
+    ) {
+        while (!cancelled) {
+            uint32_t wait = 0;
+            if (timeoutMs > 0) {
+                uint32_t elapsed = completion.getElapsedMs();
+                if (elapsed >= timeoutMs) {
+                    return completion.isDone();
+                }
+                wait = timeoutMs - elapsed;
+            }
+            if (cancelCheck) {
+                if (cancelCheck()) {
+                    cancelled = true;
+                    break;
+                }
+                if (wait == 0 || wait > ESPAI_TOOL_CANCEL_POLL_MS) {
+                    wait = ESPAI_TOOL_CANCEL_POLL_MS;
+                }
+            }
+            if (completion.wait(wait)) {
+                return true;
+            }
+        }
+        completion.cancel();
+        return true;
+    }
+}
+
+#ifdef ARDUINO
+struct ToolWorkerPool::State {
+    SemaphoreHandle_t mutex = nullptr;
+    SemaphoreHandle_t work = nullptr;      // Given when work is queued or on stop
+    SemaphoreHandle_t finished = nullptr;  // Given when a worker exits
+    std::deque<std::function<void()>> queue;
+    uint8_t workers = 0;
+    uint8_t idle = 0;
+    bool stopping = false;
+
+    void lock() { xSemaphoreTake(mutex, portMAX_DELAY); }
+    void unlock() { xSemaphoreGive(mutex); }
+
+    static void workerTask(void* param) {
+        static_cast<State*>(param)->runWorker();
+        vTaskDelete(nullptr);
+    }
+
+    void runWorker() {
+        lock();
+        while (true) {
+            if (!queue.empty()) {
+                std::function<void()> next = std::move(queue.front());
+                queue.pop_front();
+                if (!queue.empty() && idle > 0) {
+                    xSemaphoreGive(work);
+                }
+                unlock();
+                next();
+                next = nullptr;
+                lock();
+                continue;
+            }
+            if (stopping) {
+                break;
+            }
+            idle++;
+            unlock();
+            xSemaphoreTake(work, portMAX_DELAY);
+            lock();
+            idle--;
+        }
+        workers--;
+        xSemaphoreGive(work);      // Pass the stop on to the next idle worker
+        xSemaphoreGive(finished);
+        unlock();
+    }
+};
+
+ToolWorkerPool::ToolWorkerPool()
+    : _state(new State()) {
+    _state->mutex = xSemaphoreCreateMutex();
+    _state->work = xSemaphoreCreateBinary();
+    _state->finished = xSemaphoreCreateBinary();
+}
+
+ToolWorkerPool::~ToolWorkerPool() {
+    _state->lock();
+    _state->stopping = true;
+    _state->unlock();
+    while (getWorkerCount() > 0) {
+        xSemaphoreGive(_state->work);
+        xSemaphoreTake(_state->finished, pdMS_TO_TICKS(10));
+    }
+    if (_state->finished) vSemaphoreDelete(_state->finished);
+    if (_state->work) vSemaphoreDelete(_state->work);
+    if (_state->mutex) vSemaphoreDelete(_state->mutex);
+    delete _state;
+}
+
+uint8_t ToolWorkerPool::run(const std::function<void()>& work, uint8_t count) {
+    _state->lock();
+    while (_state->workers < count) {
+        BaseType_t rc = xTaskCreatePinnedToCore(
+            State::workerTask,
+            "espai_tool",
+            ESPAI_TOOL_WORKER_STACK_SIZE,
+            _state,
+            ESPAI_TOOL_WORKER_PRIORITY,
+            nullptr,
+            static_cast<BaseType_t>(_state->workers % portNUM_PROCESSORS)
+        );
+        if (rc != pdPASS) {
+            break;
+        }
+        _state->workers++;
+    }
+    uint8_t running = (_state->workers < count) ? _state->workers : count;
+    for (uint8_t i = 0; i < running; i++) {
+        _state->queue.push_back(work);
+    }
+    if (running > 0 && _state->idle > 0) {
+        xSemaphoreGive(_state->work);
+    }
+    _state->unlock();
+    return running;
+}
+
+bool ToolWorkerPool::post(const std::function<void()>& work, uint8_t maxWorkers) {
+    _state->lock();
+    if (_state->idle <= _state->queue.size() && _state->workers < maxWorkers) {
+        BaseType_t rc = xTaskCreatePinnedToCore(
+            State::workerTask,
+            "espai_tool",
+            ESPAI_TOOL_WORKER_STACK_SIZE,
+            _state,
+            ESPAI_TOOL_WORKER_PRIORITY,
+            nullptr,
+            static_cast<BaseType_t>(_state->workers % portNUM_PROCESSORS)
+        );
+        if (rc == pdPASS) {
+            _state->workers++;
+        }
+    }
+    bool posted = _state->workers > 0;
+    if (posted) {
+        _state->queue.push_back(work);
+        if (_state->idle > 0) {
+            xSemaphoreGive(_state->work);
+        }
+    }
+    _state->unlock();
+    return posted;
+}
+
+uint8_t ToolWorkerPool::getWorkerCount() const {
+    _state->lock();
+    uint8_t count = _state->workers;
+    _state->unlock();
+    return count;
+}
+#else
+struct ToolWorkerPool::State {
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::function<void()>> queue;
+    std::vector<std::thread> threads;
+    size_t idle = 0;
+    bool stopping = false;
+
+    void runWorker() {
+        std::unique_lock<std::mutex> guard(mutex);
+        while (true) {
+            if (!queue.empty()) {
+                std::function<void()> next = std::move(queue.front());
+                queue.pop_front();
+                guard.unlock();
+                next();
+                next = nullptr;
+                guard.lock();
+                continue;
+            }
+            if (stopping) {
+                break;
+            }
+            idle++;
+            wake.wait(guard);
+            idle--;
+        }
+    }
+};
+
+ToolWorkerPool::ToolWorkerPool()
+    : _state(new State()) {}
+
+ToolWorkerPool::~ToolWorkerPool() {
+    {
+        std::lock_guard<std::mutex> guard(_state->mutex);
+        _state->stopping = true;
+    }
+    _state->wake.notify_all();
+    for (auto& thread : _state->threads) {
+        thread.join();
+    }
+    delete _state;
+}
+
+uint8_t ToolWorkerPool::run(const std::function<void()>& work, uint8_t count) {
+    std::lock_guard<std::mutex> guard(_state->mutex);
+    State* state = _state;
+    while (state->threads.size() < count) {
+        state->threads.push_back(std::thread([state]() { state->runWorker(); }));
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        state->queue.push_back(work);
+    }
+    state->wake.notify_all();
+    return count;
+}
+
+bool ToolWorkerPool::post(const std::function<void()>& work, uint8_t maxWorkers) {
+    std::lock_guard<std::mutex> guard(_state->mutex);
+    State* state = _state;
+    if (state->idle <= state->queue.size() && state->threads.size() < maxWorkers) {
+        state->threads.push_back(std::thread([state]() { state->runWorker(); }));
+    }
+    if (state->threads.empty()) {
+        return false;
+    }
+    state->queue.push_back(work);
+    state->wake.notify_one();
+    return true;
+}
+
+uint8_t ToolWorkerPool::getWorkerCount() const {
+    std::lock_guard<std::mutex> guard(_state->mutex);
+    return static_cast<uint8_t>(_state->threads.size());
+}
+#endif
+
+ParallelToolExecutor::ParallelToolExecutor(uint8_t maxWorkers)
+    : _maxWorkers(maxWorkers) {}
+
+std::vector<ToolResult> ParallelToolExecutor::execute(
+    const ToolRegistry& registry,
+    const std::vector<ToolCall>& calls
+) {
+    std::vector<ToolResult> results(calls.size());
+    std::vector<size_t> serial;
+    std::vector<std::pair<size_t, ToolCompletion>> pending;
+    auto batch = std::make_shared<Batch>();
+    _lastWorkerCount = 0;
+    _lastTimeoutCount = 0;
+
+    for (size_t i = 0; i < calls.size(); i++) {
+        const Tool* tool = registry.findTool(calls[i].name);
+        if (tool != nullptr && tool->asyncHandler) {
+            results[i].toolCallId = calls[i].id;
+            results[i].toolName = calls[i].name;
+            if (tool->cacheTtlMs > 0 && registry.getCachedResult(tool->name, calls[i].arguments, results[i].result)) {
+                results[i].success = true;
+            } else {
+                pending.push_back(std::make_pair(i, startAsyncTool(tool->asyncHandler, calls[i].arguments)));
+            }
+        } else if (_maxWorkers > 0 && tool != nullptr && (tool->handler || tool->jsonHandler) && tool->parallelSafe) {
+            // Cache hits are answered here; workers never touch the cache
+            if (tool->cacheTtlMs > 0 && registry.getCachedResult(tool->name, calls[i].arguments, results[i].result)) {
+                results[i].toolCallId = calls[i].id;
+                results[i].toolName = calls[i].name;
+                results[i].success = true;
+                continue;
+            }
+            Job job;
+            job.callIndex = i;
+            job.handler = tool->handler;
+            job.jsonHandler = tool->jsonHandler;
+            job.arguments = calls[i].arguments;
+            job.timeoutMs = (tool->timeoutMs > 0) ? tool->timeoutMs : _defaultTimeoutMs;
+            batch->jobs.push_back(job);
+        } else {
+            serial.push_back(i);
+        }
+    }
+
+    if (!batch->jobs.empty()) {
+        uint8_t count = _maxWorkers;
+        if (batch->jobs.size() < count) {
+            count = static_cast<uint8_t>(batch->jobs.size());
+        }
+
+        uint32_t startMs = nowMs();
+        _lastWorkerCount = registry.getWorkerPool().run([batch]() { batch->runJobs(); }, count);
+        if (_lastWorkerCount == 0) {
+            // No worker could be created: run on this task, without timeouts
+            batch->runJobs();
+        }
+
+        for (size_t j = 0; j < batch->jobs.size(); j++) {
+            const Job& job = batch->jobs[j];
+            const ToolCall& call = calls[job.callIndex];
+            ToolResult& result = results[job.callIndex];
+            result.toolCallId = call.id;
+            result.toolName = call.name;
+
+            if (batch->waitFor(j, startMs, job.timeoutMs, result.result, result.success)) {
+                const Tool* tool = registry.findTool(call.name);
+                if (result.success && tool != nullptr && tool->cacheTtlMs > 0) {
+                    registry.cacheResult(call.name, call.arguments, result.result, tool->cacheTtlMs);
+                }
+            } else {
+                batch->lock();
+                batch->jobs[j].abandoned = true;
+                batch->unlock();
+                result.result = makeErrorJson("Tool timed out");
+                result.success = false;
+                _lastTimeoutCount++;
+                ESPAI_LOG_W("Tools", "Tool %s timed out after %lums",
+                            call.name.c_str(), (unsigned long)job.timeoutMs);
+            }
+        }
+    }
+
+    bool cancelled = false;
+    for (size_t i : serial) {
+        if (_cancelCheck && _cancelCheck()) {
+            cancelled = true;
+        }
+        if (cancelled) {
+            results[i] = ToolResult(calls[i].id, calls[i].name, makeErrorJson("Tool cancelled"), false);
+            continue;
+        }
+        results[i] = registry.execute(calls[i]);
+    }
+
+    for (auto& entry : pending) {
+        const ToolCall& call = calls[entry.first];
+        const Tool* tool = registry.findTool(call.name);
+        ToolCompletion& completion = entry.second;
+        uint32_t timeoutMs = (tool->timeoutMs > 0) ? tool->timeoutMs : _defaultTimeoutMs;
+
+        if (!awaitAsync(completion, timeoutMs, _cancelCheck, cancelled)) {
+            completion.cancel("Tool timed out");
+            _lastTimeoutCount++;
+            ESPAI_LOG_W("Tools", "Tool %s timed out after %lums",
+                        call.name.c_str(), (unsigned long)timeoutMs);
+        }
+
+        ToolResult& result = results[entry.first];
+        result.result = completion.getResult();
+        result.success = completion.isSuccess();
+        if (result.success && tool->cacheTtlMs > 0) {
+            registry.cacheResult(call.name, call.arguments, result.result, tool->cacheTtlMs);
+        }
+    }
+
+    return results;
+}
+
+void ParallelToolExecutor::submit(const ToolRegistry& registry, const ToolCall& call) {
+    _submitRegistry = &registry;
+    Submitted entry;
+    entry.call = call;
+
+    const Tool* tool = registry.findTool(call.name);
+    if (tool != nullptr && tool->asyncHandler) {
+        entry.kind = SubmitKind::Async;
+    } else if (_maxWorkers > 0 && tool != nullptr && (tool->handler || tool->jsonHandler) && tool->parallelSafe) {
+        entry.kind = SubmitKind::Worker;
+    }
+
+    if (entry.kind != SubmitKind::Serial && tool->cacheTtlMs > 0) {
+        String cached;
+        if (registry.getCachedResult(tool->name, call.arguments, cached)) {
+            entry.cached = true;
+            entry.completion.complete(cached);
+        }
+    }
+
+    if (!entry.cached && entry.kind == SubmitKind::Async) {
+        entry.completion = startAsyncTool(tool->asyncHandler, call.arguments);
+    } else if (!entry.cached && entry.kind == SubmitKind::Worker) {
+        ToolCompletion completion = entry.completion;
+        ToolHandler handler = tool->handler;
+        JsonToolHandler jsonHandler = tool->jsonHandler;
+        String arguments = call.arguments;
+        bool posted = registry.getWorkerPool().post([completion, handler, jsonHandler, arguments]() mutable {
+            if (completion.isCancelled()) {
+                return;  // Timed out before a worker picked it up
+            }
+            String result;
+            bool ok = invokeToolHandler(handler, jsonHandler, arguments, result);
+            completion.complete(result, ok);
+        }, _maxWorkers);
+        if (!posted) {
+            entry.kind = SubmitKind::Serial;
+        }
+    }
+    _submitted.push_back(entry);
+}
+
+std::vector<ToolResult> ParallelToolExecutor::collect() {
+    std::vector<Submitted> submitted;
+    submitted.swap(_submitted);
+    std::vector<ToolResult> results(submitted.size());
+    _lastWorkerCount = 0;
+    _lastTimeoutCount = 0;
+    if (submitted.empty()) {
+        return results;
+    }
+    const ToolRegistry& registry = *_submitRegistry;
+
+    // Same order as execute(): workers, then serial calls, then async calls
+    bool cancelled = false;
+    const SubmitKind order[] = {SubmitKind::Worker, SubmitKind::Serial, SubmitKind::Async};
+    for (SubmitKind kind : order) {
+        for (size_t i = 0; i < submitted.size(); i++) {
+            Submitted& entry = submitted[i];
+            if (entry.kind != kind) {
+                continue;
+            }
+            const ToolCall& call = entry.call;
+
+            if (kind == SubmitKind::Serial) {
+                if (_cancelCheck && _cancelCheck()) {
+                    cancelled = true;
+                }
+                results[i] = cancelled
+                    ? ToolResult(call.id, call.name, makeErrorJson("Tool cancelled"), false)
+                    : registry.execute(call);
+                continue;
+            }
+
+            const Tool* tool = registry.findTool(call.name);
+            if (kind == SubmitKind::Worker && !entry.cached && _lastWorkerCount < _maxWorkers) {
+                _lastWorkerCount++;
+            }
+            uint32_t timeoutMs = (tool != nullptr && tool->timeoutMs > 0) ? tool->timeoutMs : _defaultTimeoutMs;
+            if (!awaitAsync(entry.completion, timeoutMs, _cancelCheck, cancelled)) {
+                entry.completion.cancel("Tool timed out");
+                _lastTimeoutCount++;
+                ESPAI_LOG_W("Tools", "Tool %s timed out after %lums",
+                            call.name.c_str(), (unsigned long)timeoutMs);
+            }
+
+            ToolResult& result = results[i];
+            result.toolCallId = call.id;
+            result.toolName = call.name;
+            result.result = entry.completion.getResult();
+            result.success = entry.completion.isSuccess();
+            if (result.success && !entry.cached && tool != nullptr && tool->cacheTtlMs > 0) {
+                registry.cacheResult(call.name, call.arguments, result.result, tool->cacheTtlMs);
+            }
+        }
+    }
+    return results;
+}
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_TOOLS
@@ -0,0 +1,141 @@
+#ifndef ESPAI_PARALLEL_TOOL_EXECUTOR_H
+#define ESPAI_PARALLEL_TOOL_EXECUTOR_H
+
+#include "../core/AIConfig.h"
+#include "../core/AITypes.h"
+#include "ToolRegistry.h"
+#include "ToolCompletion.h"
+#include <functional>
+#include <vector>
+
+#if ESPAI_ENABLE_TOOLS
+
+#ifndef ESPAI_TOOL_WORKER_STACK_SIZE
+#define ESPAI_TOOL_WORKER_STACK_SIZE    8192
+#endif
+
+#ifndef ESPAI_TOOL_WORKER_PRIORITY
+#define ESPAI_TOOL_WORKER_PRIORITY      2
+#endif
+
+#ifndef ESPAI_TOOL_CANCEL_POLL_MS
+#define ESPAI_TOOL_CANCEL_POLL_MS       20
+#endif
+
+namespace ESPAI {
+
+/**
+ * Persistent tool workers, owned by a ToolRegistry (getWorkerPool()).
+ *
+ * Workers are FreeRTOS tasks pinned round-robin across the cores on ESP32,
+ * std::thread on native builds. They are started on first use, up to the
+ * largest count asked for, and then wait for the next batch instead of
+ * exiting. The destructor waits for handlers still running, including
+ * ones whose calls timed out, then stops the workers.
+ */
+class ToolWorkerPool {
+public:
+    ToolWorkerPool();
+    ~ToolWorkerPool();
+
+    // Runs work once on each of up to count workers, starting missing ones.
+    // Returns how many will run it; 0 if no worker could be started.
+    uint8_t run(const std::function<void()>& work, uint8_t count);
+    // Queues work once, starting a worker if none is idle and fewer than
+    // maxWorkers exist. Returns false if no worker could be started.
+    bool post(const std::function<void()>& work, uint8_t maxWorkers);
+    uint8_t getWorkerCount() const;
+
+private:
+    struct State;
+    State* _state;
+
+    ToolWorkerPool(const ToolWorkerPool&) = delete;
+    ToolWorkerPool& operator=(const ToolWorkerPool&) = delete;
+};
+
+/**
+ * Runs the tool calls of one model turn concurrently.
+ *
+ * Calls to tools marked parallelSafe are spread over up to maxWorkers
+ * workers of the registry's ToolWorkerPool. All other calls run one after
+ * another on the calling task once the parallel ones have finished (or
+ * timed out), so a handler that is not parallel-safe does not overlap with
+ * other tools.
+ *
+ * Results are returned in the order of calls, each carrying its call's
+ * toolCallId. A parallel call not finished timeoutMs (the tool's, else the
+ * executor default) after dispatch gets an error result. If no worker had
+ * picked it up yet it never runs; otherwise it finishes on its worker and
+ * the late result is discarded. The registry's destructor waits for it.
+ *
+ * Tools with an asyncHandler need no worker: their handlers are all
+ * started on the calling task before anything else runs, so their I/O
+ * overlaps with each other and with the other calls, and are awaited last
+ * with the same timeouts. A timed-out async call is cancelled (its
+ * onCancel() callback runs). With a cancel check set, pending async calls
+ * are cancelled and remaining serial calls skipped once it returns true.
+ *
+ * Tools with cacheTtlMs use the registry's ToolResultCache; it is only
+ * accessed from the calling task.
+ *
+ * Calls that arrive one at a time, like those of a stream, use submit()
+ * and collect() instead of execute(). submit() never runs a handler on
+ * the calling task: async calls start, parallelSafe calls go to a worker
+ * and the others are held back. collect() waits for the started calls,
+ * runs the held-back ones and returns every result in submission order.
+ */
+class ParallelToolExecutor {
+public:
+    explicit ParallelToolExecutor(uint8_t maxWorkers = ESPAI_TOOL_WORKERS);
+
+    std::vector<ToolResult> execute(const ToolRegistry& registry, const std::vector<ToolCall>& calls);
+
+    // Starts a call without blocking on its handler. The registry must
+    // outlive the next collect().
+    void submit(const ToolRegistry& registry, const ToolCall& call);
+    // Results of the calls submitted since the last collect(), in order
+    std::vector<ToolResult> collect();
+    size_t getSubmittedCount() const { return _submitted.size(); }
+
+    uint8_t getMaxWorkers() const { return _maxWorkers; }
+    void setMaxWorkers(uint8_t workers) { _maxWorkers = workers; }
+
+    // Used for parallel and async tools with timeoutMs == 0. 0 waits forever.
+    uint32_t getDefaultTimeout() const { return _defaultTimeoutMs; }
+    void setDefaultTimeout(uint32_t ms) { _defaultTimeoutMs = ms; }
+
+    // Polled every ESPAI_TOOL_CANCEL_POLL_MS while awaiting async calls
+    void setCancelCheck(std::function<bool()> check) { _cancelCheck = check; }
+
+    // Statistics of the last execute() or collect() call
+    uint8_t getLastWorkerCount() const { return _lastWorkerCount; }
+    uint8_t getLastTimeoutCount() const { return _lastTimeoutCount; }
+
+private:
+    enum class SubmitKind : uint8_t {
+        Serial,     // Runs in collect()
+        Worker,
+        Async
+    };
+
+    struct Submitted {
+        ToolCall call;
+        SubmitKind kind = SubmitKind::Serial;
+        bool cached = false;
+        ToolCompletion completion;
+    };
+
+    uint8_t _maxWorkers;
+    const ToolRegistry* _submitRegistry = nullptr;
+    std::vector<Submitted> _submitted;
+    uint32_t _defaultTimeoutMs = ESPAI_TOOL_TIMEOUT_MS;
+    std::function<bool()> _cancelCheck;
+    uint8_t _lastWorkerCount = 0;
+    uint8_t _lastTimeoutCount = 0;
+};
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_TOOLS
+#endif // ESPAI_PARALLEL_TOOL_EXECUTOR_H
@@ -0,0 +1,236 @@
+#ifndef ESPAI_STATIC_TOOL_TABLE_H
+#define ESPAI_STATIC_TOOL_TABLE_H
+
+#include "../core/AIConfig.h"
+#include "../core/AITypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if ESPAI_ENABLE_TOOLS
+
+#ifndef ESPAI_PROGMEM
+#ifdef ESP32
+#include <pgmspace.h>
+#define ESPAI_PROGMEM PROGMEM
+#else
+#define ESPAI_PROGMEM
+#endif
+#endif
+
+namespace ESPAI {
+
+// Plain function pointer: a static tool needs no heap for its handler
+using StaticToolHandler = bool (*)(JsonVariantConst args, JsonObject result);
+
+/**
+ * Tool known at build time. All fields are constants, so a constexpr
+ * array of StaticTool stays in flash:
+ *
+ *   constexpr StaticTool kTools[] ESPAI_PROGMEM = {
+ *       {"get_temperature", "Read a room temperature", R"({"type":"object",...})", readTemperature},
+ *   };
+ *   constexpr auto kToolTable = makeStaticToolTable(kTools);
+ *   registry.setStaticTools(kToolTable.view());
+ */
+struct StaticTool {
+    const char* name;
+    const char* description;
+    const char* parametersJson;
+    StaticToolHandler handler;
+
+    // Heap copy for APIs that take a Tool; providers take the StaticTool itself (AIProvider::addStaticTool)
+    Tool toTool() const { return Tool(name, description, parametersJson); }
+};
+
+namespace detail {
+    // FNV-1a with a seed mixed into the offset basis
+    constexpr uint32_t staticToolHash(const char* s, size_t len, uint32_t seed) {
+        uint32_t hash = 2166136261u ^ (seed * 16777619u);
+        for (size_t i = 0; i < len; i++) {
+            hash ^= static_cast<uint8_t>(s[i]);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    constexpr size_t staticToolLength(const char* s) {
+        size_t len = 0;
+        while (s[len] != '\0') {
+            len++;
+        }
+        return len;
+    }
+
+    constexpr bool staticToolNamesEqual(const char* a, const char* b) {
+        size_t i = 0;
+        while (a[i] != '\0' && a[i] == b[i]) {
+            i++;
+        }
+        return a[i] == b[i];
+    }
+
+    constexpr size_t staticToolSlots(size_t count) {
+        size_t slots = 2;
+        while (slots < count * 2) {
+            slots *= 2;
+        }
+        return slots;
+    }
+
+    // Not constexpr: reaching it while building a table makes the build fail
+    inline void staticToolTableError(const char*) {}
+}
+
+/**
+ * Non-template view of a StaticToolTable, as stored by ToolRegistry.
+ *
+ * Lookup is a two-level perfect hash: the name's bucket gives a seed, and
+ * the seeded hash gives the one slot the name can occupy. One hash pass
+ * and at most one string compare, whatever the number of tools.
+ */
+struct StaticToolTableView {
+    const StaticTool* tools = nullptr;
+    size_t count = 0;
+    const uint16_t* seeds = nullptr;  // Per bucket, count buckets
+    const uint16_t* slots = nullptr;  // Tool index + 1, 0 = empty
+    size_t slotMask = 0;
+
+    const StaticTool* find(const char* name, size_t len) const {
+        if (count == 0) {
+            return nullptr;
+        }
+        uint32_t bucket = detail::staticToolHash(name, len, 0) % count;
+        uint32_t slot = detail::staticToolHash(name, len, seeds[bucket]) & slotMask;
+        uint16_t index = slots[slot];
+        if (index == 0) {
+            return nullptr;
+        }
+        const StaticTool& tool = tools[index - 1];
+        if (strncmp(tool.name, name, len) != 0 || tool.name[len] != '\0') {
+            return nullptr;
+        }
+        return &tool;
+    }
+
+    const StaticTool* find(const String& name) const { return find(name.c_str(), name.length()); }
+    size_t size() const { return count; }
+};
+
+template <size_t N>
+struct StaticToolTable {
+    static_assert(N > 0, "StaticToolTable needs at least one tool");
+    static_assert(N < 0xFFFF, "StaticToolTable supports up to 65534 tools");
+    static constexpr size_t kSlots = detail::staticToolSlots(N);
+
+    const StaticTool* tools = nullptr;
+    uint16_t seeds[N] = {};
+    uint16_t slots[kSlots] = {};
+
+    const StaticTool* find(const char* name) const { return view().find(name, strlen(name)); }
+    const StaticTool* find(const String& name) const { return view().find(name); }
+    constexpr size_t size() const { return N; }
+
+    constexpr StaticToolTableView view() const {
+        StaticToolTableView v;
+        v.tools = tools;
+        v.count = N;
+        v.seeds = seeds;
+        v.slots = slots;
+        v.slotMask = kSlots - 1;
+        return v;
+    }
+};
+
+/**
+ * Builds the perfect hash for a constexpr StaticTool array at compile
+ * time (hash-and-displace: largest buckets are placed first, each
+ * searching for a seed that puts all its names into free slots).
+ * Duplicate names fail the build.
+ */
+template <size_t N>
+constexpr StaticToolTable<N> makeStaticToolTable(const StaticTool (&tools)[N]) {
+    StaticToolTable<N> table;
+    table.tools = tools;
+    constexpr size_t kSlots = StaticToolTable<N>::kSlots;
+
+    uint32_t bucketOf[N] = {};
+    size_t bucketSize[N] = {};
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = 0; j < i; j++) {
+            if (detail::staticToolNamesEqual(tools[i].name, tools[j].name)) {
+                detail::staticToolTableError("duplicate static tool name");
+            }
+        }
+        size_t len = detail::staticToolLength(tools[i].name);
+        bucketOf[i] = detail::staticToolHash(tools[i].name, len, 0) % N;
+        bucketSize[bucketOf[i]]++;
+    }
+
+    // Bucket order: largest first
+    size_t order[N] = {};
+    for (size_t b = 0; b < N; b++) {
+        order[b] = b;
+    }
+    for (size_t a = 0; a < N; a++) {
+        for (size_t b = a + 1; b < N; b++) {
+            if (bucketSize[order[b]] > bucketSize[order[a]]) {
+                size_t tmp = order[a];
+                order[a] = order[b];
+                order[b] = tmp;
+            }
+        }
+    }
+
+    for (size_t o = 0; o < N; o++) {
+        size_t bucket = order[o];
+        if (bucketSize[bucket] == 0) {
+            break;
+        }
+
+        bool placed = false;
+        for (uint32_t seed = 1; seed < 0xFFFF && !placed; seed++) {
+            size_t taken[N] = {};  // Slots claimed by this bucket so far
+            size_t takenCount = 0;
+            bool ok = true;
+            for (size_t i = 0; i < N && ok; i++) {
+                if (bucketOf[i] != bucket) {
+                    continue;
+                }
+                size_t len = detail::staticToolLength(tools[i].name);
+                size_t slot = detail::staticToolHash(tools[i].name, len, seed) & (kSlots - 1);
+                if (table.slots[slot] != 0) {
+                    ok = false;
+                }
+                for (size_t t = 0; t < takenCount && ok; t++) {
+                    if (taken[t] == slot) {
+                        ok = false;
+                    }
+                }
+                taken[takenCount++] = slot;
+            }
+            if (!ok) {
+                continue;
+            }
+
+            size_t t = 0;
+            for (size_t i = 0; i < N; i++) {
+                if (bucketOf[i] == bucket) {
+                    table.slots[taken[t++]] = static_cast<uint16_t>(i + 1);
+                }
+            }
+            table.seeds[bucket] = static_cast<uint16_t>(seed);
+            placed = true;
+        }
+        if (!placed) {
+            detail::staticToolTableError("no perfect hash seed found");
+        }
+    }
+
+    return table;
+}
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_TOOLS
+#endif // ESPAI_STATIC_TOOL_TABLE_H
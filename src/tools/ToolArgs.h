@@ -0,0 +1,110 @@
+#ifndef ESPAI_TOOL_ARGS_H
+#define ESPAI_TOOL_ARGS_H
+
+#include "../core/AIConfig.h"
+#include "../core/AITypes.h"
+
+#if ESPAI_ENABLE_TOOLS
+
+#include <ArduinoJson.h>
+
+namespace ESPAI {
+
+/**
+ * Describes one argument field decoded into a member of S:
+ *
+ *   struct LedArgs { uint8_t pin; bool on; };
+ *   toolArg("pin", &LedArgs::pin)
+ *
+ * Required fields must be present; optional ones keep the member's
+ * initial value when missing. A present field must hold a value of the
+ * member's type (ArduinoJson is<T>(), including integer range checks).
+ */
+template <typename S, typename M>
+struct ToolArgField {
+    const char* key;
+    M S::*member;
+    bool required;
+};
+
+template <typename S, typename M>
+constexpr ToolArgField<S, M> toolArg(const char* key, M S::*member, bool required = true) {
+    return ToolArgField<S, M>{key, member, required};
+}
+
+namespace detail {
+    template <typename M>
+    inline bool readToolArg(JsonVariantConst value, M& out) {
+        if (!value.is<M>()) {
+            return false;
+        }
+        out = value.as<M>();
+        return true;
+    }
+
+    inline bool readToolArg(JsonVariantConst value, String& out) {
+        if (!value.is<const char*>()) {
+            return false;
+        }
+        out = value.as<const char*>();
+        return true;
+    }
+
+    template <typename S>
+    inline bool decodeToolArgFields(JsonObjectConst, S&, String&) {
+        return true;
+    }
+
+    template <typename S, typename M, typename... Rest>
+    bool decodeToolArgFields(JsonObjectConst args, S& out, String& error,
+                             const ToolArgField<S, M>& field, const Rest&... rest) {
+        JsonVariantConst value = args[field.key];
+        if (value.isNull()) {
+            if (field.required) {
+                error = String("Missing argument: ") + field.key;
+                return false;
+            }
+        } else if (!readToolArg(value, out.*(field.member))) {
+            error = String("Invalid type for argument: ") + field.key;
+            return false;
+        }
+        return decodeToolArgFields(args, out, error, rest...);
+    }
+}
+
+// Decodes args into out. On failure, error names the offending field.
+template <typename S, typename... Fields>
+bool decodeToolArgs(JsonVariantConst args, S& out, String& error, const Fields&... fields) {
+    if (!args.is<JsonObjectConst>()) {
+        error = "Arguments must be a JSON object";
+        return false;
+    }
+    return detail::decodeToolArgFields(args.as<JsonObjectConst>(), out, error, fields...);
+}
+
+/**
+ * Builds a JsonToolHandler that decodes the arguments into S before
+ * calling handler(const S& args, JsonObject result) -> bool. Invalid
+ * arguments produce {"error": "..."} without calling the handler.
+ *
+ *   tool.jsonHandler = typedToolHandler<LedArgs>(
+ *       [](const LedArgs& a, JsonObject out) { ...; out["ok"] = true; return true; },
+ *       toolArg("pin", &LedArgs::pin), toolArg("on", &LedArgs::on));
+ */
+template <typename S, typename F, typename... Fields>
+JsonToolHandler typedToolHandler(F handler, Fields... fields) {
+    return [handler, fields...](JsonVariantConst args, JsonObject result) -> bool {
+        S decoded{};
+        String error;
+        if (!decodeToolArgs(args, decoded, error, fields...)) {
+            result["error"] = error.c_str();
+            return false;
+        }
+        return handler(static_cast<const S&>(decoded), result);
+    };
+}
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_TOOLS
+#endif // ESPAI_TOOL_ARGS_H
@@ -0,0 +1,212 @@
+#include "ToolCompletion.h"
+#include <ArduinoJson.h>
+
+#if ESPAI_ENABLE_TOOLS
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace ESPAI {
+
+namespace {
+    String makeErrorJson(const char* message) {
+        JsonDocument doc;
+        doc["error"] = message;
+        String output;
+        serializeJson(doc, output);
+        return output;
+    }
+
+    uint32_t nowMs() {
+#ifdef ARDUINO
+        return millis();
+#else
+        static auto start = std::chrono::steady_clock::now();
+        auto now = std::chrono::steady_clock::now();
+        return static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count());
+#endif
+    }
+}
+
+struct ToolCompletion::State {
+    String result;
+    bool success = false;
+    bool done = false;
+    bool cancelled = false;
+    std::function<void()> cancelCallback;
+    uint32_t startMs = nowMs();
+#ifdef ARDUINO
+    SemaphoreHandle_t mutex = nullptr;
+    SemaphoreHandle_t signal = nullptr;  // Given when done
+
+    State() {
+        mutex = xSemaphoreCreateMutex();
+        signal = xSemaphoreCreateBinary();
+    }
+    ~State() {
+        if (mutex) vSemaphoreDelete(mutex);
+        if (signal) vSemaphoreDelete(signal);
+    }
+    void lock() { xSemaphoreTake(mutex, portMAX_DELAY); }
+    void unlock() { xSemaphoreGive(mutex); }
+    void notify() { xSemaphoreGive(signal); }
+#else
+    std::mutex mutex;
+    std::condition_variable signal;
+
+    void lock() { mutex.lock(); }
+    void unlock() { mutex.unlock(); }
+    void notify() { signal.notify_all(); }
+#endif
+};
+
+ToolCompletion::ToolCompletion()
+    : _state(std::make_shared<State>()) {}
+
+void ToolCompletion::complete(const String& result, bool success) {
+    _state->lock();
+    if (_state->done) {
+        _state->unlock();
+        return;
+    }
+    _state->result = result;
+    _state->success = success;
+    _state->done = true;
+    _state->cancelCallback = nullptr;
+    _state->unlock();
+    _state->notify();
+}
+
+void ToolCompletion::fail(const String& message) {
+    complete(makeErrorJson(message.c_str()), false);
+}
+
+bool ToolCompletion::isCancelled() const {
+    _state->lock();
+    bool cancelled = _state->cancelled;
+    _state->unlock();
+    return cancelled;
+}
+
+void ToolCompletion::onCancel(std::function<void()> callback) {
+    _state->lock();
+    bool cancelled = _state->cancelled;
+    if (!cancelled && !_state->done) {
+        _state->cancelCallback = callback;
+    }
+    _state->unlock();
+    if (cancelled && callback) {
+        callback();
+    }
+}
+
+bool ToolCompletion::isDone() const {
+    _state->lock();
+    bool done = _state->done;
+    _state->unlock();
+    return done;
+}
+
+bool ToolCompletion::wait(uint32_t timeoutMs) const {
+#ifdef ARDUINO
+    uint32_t startMs = nowMs();
+    while (true) {
+        if (isDone()) {
+            // Pass the signal on to any other waiter
+            _state->notify();
+            return true;
+        }
+
+        TickType_t wait = portMAX_DELAY;
+        if (timeoutMs > 0) {
+            uint32_t elapsed = nowMs() - startMs;
+            if (elapsed >= timeoutMs) {
+                return false;
+            }
+            wait = pdMS_TO_TICKS(timeoutMs - elapsed);
+            if (wait == 0) {
+                wait = 1;
+            }
+        }
+        xSemaphoreTake(_state->signal, wait);
+    }
+#else
+    std::unique_lock<std::mutex> guard(_state->mutex);
+    State* state = _state.get();
+    auto isDone = [state]() { return state->done; };
+    if (timeoutMs == 0) {
+        state->signal.wait(guard, isDone);
+        return true;
+    }
+    return state->signal.wait_for(guard, std::chrono::milliseconds(timeoutMs), isDone);
+#endif
+}
+
+uint32_t ToolCompletion::getElapsedMs() const {
+    return nowMs() - _state->startMs;
+}
+
+void ToolCompletion::cancel(const char* message) {
+    _state->lock();
+    if (_state->done) {
+        _state->unlock();
+        return;
+    }
+    _state->result = makeErrorJson(message);
+    _state->success = false;
+    _state->done = true;
+    _state->cancelled = true;
+    std::function<void()> callback = _state->cancelCallback;
+    _state->cancelCallback = nullptr;
+    _state->unlock();
+    _state->notify();
+
+    if (callback) {
+        callback();
+    }
+}
+
+String ToolCompletion::getResult() const {
+    _state->lock();
+    String result = _state->result;
+    _state->unlock();
+    return result;
+}
+
+bool ToolCompletion::isSuccess() const {
+    _state->lock();
+    bool success = _state->success;
+    _state->unlock();
+    return success;
+}
+
+ToolCompletion startAsyncTool(const AsyncToolHandler& handler, const String& arguments) {
+    ToolCompletion completion;
+    handler(arguments, completion);
+    return completion;
+}
+
+bool finishAsyncTool(ToolCompletion& completion, uint32_t timeoutMs, String& result) {
+    if (timeoutMs == 0) {
+        // A handler that never completes must not block its caller forever
+        timeoutMs = ESPAI_TOOL_TIMEOUT_MS;
+    }
+    uint32_t elapsed = completion.getElapsedMs();
+    uint32_t remaining = (elapsed < timeoutMs) ? timeoutMs - elapsed : 1;
+    if (!completion.wait(remaining)) {
+        completion.cancel("Tool timed out");
+    }
+    result = completion.getResult();
+    return completion.isSuccess();
+}
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_TOOLS
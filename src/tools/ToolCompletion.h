@@ -0,0 +1,74 @@
+#ifndef ESPAI_TOOL_COMPLETION_H
+#define ESPAI_TOOL_COMPLETION_H
+
+#include "../core/AIConfig.h"
+#include "../core/AITypes.h"
+#include <functional>
+#include <memory>
+
+#if ESPAI_ENABLE_TOOLS
+
+// Wait for async and parallel tool calls whose Tool::timeoutMs is 0
+#ifndef ESPAI_TOOL_TIMEOUT_MS
+#define ESPAI_TOOL_TIMEOUT_MS       30000
+#endif
+
+namespace ESPAI {
+
+/**
+ * Completion handle of one asynchronous tool call.
+ *
+ * An AsyncToolHandler receives a copy, starts its I/O (a sensor read, a
+ * Modbus transaction, a local HTTP request...) and returns at once. Whoever
+ * finishes the operation later, on any task, calls complete() or fail()
+ * on its copy; all copies share one state.
+ *
+ *   tool.asyncHandler = [](const String& args, ToolCompletion done) {
+ *       modbus.readAsync(args, [done](bool ok, const String& value) mutable {
+ *           ok ? done.complete(value) : done.fail("Modbus read failed");
+ *       });
+ *   };
+ *
+ * The first complete()/fail() wins; later ones and ones after cancel()
+ * are ignored. A timed-out or cancelled call runs its onCancel() callback
+ * so the handler can abort the operation. Not for use from ISRs.
+ */
+class ToolCompletion {
+public:
+    ToolCompletion();
+
+    // Handler side
+    void complete(const String& result, bool success = true);
+    void fail(const String& message);  // Result {"error":"message"}, success false
+    bool isCancelled() const;
+    // Runs on the cancelling task; at once if already cancelled
+    void onCancel(std::function<void()> callback);
+
+    // Waiting side
+    bool isDone() const;
+    // Blocks until done or for timeoutMs (0 = no limit). Returns isDone().
+    bool wait(uint32_t timeoutMs) const;
+    uint32_t getElapsedMs() const;  // Since the handle was created
+    // Marks the call cancelled with result {"error":"message"} unless it already completed
+    void cancel(const char* message = "Tool cancelled");
+    String getResult() const;
+    bool isSuccess() const;
+
+private:
+    struct State;
+    std::shared_ptr<State> _state;
+};
+
+// Creates a completion, runs handler with it and returns it. A call that
+// never completes only ends through a timeout or cancel().
+ToolCompletion startAsyncTool(const AsyncToolHandler& handler, const String& arguments);
+
+// Waits up to timeoutMs after the call started (0 = ESPAI_TOOL_TIMEOUT_MS),
+// cancelling it with {"error":"Tool timed out"} past that. Copies the result
+// and returns the call's success.
+bool finishAsyncTool(ToolCompletion& completion, uint32_t timeoutMs, String& result);
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_TOOLS
+#endif // ESPAI_TOOL_COMPLETION_H
@@ -0,0 +1,249 @@
+#include "ToolLoop.h"
+
+#if ESPAI_ENABLE_TOOLS
+
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+namespace ESPAI {
+
+namespace {
+#if ESPAI_ENABLE_STREAMING
+    using LoopStreamCallback = StreamCallback;
+#else
+    using LoopStreamCallback = std::function<void(const String& chunk, bool done)>;
+#endif
+
+    uint32_t nowMs() {
+#ifdef ARDUINO
+        return millis();
+#else
+        static auto start = std::chrono::steady_clock::now();
+        auto now = std::chrono::steady_clock::now();
+        return static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count());
+#endif
+    }
+
+    String lastUserMessage(const Conversation& conversation) {
+        MessageView messages = conversation.getMessages();
+        for (size_t i = messages.size(); i > 0; i--) {
+            if (messages[i - 1].role == Role::User) {
+                return messages[i - 1].content;
+            }
+        }
+        return String();
+    }
+
+    ToolLoopResult runLoop(
+        AIProvider& provider,
+        Conversation& conversation,
+        const ToolRegistry& registry,
+        const ChatOptions& options,
+        const LoopStreamCallback* callback,
+        const std::function<bool()>& isCancelled
+    ) {
+        ToolLoopResult result;
+        uint8_t maxIterations = registry.getMaxIterations();
+        result.iterations.reserve(maxIterations);
+
+        ChatOptions opts = options;
+        if (opts.systemPrompt.isEmpty()) {
+            opts.systemPrompt = conversation.getSystemPrompt();
+        }
+
+        ToolSelector* selector = registry.getSelector();
+        if (selector != nullptr) {
+            selector->apply(provider, registry, lastUserMessage(conversation), conversation.getId());
+        } else {
+            // Schemas come normalized from the registry's cache
+            SchemaDialect dialect = provider.getSchemaDialect();
+            provider.clearTools();
+            for (const auto& tool : registry.getTools()) {
+                provider.addTool(tool, registry.getToolSchema(tool.name, dialect));
+            }
+            const StaticToolTableView& staticTools = registry.getStaticTools();
+            for (size_t t = 0; t < staticTools.size(); t++) {
+                const StaticTool& tool = staticTools.tools[t];
+                provider.addStaticTool(tool, registry.getToolSchema(tool.name, dialect));
+            }
+        }
+
+        ParallelToolExecutor executor(registry.getParallelWorkers());
+        executor.setDefaultTimeout(registry.getDefaultTimeout());
+        if (isCancelled) {
+            executor.setCancelCheck(isCancelled);
+        }
+        uint32_t totalPrompt = 0;
+        uint32_t totalCompletion = 0;
+        String text;  // Streamed text of the current iteration, reused across iterations
+
+#if ESPAI_ENABLE_STREAMING
+        LoopStreamCallback forward;
+        if (callback != nullptr) {
+            // Intermediate streams end with tool calls; done is only reported after the final answer
+            forward = [&text, callback](const String& chunk, bool done) {
+                if (!done) {
+                    text += chunk;
+                    (*callback)(chunk, false);
+                }
+            };
+        }
+#else
+        (void)callback;
+        (void)text;
+#endif
+
+        for (uint8_t i = 0; i < maxIterations; i++) {
+            if (isCancelled && isCancelled()) {
+                result.response = Response::fail(ErrorCode::NetworkError, "Request cancelled");
+                return result;
+            }
+
+            ToolLoopIteration iteration;
+            uint32_t start = nowMs();
+
+            Response response;
+#if ESPAI_ENABLE_STREAMING
+            if (callback != nullptr) {
+                text = "";
+                provider.chatStream(conversation.getMessages(), opts, forward);
+                response = provider.getLastStreamResponse();
+                response.content = text;
+            } else
+#endif
+            {
+                response = provider.chat(conversation.getMessages(), opts);
+            }
+
+            iteration.requestMs = nowMs() - start;
+            iteration.promptTokens = response.promptTokens;
+            iteration.completionTokens = response.completionTokens;
+            totalPrompt += response.promptTokens;
+            totalCompletion += response.completionTokens;
+
+            if (!response.success) {
+                result.iterations.push_back(iteration);
+                result.response = response;
+                return result;
+            }
+
+            const std::vector<ToolCall>& calls = provider.getLastToolCalls();
+            if (calls.empty()) {
+                result.iterations.push_back(iteration);
+                conversation.addAssistantMessage(response.content);
+                response.promptTokens = totalPrompt;
+                response.completionTokens = totalCompletion;
+                result.response = response;
+#if ESPAI_ENABLE_STREAMING
+                if (callback != nullptr) {
+                    (*callback)("", true);
+                }
+#endif
+                return result;
+            }
+
+            iteration.toolCalls = static_cast<uint8_t>(calls.size());
+            if (selector != nullptr) {
+                // Keeps the tool in this conversation's selection for later turns
+                for (const auto& call : calls) {
+                    selector->pin(conversation.getId(), call.name);
+                    selector->recordUse(call.name);
+                }
+            }
+            conversation.addMessage(provider.getAssistantMessageWithToolCalls(response.content));
+
+            start = nowMs();
+#if ESPAI_ENABLE_STREAMING
+            // Calls already run by early dispatch during the stream are not run again
+            const std::vector<ToolResult>& early = provider.getLastToolResults();
+            if (callback != nullptr && early.size() == calls.size()) {
+                for (const auto& toolResult : early) {
+                    conversation.addMessage(Message(Role::Tool, toolResult.result, toolResult.toolCallId));
+                }
+            } else
+#endif
+            {
+                for (const auto& toolResult : executor.execute(registry, calls)) {
+                    conversation.addMessage(Message(Role::Tool, toolResult.result, toolResult.toolCallId));
+                }
+            }
+            iteration.toolMs = nowMs() - start;
+
+            result.iterations.push_back(iteration);
+        }
+
+        result.response = Response::fail(ErrorCode::ToolLimitReached, "Tool iteration limit reached");
+        result.response.promptTokens = totalPrompt;
+        result.response.completionTokens = totalCompletion;
+#if ESPAI_ENABLE_STREAMING
+        if (callback != nullptr) {
+            (*callback)("", true);
+        }
+#endif
+        return result;
+    }
+}
+
+ToolLoopResult runWithTools(
+    AIProvider& provider,
+    Conversation& conversation,
+    const ToolRegistry& registry,
+    const ChatOptions& options
+) {
+#if ESPAI_ENABLE_ASYNC
+    // The provider's queued requests (e.g. a conversation summary) wait until the loop is done
+    AsyncRequestQueue::OwnerLock hold(provider.getAsyncQueue(), &provider);
+#endif
+    return runLoop(provider, conversation, registry, options, nullptr, nullptr);
+}
+
+#if ESPAI_ENABLE_STREAMING
+ToolLoopResult runWithTools(
+    AIProvider& provider,
+    Conversation& conversation,
+    const ToolRegistry& registry,
+    const ChatOptions& options,
+    StreamCallback callback
+) {
+#if ESPAI_ENABLE_ASYNC
+    // As above
+    AsyncRequestQueue::OwnerLock hold(provider.getAsyncQueue(), &provider);
+#endif
+    return runLoop(provider, conversation, registry, options, &callback, nullptr);
+}
+#endif
+
+#if ESPAI_ENABLE_ASYNC
+ChatRequest* runWithToolsAsync(
+    AIProvider& provider,
+    Conversation& conversation,
+    const ToolRegistry& registry,
+    const ChatOptions& options,
+    AsyncChatCallback onComplete,
+    ToolLoopResult* result
+) {
+    AIProvider* providerPtr = &provider;
+    Conversation* conversationPtr = &conversation;
+    const ToolRegistry* registryPtr = &registry;
+
+    return provider.launchAsync(
+        [providerPtr, conversationPtr, registryPtr, options, result](const ChatRequest& request) -> Response {
+            ToolLoopResult loop = runLoop(*providerPtr, *conversationPtr, *registryPtr, options, nullptr,
+                                          [&request]() { return request.isCancelled(); });
+            if (result != nullptr) {
+                *result = loop;
+            }
+            return loop.response;
+        },
+        onComplete,
+        // Turns of one conversation run in order
+        AsyncRequestOptions(0, conversation.getId())
+    );
+}
+#endif
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_TOOLS
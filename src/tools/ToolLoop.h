@@ -0,0 +1,90 @@
+#ifndef ESPAI_TOOL_LOOP_H
+#define ESPAI_TOOL_LOOP_H
+
+#include "../core/AIConfig.h"
+#include "../core/AITypes.h"
+#include "../conversation/Conversation.h"
+#include "../providers/AIProvider.h"
+#include "ToolRegistry.h"
+#include "ParallelToolExecutor.h"
+#include "ToolSelector.h"
+#include <vector>
+
+#if ESPAI_ENABLE_TOOLS
+
+namespace ESPAI {
+
+struct ToolLoopIteration {
+    uint32_t requestMs;        // Time spent waiting for the model
+    uint32_t toolMs;           // Time spent executing tool handlers
+    uint32_t promptTokens;
+    uint32_t completionTokens;
+    uint8_t toolCalls;
+
+    ToolLoopIteration()
+        : requestMs(0)
+        , toolMs(0)
+        , promptTokens(0)
+        , completionTokens(0)
+        , toolCalls(0) {}
+};
+
+struct ToolLoopResult {
+    Response response;  // Final answer; token counts are totals over all iterations
+    std::vector<ToolLoopIteration> iterations;
+
+    uint8_t iterationCount() const { return static_cast<uint8_t>(iterations.size()); }
+};
+
+/**
+ * Runs chat -> execute tool calls -> chat until the model answers without
+ * calling a tool, or until registry.getMaxIterations() requests were made
+ * (ErrorCode::ToolLimitReached).
+ *
+ * The registry's tools replace the provider's tool list, or only the ones
+ * picked for the latest user message if a ToolSelector is attached. The assistant
+ * tool-call messages, tool results and final answer are appended to the
+ * conversation, whose message vector is passed to the provider by reference.
+ * If options.systemPrompt is empty, the conversation's system prompt is used.
+ * Tool calls of one turn run through a ParallelToolExecutor with
+ * registry.getParallelWorkers() workers; async tool calls are awaited
+ * concurrently. With async enabled, the provider's queued requests (such as
+ * the conversation's compaction summary) do not run during the loop.
+ */
+ToolLoopResult runWithTools(
+    AIProvider& provider,
+    Conversation& conversation,
+    const ToolRegistry& registry,
+    const ChatOptions& options = ChatOptions()
+);
+
+#if ESPAI_ENABLE_STREAMING
+// Streams the text of every iteration to callback. done is reported once, after the final answer.
+ToolLoopResult runWithTools(
+    AIProvider& provider,
+    Conversation& conversation,
+    const ToolRegistry& registry,
+    const ChatOptions& options,
+    StreamCallback callback
+);
+#endif
+
+#if ESPAI_ENABLE_ASYNC
+// Queues the loop on the provider's async queue, after earlier loops on the
+// same conversation. conversation, registry and result (optional, receives
+// per-iteration stats) must outlive the request.
+// Cancelling the request also cancels pending async tool calls.
+ChatRequest* runWithToolsAsync(
+    AIProvider& provider,
+    Conversation& conversation,
+    const ToolRegistry& registry,
+    const ChatOptions& options,
+    AsyncChatCallback onComplete = nullptr,
+    ToolLoopResult* result = nullptr
+);
+#endif
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_TOOLS
+#endif // ESPAI_TOOL_LOOP_H
@@ -1,8 +1,17 @@
 #include "ToolRegistry.h"
+#include "ToolCompletion.h"
+#include "ParallelToolExecutor.h"
 #include <ArduinoJson.h>
 
 #if ESPAI_ENABLE_TOOLS
 
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#else
+#include <mutex>
+#endif
+
 namespace ESPAI {
 
 namespace {
@@ -13,19 +22,95 @@ namespace {
         serializeJson(doc, output);
         return output;
     }
+
+    bool hasHandler(const Tool& tool) {
+        return tool.handler || tool.jsonHandler || tool.asyncHandler;
+    }
+}
+
+bool invokeToolHandler(
+    const ToolHandler& handler,
+    const JsonToolHandler& jsonHandler,
+    const String& arguments,
+    String& result
+) {
+    if (!jsonHandler) {
+        result = handler(arguments);
+        return true;
+    }
+
+    JsonDocument argsDoc;
+    if (arguments.isEmpty()) {
+        argsDoc.to<JsonObject>();
+    } else if (deserializeJson(argsDoc, arguments)) {
+        result = makeErrorJson("Invalid arguments JSON");
+        return false;
+    }
+
+    JsonDocument resultDoc;
+    bool ok = jsonHandler(argsDoc.as<JsonVariantConst>(), resultDoc.to<JsonObject>());
+    result = "";
+    serializeJson(resultDoc, result);
+    return ok;
+}
+
+struct ToolRegistry::CacheMutex {
+#ifdef ARDUINO
+    SemaphoreHandle_t handle = xSemaphoreCreateMutex();
+
+    ~CacheMutex() {
+        if (handle) vSemaphoreDelete(handle);
+    }
+    void lock() { xSemaphoreTake(handle, portMAX_DELAY); }
+    void unlock() { xSemaphoreGive(handle); }
+#else
+    std::mutex mutex;
+
+    void lock() { mutex.lock(); }
+    void unlock() { mutex.unlock(); }
+#endif
+
+    struct Guard {
+        CacheMutex& owner;
+        explicit Guard(CacheMutex& m) : owner(m) { owner.lock(); }
+        ~Guard() { owner.unlock(); }
+    };
+};
+
+ToolRegistry::ToolRegistry()
+    : _workerPool(new ToolWorkerPool())
+    , _cacheMutex(new CacheMutex()) {
+}
+
+ToolRegistry::~ToolRegistry() {
 }
 
 bool ToolRegistry::registerTool(const Tool& tool) {
     if (tool.name.isEmpty()) {
         return false;
     }
-    if (_tools.size() >= ESPAI_MAX_TOOLS) {
+    if (_tools.size() >= ESPAI_MAX_REGISTRY_TOOLS) {
+        ESPAI_LOG_W("Tools", "Tool %s rejected: ESPAI_MAX_REGISTRY_TOOLS reached", tool.name.c_str());
         return false;
     }
     if (hasTool(tool.name)) {
         return false;
     }
+
+    // Validated once here; the OpenAI form is kept for later requests
+    String schema;
+    String error;
+    if (!normalizeToolSchema(tool.parametersJson, SchemaDialect::OpenAI, schema, &error)) {
+        ESPAI_LOG_W("Tools", "Tool %s rejected: %s", tool.name.c_str(), error.c_str());
+        return false;
+    }
+
     _tools.push_back(tool);
+    CacheMutex::Guard guard(*_cacheMutex);
+    _revision++;
+    SchemaCacheEntry& entry = schemaEntry(tool.name);
+    entry.schemas[static_cast<uint8_t>(SchemaDialect::OpenAI)] = schema;
+    entry.readyMask |= 1 << static_cast<uint8_t>(SchemaDialect::OpenAI);
     return true;
 }
 
@@ -33,6 +118,15 @@ bool ToolRegistry::unregisterTool(const String& name) {
     for (auto it = _tools.begin(); it != _tools.end(); ++it) {
         if (it->name == name) {
             _tools.erase(it);
+            CacheMutex::Guard guard(*_cacheMutex);
+            _cache.invalidate(name);
+            for (auto entry = _schemaCache.begin(); entry != _schemaCache.end(); ++entry) {
+                if (entry->name == name) {
+                    _schemaCache.erase(entry);
+                    break;
+                }
+            }
+            _revision++;
             return true;
         }
     }
@@ -41,6 +135,22 @@ bool ToolRegistry::unregisterTool(const String& name) {
 
 void ToolRegistry::clearTools() {
     _tools.clear();
+    CacheMutex::Guard guard(*_cacheMutex);
+    _cache.clear();
+    _schemaCache.clear();
+    _revision++;
+}
+
+void ToolRegistry::setStaticTools(const StaticToolTableView& table) {
+    _staticTools = table;
+    CacheMutex::Guard guard(*_cacheMutex);
+    // Runtime tool schemas stay valid; the others belonged to the old table
+    for (size_t i = _schemaCache.size(); i > 0; i--) {
+        if (findTool(_schemaCache[i - 1].name) == nullptr) {
+            _schemaCache.erase(_schemaCache.begin() + (i - 1));
+        }
+    }
+    _revision++;
 }
 
 Tool* ToolRegistry::findTool(const String& name) {
@@ -64,101 +174,203 @@ const Tool* ToolRegistry::findTool(const String& name) const {
 String ToolRegistry::executeToolCall(const String& name, const String& args) const {
     const Tool* tool = findTool(name);
     if (!tool) {
-        return makeErrorJson("Tool not found");
+        const StaticTool* staticTool = findStaticTool(name);
+        if (staticTool != nullptr && staticTool->handler != nullptr) {
+            String result;
+            invokeToolHandler(nullptr, staticTool->handler, args, result);
+            return result;
+        }
+        return makeErrorJson(staticTool != nullptr ? "Tool has no handler" : "Tool not found");
     }
-    if (!tool->handler) {
+    if (!hasHandler(*tool)) {
         return makeErrorJson("Tool has no handler");
     }
-    return tool->handler(args);
+    String result;
+    runHandler(*tool, args, result);
+    return result;
 }
 
 String ToolRegistry::executeToolCall(const ToolCall& call) const {
     return executeToolCall(call.name, call.arguments);
 }
 
-std::vector<ToolResult> ToolRegistry::executeToolCalls(const std::vector<ToolCall>& calls) const {
-    std::vector<ToolResult> results;
-    results.reserve(calls.size());
-
-    for (const auto& call : calls) {
-        ToolResult result;
-        result.toolCallId = call.id;
-        result.toolName = call.name;
+ToolResult ToolRegistry::execute(const ToolCall& call) const {
+    ToolResult result;
+    result.toolCallId = call.id;
+    result.toolName = call.name;
 
-        const Tool* tool = findTool(call.name);
-        if (!tool) {
-            result.result = makeErrorJson("Tool not found");
-            result.success = false;
-        } else if (!tool->handler) {
+    const Tool* tool = findTool(call.name);
+    const StaticTool* staticTool = (tool == nullptr) ? findStaticTool(call.name) : nullptr;
+    if (staticTool != nullptr) {
+        if (staticTool->handler != nullptr) {
+            result.success = invokeToolHandler(nullptr, staticTool->handler, call.arguments, result.result);
+        } else {
             result.result = makeErrorJson("Tool has no handler");
             result.success = false;
-        } else {
-            result.result = tool->handler(call.arguments);
-            result.success = true;
         }
-
-        results.push_back(result);
+    } else if (!tool) {
+        result.result = makeErrorJson("Tool not found");
+        result.success = false;
+    } else if (!hasHandler(*tool)) {
+        result.result = makeErrorJson("Tool has no handler");
+        result.success = false;
+    } else {
+        result.success = runHandler(*tool, call.arguments, result.result);
     }
 
-    return results;
+    return result;
 }
 
-String ToolRegistry::toOpenAISchema() const {
-    if (_tools.empty()) {
-        return "[]";
+bool ToolRegistry::getCachedResult(const String& name, const String& args, String& result) const {
+    CacheMutex::Guard guard(*_cacheMutex);
+    return _cache.get(name, args, result);
+}
+
+void ToolRegistry::cacheResult(const String& name, const String& args, const String& result, uint32_t ttlMs) const {
+    CacheMutex::Guard guard(*_cacheMutex);
+    _cache.put(name, args, result, ttlMs);
+}
+
+bool ToolRegistry::runHandler(const Tool& tool, const String& args, String& result) const {
+    if (tool.cacheTtlMs > 0 && getCachedResult(tool.name, args, result)) {
+        return true;
+    }
+    bool ok;
+    if (tool.asyncHandler) {
+        ToolCompletion completion = startAsyncTool(tool.asyncHandler, args);
+        ok = finishAsyncTool(completion, tool.timeoutMs > 0 ? tool.timeoutMs : getDefaultTimeout(), result);
+    } else {
+        ok = invokeToolHandler(tool.handler, tool.jsonHandler, args, result);
+    }
+    if (ok && tool.cacheTtlMs > 0) {
+        cacheResult(tool.name, args, result, tool.cacheTtlMs);
+    }
+    return ok;
+}
+
+std::vector<ToolResult> ToolRegistry::executeToolCalls(const std::vector<ToolCall>& calls) const {
+    std::vector<ToolResult> results(calls.size());
+    std::vector<std::pair<size_t, ToolCompletion>> pending;
+
+    // Async calls are all started first so their I/O overlaps
+    for (size_t i = 0; i < calls.size(); i++) {
+        const Tool* tool = findTool(calls[i].name);
+        if (tool == nullptr || !tool->asyncHandler) {
+            continue;
+        }
+        results[i].toolCallId = calls[i].id;
+        results[i].toolName = calls[i].name;
+        if (tool->cacheTtlMs > 0 && getCachedResult(tool->name, calls[i].arguments, results[i].result)) {
+            results[i].success = true;
+            continue;
+        }
+        pending.push_back(std::make_pair(i, startAsyncTool(tool->asyncHandler, calls[i].arguments)));
     }
 
-    JsonDocument doc;
-    JsonArray arr = doc.to<JsonArray>();
+    for (size_t i = 0; i < calls.size(); i++) {
+        const Tool* tool = findTool(calls[i].name);
+        if (tool == nullptr || !tool->asyncHandler) {
+            results[i] = execute(calls[i]);
+        }
+    }
 
-    for (const auto& tool : _tools) {
-        JsonObject t = arr.add<JsonObject>();
-        t["type"] = "function";
+    for (auto& entry : pending) {
+        const ToolCall& call = calls[entry.first];
+        const Tool* tool = findTool(call.name);
+        ToolResult& result = results[entry.first];
+        uint32_t timeoutMs = (tool->timeoutMs > 0) ? tool->timeoutMs : getDefaultTimeout();
+        result.success = finishAsyncTool(entry.second, timeoutMs, result.result);
+        if (result.success && tool->cacheTtlMs > 0) {
+            cacheResult(call.name, call.arguments, result.result, tool->cacheTtlMs);
+        }
+    }
 
-        JsonObject func = t["function"].to<JsonObject>();
-        func["name"] = tool.name.c_str();
+    return results;
+}
 
-        if (!tool.description.isEmpty()) {
-            func["description"] = tool.description.c_str();
+ToolRegistry::SchemaCacheEntry& ToolRegistry::schemaEntry(const String& name) const {
+    for (auto& entry : _schemaCache) {
+        if (entry.name == name) {
+            return entry;
         }
+    }
+    SchemaCacheEntry entry;
+    entry.name = name;
+    _schemaCache.push_back(entry);
+    return _schemaCache.back();
+}
 
-        if (!tool.parametersJson.isEmpty()) {
-            JsonDocument paramsDoc;
-            DeserializationError err = deserializeJson(paramsDoc, tool.parametersJson);
-            if (!err) {
-                func["parameters"] = paramsDoc.as<JsonObject>();
-            }
+String ToolRegistry::getToolSchema(const String& name, SchemaDialect dialect) const {
+    CacheMutex::Guard guard(*_cacheMutex);
+    return toolSchema(name, dialect);
+}
+
+String ToolRegistry::toolSchema(const String& name, SchemaDialect dialect) const {
+    const char* parametersJson = nullptr;
+    const Tool* tool = findTool(name);
+    if (tool != nullptr) {
+        parametersJson = tool->parametersJson.c_str();
+    } else {
+        const StaticTool* staticTool = findStaticTool(name);
+        if (staticTool == nullptr) {
+            return String();
         }
+        parametersJson = staticTool->parametersJson;
     }
 
-    String output;
-    serializeJson(doc, output);
-    return output;
+    SchemaCacheEntry& entry = schemaEntry(name);
+    uint8_t bit = 1 << static_cast<uint8_t>(dialect);
+    if ((entry.readyMask & bit) == 0) {
+        String error;
+        if (!normalizeToolSchema(parametersJson != nullptr ? String(parametersJson) : String(),
+                                 dialect, entry.schemas[static_cast<uint8_t>(dialect)], &error)) {
+            // Only static tools get here: runtime ones were validated on registration
+            ESPAI_LOG_W("Tools", "Tool %s schema ignored: %s", name.c_str(), error.c_str());
+        }
+        entry.readyMask |= bit;
+    }
+    return entry.schemas[static_cast<uint8_t>(dialect)];
 }
 
-String ToolRegistry::toAnthropicSchema() const {
-    if (_tools.empty()) {
+String ToolRegistry::buildSchema(SchemaDialect dialect) const {
+    if (_tools.empty() && _staticTools.size() == 0) {
         return "[]";
     }
 
     JsonDocument doc;
     JsonArray arr = doc.to<JsonArray>();
+    JsonArray declarations = arr;
+    if (dialect == SchemaDialect::Gemini) {
+        JsonObject toolObj = arr.add<JsonObject>();
+        declarations = toolObj["functionDeclarations"].to<JsonArray>();
+    }
+    const char* schemaKey = (dialect == SchemaDialect::Anthropic) ? "input_schema" : "parameters";
 
-    for (const auto& tool : _tools) {
-        JsonObject t = arr.add<JsonObject>();
-        t["name"] = tool.name.c_str();
+    auto addTool = [this, &declarations, dialect, schemaKey](const char* name, const char* description) {
+        JsonObject t = declarations.add<JsonObject>();
+        JsonObject declaration = t;
+        if (dialect == SchemaDialect::OpenAI) {
+            t["type"] = "function";
+            declaration = t["function"].to<JsonObject>();
+        }
+        declaration["name"] = name;
 
-        if (!tool.description.isEmpty()) {
-            t["description"] = tool.description.c_str();
+        if (description != nullptr && description[0] != '\0') {
+            declaration["description"] = description;
         }
 
-        if (!tool.parametersJson.isEmpty()) {
-            JsonDocument schemaDoc;
-            DeserializationError err = deserializeJson(schemaDoc, tool.parametersJson);
-            if (!err) {
-                t["input_schema"] = schemaDoc.as<JsonObject>();
-            }
+        String schema = toolSchema(name, dialect);
+        if (!schema.isEmpty()) {
+            declaration[schemaKey] = serialized(schema);
         }
+    };
+
+    for (const auto& tool : _tools) {
+        addTool(tool.name.c_str(), tool.description.c_str());
+    }
+    for (size_t i = 0; i < _staticTools.size(); i++) {
+        const StaticTool& tool = _staticTools.tools[i];
+        addTool(tool.name, tool.description);
     }
 
     String output;
@@ -166,6 +378,30 @@ String ToolRegistry::toAnthropicSchema() const {
     return output;
 }
 
+const String& ToolRegistry::cachedSchema(SchemaDialect dialect) const {
+    uint8_t d = static_cast<uint8_t>(dialect);
+    if (_schemaOutputRevisions[d] != _revision + 1) {
+        _schemaOutputs[d] = buildSchema(dialect);
+        _schemaOutputRevisions[d] = _revision + 1;
+    }
+    return _schemaOutputs[d];
+}
+
+String ToolRegistry::toOpenAISchema() const {
+    CacheMutex::Guard guard(*_cacheMutex);
+    return cachedSchema(SchemaDialect::OpenAI);
+}
+
+String ToolRegistry::toAnthropicSchema() const {
+    CacheMutex::Guard guard(*_cacheMutex);
+    return cachedSchema(SchemaDialect::Anthropic);
+}
+
+String ToolRegistry::toGeminiSchema() const {
+    CacheMutex::Guard guard(*_cacheMutex);
+    return cachedSchema(SchemaDialect::Gemini);
+}
+
 } // namespace ESPAI
 
 #endif // ESPAI_ENABLE_TOOLS
@@ -3,6 +3,11 @@
 
 #include "../core/AIConfig.h"
 #include "../core/AITypes.h"
+#include "ToolResultCache.h"
+#include "ToolCompletion.h"
+#include "StaticToolTable.h"
+#include "ToolSchema.h"
+#include <memory>
 #include <vector>
 
 #if ESPAI_ENABLE_TOOLS
@@ -11,12 +16,41 @@
 #define ESPAI_MAX_TOOL_ITERATIONS 10
 #endif
 
+#ifndef ESPAI_TOOL_WORKERS
+#define ESPAI_TOOL_WORKERS 2
+#endif
+
+// Runtime tools a registry holds. Separate from ESPAI_MAX_TOOLS (tools per
+// request), so a ToolSelector can choose from more tools than it sends.
+#ifndef ESPAI_MAX_REGISTRY_TOOLS
+#define ESPAI_MAX_REGISTRY_TOOLS 32
+#endif
+
 namespace ESPAI {
 
+class ToolSelector;
+class ToolWorkerPool;
+
+// Runs jsonHandler if set (one argument parse, one result serialize), else handler.
+// Returns the call's success; plain String handlers always succeed.
+bool invokeToolHandler(
+    const ToolHandler& handler,
+    const JsonToolHandler& jsonHandler,
+    const String& arguments,
+    String& result
+);
+
+// The const methods (execution, schemas) may run on several tasks at once:
+// the result and schema caches they fill are locked. Registering, removing
+// or replacing tools must not overlap them.
 class ToolRegistry {
 public:
-    ToolRegistry() = default;
+    ToolRegistry();
+    // Waits for tool handlers still running on the worker pool
+    ~ToolRegistry();
 
+    // Fails for an empty or taken name, a full registry or an invalid
+    // parametersJson (see normalizeToolSchema(); the reason is logged)
     bool registerTool(const Tool& tool);
     bool unregisterTool(const String& name);
     void clearTools();
@@ -26,21 +60,89 @@ public:
 
     String executeToolCall(const String& name, const String& args) const;
     String executeToolCall(const ToolCall& call) const;
+    ToolResult execute(const ToolCall& call) const;
+    // Starts every asyncHandler call first, runs the others in order, then
+    // awaits the async ones (each bounded by its tool's timeoutMs, else getDefaultTimeout())
     std::vector<ToolResult> executeToolCalls(const std::vector<ToolCall>& calls) const;
 
+    // Tool declaration arrays ("tools" values), built once per tool set and dialect
     String toOpenAISchema() const;
     String toAnthropicSchema() const;
+    String toGeminiSchema() const;  // [{"functionDeclarations":[...]}]
+
+    // A tool's parametersJson normalized for dialect (see normalizeToolSchema()),
+    // computed on first use and cached; empty if none or unknown tool
+    String getToolSchema(const String& name, SchemaDialect dialect) const;
 
     size_t toolCount() const { return _tools.size(); }
-    bool hasTool(const String& name) const { return findTool(name) != nullptr; }
+    bool hasTool(const String& name) const { return findTool(name) != nullptr || findStaticTool(name) != nullptr; }
     const std::vector<Tool>& getTools() const { return _tools; }
 
+    // Build-time tools kept in flash. They are not counted by toolCount() or
+    // ESPAI_MAX_REGISTRY_TOOLS; runtime tools cannot reuse their names.
+    void setStaticTools(const StaticToolTableView& table);
+    const StaticToolTableView& getStaticTools() const { return _staticTools; }
+    const StaticTool* findStaticTool(const String& name) const { return _staticTools.find(name); }
+
+    // Changes whenever tools are added or removed
+    uint32_t getRevision() const { return _revision; }
+
+    // Optional: runWithTools() then sends only the selected tools per turn
+    void setSelector(ToolSelector* selector) { _selector = selector; }
+    ToolSelector* getSelector() const { return _selector; }
+
     uint8_t getMaxIterations() const { return _maxIterations; }
     void setMaxIterations(uint8_t max) { _maxIterations = max; }
 
+    // Results of tools with cacheTtlMs > 0. Used by the const execute methods, hence mutable.
+    // Direct access is unlocked: use it only while no tool call is running on another task.
+    ToolResultCache& getCache() const { return _cache; }
+    // Locked cache lookups, safe from any task
+    bool getCachedResult(const String& name, const String& args, String& result) const;
+    void cacheResult(const String& name, const String& args, const String& result, uint32_t ttlMs) const;
+
+    // Workers used by runWithTools() for parallelSafe tools; 0 runs every call sequentially
+    uint8_t getParallelWorkers() const { return _parallelWorkers; }
+    void setParallelWorkers(uint8_t workers) { _parallelWorkers = workers; }
+    // Wait for async and parallel calls of tools with timeoutMs == 0, here and in
+    // runWithTools() and early dispatch; 0 means ESPAI_TOOL_TIMEOUT_MS
+    uint32_t getDefaultTimeout() const { return _defaultTimeoutMs > 0 ? _defaultTimeoutMs : ESPAI_TOOL_TIMEOUT_MS; }
+    void setDefaultTimeout(uint32_t ms) { _defaultTimeoutMs = ms; }
+    // Persistent workers shared by every ParallelToolExecutor run on this registry
+    ToolWorkerPool& getWorkerPool() const { return *_workerPool; }
+
 private:
     std::vector<Tool> _tools;
     uint8_t _maxIterations = ESPAI_MAX_TOOL_ITERATIONS;
+    uint8_t _parallelWorkers = ESPAI_TOOL_WORKERS;
+    uint32_t _defaultTimeoutMs = ESPAI_TOOL_TIMEOUT_MS;
+    mutable ToolResultCache _cache;
+    StaticToolTableView _staticTools;
+    uint32_t _revision = 0;
+    ToolSelector* _selector = nullptr;
+    std::unique_ptr<ToolWorkerPool> _workerPool;
+
+    // Guards _cache and the schema caches below
+    struct CacheMutex;
+    std::unique_ptr<CacheMutex> _cacheMutex;
+
+    struct SchemaCacheEntry {
+        String name;
+        String schemas[kSchemaDialectCount];
+        uint8_t readyMask = 0;  // Bit per SchemaDialect
+    };
+    mutable std::vector<SchemaCacheEntry> _schemaCache;
+    mutable String _schemaOutputs[kSchemaDialectCount];
+    mutable uint32_t _schemaOutputRevisions[kSchemaDialectCount] = {};  // _revision + 1 when built
+
+    bool runHandler(const Tool& tool, const String& args, String& result) const;
+    SchemaCacheEntry& schemaEntry(const String& name) const;
+    String toolSchema(const String& name, SchemaDialect dialect) const;  // Caller holds _cacheMutex
+    String buildSchema(SchemaDialect dialect) const;
+    const String& cachedSchema(SchemaDialect dialect) const;
+
+    ToolRegistry(const ToolRegistry&) = delete;
+    ToolRegistry& operator=(const ToolRegistry&) = delete;
 };
 
 } // namespace ESPAI
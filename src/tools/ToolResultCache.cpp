@@ -0,0 +1,264 @@
+#include "ToolResultCache.h"
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if ESPAI_ENABLE_TOOLS
+
+#ifdef ARDUINO
+#include <esp_heap_caps.h>
+#else
+#include <chrono>
+#endif
+
+namespace ESPAI {
+
+namespace {
+    uint32_t nowMs() {
+#ifdef ARDUINO
+        return millis();
+#else
+        static auto start = std::chrono::steady_clock::now();
+        auto now = std::chrono::steady_clock::now();
+        return static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count());
+#endif
+    }
+
+    // FNV-1a
+    uint32_t hashKey(const char* data, size_t len) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < len; i++) {
+            hash ^= static_cast<uint8_t>(data[i]);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    void copySorted(JsonVariantConst src, JsonVariant dst) {
+        if (src.is<JsonObjectConst>()) {
+            JsonObjectConst obj = src.as<JsonObjectConst>();
+            std::vector<JsonPairConst> pairs;
+            for (JsonPairConst pair : obj) {
+                pairs.push_back(pair);
+            }
+            std::sort(pairs.begin(), pairs.end(), [](const JsonPairConst& a, const JsonPairConst& b) {
+                return strcmp(a.key().c_str(), b.key().c_str()) < 0;
+            });
+            JsonObject out = dst.to<JsonObject>();
+            for (const auto& pair : pairs) {
+                copySorted(pair.value(), out[pair.key()]);
+            }
+        } else if (src.is<JsonArrayConst>()) {
+            JsonArray out = dst.to<JsonArray>();
+            for (JsonVariantConst item : src.as<JsonArrayConst>()) {
+                copySorted(item, out.add<JsonVariant>());
+            }
+        } else {
+            dst.set(src);
+        }
+    }
+}
+
+ToolResultCache::ToolResultCache(size_t maxEntries, size_t maxBytes)
+    : _maxEntries(maxEntries), _maxBytes(maxBytes) {}
+
+ToolResultCache::~ToolResultCache() {
+    clear();
+}
+
+ToolResultCache::ToolResultCache(const ToolResultCache& other)
+    : _maxEntries(other._maxEntries), _maxBytes(other._maxBytes), _usePSRAM(other._usePSRAM) {}
+
+ToolResultCache& ToolResultCache::operator=(const ToolResultCache& other) {
+    if (this != &other) {
+        clear();
+        resetStats();
+        _maxEntries = other._maxEntries;
+        _maxBytes = other._maxBytes;
+        _usePSRAM = other._usePSRAM;
+    }
+    return *this;
+}
+
+String ToolResultCache::canonicalArguments(const String& arguments) {
+    JsonDocument doc;
+    if (deserializeJson(doc, arguments)) {
+        return arguments;
+    }
+    JsonDocument sorted;
+    copySorted(doc.as<JsonVariantConst>(), sorted.to<JsonVariant>());
+    String output;
+    serializeJson(sorted, output);
+    return output;
+}
+
+String ToolResultCache::makeKey(const String& toolName, const String& arguments) {
+    String key = toolName;
+    key += '\n';
+    key += canonicalArguments(arguments);
+    return key;
+}
+
+int ToolResultCache::findEntry(const String& key, uint32_t hash) const {
+    for (size_t i = 0; i < _entries.size(); i++) {
+        const Entry& e = _entries[i];
+        if (e.hash == hash && e.keyLen == key.length() && memcmp(e.data, key.c_str(), e.keyLen) == 0) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool ToolResultCache::get(const String& toolName, const String& arguments, String& result) {
+    String key = makeKey(toolName, arguments);
+    uint32_t hash = hashKey(key.c_str(), key.length());
+    int index = findEntry(key, hash);
+    uint32_t now = nowMs();
+
+    if (index >= 0 && now - _entries[index].storedAt >= _entries[index].ttlMs) {
+        removeAt(static_cast<size_t>(index));
+        index = -1;
+    }
+    if (index < 0) {
+        _misses++;
+        return false;
+    }
+
+    Entry& e = _entries[index];
+    e.lastUsed = now;
+    result = "";
+    result.reserve(e.resultLen);
+#ifdef ARDUINO
+    result.concat(e.data + e.keyLen, e.resultLen);
+#else
+    result.append(e.data + e.keyLen, e.resultLen);
+#endif
+    _hits++;
+    return true;
+}
+
+void ToolResultCache::put(const String& toolName, const String& arguments, const String& result, uint32_t ttlMs) {
+    if (ttlMs == 0 || _maxEntries == 0) {
+        return;
+    }
+
+    String key = makeKey(toolName, arguments);
+    uint32_t hash = hashKey(key.c_str(), key.length());
+    int existing = findEntry(key, hash);
+    if (existing >= 0) {
+        removeAt(static_cast<size_t>(existing));
+    }
+
+    size_t size = key.length() + result.length();
+    uint32_t now = nowMs();
+    if (size > _maxBytes || !trim(size, now)) {
+        return;
+    }
+
+    char* data = allocate(size);
+    if (data == nullptr) {
+        return;
+    }
+    memcpy(data, key.c_str(), key.length());
+    memcpy(data + key.length(), result.c_str(), result.length());
+
+    Entry e;
+    e.hash = hash;
+    e.storedAt = now;
+    e.ttlMs = ttlMs;
+    e.lastUsed = now;
+    e.keyLen = key.length();
+    e.resultLen = result.length();
+    e.data = data;
+    _entries.push_back(e);
+    _bytes += size;
+}
+
+void ToolResultCache::invalidate(const String& toolName) {
+    for (size_t i = _entries.size(); i > 0; i--) {
+        const Entry& e = _entries[i - 1];
+        // Key layout: name '\n' arguments
+        if (e.keyLen > toolName.length() && e.data[toolName.length()] == '\n' &&
+            memcmp(e.data, toolName.c_str(), toolName.length()) == 0) {
+            removeAt(i - 1);
+        }
+    }
+}
+
+void ToolResultCache::clear() {
+    for (auto& e : _entries) {
+        free(e.data);
+    }
+    _entries.clear();
+    _bytes = 0;
+}
+
+void ToolResultCache::setMaxEntries(size_t entries) {
+    _maxEntries = entries;
+    trim(0, nowMs());
+}
+
+void ToolResultCache::setMaxBytes(size_t bytes) {
+    _maxBytes = bytes;
+    trim(0, nowMs());
+}
+
+void ToolResultCache::removeAt(size_t index) {
+    Entry& e = _entries[index];
+    _bytes -= e.keyLen + e.resultLen;
+    free(e.data);
+    _entries.erase(_entries.begin() + index);
+}
+
+void ToolResultCache::removeExpired(uint32_t now) {
+    for (size_t i = _entries.size(); i > 0; i--) {
+        if (now - _entries[i - 1].storedAt >= _entries[i - 1].ttlMs) {
+            removeAt(i - 1);
+        }
+    }
+}
+
+bool ToolResultCache::fits(size_t bytes) const {
+    return _entries.size() < _maxEntries && _bytes + bytes <= _maxBytes;
+}
+
+bool ToolResultCache::trim(size_t bytes, uint32_t now) {
+    // bytes == 0 only trims down to the limits; an incoming entry also needs a free slot
+    auto over = [this, bytes]() {
+        return bytes > 0 ? !fits(bytes) : (_entries.size() > _maxEntries || _bytes > _maxBytes);
+    };
+    if (!over()) {
+        return true;
+    }
+    removeExpired(now);
+    while (!_entries.empty() && over()) {
+        size_t lru = 0;
+        for (size_t i = 1; i < _entries.size(); i++) {
+            if (now - _entries[i].lastUsed > now - _entries[lru].lastUsed) {
+                lru = i;
+            }
+        }
+        removeAt(lru);
+    }
+    return !over();
+}
+
+char* ToolResultCache::allocate(size_t size) const {
+    size_t allocSize = (size > 0) ? size : 1;
+#ifdef ARDUINO
+    if (_usePSRAM) {
+        // heap_caps_malloc memory is released with free()
+        void* p = heap_caps_malloc(allocSize, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (p != nullptr) {
+            return static_cast<char*>(p);
+        }
+    }
+#endif
+    return static_cast<char*>(malloc(allocSize));
+}
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_TOOLS
@@ -0,0 +1,95 @@
+#ifndef ESPAI_TOOL_RESULT_CACHE_H
+#define ESPAI_TOOL_RESULT_CACHE_H
+
+#include "../core/AIConfig.h"
+#include "../core/AITypes.h"
+#include <vector>
+
+#if ESPAI_ENABLE_TOOLS
+
+#ifndef ESPAI_TOOL_CACHE_ENTRIES
+#define ESPAI_TOOL_CACHE_ENTRIES    16
+#endif
+
+#ifndef ESPAI_TOOL_CACHE_BYTES
+#define ESPAI_TOOL_CACHE_BYTES      4096
+#endif
+
+namespace ESPAI {
+
+/**
+ * Memoizes tool handler results keyed on tool name + canonical arguments.
+ *
+ * Arguments are canonicalized by re-serializing the JSON with object keys
+ * sorted, so {"b":1,"a":2} and { "a": 2, "b": 1 } share one entry. Entries
+ * expire after the TTL given to put(). When the entry or byte limit is
+ * reached, expired entries go first, then the least recently used.
+ *
+ * With setUsePSRAM(true), entry data is allocated from PSRAM when
+ * available (internal RAM otherwise). Not thread-safe; copying a cache
+ * copies its limits but not its entries.
+ */
+class ToolResultCache {
+public:
+    explicit ToolResultCache(size_t maxEntries = ESPAI_TOOL_CACHE_ENTRIES,
+                             size_t maxBytes = ESPAI_TOOL_CACHE_BYTES);
+    ~ToolResultCache();
+    ToolResultCache(const ToolResultCache& other);
+    ToolResultCache& operator=(const ToolResultCache& other);
+
+    // Returns true and sets result on a fresh hit. Counts a hit or a miss.
+    bool get(const String& toolName, const String& arguments, String& result);
+    void put(const String& toolName, const String& arguments, const String& result, uint32_t ttlMs);
+
+    void invalidate(const String& toolName);
+    void clear();
+
+    size_t size() const { return _entries.size(); }
+    size_t getBytes() const { return _bytes; }
+    uint32_t getHits() const { return _hits; }
+    uint32_t getMisses() const { return _misses; }
+    void resetStats() { _hits = 0; _misses = 0; }
+
+    size_t getMaxEntries() const { return _maxEntries; }
+    void setMaxEntries(size_t entries);
+    size_t getMaxBytes() const { return _maxBytes; }
+    void setMaxBytes(size_t bytes);
+
+    bool getUsePSRAM() const { return _usePSRAM; }
+    void setUsePSRAM(bool use) { _usePSRAM = use; }
+
+    // Compact JSON with sorted object keys; unparseable input is returned unchanged
+    static String canonicalArguments(const String& arguments);
+
+private:
+    struct Entry {
+        uint32_t hash;
+        uint32_t storedAt;
+        uint32_t ttlMs;
+        uint32_t lastUsed;
+        size_t keyLen;
+        size_t resultLen;
+        char* data;  // key followed by result, not null-terminated
+    };
+
+    std::vector<Entry> _entries;
+    size_t _maxEntries;
+    size_t _maxBytes;
+    size_t _bytes = 0;
+    uint32_t _hits = 0;
+    uint32_t _misses = 0;
+    bool _usePSRAM = false;
+
+    static String makeKey(const String& toolName, const String& arguments);
+    int findEntry(const String& key, uint32_t hash) const;
+    void removeAt(size_t index);
+    void removeExpired(uint32_t now);
+    bool fits(size_t bytes) const;
+    bool trim(size_t bytes, uint32_t now);
+    char* allocate(size_t size) const;
+};
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_TOOLS
+#endif // ESPAI_TOOL_RESULT_CACHE_H
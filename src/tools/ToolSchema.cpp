@@ -0,0 +1,123 @@
+#include "ToolSchema.h"
+#include <ArduinoJson.h>
+#include <cstring>
+
+#if ESPAI_ENABLE_TOOLS
+
+namespace ESPAI {
+
+namespace {
+    // Schema keywords Gemini's functionDeclarations accept
+    const char* const kGeminiKeywords[] = {
+        "type", "format", "title", "description", "nullable", "enum", "default", "example",
+        "properties", "required", "propertyOrdering", "minProperties", "maxProperties",
+        "items", "minItems", "maxItems", "minLength", "maxLength", "pattern",
+        "minimum", "maximum", "anyOf",
+    };
+
+    bool isGeminiKeyword(const char* key) {
+        for (const char* keyword : kGeminiKeywords) {
+            if (strcmp(key, keyword) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool fail(String* error, const char* message) {
+        if (error != nullptr) {
+            *error = message;
+        }
+        return false;
+    }
+
+    void copyGeminiSchema(JsonObjectConst src, JsonObject dst) {
+        for (JsonPairConst kv : src) {
+            const char* key = kv.key().c_str();
+            JsonVariantConst value = kv.value();
+            if (!isGeminiKeyword(key)) {
+                continue;
+            }
+
+            if (strcmp(key, "properties") == 0 && value.is<JsonObjectConst>()) {
+                JsonObject properties = dst["properties"].to<JsonObject>();
+                for (JsonPairConst property : value.as<JsonObjectConst>()) {
+                    if (property.value().is<JsonObjectConst>()) {
+                        copyGeminiSchema(property.value().as<JsonObjectConst>(),
+                                         properties[property.key().c_str()].to<JsonObject>());
+                    }
+                }
+            } else if (strcmp(key, "items") == 0 && value.is<JsonObjectConst>()) {
+                copyGeminiSchema(value.as<JsonObjectConst>(), dst["items"].to<JsonObject>());
+            } else if (strcmp(key, "anyOf") == 0 && value.is<JsonArrayConst>()) {
+                JsonArray anyOf = dst["anyOf"].to<JsonArray>();
+                for (JsonVariantConst option : value.as<JsonArrayConst>()) {
+                    if (option.is<JsonObjectConst>()) {
+                        copyGeminiSchema(option.as<JsonObjectConst>(), anyOf.add<JsonObject>());
+                    }
+                }
+            } else if (strcmp(key, "type") == 0 && value.is<JsonArrayConst>()) {
+                // ["string", "null"] -> "string" + nullable
+                for (JsonVariantConst type : value.as<JsonArrayConst>()) {
+                    const char* name = type | "";
+                    if (strcmp(name, "null") == 0) {
+                        dst["nullable"] = true;
+                    } else if (name[0] != '\0' && dst["type"].isNull()) {
+                        dst["type"] = name;
+                    }
+                }
+            } else {
+                dst[key] = value;
+            }
+        }
+    }
+}
+
+bool normalizeToolSchema(
+    const String& parametersJson,
+    SchemaDialect dialect,
+    String& output,
+    String* error
+) {
+    output = "";
+    if (parametersJson.isEmpty()) {
+        return true;
+    }
+
+    JsonDocument doc;
+    if (deserializeJson(doc, parametersJson)) {
+        return fail(error, "Invalid parameters JSON");
+    }
+    if (!doc.is<JsonObject>()) {
+        return fail(error, "Parameters schema must be a JSON object");
+    }
+    JsonVariantConst type = doc["type"];
+    if (!type.isNull() && strcmp(type | "", "object") != 0) {
+        return fail(error, "Parameters schema type must be \"object\"");
+    }
+    if (!doc["properties"].isNull() && !doc["properties"].is<JsonObject>()) {
+        return fail(error, "Schema properties must be an object");
+    }
+    if (!doc["required"].isNull() && !doc["required"].is<JsonArray>()) {
+        return fail(error, "Schema required must be an array");
+    }
+
+    if (dialect != SchemaDialect::Gemini) {
+        doc.remove("$schema");
+        serializeJson(doc, output);
+        return true;
+    }
+
+    JsonDocument gemini;
+    JsonObject root = gemini.to<JsonObject>();
+    copyGeminiSchema(doc.as<JsonObjectConst>(), root);
+    if (root["properties"].size() == 0) {
+        return true;
+    }
+    serializeJson(gemini, output);
+    return true;
+}
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_TOOLS
@@ -0,0 +1,45 @@
+#ifndef ESPAI_TOOL_SCHEMA_H
+#define ESPAI_TOOL_SCHEMA_H
+
+#include "../core/AIConfig.h"
+#include "../core/AITypes.h"
+
+#if ESPAI_ENABLE_TOOLS
+
+namespace ESPAI {
+
+// JSON schema flavour accepted by a provider's tool declarations
+enum class SchemaDialect : uint8_t {
+    OpenAI = 0,     // OpenAI and OpenAI-compatible servers (full JSON schema)
+    Anthropic,      // input_schema (full JSON schema)
+    Gemini          // functionDeclarations parameters (OpenAPI subset)
+};
+
+static const uint8_t kSchemaDialectCount = 3;
+
+/**
+ * Validates a tool's parametersJson and rewrites it for one dialect,
+ * minified and ready to embed in a request body as is.
+ *
+ * The schema must be a JSON object whose type, if given, is "object";
+ * properties must be an object and required an array. "$schema" is
+ * dropped for every dialect. For Gemini, keywords outside the OpenAPI
+ * subset (additionalProperties, $ref, oneOf...) are removed at every
+ * level, ["T","null"] types become type T with nullable, and an object
+ * without properties yields an empty output (declared with no
+ * parameters, which Gemini requires).
+ *
+ * An empty parametersJson is valid and gives an empty output. Returns
+ * false, with error set when given, for an invalid schema.
+ */
+bool normalizeToolSchema(
+    const String& parametersJson,
+    SchemaDialect dialect,
+    String& output,
+    String* error = nullptr
+);
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_TOOLS
+#endif // ESPAI_TOOL_SCHEMA_H
@@ -0,0 +1,307 @@
+#include "ToolSelector.h"
+#include "ToolRegistry.h"
+#include "../providers/AIProvider.h"
+#include <algorithm>
+
+#if ESPAI_ENABLE_TOOLS
+
+namespace ESPAI {
+
+namespace {
+    const uint8_t kTextWeight = 1;
+    const uint8_t kTagWeight = 2;
+    const float kUseBoost = 0.1f;
+    const uint16_t kMaxUseBoostCount = 10;
+
+    size_t candidateCount(const ToolRegistry& registry) {
+        return registry.getTools().size() + registry.getStaticTools().size();
+    }
+
+    // Runtime tools first, then static tools
+    String candidateName(const ToolRegistry& registry, size_t i) {
+        const std::vector<Tool>& tools = registry.getTools();
+        if (i < tools.size()) {
+            return tools[i].name;
+        }
+        return registry.getStaticTools().tools[i - tools.size()].name;
+    }
+
+    String candidateDescription(const ToolRegistry& registry, size_t i) {
+        const std::vector<Tool>& tools = registry.getTools();
+        if (i < tools.size()) {
+            return tools[i].description;
+        }
+        return registry.getStaticTools().tools[i - tools.size()].description;
+    }
+
+    bool isTokenChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+    }
+}
+
+ToolSelector::ToolSelector(uint8_t maxTools)
+    : _maxTools(maxTools) {}
+
+std::vector<String> ToolSelector::tokenize(const String& text) {
+    std::vector<String> tokens;
+    String current;
+    size_t len = text.length();
+    for (size_t i = 0; i <= len; i++) {
+        char c = (i < len) ? text[i] : ' ';
+        if (isTokenChar(c)) {
+            current += static_cast<char>((c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c);
+            continue;
+        }
+        if (current.length() >= 3 &&
+            std::find(tokens.begin(), tokens.end(), current) == tokens.end()) {
+            tokens.push_back(current);
+        }
+        current = "";
+    }
+    return tokens;
+}
+
+void ToolSelector::setTags(const String& toolName, const String& tags) {
+    for (auto& entry : _tags) {
+        if (entry.first == toolName) {
+            entry.second = tags;
+            _indexDirty = true;
+            return;
+        }
+    }
+    _tags.push_back(std::make_pair(toolName, tags));
+    _indexDirty = true;
+}
+
+void ToolSelector::pin(const String& toolName) {
+    if (!isPinned(toolName)) {
+        _pinned.push_back(toolName);
+    }
+}
+
+void ToolSelector::unpin(const String& toolName) {
+    _pinned.erase(std::remove(_pinned.begin(), _pinned.end(), toolName), _pinned.end());
+}
+
+bool ToolSelector::isPinned(const String& toolName) const {
+    return std::find(_pinned.begin(), _pinned.end(), toolName) != _pinned.end();
+}
+
+void ToolSelector::clearPins() {
+    _pinned.clear();
+    _conversationPins.clear();
+}
+
+const ToolSelector::ConversationPins* ToolSelector::findPins(uint32_t conversationId) const {
+    for (const auto& entry : _conversationPins) {
+        if (entry.conversationId == conversationId) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void ToolSelector::pin(uint32_t conversationId, const String& toolName) {
+    if (conversationId == 0) {
+        pin(toolName);
+        return;
+    }
+    // Move the conversation to the back, evicting the least recently pinned one when full
+    ConversationPins entry;
+    entry.conversationId = conversationId;
+    for (auto it = _conversationPins.begin(); it != _conversationPins.end(); ++it) {
+        if (it->conversationId == conversationId) {
+            entry = std::move(*it);
+            _conversationPins.erase(it);
+            break;
+        }
+    }
+    if (_conversationPins.size() >= ESPAI_TOOL_SELECT_CONVERSATIONS) {
+        _conversationPins.erase(_conversationPins.begin());
+    }
+    if (std::find(entry.tools.begin(), entry.tools.end(), toolName) == entry.tools.end()) {
+        entry.tools.push_back(toolName);
+    }
+    _conversationPins.push_back(std::move(entry));
+}
+
+void ToolSelector::unpin(uint32_t conversationId, const String& toolName) {
+    for (auto& entry : _conversationPins) {
+        if (entry.conversationId == conversationId) {
+            entry.tools.erase(std::remove(entry.tools.begin(), entry.tools.end(), toolName), entry.tools.end());
+            return;
+        }
+    }
+}
+
+bool ToolSelector::isPinned(uint32_t conversationId, const String& toolName) const {
+    const ConversationPins* pins = findPins(conversationId);
+    return pins != nullptr &&
+        std::find(pins->tools.begin(), pins->tools.end(), toolName) != pins->tools.end();
+}
+
+void ToolSelector::clearPins(uint32_t conversationId) {
+    for (auto it = _conversationPins.begin(); it != _conversationPins.end(); ++it) {
+        if (it->conversationId == conversationId) {
+            _conversationPins.erase(it);
+            return;
+        }
+    }
+}
+
+void ToolSelector::recordUse(const String& toolName) {
+    for (auto& entry : _useCounts) {
+        if (entry.first == toolName) {
+            if (entry.second < 0xFFFF) {
+                entry.second++;
+            }
+            return;
+        }
+    }
+    _useCounts.push_back(std::make_pair(toolName, static_cast<uint16_t>(1)));
+}
+
+uint16_t ToolSelector::getUseCount(const String& toolName) const {
+    for (const auto& entry : _useCounts) {
+        if (entry.first == toolName) {
+            return entry.second;
+        }
+    }
+    return 0;
+}
+
+void ToolSelector::addToIndex(const String& text, uint16_t tool, uint8_t weight) {
+    String spaced = text;
+    // Split snake_case and kebab-case names into words
+    for (size_t i = 0; i < spaced.length(); i++) {
+        if (spaced[i] == '_' || spaced[i] == '-') {
+            spaced[i] = ' ';
+        }
+    }
+
+    for (const auto& token : tokenize(spaced)) {
+        auto it = std::lower_bound(_index.begin(), _index.end(), token,
+            [](const Posting& p, const String& t) { return p.token < t; });
+        if (it == _index.end() || it->token != token) {
+            Posting posting;
+            posting.token = token;
+            it = _index.insert(it, posting);
+        }
+        if (!it->tools.empty() && it->tools.back() == tool) {
+            it->weights.back() = std::max(it->weights.back(), weight);
+        } else {
+            it->tools.push_back(tool);
+            it->weights.push_back(weight);
+        }
+    }
+}
+
+void ToolSelector::buildIndex(const ToolRegistry& registry) {
+    _index.clear();
+    size_t count = candidateCount(registry);
+    for (size_t i = 0; i < count; i++) {
+        uint16_t tool = static_cast<uint16_t>(i);
+        String name = candidateName(registry, i);
+        addToIndex(name, tool, kTextWeight);
+        addToIndex(candidateDescription(registry, i), tool, kTextWeight);
+        for (const auto& entry : _tags) {
+            if (entry.first == name) {
+                addToIndex(entry.second, tool, kTagWeight);
+            }
+        }
+    }
+    _indexedRegistry = &registry;
+    _indexedRevision = registry.getRevision();
+    _indexDirty = false;
+}
+
+std::vector<String> ToolSelector::select(const ToolRegistry& registry, const String& query, uint32_t conversationId) {
+    size_t count = candidateCount(registry);
+    std::vector<String> selected;
+    _dropped.clear();
+    if (count == 0) {
+        return selected;
+    }
+
+    std::vector<float> scores(count, 0.0f);
+    if (_scorer) {
+        for (size_t i = 0; i < count; i++) {
+            scores[i] = _scorer(query, candidateName(registry, i), candidateDescription(registry, i));
+        }
+    } else {
+        if (_indexDirty || _indexedRegistry != &registry || _indexedRevision != registry.getRevision()) {
+            buildIndex(registry);
+        }
+        for (const auto& token : tokenize(query)) {
+            auto it = std::lower_bound(_index.begin(), _index.end(), token,
+                [](const Posting& p, const String& t) { return p.token < t; });
+            if (it == _index.end() || it->token != token) {
+                continue;
+            }
+            for (size_t p = 0; p < it->tools.size(); p++) {
+                scores[it->tools[p]] += it->weights[p];
+            }
+        }
+    }
+
+    // Global pins first, then the conversation's; both count against _maxTools
+    const ConversationPins* conversationPins = conversationId != 0 ? findPins(conversationId) : nullptr;
+    std::vector<String> pinnedHere;
+    std::vector<uint16_t> order;
+    order.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        String name = candidateName(registry, i);
+        uint16_t uses = getUseCount(name);
+        scores[i] += kUseBoost * static_cast<float>(std::min(uses, kMaxUseBoostCount));
+        if (isPinned(name)) {
+            selected.push_back(name);
+        } else if (conversationPins != nullptr &&
+                   std::find(conversationPins->tools.begin(), conversationPins->tools.end(), name) !=
+                       conversationPins->tools.end()) {
+            pinnedHere.push_back(name);
+        } else {
+            order.push_back(static_cast<uint16_t>(i));
+        }
+    }
+    selected.insert(selected.end(), pinnedHere.begin(), pinnedHere.end());
+    while (selected.size() > _maxTools) {
+        ESPAI_LOG_W("Tools", "Pinned tool %s dropped: more pins than maxTools", selected.back().c_str());
+        _dropped.insert(_dropped.begin(), selected.back());
+        selected.pop_back();
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&scores](uint16_t a, uint16_t b) {
+        return scores[a] > scores[b];
+    });
+
+    for (uint16_t i : order) {
+        if (selected.size() >= _maxTools) {
+            break;
+        }
+        selected.push_back(candidateName(registry, i));
+    }
+    return selected;
+}
+
+void ToolSelector::apply(AIProvider& provider, const ToolRegistry& registry, const String& query, uint32_t conversationId) {
+    SchemaDialect dialect = provider.getSchemaDialect();
+    provider.clearTools();
+    for (const auto& name : select(registry, query, conversationId)) {
+        const Tool* tool = registry.findTool(name);
+        if (tool != nullptr) {
+            // Fails past the provider's ESPAI_MAX_TOOLS when maxTools is larger
+            if (!provider.addTool(*tool, registry.getToolSchema(name, dialect))) {
+                _dropped.push_back(name);
+            }
+            continue;
+        }
+        const StaticTool* staticTool = registry.findStaticTool(name);
+        if (staticTool != nullptr) {
+            provider.addStaticTool(*staticTool, registry.getToolSchema(name, dialect));
+        }
+    }
+}
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_TOOLS
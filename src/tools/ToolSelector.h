@@ -0,0 +1,119 @@
+#ifndef ESPAI_TOOL_SELECTOR_H
+#define ESPAI_TOOL_SELECTOR_H
+
+#include "../core/AIConfig.h"
+#include "../core/AITypes.h"
+#include <functional>
+#include <vector>
+
+#if ESPAI_ENABLE_TOOLS
+
+#ifndef ESPAI_TOOL_SELECT_TOP_K
+#define ESPAI_TOOL_SELECT_TOP_K     5
+#endif
+
+#ifndef ESPAI_TOOL_SELECT_CONVERSATIONS
+#define ESPAI_TOOL_SELECT_CONVERSATIONS 8
+#endif
+
+namespace ESPAI {
+
+class AIProvider;
+class ToolRegistry;
+
+// Returns a relevance score for one tool; higher is more relevant
+using ToolScorer = std::function<float(const String& query, const String& toolName, const String& description)>;
+
+/**
+ * Picks the tools sent with a request so large registries do not bloat
+ * every body.
+ *
+ * Tools are ranked for the query (normally the latest user message) by an
+ * inverted keyword index over their name, description and tags (tag hits
+ * weigh double), plus a small boost per past use. A ToolScorer replaces the
+ * keyword score. Pinned tools come first and count against maxTools; the
+ * rest is filled by score, ties keeping registration order. Pins past
+ * maxTools, and tools the provider refuses in apply(), are reported by
+ * getDropped().
+ *
+ * pin(name) applies to every request. pin(conversationId, name) applies only
+ * to that conversation (Conversation::getId()). runWithTools() uses the
+ * selector attached with ToolRegistry::setSelector() and pins every tool
+ * the model calls for the conversation, so tools used in its earlier turns
+ * stay available without leaking into other conversations.
+ */
+class ToolSelector {
+public:
+    explicit ToolSelector(uint8_t maxTools = ESPAI_TOOL_SELECT_TOP_K);
+
+    // Names of the selected tools, pinned first, then by descending score.
+    // conversationId 0 uses the global pins only.
+    std::vector<String> select(const ToolRegistry& registry, const String& query, uint32_t conversationId = 0);
+
+    // Replaces the provider's tools with the selection
+    void apply(AIProvider& provider, const ToolRegistry& registry, const String& query, uint32_t conversationId = 0);
+
+    // Tools left out of the last select() or apply() although pinned or selected
+    const std::vector<String>& getDropped() const { return _dropped; }
+
+    uint8_t getMaxTools() const { return _maxTools; }
+    void setMaxTools(uint8_t maxTools) { _maxTools = maxTools; }
+
+    // Extra keywords for a tool, separated by spaces or commas
+    void setTags(const String& toolName, const String& tags);
+    void setScorer(ToolScorer scorer) { _scorer = scorer; }
+
+    void pin(const String& toolName);
+    void unpin(const String& toolName);
+    bool isPinned(const String& toolName) const;
+    // Clears global and per-conversation pins
+    void clearPins();
+
+    // Pins kept for the most recent ESPAI_TOOL_SELECT_CONVERSATIONS conversations
+    void pin(uint32_t conversationId, const String& toolName);
+    void unpin(uint32_t conversationId, const String& toolName);
+    bool isPinned(uint32_t conversationId, const String& toolName) const;
+    void clearPins(uint32_t conversationId);
+
+    void recordUse(const String& toolName);
+    uint16_t getUseCount(const String& toolName) const;
+    void clearHistory() { _useCounts.clear(); }
+
+    // Lower-case alphanumeric words of at least 3 characters
+    static std::vector<String> tokenize(const String& text);
+
+private:
+    struct Posting {
+        String token;
+        std::vector<uint16_t> tools;  // Candidate indices
+        std::vector<uint8_t> weights;
+    };
+
+    struct ConversationPins {
+        uint32_t conversationId;
+        std::vector<String> tools;
+    };
+
+    uint8_t _maxTools;
+    ToolScorer _scorer;
+    std::vector<std::pair<String, String>> _tags;
+    std::vector<String> _pinned;
+    std::vector<ConversationPins> _conversationPins;  // Least recently pinned first
+    std::vector<String> _dropped;
+    std::vector<std::pair<String, uint16_t>> _useCounts;
+
+    // Inverted index, rebuilt when the registry's tool set changes
+    std::vector<Posting> _index;
+    const ToolRegistry* _indexedRegistry = nullptr;
+    uint32_t _indexedRevision = 0;
+    bool _indexDirty = true;
+
+    const ConversationPins* findPins(uint32_t conversationId) const;
+    void buildIndex(const ToolRegistry& registry);
+    void addToIndex(const String& text, uint16_t tool, uint8_t weight);
+};
+
+} // namespace ESPAI
+
+#endif // ESPAI_ENABLE_TOOLS
+#endif // ESPAI_TOOL_SELECTOR_H
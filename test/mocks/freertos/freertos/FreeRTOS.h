@@ -4,12 +4,22 @@
 #include <cstdint>
 
 typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
 typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;
+
+typedef struct {
+    void* reserved;
+} StaticTask_t;
 
 #define pdPASS 1
 #define pdFAIL 0
 #define portMAX_DELAY 0xFFFFFFFF
 #define tskNO_AFFINITY 0x7FFFFFFF
 #define configSTACK_DEPTH_TYPE uint32_t
+#define portTICK_PERIOD_MS 1
+#ifndef pdMS_TO_TICKS
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#endif
 
 #endif // MOCK_FREERTOS_H
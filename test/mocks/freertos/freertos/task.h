@@ -16,6 +16,24 @@ extern BaseType_t xTaskCreatePinnedToCore(
     BaseType_t xCoreID
 );
 
+extern TaskHandle_t xTaskCreateStaticPinnedToCore(
+    TaskFunction_t pxTaskCode,
+    const char* pcName,
+    const uint32_t ulStackDepth,
+    void* pvParameters,
+    UBaseType_t uxPriority,
+    StackType_t* const puxStackBuffer,
+    StaticTask_t* const pxTaskBuffer,
+    const BaseType_t xCoreID
+);
+
 extern void vTaskDelete(TaskHandle_t xTask);
 
+// Reports half of the calling task's stack as never used
+extern UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask);
+
+// Test helpers: tasks created so far, and how many used a static stack
+extern uint32_t mockTaskCreateCount();
+extern uint32_t mockStaticTaskCreateCount();
+
 #endif // MOCK_FREERTOS_TASK_H
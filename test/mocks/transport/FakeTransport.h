@@ -0,0 +1,171 @@
+#ifndef ESPAI_TEST_FAKE_TRANSPORT_H
+#define ESPAI_TEST_FAKE_TRANSPORT_H
+
+// Scripted HttpTransport for native tests: execute() returns the queued
+// responses in order and executeStream() replays the queued SSE bodies.
+// openExchange() serves the same scripts as HTTP/1.1 wire bytes (streams
+// chunked), or rawExchanges verbatim, streamChunkSize bytes per step.
+
+#include "http/HttpTransport.h"
+#include "http/HttpResponseParser.h"
+#include <cstdio>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+class FakeTransport : public ESPAI::HttpTransport {
+public:
+    std::vector<ESPAI::HttpResponse> responses;
+    std::vector<String> streams;
+    std::vector<ESPAI::HttpRequest> requests;
+    size_t streamChunkSize = 16;
+    uint32_t streamChunkDelayMs = 0;  // Simulated network time before each chunk
+    uint32_t executeDelayMs = 0;      // Simulated round trip of execute()
+    bool streamAborted = false;
+
+    std::vector<String> rawExchanges;
+    bool exchangeSupported = true;
+    size_t exchangeConnectSteps = 1;
+    bool exchangeStalled = false;   // Never answers after sending
+    int openExchanges = 0;
+
+    void addResponse(int16_t status, const String& body) {
+        ESPAI::HttpResponse response;
+        response.statusCode = status;
+        response.body = body;
+        response.success = status >= 200 && status < 300;
+        responses.push_back(response);
+    }
+
+    ESPAI::HttpResponse execute(const ESPAI::HttpRequest& request) override {
+        requests.push_back(request);
+        if (executeDelayMs > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(executeDelayMs));
+        }
+        if (_nextResponse >= responses.size()) {
+            _lastError = "No scripted response";
+            return ESPAI::HttpResponse();
+        }
+        return responses[_nextResponse++];
+    }
+
+    bool executeStream(const ESPAI::HttpRequest& request, ESPAI::StreamDataCallback callback) override {
+        requests.push_back(request);
+        if (_nextStream >= streams.size()) {
+            _lastError = "No scripted stream";
+            return false;
+        }
+        const String& body = streams[_nextStream++];
+        for (size_t pos = 0; pos < body.length(); pos += streamChunkSize) {
+            size_t len = body.length() - pos < streamChunkSize ? body.length() - pos : streamChunkSize;
+            if (streamChunkDelayMs > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(streamChunkDelayMs));
+            }
+            if (!callback(reinterpret_cast<const uint8_t*>(body.c_str() + pos), len)) {
+                break;
+            }
+        }
+        return true;
+    }
+
+    bool isReady() const override { return true; }
+    const String& getLastError() const override { return _lastError; }
+    void setCACert(const char* cert) override { (void)cert; }
+    void setInsecure(bool insecure) override { (void)insecure; }
+    void abortStream() override { streamAborted = true; }
+
+    std::unique_ptr<ESPAI::HttpExchange> openExchange(const ESPAI::HttpRequest& request, bool stream) override {
+        if (!exchangeSupported) {
+            return nullptr;
+        }
+        requests.push_back(request);
+        String wire;
+        if (_nextRaw < rawExchanges.size()) {
+            wire = rawExchanges[_nextRaw++];
+        } else if (stream && _nextStream < streams.size()) {
+            wire = chunkedResponse(streams[_nextStream++]);
+        } else if (!stream && _nextResponse < responses.size()) {
+            const ESPAI::HttpResponse& response = responses[_nextResponse++];
+            wire = "HTTP/1.1 " + String(static_cast<int>(response.statusCode)) + " Scripted\r\nContent-Length: " +
+                   String(static_cast<unsigned int>(response.body.length())) + "\r\n\r\n" + response.body;
+        }
+        return std::unique_ptr<ESPAI::HttpExchange>(new FakeExchange(*this, wire));
+    }
+
+private:
+    class FakeExchange : public ESPAI::HttpExchange {
+    public:
+        FakeExchange(FakeTransport& owner, const String& wire)
+            : _owner(owner), _wire(wire), _connectSteps(owner.exchangeConnectSteps) {
+            _owner.openExchanges++;
+        }
+        ~FakeExchange() override { _owner.openExchanges--; }
+
+        Phase step(uint8_t* buffer, size_t size, size_t& received) override {
+            received = 0;
+            if (_phase == Phase::Connecting) {
+                if (_connectSteps > 0) {
+                    _connectSteps--;
+                }
+                if (_connectSteps == 0) {
+                    _phase = Phase::Sending;
+                }
+            } else if (_phase == Phase::Sending) {
+                _phase = Phase::Receiving;
+            } else if (_phase == Phase::Receiving && !_owner.exchangeStalled) {
+                size_t len = _wire.length() - _pos;
+                if (len > _owner.streamChunkSize) len = _owner.streamChunkSize;
+                if (len > size) len = size;
+                if (len == 0) {
+                    _parser.onClosed();
+                } else {
+                    memcpy(buffer, _wire.c_str() + _pos, len);
+                    _pos += len;
+                    received = _parser.decode(buffer, len);
+                }
+                if (_parser.hasError()) {
+                    _lastError = _parser.getError();
+                    _phase = Phase::Failed;
+                } else if (_parser.isDone()) {
+                    _phase = Phase::Done;
+                }
+            }
+            return _phase;
+        }
+
+        int16_t getStatusCode() const override { return _parser.getStatusCode(); }
+        int32_t getRetryAfterSeconds() const override { return _parser.getRetryAfterSeconds(); }
+        const String& getLastError() const override { return _lastError; }
+
+    private:
+        FakeTransport& _owner;
+        String _wire;
+        size_t _pos = 0;
+        size_t _connectSteps;
+        Phase _phase = Phase::Connecting;
+        ESPAI::HttpResponseParser _parser;
+        String _lastError;
+    };
+
+    String chunkedResponse(const String& body) const {
+        String wire = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nTransfer-Encoding: chunked\r\n\r\n";
+        for (size_t pos = 0; pos < body.length(); pos += streamChunkSize) {
+            size_t len = body.length() - pos < streamChunkSize ? body.length() - pos : streamChunkSize;
+            char size[16];
+            snprintf(size, sizeof(size), "%zx\r\n", len);
+            wire += size;
+            wire += body.substring(pos, pos + len);
+            wire += "\r\n";
+        }
+        wire += "0\r\n\r\n";
+        return wire;
+    }
+
+    String _lastError;
+    size_t _nextResponse = 0;
+    size_t _nextStream = 0;
+    size_t _nextRaw = 0;
+};
+
+#endif // ESPAI_TEST_FAKE_TRANSPORT_H
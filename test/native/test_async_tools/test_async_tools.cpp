@@ -0,0 +1,309 @@
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "tools/ToolCompletion.h"
+#include "tools/ParallelToolExecutor.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace ESPAI;
+
+static std::atomic<int> cancelCount{0};
+
+static void sleepMs(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+static uint32_t elapsedSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+// Completes from another thread after ms, like a peripheral driver callback
+static AsyncToolHandler delayedHandler(uint32_t ms, const char* reply) {
+    String out(reply);
+    return [ms, out](const String& args, ToolCompletion done) {
+        done.onCancel([]() { cancelCount++; });
+        std::thread([ms, out, args, done]() mutable {
+            sleepMs(ms);
+            done.complete(out + ":" + args);
+        }).detach();
+    };
+}
+
+static Tool makeAsyncTool(const char* name, uint32_t ms, uint32_t timeoutMs = 0) {
+    Tool tool(name, "async tool", "{}");
+    tool.asyncHandler = delayedHandler(ms, name);
+    tool.timeoutMs = timeoutMs;
+    return tool;
+}
+
+void setUp() {
+    cancelCount = 0;
+}
+
+void tearDown() {}
+
+// ToolCompletion
+
+void test_complete_once() {
+    ToolCompletion done;
+    TEST_ASSERT_FALSE(done.isDone());
+    done.complete("{\"v\":1}");
+    done.complete("{\"v\":2}", false);
+
+    TEST_ASSERT_TRUE(done.isDone());
+    TEST_ASSERT_TRUE(done.wait(0));
+    TEST_ASSERT_TRUE(done.isSuccess());
+    TEST_ASSERT_EQUAL_STRING("{\"v\":1}", done.getResult().c_str());
+}
+
+void test_fail_sets_error() {
+    ToolCompletion done;
+    ToolCompletion copy = done;
+    copy.fail("Sensor offline");
+
+    TEST_ASSERT_TRUE(done.isDone());
+    TEST_ASSERT_FALSE(done.isSuccess());
+    TEST_ASSERT_EQUAL_STRING("{\"error\":\"Sensor offline\"}", done.getResult().c_str());
+}
+
+void test_wait_times_out() {
+    ToolCompletion done;
+    auto start = std::chrono::steady_clock::now();
+    TEST_ASSERT_FALSE(done.wait(30));
+    TEST_ASSERT_TRUE(elapsedSince(start) >= 25);
+}
+
+void test_wait_wakes_on_complete() {
+    ToolCompletion done;
+    std::thread([done]() mutable {
+        sleepMs(20);
+        done.complete("ok");
+    }).detach();
+    TEST_ASSERT_TRUE(done.wait(1000));
+    TEST_ASSERT_EQUAL_STRING("ok", done.getResult().c_str());
+}
+
+void test_cancel_runs_callback() {
+    ToolCompletion done;
+    done.onCancel([]() { cancelCount++; });
+    done.cancel();
+    done.complete("late");
+
+    TEST_ASSERT_EQUAL(1, cancelCount.load());
+    TEST_ASSERT_TRUE(done.isCancelled());
+    TEST_ASSERT_FALSE(done.isSuccess());
+    TEST_ASSERT_EQUAL_STRING("{\"error\":\"Tool cancelled\"}", done.getResult().c_str());
+
+    // Registered after the cancel: runs at once
+    done.onCancel([]() { cancelCount++; });
+    TEST_ASSERT_EQUAL(2, cancelCount.load());
+}
+
+void test_cancel_after_complete_is_ignored() {
+    ToolCompletion done;
+    done.onCancel([]() { cancelCount++; });
+    done.complete("ok");
+    done.cancel();
+
+    TEST_ASSERT_EQUAL(0, cancelCount.load());
+    TEST_ASSERT_FALSE(done.isCancelled());
+    TEST_ASSERT_TRUE(done.isSuccess());
+}
+
+// ToolRegistry
+
+void test_registry_execute_async_tool() {
+    ToolRegistry registry;
+    registry.registerTool(makeAsyncTool("sensor", 20));
+    TEST_ASSERT_TRUE(registry.hasTool("sensor"));
+
+    ToolResult result = registry.execute(ToolCall("call_1", "sensor", "{}"));
+    TEST_ASSERT_TRUE(result.success);
+    TEST_ASSERT_EQUAL_STRING("call_1", result.toolCallId.c_str());
+    TEST_ASSERT_EQUAL_STRING("sensor:{}", result.result.c_str());
+    TEST_ASSERT_EQUAL_STRING("sensor:{\"a\":1}", registry.executeToolCall("sensor", "{\"a\":1}").c_str());
+}
+
+void test_registry_completes_inside_handler() {
+    ToolRegistry registry;
+    Tool tool("now", "d", "{}");
+    tool.asyncHandler = [](const String& args, ToolCompletion done) { done.complete("immediate"); };
+    registry.registerTool(tool);
+
+    TEST_ASSERT_EQUAL_STRING("immediate", registry.executeToolCall("now", "{}").c_str());
+}
+
+void test_registry_async_timeout_cancels() {
+    ToolRegistry registry;
+    registry.registerTool(makeAsyncTool("modbus", 300, 30));
+
+    auto start = std::chrono::steady_clock::now();
+    ToolResult result = registry.execute(ToolCall("call_1", "modbus", "{}"));
+    TEST_ASSERT_TRUE(elapsedSince(start) < 200);
+    TEST_ASSERT_FALSE(result.success);
+    TEST_ASSERT_EQUAL_STRING("{\"error\":\"Tool timed out\"}", result.result.c_str());
+    TEST_ASSERT_EQUAL(1, cancelCount.load());
+}
+
+void test_registry_default_timeout_bounds_async_tool() {
+    ToolRegistry registry;
+    TEST_ASSERT_EQUAL(ESPAI_TOOL_TIMEOUT_MS, registry.getDefaultTimeout());
+    registry.setDefaultTimeout(30);
+
+    Tool tool("never", "d", "{}");
+    tool.asyncHandler = [](const String& args, ToolCompletion done) {
+        done.onCancel([]() { cancelCount++; });
+    };
+    registry.registerTool(tool);
+
+    auto start = std::chrono::steady_clock::now();
+    ToolResult result = registry.execute(ToolCall("1", "never", "{}"));
+    std::vector<ToolResult> results = registry.executeToolCalls({ToolCall("2", "never", "{}")});
+    TEST_ASSERT_TRUE(elapsedSince(start) < 400);
+    TEST_ASSERT_EQUAL_STRING("{\"error\":\"Tool timed out\"}", result.result.c_str());
+    TEST_ASSERT_FALSE(results[0].success);
+    TEST_ASSERT_EQUAL(2, cancelCount.load());
+}
+
+void test_registry_execute_tool_calls_overlap() {
+    ToolRegistry registry;
+    registry.registerTool(makeAsyncTool("a", 100));
+    registry.registerTool(makeAsyncTool("b", 100));
+    registry.registerTool(makeAsyncTool("c", 100));
+    registry.registerTool(Tool("sync", "d", "{}", [](const String& args) -> String { return "sync"; }));
+
+    std::vector<ToolCall> calls = {
+        ToolCall("1", "a", "{}"), ToolCall("2", "sync", "{}"), ToolCall("3", "b", "{}"), ToolCall("4", "c", "{}"),
+    };
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ToolResult> results = registry.executeToolCalls(calls);
+    TEST_ASSERT_TRUE(elapsedSince(start) < 250);
+
+    TEST_ASSERT_EQUAL(4, results.size());
+    TEST_ASSERT_EQUAL_STRING("1", results[0].toolCallId.c_str());
+    TEST_ASSERT_EQUAL_STRING("a:{}", results[0].result.c_str());
+    TEST_ASSERT_EQUAL_STRING("sync", results[1].result.c_str());
+    TEST_ASSERT_EQUAL_STRING("b:{}", results[2].result.c_str());
+    TEST_ASSERT_EQUAL_STRING("4", results[3].toolCallId.c_str());
+    for (const auto& result : results) {
+        TEST_ASSERT_TRUE(result.success);
+    }
+}
+
+void test_registry_caches_async_results() {
+    ToolRegistry registry;
+    std::shared_ptr<std::atomic<int>> calls = std::make_shared<std::atomic<int>>(0);
+    Tool tool("cached", "d", "{}");
+    tool.cacheTtlMs = 60000;
+    tool.asyncHandler = [calls](const String& args, ToolCompletion done) {
+        (*calls)++;
+        done.complete("value");
+    };
+    registry.registerTool(tool);
+
+    registry.execute(ToolCall("1", "cached", "{}"));
+    std::vector<ToolResult> results = registry.executeToolCalls({ToolCall("2", "cached", "{}")});
+    TEST_ASSERT_EQUAL(1, calls->load());
+    TEST_ASSERT_EQUAL_STRING("2", results[0].toolCallId.c_str());
+    TEST_ASSERT_EQUAL_STRING("value", results[0].result.c_str());
+}
+
+// ParallelToolExecutor
+
+void test_executor_awaits_async_concurrently() {
+    ToolRegistry registry;
+    registry.registerTool(makeAsyncTool("a", 100));
+    registry.registerTool(makeAsyncTool("b", 100));
+
+    ParallelToolExecutor executor(0);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ToolResult> results = executor.execute(registry, {ToolCall("1", "a", "{}"), ToolCall("2", "b", "{}")});
+    TEST_ASSERT_TRUE(elapsedSince(start) < 180);
+
+    TEST_ASSERT_EQUAL_STRING("a:{}", results[0].result.c_str());
+    TEST_ASSERT_EQUAL_STRING("b:{}", results[1].result.c_str());
+    TEST_ASSERT_EQUAL(0, executor.getLastWorkerCount());
+}
+
+void test_executor_async_default_timeout() {
+    TEST_ASSERT_EQUAL(ESPAI_TOOL_TIMEOUT_MS, ParallelToolExecutor().getDefaultTimeout());
+
+    ToolRegistry registry;
+    registry.registerTool(makeAsyncTool("slow", 300));
+    registry.registerTool(makeAsyncTool("fast", 10));
+
+    ParallelToolExecutor executor(2);
+    executor.setDefaultTimeout(50);
+    std::vector<ToolResult> results = executor.execute(registry, {ToolCall("1", "slow", "{}"), ToolCall("2", "fast", "{}")});
+
+    TEST_ASSERT_FALSE(results[0].success);
+    TEST_ASSERT_EQUAL_STRING("{\"error\":\"Tool timed out\"}", results[0].result.c_str());
+    TEST_ASSERT_TRUE(results[1].success);
+    TEST_ASSERT_EQUAL(1, executor.getLastTimeoutCount());
+    TEST_ASSERT_EQUAL(1, cancelCount.load());
+}
+
+void test_executor_cancel_check() {
+    ToolRegistry registry;
+    registry.registerTool(makeAsyncTool("slow", 300));
+    int syncCalls = 0;
+    registry.registerTool(Tool("sync", "d", "{}", [&syncCalls](const String& args) -> String {
+        syncCalls++;
+        return "sync";
+    }));
+
+    auto start = std::chrono::steady_clock::now();
+    ParallelToolExecutor executor(0);
+    executor.setCancelCheck([start]() { return elapsedSince(start) >= 30; });
+
+    // First batch: the async call is cancelled while awaited
+    std::vector<ToolResult> results = executor.execute(registry, {ToolCall("1", "slow", "{}")});
+    TEST_ASSERT_TRUE(elapsedSince(start) < 200);
+    TEST_ASSERT_FALSE(results[0].success);
+    TEST_ASSERT_EQUAL_STRING("{\"error\":\"Tool cancelled\"}", results[0].result.c_str());
+    TEST_ASSERT_EQUAL(1, cancelCount.load());
+    TEST_ASSERT_EQUAL(0, executor.getLastTimeoutCount());
+
+    // Already cancelled: serial calls are skipped
+    results = executor.execute(registry, {ToolCall("2", "sync", "{}")});
+    TEST_ASSERT_EQUAL(0, syncCalls);
+    TEST_ASSERT_FALSE(results[0].success);
+    TEST_ASSERT_EQUAL_STRING("2", results[0].toolCallId.c_str());
+}
+
+int main() {
+    UNITY_BEGIN();
+
+    // ToolCompletion
+    RUN_TEST(test_complete_once);
+    RUN_TEST(test_fail_sets_error);
+    RUN_TEST(test_wait_times_out);
+    RUN_TEST(test_wait_wakes_on_complete);
+    RUN_TEST(test_cancel_runs_callback);
+    RUN_TEST(test_cancel_after_complete_is_ignored);
+
+    // ToolRegistry
+    RUN_TEST(test_registry_execute_async_tool);
+    RUN_TEST(test_registry_completes_inside_handler);
+    RUN_TEST(test_registry_async_timeout_cancels);
+    RUN_TEST(test_registry_default_timeout_bounds_async_tool);
+    RUN_TEST(test_registry_execute_tool_calls_overlap);
+    RUN_TEST(test_registry_caches_async_results);
+
+    // ParallelToolExecutor
+    RUN_TEST(test_executor_awaits_async_concurrently);
+    RUN_TEST(test_executor_async_default_timeout);
+    RUN_TEST(test_executor_cancel_check);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
@@ -121,6 +121,32 @@ void test_set_max_messages_triggers_pruning() {
 
 // --- System Prompt Handling Tests ---
 
+void test_add_full_message() {
+    ESPAI::Conversation conv;
+    ESPAI::Message msg(ESPAI::Role::Tool, "{\"ok\":true}", "call_1");
+    conv.addMessage(msg);
+
+    TEST_ASSERT_EQUAL(1, conv.size());
+    TEST_ASSERT_EQUAL(ESPAI::Role::Tool, conv.getMessages()[0].role);
+    TEST_ASSERT_EQUAL_STRING("call_1", conv.getMessages()[0].name.c_str());
+}
+
+void test_pruning_drops_orphan_tool_results() {
+    ESPAI::Conversation conv(3);
+    conv.addUserMessage("Q");
+    ESPAI::Message call(ESPAI::Role::Assistant, "");
+    call.toolCallsJson = "[]";
+    conv.addMessage(call);
+    conv.addMessage(ESPAI::Message(ESPAI::Role::Tool, "r1", "call_1"));
+    conv.addMessage(ESPAI::Message(ESPAI::Role::Tool, "r2", "call_2"));
+
+    // Dropping "Q" and the tool-call message would leave r2 as the first message
+    conv.addAssistantMessage("A");
+
+    TEST_ASSERT_EQUAL(1, conv.size());
+    TEST_ASSERT_EQUAL_STRING("A", conv.getMessages()[0].content.c_str());
+}
+
 void test_set_system_prompt() {
     ESPAI::Conversation conv;
     conv.setSystemPrompt("You are a helpful assistant");
@@ -179,6 +205,20 @@ void test_clear_preserves_max_messages() {
     TEST_ASSERT_EQUAL(5, conv.getMaxMessages());
 }
 
+void test_ids_are_unique_per_instance() {
+    ESPAI::Conversation a;
+    ESPAI::Conversation b;
+    TEST_ASSERT_NOT_EQUAL(0, a.getId());
+    TEST_ASSERT_NOT_EQUAL(a.getId(), b.getId());
+
+    // A copy is a separate conversation; assignment keeps the target's id
+    ESPAI::Conversation copy(a);
+    TEST_ASSERT_NOT_EQUAL(a.getId(), copy.getId());
+    uint32_t bId = b.getId();
+    b = a;
+    TEST_ASSERT_EQUAL(bId, b.getId());
+}
+
 // --- EstimateTokens Tests ---
 
 void test_estimate_tokens_empty() {
@@ -307,6 +347,191 @@ void test_from_json_default_max_messages() {
     TEST_ASSERT_EQUAL(20, conv.getMaxMessages());
 }
 
+// --- Ring Storage Tests ---
+
+void test_ring_wraps_in_order() {
+    ESPAI::Conversation conv(4);
+    for (int i = 0; i < 11; i++) {
+        conv.addUserMessage(String(i));
+    }
+
+    ESPAI::MessageView view = conv.getMessages();
+    TEST_ASSERT_EQUAL(4, view.size());
+    // 11 adds into 4 slots: the oldest kept message sits in slot 3
+    TEST_ASSERT_EQUAL(1, view.firstRunSize());
+    TEST_ASSERT_EQUAL(3, view.secondRunSize());
+
+    const char* expected[] = {"7", "8", "9", "10"};
+    size_t i = 0;
+    for (const ESPAI::Message& msg : view) {
+        TEST_ASSERT_EQUAL_STRING(expected[i], msg.content.c_str());
+        TEST_ASSERT_EQUAL_STRING(expected[i], view[i].content.c_str());
+        i++;
+    }
+    TEST_ASSERT_EQUAL(4, i);
+    TEST_ASSERT_EQUAL_STRING("7", view.front().content.c_str());
+    TEST_ASSERT_EQUAL_STRING("10", view.back().content.c_str());
+}
+
+void test_ring_drops_orphan_tool_results_across_wrap() {
+    ESPAI::Conversation conv(3);
+    conv.addUserMessage("A");
+    conv.addUserMessage("B");
+    conv.addUserMessage("Q");
+    ESPAI::Message call(ESPAI::Role::Assistant, "");
+    call.toolCallsJson = "[]";
+    conv.addMessage(call);
+    conv.addMessage(ESPAI::Message(ESPAI::Role::Tool, "r1", "call_1"));
+    conv.addMessage(ESPAI::Message(ESPAI::Role::Tool, "r2", "call_2"));
+    conv.addAssistantMessage("Done");
+
+    TEST_ASSERT_EQUAL(1, conv.size());
+    TEST_ASSERT_EQUAL_STRING("Done", conv.getMessages()[0].content.c_str());
+
+    // Slots freed by the dropped tool results are reused before wrapping again
+    conv.addUserMessage("Next");
+    conv.addAssistantMessage("Reply");
+    conv.addUserMessage("Last");
+    TEST_ASSERT_EQUAL(3, conv.size());
+    TEST_ASSERT_EQUAL_STRING("Next", conv.getMessages()[0].content.c_str());
+    TEST_ASSERT_EQUAL_STRING("Last", conv.getMessages()[2].content.c_str());
+}
+
+void test_set_max_messages_after_wrap() {
+    ESPAI::Conversation conv(3);
+    for (int i = 0; i < 5; i++) {
+        conv.addUserMessage(String(i));
+    }
+
+    conv.setMaxMessages(6);
+    conv.addUserMessage("5");
+    conv.addUserMessage("6");
+    TEST_ASSERT_EQUAL(5, conv.size());
+    TEST_ASSERT_EQUAL_STRING("2", conv.getMessages()[0].content.c_str());
+    TEST_ASSERT_EQUAL_STRING("6", conv.getMessages()[4].content.c_str());
+
+    conv.setMaxMessages(2);
+    TEST_ASSERT_EQUAL(2, conv.size());
+    TEST_ASSERT_EQUAL_STRING("5", conv.getMessages()[0].content.c_str());
+    TEST_ASSERT_EQUAL_STRING("6", conv.getMessages()[1].content.c_str());
+}
+
+void test_zero_max_messages_keeps_nothing() {
+    ESPAI::Conversation conv(0);
+    conv.addUserMessage("Hello");
+    TEST_ASSERT_EQUAL(0, conv.size());
+    TEST_ASSERT_TRUE(conv.getMessages().empty());
+}
+
+void test_to_json_after_wrap_is_oldest_first() {
+    ESPAI::Conversation conv(2);
+    conv.addUserMessage("A");
+    conv.addAssistantMessage("B");
+    conv.addUserMessage("C");
+
+    ESPAI::Conversation restored;
+    TEST_ASSERT_TRUE(restored.fromJson(conv.toJson()));
+    TEST_ASSERT_EQUAL(2, restored.size());
+    TEST_ASSERT_EQUAL_STRING("B", restored.getMessages()[0].content.c_str());
+    TEST_ASSERT_EQUAL_STRING("C", restored.getMessages()[1].content.c_str());
+}
+
+void test_message_view_from_vector() {
+    std::vector<ESPAI::Message> messages;
+    messages.push_back(ESPAI::Message(ESPAI::Role::User, "Hi"));
+    messages.push_back(ESPAI::Message(ESPAI::Role::Assistant, "Hello"));
+
+    ESPAI::MessageView view = messages;
+    TEST_ASSERT_EQUAL(2, view.size());
+    TEST_ASSERT_EQUAL(0, view.secondRunSize());
+    TEST_ASSERT_EQUAL_STRING("Hello", view[1].content.c_str());
+
+    std::vector<ESPAI::Message> copy = view.toVector();
+    TEST_ASSERT_EQUAL(2, copy.size());
+    TEST_ASSERT_EQUAL_STRING("Hi", copy[0].content.c_str());
+}
+
+// --- Token Budget Tests ---
+
+void test_token_budget_default_off() {
+    ESPAI::Conversation conv;
+    TEST_ASSERT_EQUAL(0, conv.getTokenBudget());
+}
+
+void test_token_budget_keeps_newest_messages() {
+    ESPAI::Conversation conv;
+    conv.setTokenBudget(5);
+    conv.addUserMessage("11112222");       // 2 tokens
+    conv.addAssistantMessage("33334444");  // 2 tokens
+    conv.addUserMessage("55556666");       // 2 tokens
+
+    TEST_ASSERT_EQUAL(2, conv.size());
+    TEST_ASSERT_EQUAL_STRING("33334444", conv.getMessages()[0].content.c_str());
+    TEST_ASSERT_EQUAL(4, conv.estimateTokens());
+}
+
+void test_token_budget_counts_system_prompt() {
+    ESPAI::Conversation conv;
+    conv.addUserMessage("11112222");
+    conv.addAssistantMessage("33334444");
+    conv.setSystemPrompt("1234");          // 1 token, never dropped
+    conv.setTokenBudget(3);
+
+    TEST_ASSERT_EQUAL(1, conv.size());
+    TEST_ASSERT_EQUAL_STRING("33334444", conv.getMessages()[0].content.c_str());
+    TEST_ASSERT_EQUAL(3, conv.estimateTokens());
+}
+
+void test_token_budget_drops_tool_call_with_results() {
+    ESPAI::Conversation conv;
+    ESPAI::Message call(ESPAI::Role::Assistant, "");
+    call.toolCallsJson = "[{\"id\":\"c1\"}]";   // 13 chars: 4 tokens
+    conv.addMessage(call);
+    conv.addMessage(ESPAI::Message(ESPAI::Role::Tool, "resultAA", "c1"));
+    conv.addMessage(ESPAI::Message(ESPAI::Role::Tool, "resultBB", "c2"));
+    conv.addAssistantMessage("Done");
+    TEST_ASSERT_EQUAL(9, conv.estimateTokens());
+
+    conv.setTokenBudget(7);
+
+    // Dropping only the call would orphan both results
+    TEST_ASSERT_EQUAL(1, conv.size());
+    TEST_ASSERT_EQUAL_STRING("Done", conv.getMessages()[0].content.c_str());
+    TEST_ASSERT_EQUAL(1, conv.estimateTokens());
+}
+
+void test_token_budget_keeps_newest_turn_over_budget() {
+    ESPAI::Conversation conv;
+    conv.setTokenBudget(2);
+    conv.addUserMessage("short");
+    conv.addUserMessage("a message well over the budget");
+
+    TEST_ASSERT_EQUAL(1, conv.size());
+    TEST_ASSERT_EQUAL_STRING("a message well over the budget", conv.getMessages()[0].content.c_str());
+}
+
+void test_token_estimates_follow_ring_pruning() {
+    ESPAI::Conversation conv(2);
+    conv.addUserMessage("12345678");
+    conv.addUserMessage("1234");
+    conv.addUserMessage("123456789012");
+    TEST_ASSERT_EQUAL(4, conv.estimateTokens());
+
+    conv.clear();
+    TEST_ASSERT_EQUAL(0, conv.estimateTokens());
+}
+
+void test_token_budget_roundtrip_serialization() {
+    ESPAI::Conversation conv;
+    conv.setTokenBudget(1000);
+    conv.addUserMessage("Hello");
+
+    ESPAI::Conversation restored;
+    TEST_ASSERT_TRUE(restored.fromJson(conv.toJson()));
+    TEST_ASSERT_EQUAL(1000, restored.getTokenBudget());
+    TEST_ASSERT_EQUAL(conv.estimateTokens(), restored.estimateTokens());
+}
+
 int main(int argc, char** argv) {
     UNITY_BEGIN();
 
@@ -324,6 +549,8 @@ int main(int argc, char** argv) {
     RUN_TEST(test_pruning_removes_oldest);
     RUN_TEST(test_pruning_multiple_messages);
     RUN_TEST(test_set_max_messages_triggers_pruning);
+    RUN_TEST(test_add_full_message);
+    RUN_TEST(test_pruning_drops_orphan_tool_results);
 
     // System Prompt Handling Tests
     RUN_TEST(test_set_system_prompt);
@@ -335,6 +562,7 @@ int main(int argc, char** argv) {
     RUN_TEST(test_clear_removes_all_messages);
     RUN_TEST(test_clear_on_empty_conversation);
     RUN_TEST(test_clear_preserves_max_messages);
+    RUN_TEST(test_ids_are_unique_per_instance);
 
     // EstimateTokens Tests
     RUN_TEST(test_estimate_tokens_empty);
@@ -353,6 +581,23 @@ int main(int argc, char** argv) {
     RUN_TEST(test_roundtrip_serialization);
     RUN_TEST(test_from_json_default_max_messages);
 
+    // Ring Storage Tests
+    RUN_TEST(test_ring_wraps_in_order);
+    RUN_TEST(test_ring_drops_orphan_tool_results_across_wrap);
+    RUN_TEST(test_set_max_messages_after_wrap);
+    RUN_TEST(test_zero_max_messages_keeps_nothing);
+    RUN_TEST(test_to_json_after_wrap_is_oldest_first);
+    RUN_TEST(test_message_view_from_vector);
+
+    // Token Budget Tests
+    RUN_TEST(test_token_budget_default_off);
+    RUN_TEST(test_token_budget_keeps_newest_messages);
+    RUN_TEST(test_token_budget_counts_system_prompt);
+    RUN_TEST(test_token_budget_drops_tool_call_with_results);
+    RUN_TEST(test_token_budget_keeps_newest_turn_over_budget);
+    RUN_TEST(test_token_estimates_follow_ring_pruning);
+    RUN_TEST(test_token_budget_roundtrip_serialization);
+
     return UNITY_END();
 }
 
@@ -0,0 +1,470 @@
+/**
+ * @file test_conversation_log.cpp
+ * @brief Unit tests for ConversationLog
+ */
+
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "conversation/Conversation.h"
+#include "conversation/ConversationLog.h"
+
+#include <cstdio>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace ESPAI;
+
+static const char* kPath = "/tmp/espai_test_conversation.log";
+
+static long fileSize() {
+    FILE* file = fopen(kPath, "rb");
+    if (!file) {
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+static void addTurns(Conversation& conv, int first, int count) {
+    for (int i = first; i < first + count; i++) {
+        conv.addMessage(i % 2 == 0 ? Role::User : Role::Assistant, String("m") + String(i));
+    }
+}
+
+// A directory where compact() writes its temporary file makes every rewrite fail
+static void blockCompaction() {
+    mkdir((String(kPath) + ".tmp").c_str(), 0700);
+}
+
+static void unblockCompaction() {
+    rmdir((String(kPath) + ".tmp").c_str());
+}
+
+void setUp(void) {
+    remove(kPath);
+    unblockCompaction();
+    remove((String(kPath) + ".tmp").c_str());
+}
+
+void tearDown(void) {
+    remove(kPath);
+}
+
+// --- Round Trip Tests ---
+
+void test_new_log_starts_from_conversation() {
+    Conversation conv;
+    conv.setSystemPrompt("Be brief");
+    conv.addUserMessage("Before the log");
+
+    ConversationLog log(kPath);
+    TEST_ASSERT_TRUE(log.open(conv));
+    TEST_ASSERT_TRUE(log.isOpen());
+    TEST_ASSERT_EQUAL(1, conv.size());
+    TEST_ASSERT_EQUAL(1, log.getStoredCount());
+    TEST_ASSERT_EQUAL(fileSize(), (long)log.getFileSize());
+}
+
+void test_messages_survive_reopen() {
+    {
+        Conversation conv;
+        ConversationLog log(kPath);
+        TEST_ASSERT_TRUE(log.open(conv));
+        conv.setSystemPrompt("You are a thermostat");
+        conv.addUserMessage("Hello");
+        Message call(Role::Assistant, "");
+        call.toolCallsJson = "[{\"id\":\"c1\"}]";
+        conv.addMessage(call);
+        conv.addMessage(Message(Role::Tool, "21C", "c1"));
+        conv.addAssistantMessage("It is 21C");
+    }
+
+    Conversation conv;
+    ConversationLog log(kPath);
+    TEST_ASSERT_TRUE(log.open(conv));
+    TEST_ASSERT_EQUAL(4, log.getStats().replayedMessages);
+    TEST_ASSERT_EQUAL_STRING("You are a thermostat", conv.getSystemPrompt().c_str());
+    TEST_ASSERT_EQUAL(4, conv.size());
+    TEST_ASSERT_EQUAL_STRING("Hello", conv.getMessages()[0].content.c_str());
+    TEST_ASSERT_EQUAL_STRING("[{\"id\":\"c1\"}]", conv.getMessages()[1].toolCallsJson.c_str());
+    TEST_ASSERT_EQUAL(Role::Tool, conv.getMessages()[2].role);
+    TEST_ASSERT_EQUAL_STRING("c1", conv.getMessages()[2].name.c_str());
+    TEST_ASSERT_EQUAL_STRING("It is 21C", conv.getMessages()[3].content.c_str());
+}
+
+void test_settings_survive_reopen() {
+    {
+        Conversation conv;
+        ConversationLog log(kPath);
+        TEST_ASSERT_TRUE(log.open(conv));
+        conv.setMaxMessages(7);
+        conv.setTokenBudget(500);
+    }
+
+    Conversation conv;
+    ConversationLog log(kPath);
+    TEST_ASSERT_TRUE(log.open(conv));
+    TEST_ASSERT_EQUAL(7, conv.getMaxMessages());
+    TEST_ASSERT_EQUAL(500, conv.getTokenBudget());
+}
+
+void test_clear_is_logged() {
+    {
+        Conversation conv;
+        ConversationLog log(kPath);
+        TEST_ASSERT_TRUE(log.open(conv));
+        addTurns(conv, 0, 4);
+        conv.clear();
+        conv.addUserMessage("After clear");
+        TEST_ASSERT_EQUAL(1, log.getStoredCount());
+    }
+
+    Conversation conv;
+    ConversationLog log(kPath);
+    TEST_ASSERT_TRUE(log.open(conv));
+    TEST_ASSERT_EQUAL(1, conv.size());
+    TEST_ASSERT_EQUAL_STRING("After clear", conv.getMessages()[0].content.c_str());
+}
+
+// --- Append Cost Tests ---
+
+void test_append_cost_is_one_record() {
+    Conversation conv;
+    ConversationLog log(kPath);
+    TEST_ASSERT_TRUE(log.open(conv));
+    addTurns(conv, 0, 10);
+
+    uint32_t before = log.getStats().bytesWritten;
+    size_t sizeBefore = log.getFileSize();
+    conv.addUserMessage("12345678");
+    // Record header, three length prefixes, the content
+    TEST_ASSERT_EQUAL(10 + 12 + 8, log.getStats().bytesWritten - before);
+    TEST_ASSERT_EQUAL(sizeBefore + 30, log.getFileSize());
+    TEST_ASSERT_EQUAL(fileSize(), (long)log.getFileSize());
+}
+
+// --- Crash Recovery Tests ---
+
+void test_torn_tail_is_truncated() {
+    size_t goodSize;
+    {
+        Conversation conv;
+        ConversationLog log(kPath);
+        TEST_ASSERT_TRUE(log.open(conv));
+        addTurns(conv, 0, 3);
+        goodSize = log.getFileSize();
+        conv.addUserMessage("This one is cut short");
+    }
+    TEST_ASSERT_EQUAL(0, truncate(kPath, (off_t)goodSize + 14));
+
+    Conversation conv;
+    ConversationLog log(kPath);
+    TEST_ASSERT_TRUE(log.open(conv));
+    TEST_ASSERT_EQUAL(3, conv.size());
+    TEST_ASSERT_EQUAL(14, log.getStats().truncatedBytes);
+    TEST_ASSERT_EQUAL((long)goodSize, fileSize());
+
+    // Appends continue after the last good record
+    conv.addUserMessage("m3");
+    log.close();
+    Conversation again;
+    ConversationLog reopened(kPath);
+    TEST_ASSERT_TRUE(reopened.open(again));
+    TEST_ASSERT_EQUAL(4, again.size());
+    TEST_ASSERT_EQUAL_STRING("m3", again.getMessages()[3].content.c_str());
+}
+
+void test_corrupt_record_ends_log() {
+    size_t corruptAt;
+    {
+        Conversation conv;
+        ConversationLog log(kPath);
+        TEST_ASSERT_TRUE(log.open(conv));
+        addTurns(conv, 0, 2);
+        corruptAt = log.getFileSize();
+        addTurns(conv, 2, 2);
+    }
+    // Flip a content byte of m2
+    FILE* file = fopen(kPath, "r+b");
+    fseek(file, (long)corruptAt + 10 + 4, SEEK_SET);
+    fputc('X', file);
+    fclose(file);
+
+    Conversation conv;
+    ConversationLog log(kPath);
+    TEST_ASSERT_TRUE(log.open(conv));
+    TEST_ASSERT_EQUAL(2, conv.size());
+    TEST_ASSERT_EQUAL_STRING("m1", conv.getMessages()[1].content.c_str());
+    TEST_ASSERT_EQUAL((long)corruptAt, fileSize());
+}
+
+void test_rejects_foreign_file() {
+    FILE* file = fopen(kPath, "wb");
+    fputs("{\"messages\":[]}", file);
+    fclose(file);
+
+    Conversation conv;
+    ConversationLog log(kPath);
+    TEST_ASSERT_FALSE(log.open(conv));
+    TEST_ASSERT_FALSE(log.isOpen());
+    TEST_ASSERT_EQUAL_STRING("Not a conversation log", log.getLastError().c_str());
+}
+
+// --- Lazy Loading Tests ---
+
+void test_window_comes_from_log() {
+    {
+        Conversation conv(50);
+        ConversationLog log(kPath);
+        TEST_ASSERT_TRUE(log.open(conv));
+        addTurns(conv, 0, 30);
+    }
+
+    // The log's window wins over the constructor's
+    Conversation conv(4);
+    ConversationLog log(kPath);
+    TEST_ASSERT_TRUE(log.open(conv));
+    TEST_ASSERT_EQUAL(50, conv.getMaxMessages());
+    TEST_ASSERT_EQUAL(30, conv.size());
+
+    // A new window compacts: the older messages leave the file
+    conv.setMaxMessages(4);
+    TEST_ASSERT_EQUAL(4, log.getStoredCount());
+    log.close();
+
+    Conversation again;
+    ConversationLog reopened(kPath);
+    TEST_ASSERT_TRUE(reopened.open(again));
+    TEST_ASSERT_EQUAL(4, again.size());
+    TEST_ASSERT_EQUAL_STRING("m26", again.getMessages()[0].content.c_str());
+}
+
+void test_older_messages_readable_from_flash() {
+    Conversation conv(5);
+    ConversationLog log(kPath);
+    TEST_ASSERT_TRUE(log.open(conv));
+    addTurns(conv, 0, 12);
+    TEST_ASSERT_EQUAL(5, conv.size());
+    TEST_ASSERT_EQUAL(12, log.getStoredCount());
+
+    Message message;
+    TEST_ASSERT_TRUE(log.readMessage(0, message));
+    TEST_ASSERT_EQUAL_STRING("m0", message.content.c_str());
+    TEST_ASSERT_EQUAL(Role::User, message.role);
+    TEST_ASSERT_TRUE(log.readMessage(11, message));
+    TEST_ASSERT_EQUAL_STRING("m11", message.content.c_str());
+    TEST_ASSERT_FALSE(log.readMessage(12, message));
+
+    // Replay loads the newest five, but all twelve stay reachable
+    log.close();
+    Conversation again(5);
+    ConversationLog reopened(kPath);
+    TEST_ASSERT_TRUE(reopened.open(again));
+    TEST_ASSERT_EQUAL(5, again.size());
+    TEST_ASSERT_EQUAL(5, reopened.getStats().replayedMessages);
+    TEST_ASSERT_EQUAL_STRING("m7", again.getMessages()[0].content.c_str());
+    TEST_ASSERT_EQUAL(12, reopened.getStoredCount());
+    TEST_ASSERT_TRUE(reopened.readMessage(2, message));
+    TEST_ASSERT_EQUAL_STRING("m2", message.content.c_str());
+}
+
+// --- Compaction Tests ---
+
+void test_compaction_bounds_file() {
+    ConversationLogConfig config;
+    config.compactBytes = 512;
+    config.syncEachWrite = false;
+
+    Conversation conv(6);
+    ConversationLog log(kPath, config);
+    TEST_ASSERT_TRUE(log.open(conv));
+    addTurns(conv, 0, 200);
+
+    TEST_ASSERT_TRUE(log.getStats().compactions > 1);
+    TEST_ASSERT_TRUE(log.getFileSize() < 2 * 512);
+    TEST_ASSERT_EQUAL(fileSize(), (long)log.getFileSize());
+    TEST_ASSERT_TRUE(log.getStoredCount() >= 6);
+    TEST_ASSERT_NOT_EQUAL(0, access((String(kPath) + ".tmp").c_str(), F_OK));  // No temporary file left
+
+    log.close();
+    Conversation again(6);
+    ConversationLog reopened(kPath, config);
+    TEST_ASSERT_TRUE(reopened.open(again));
+    TEST_ASSERT_EQUAL(6, again.size());
+    TEST_ASSERT_EQUAL_STRING("m194", again.getMessages()[0].content.c_str());
+    TEST_ASSERT_EQUAL_STRING("m199", again.getMessages()[5].content.c_str());
+}
+
+void test_from_json_compacts() {
+    Conversation source;
+    source.setSystemPrompt("Loaded");
+    addTurns(source, 0, 3);
+    String json = source.toJson();
+
+    {
+        Conversation conv;
+        ConversationLog log(kPath);
+        TEST_ASSERT_TRUE(log.open(conv));
+        addTurns(conv, 10, 5);
+        uint32_t compactions = log.getStats().compactions;
+        TEST_ASSERT_TRUE(conv.fromJson(json));
+        TEST_ASSERT_EQUAL(compactions + 1, log.getStats().compactions);
+        TEST_ASSERT_EQUAL(3, log.getStoredCount());
+    }
+
+    Conversation conv;
+    ConversationLog log(kPath);
+    TEST_ASSERT_TRUE(log.open(conv));
+    TEST_ASSERT_EQUAL_STRING("Loaded", conv.getSystemPrompt().c_str());
+    TEST_ASSERT_EQUAL(3, conv.size());
+    TEST_ASSERT_EQUAL_STRING("m2", conv.getMessages()[2].content.c_str());
+}
+
+void test_failed_compaction_appends_message() {
+    ConversationLogConfig config;
+    config.compactBytes = 256;
+
+    {
+        Conversation conv(50);
+        ConversationLog log(kPath, config);
+        TEST_ASSERT_TRUE(log.open(conv));
+        uint32_t compactions = log.getStats().compactions;
+        blockCompaction();
+        addTurns(conv, 0, 30);
+
+        TEST_ASSERT_EQUAL(compactions, log.getStats().compactions);
+        TEST_ASSERT_TRUE(log.isDirty());
+        TEST_ASSERT_EQUAL(30, log.getStoredCount());
+        TEST_ASSERT_EQUAL(fileSize(), (long)log.getFileSize());
+
+        // The next write retries the rewrite
+        unblockCompaction();
+        addTurns(conv, 30, 1);
+        TEST_ASSERT_EQUAL(compactions + 1, log.getStats().compactions);
+        TEST_ASSERT_FALSE(log.isDirty());
+    }
+
+    Conversation conv(50);
+    ConversationLog log(kPath, config);
+    TEST_ASSERT_TRUE(log.open(conv));
+    TEST_ASSERT_EQUAL(31, conv.size());
+    TEST_ASSERT_EQUAL_STRING("m30", conv.getMessages()[30].content.c_str());
+}
+
+void test_failed_snapshot_is_appended() {
+    Conversation source;
+    source.setSystemPrompt("Loaded");
+    addTurns(source, 0, 3);
+    String json = source.toJson();
+
+    {
+        Conversation conv;
+        conv.setTokenBudget(1000);
+        ConversationLog log(kPath);
+        TEST_ASSERT_TRUE(log.open(conv));
+        addTurns(conv, 10, 5);
+        blockCompaction();
+
+        conv.setSystemPrompt("Changed");
+        conv.setMaxMessages(4);
+        TEST_ASSERT_TRUE(log.isDirty());
+        TEST_ASSERT_EQUAL(4, log.getStoredCount());
+        log.close();
+    }
+
+    {
+        Conversation conv;
+        ConversationLog log(kPath);
+        TEST_ASSERT_TRUE(log.open(conv));
+        TEST_ASSERT_EQUAL_STRING("Changed", conv.getSystemPrompt().c_str());
+        TEST_ASSERT_EQUAL(4, conv.getMaxMessages());
+        TEST_ASSERT_EQUAL(4, conv.size());
+        TEST_ASSERT_EQUAL_STRING("m11", conv.getMessages()[0].content.c_str());
+
+        TEST_ASSERT_TRUE(conv.fromJson(json));
+        TEST_ASSERT_TRUE(log.isDirty());
+    }
+
+    Conversation conv;
+    ConversationLog log(kPath);
+    TEST_ASSERT_TRUE(log.open(conv));
+    TEST_ASSERT_EQUAL_STRING("Loaded", conv.getSystemPrompt().c_str());
+    TEST_ASSERT_EQUAL(3, conv.size());
+    TEST_ASSERT_EQUAL_STRING("m0", conv.getMessages()[0].content.c_str());
+}
+
+void test_log_recovered_from_temporary_file() {
+    {
+        Conversation conv;
+        ConversationLog log(kPath);
+        TEST_ASSERT_TRUE(log.open(conv));
+        addTurns(conv, 0, 3);
+    }
+
+    // A reset between removing the log and renaming the snapshot (FAT)
+    String tmpPath = String(kPath) + ".tmp";
+    TEST_ASSERT_EQUAL(0, rename(kPath, tmpPath.c_str()));
+
+    Conversation conv;
+    ConversationLog log(kPath);
+    TEST_ASSERT_TRUE(log.open(conv));
+    TEST_ASSERT_EQUAL(3, conv.size());
+    TEST_ASSERT_EQUAL_STRING("m2", conv.getMessages()[2].content.c_str());
+    TEST_ASSERT_NOT_EQUAL(0, access(tmpPath.c_str(), F_OK));
+}
+
+void test_conversation_destroyed_first() {
+    ConversationLog log(kPath);
+    {
+        Conversation conv;
+        TEST_ASSERT_TRUE(log.open(conv));
+        conv.addUserMessage("Bye");
+    }
+    TEST_ASSERT_FALSE(log.compact());
+    log.close();
+    TEST_ASSERT_FALSE(log.isOpen());
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+
+    // Round Trip
+    RUN_TEST(test_new_log_starts_from_conversation);
+    RUN_TEST(test_messages_survive_reopen);
+    RUN_TEST(test_settings_survive_reopen);
+    RUN_TEST(test_clear_is_logged);
+
+    // Append Cost
+    RUN_TEST(test_append_cost_is_one_record);
+
+    // Crash Recovery
+    RUN_TEST(test_torn_tail_is_truncated);
+    RUN_TEST(test_corrupt_record_ends_log);
+    RUN_TEST(test_rejects_foreign_file);
+
+    // Lazy Loading
+    RUN_TEST(test_window_comes_from_log);
+    RUN_TEST(test_older_messages_readable_from_flash);
+
+    // Compaction
+    RUN_TEST(test_compaction_bounds_file);
+    RUN_TEST(test_from_json_compacts);
+    RUN_TEST(test_failed_compaction_appends_message);
+    RUN_TEST(test_failed_snapshot_is_appended);
+    RUN_TEST(test_log_recovered_from_temporary_file);
+    RUN_TEST(test_conversation_destroyed_first);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
@@ -38,6 +38,7 @@ void test_parse_response_basic() {
     TEST_ASSERT_EQUAL_STRING("Hello! How can I help you?", resp.content.c_str());
     TEST_ASSERT_EQUAL(10, resp.promptTokens);
     TEST_ASSERT_EQUAL(8, resp.completionTokens);
+    TEST_ASSERT_EQUAL_STRING("STOP", resp.stopReason.c_str());
 }
 
 void test_parse_response_multiple_text_parts() {
@@ -0,0 +1,186 @@
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "http/HttpResponseParser.h"
+#include "http/HttpExchange.h"
+
+using namespace ESPAI;
+
+// Feeds wire in pieces of at most step bytes; returns the decoded body
+static String decodeAll(HttpResponseParser& parser, const char* wire, size_t step) {
+    String body;
+    size_t length = strlen(wire);
+    uint8_t buffer[64];
+    for (size_t pos = 0; pos < length; pos += step) {
+        size_t len = (length - pos < step) ? length - pos : step;
+        memcpy(buffer, wire + pos, len);
+        size_t out = parser.decode(buffer, len);
+        body.append(reinterpret_cast<const char*>(buffer), out);
+    }
+    return body;
+}
+
+void setUp() {}
+void tearDown() {}
+
+// Framing
+
+void test_content_length_body() {
+    HttpResponseParser parser;
+    String body = decodeAll(parser,
+        "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 7\r\n\r\n{\"a\":1}", 5);
+
+    TEST_ASSERT_TRUE(parser.isDone());
+    TEST_ASSERT_FALSE(parser.hasError());
+    TEST_ASSERT_EQUAL(200, parser.getStatusCode());
+    TEST_ASSERT_EQUAL(7, parser.getContentLength());
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1}", body.c_str());
+}
+
+void test_chunked_body_any_split() {
+    const char* wire =
+        "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+        "5\r\nhello\r\n"
+        "7;ext=1\r\n, world\r\n"
+        "0\r\nX-Trailer: 1\r\n\r\n";
+
+    for (size_t step = 1; step <= 20; step++) {
+        HttpResponseParser parser;
+        String body = decodeAll(parser, wire, step);
+        TEST_ASSERT_TRUE(parser.isDone());
+        TEST_ASSERT_TRUE(parser.isChunked());
+        TEST_ASSERT_EQUAL_STRING("hello, world", body.c_str());
+    }
+}
+
+void test_body_until_close() {
+    HttpResponseParser parser;
+    String body = decodeAll(parser, "HTTP/1.0 200 OK\r\n\r\ndata: x\n\n", 4);
+
+    TEST_ASSERT_FALSE(parser.isDone());
+    parser.onClosed();
+    TEST_ASSERT_TRUE(parser.isDone());
+    TEST_ASSERT_EQUAL_STRING("data: x\n\n", body.c_str());
+}
+
+void test_interim_response_skipped() {
+    HttpResponseParser parser;
+    String body = decodeAll(parser,
+        "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 201 Created\r\nContent-Length: 2\r\n\r\nok", 3);
+
+    TEST_ASSERT_TRUE(parser.isDone());
+    TEST_ASSERT_EQUAL(201, parser.getStatusCode());
+    TEST_ASSERT_EQUAL_STRING("ok", body.c_str());
+}
+
+void test_no_content_has_no_body() {
+    HttpResponseParser parser;
+    decodeAll(parser, "HTTP/1.1 204 No Content\r\n\r\n", 64);
+    TEST_ASSERT_TRUE(parser.isDone());
+}
+
+// Headers and errors
+
+void test_retry_after_header() {
+    HttpResponseParser parser;
+    decodeAll(parser, "HTTP/1.1 429 Too Many Requests\r\nretry-after: 12\r\ncontent-length: 0\r\n\r\n", 64);
+
+    TEST_ASSERT_TRUE(parser.isDone());
+    TEST_ASSERT_EQUAL(429, parser.getStatusCode());
+    TEST_ASSERT_EQUAL(12, parser.getRetryAfterSeconds());
+}
+
+void test_malformed_status_line() {
+    HttpResponseParser parser;
+    decodeAll(parser, "SSH-2.0-OpenSSH\r\n", 64);
+    TEST_ASSERT_TRUE(parser.hasError());
+}
+
+void test_close_before_end_is_error() {
+    HttpResponseParser parser;
+    decodeAll(parser, "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nshort", 64);
+    parser.onClosed();
+
+    TEST_ASSERT_TRUE(parser.hasError());
+    TEST_ASSERT_FALSE(parser.isDone());
+}
+
+void test_reset_allows_reuse() {
+    HttpResponseParser parser;
+    decodeAll(parser, "garbage\r\n", 64);
+    TEST_ASSERT_TRUE(parser.hasError());
+
+    parser.reset();
+    String body = decodeAll(parser, "HTTP/1.1 200 OK\r\nContent-Length: 1\r\n\r\nz", 64);
+    TEST_ASSERT_TRUE(parser.isDone());
+    TEST_ASSERT_EQUAL_STRING("z", body.c_str());
+}
+
+// Request head
+
+void test_parse_url() {
+    HttpUrl url;
+    TEST_ASSERT_TRUE(parseHttpUrl("https://api.openai.com/v1/chat/completions", url));
+    TEST_ASSERT_TRUE(url.https);
+    TEST_ASSERT_EQUAL_STRING("api.openai.com", url.host.c_str());
+    TEST_ASSERT_EQUAL(443, url.port);
+    TEST_ASSERT_EQUAL_STRING("/v1/chat/completions", url.path.c_str());
+
+    TEST_ASSERT_TRUE(parseHttpUrl("http://192.168.1.5:11434", url));
+    TEST_ASSERT_FALSE(url.https);
+    TEST_ASSERT_EQUAL_STRING("192.168.1.5", url.host.c_str());
+    TEST_ASSERT_EQUAL(11434, url.port);
+    TEST_ASSERT_EQUAL_STRING("/", url.path.c_str());
+
+    TEST_ASSERT_FALSE(parseHttpUrl("ftp://example.com/", url));
+    TEST_ASSERT_FALSE(parseHttpUrl("http://host:99999/", url));
+}
+
+void test_request_head() {
+    HttpRequest request;
+    request.url = "http://localhost:8080/api/chat";
+    request.body = "{}";
+    request.headers.push_back({"Authorization", "Bearer k"});
+    HttpUrl url;
+    parseHttpUrl(request.url, url);
+
+    String head = formatHttpRequestHead(request, url, true);
+
+    TEST_ASSERT_EQUAL(0, head.indexOf("POST /api/chat HTTP/1.1\r\n"));
+    TEST_ASSERT_TRUE(head.indexOf("Host: localhost:8080\r\n") > 0);
+    TEST_ASSERT_TRUE(head.indexOf("Accept: text/event-stream\r\n") > 0);
+    TEST_ASSERT_TRUE(head.indexOf("Authorization: Bearer k\r\n") > 0);
+    TEST_ASSERT_TRUE(head.indexOf("Content-Length: 2\r\n\r\n") > 0);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+
+    // Framing
+    RUN_TEST(test_content_length_body);
+    RUN_TEST(test_chunked_body_any_split);
+    RUN_TEST(test_body_until_close);
+    RUN_TEST(test_interim_response_skipped);
+    RUN_TEST(test_no_content_has_no_body);
+
+    // Headers and errors
+    RUN_TEST(test_retry_after_header);
+    RUN_TEST(test_malformed_status_line);
+    RUN_TEST(test_close_before_end_is_error);
+    RUN_TEST(test_reset_allows_reuse);
+
+    // Request head
+    RUN_TEST(test_parse_url);
+    RUN_TEST(test_request_head);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
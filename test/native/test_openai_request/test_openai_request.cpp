@@ -46,6 +46,19 @@ void test_build_request_with_system_message() {
     TEST_ASSERT_TRUE(body.find("\"content\":\"You are helpful\"") != std::string::npos);
 }
 
+void test_build_request_system_prompt_option() {
+    std::vector<Message> messages;
+    messages.push_back(Message(Role::System, "Old prompt"));
+    messages.push_back(Message(Role::User, "Hello"));
+
+    ChatOptions options;
+    options.systemPrompt = "You are a thermostat";
+    String body = provider->buildRequestBody(messages, options);
+
+    TEST_ASSERT_TRUE(body.find("\"messages\":[{\"role\":\"system\",\"content\":\"You are a thermostat\"}") != std::string::npos);
+    TEST_ASSERT_TRUE(body.find("Old prompt") == std::string::npos);
+}
+
 void test_build_request_escapes_special_chars() {
     std::vector<Message> messages;
     messages.push_back(Message(Role::User, "Say \"hello\"\nNew line"));
@@ -506,6 +519,7 @@ int main(int argc, char** argv) {
 
     RUN_TEST(test_build_request_basic);
     RUN_TEST(test_build_request_with_system_message);
+    RUN_TEST(test_build_request_system_prompt_option);
     RUN_TEST(test_build_request_escapes_special_chars);
     RUN_TEST(test_build_request_custom_model_in_options);
     RUN_TEST(test_build_request_multiple_messages);
@@ -41,6 +41,7 @@ void test_parse_response_basic() {
     TEST_ASSERT_EQUAL_STRING("Hello! How can I help you?", resp.content.c_str());
     TEST_ASSERT_EQUAL(10, resp.promptTokens);
     TEST_ASSERT_EQUAL(8, resp.completionTokens);
+    TEST_ASSERT_EQUAL_STRING("stop", resp.stopReason.c_str());
 }
 
 void test_parse_response_with_newlines() {
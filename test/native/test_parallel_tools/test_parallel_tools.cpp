@@ -0,0 +1,434 @@
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "tools/ParallelToolExecutor.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace ESPAI;
+
+static std::atomic<int> running{0};
+static std::atomic<int> maxRunning{0};
+
+static void sleepMs(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+static uint32_t elapsedSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+// Handler that sleeps and records how many handlers overlapped
+static ToolHandler sleepingHandler(uint32_t ms, const char* reply) {
+    String out(reply);
+    return [ms, out](const String& args) -> String {
+        int now = ++running;
+        int prev = maxRunning.load();
+        while (now > prev && !maxRunning.compare_exchange_weak(prev, now)) {}
+        sleepMs(ms);
+        --running;
+        return out + ":" + args;
+    };
+}
+
+// Holds handlers until the test releases them
+struct Latch {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool open = false;
+
+    void release() {
+        std::lock_guard<std::mutex> guard(mutex);
+        open = true;
+        cv.notify_all();
+    }
+    void wait() {
+        std::unique_lock<std::mutex> guard(mutex);
+        cv.wait(guard, [this]() { return open; });
+    }
+};
+
+static Tool blockingTool(const char* name, const std::shared_ptr<Latch>& latch, uint32_t timeoutMs) {
+    Tool tool(name, "test tool", "{}", [latch](const String&) -> String {
+        latch->wait();
+        return "late";
+    });
+    tool.parallelSafe = true;
+    tool.timeoutMs = timeoutMs;
+    return tool;
+}
+
+static Tool makeTool(const char* name, uint32_t ms, bool parallelSafe, uint32_t timeoutMs = 0) {
+    Tool tool(name, "test tool", "{}", sleepingHandler(ms, name));
+    tool.parallelSafe = parallelSafe;
+    tool.timeoutMs = timeoutMs;
+    return tool;
+}
+
+void setUp() {
+    running = 0;
+    maxRunning = 0;
+}
+
+void tearDown() {}
+
+void test_tool_parallel_defaults() {
+    Tool tool("t", "d", "{}");
+    TEST_ASSERT_FALSE(tool.parallelSafe);
+    TEST_ASSERT_EQUAL(0, tool.timeoutMs);
+
+    ToolRegistry registry;
+    TEST_ASSERT_EQUAL(ESPAI_TOOL_WORKERS, registry.getParallelWorkers());
+    registry.setParallelWorkers(4);
+    TEST_ASSERT_EQUAL(4, registry.getParallelWorkers());
+}
+
+void test_parallel_safe_tools_overlap() {
+    ToolRegistry registry;
+    registry.registerTool(makeTool("a", 80, true));
+    registry.registerTool(makeTool("b", 80, true));
+    registry.registerTool(makeTool("c", 80, true));
+    registry.registerTool(makeTool("d", 80, true));
+
+    std::vector<ToolCall> calls = {
+        ToolCall("1", "a", "x"), ToolCall("2", "b", "x"),
+        ToolCall("3", "c", "x"), ToolCall("4", "d", "x")
+    };
+
+    ParallelToolExecutor executor(4);
+    auto start = std::chrono::steady_clock::now();
+    auto results = executor.execute(registry, calls);
+    uint32_t elapsed = elapsedSince(start);
+
+    TEST_ASSERT_EQUAL(4, results.size());
+    TEST_ASSERT_EQUAL(4, executor.getLastWorkerCount());
+    TEST_ASSERT_GREATER_THAN(1, maxRunning.load());
+    TEST_ASSERT_LESS_THAN(250, elapsed);
+}
+
+void test_results_keep_call_order() {
+    ToolRegistry registry;
+    registry.registerTool(makeTool("slow", 60, true));
+    registry.registerTool(makeTool("fast", 1, true));
+
+    std::vector<ToolCall> calls = {
+        ToolCall("call_1", "slow", "a"),
+        ToolCall("call_2", "fast", "b"),
+        ToolCall("call_3", "fast", "c")
+    };
+
+    ParallelToolExecutor executor(3);
+    auto results = executor.execute(registry, calls);
+
+    TEST_ASSERT_EQUAL(3, results.size());
+    TEST_ASSERT_EQUAL_STRING("call_1", results[0].toolCallId.c_str());
+    TEST_ASSERT_EQUAL_STRING("slow:a", results[0].result.c_str());
+    TEST_ASSERT_EQUAL_STRING("call_2", results[1].toolCallId.c_str());
+    TEST_ASSERT_EQUAL_STRING("fast:b", results[1].result.c_str());
+    TEST_ASSERT_EQUAL_STRING("call_3", results[2].toolCallId.c_str());
+    TEST_ASSERT_EQUAL_STRING("fast", results[2].toolName.c_str());
+    TEST_ASSERT_TRUE(results[2].success);
+}
+
+void test_worker_count_is_bounded() {
+    ToolRegistry registry;
+    registry.registerTool(makeTool("t", 20, true));
+
+    std::vector<ToolCall> calls;
+    for (int i = 0; i < 6; i++) {
+        calls.push_back(ToolCall(String("id") + String(i), "t", ""));
+    }
+
+    ParallelToolExecutor executor(2);
+    auto results = executor.execute(registry, calls);
+
+    TEST_ASSERT_EQUAL(6, results.size());
+    TEST_ASSERT_EQUAL(2, executor.getLastWorkerCount());
+    TEST_ASSERT_LESS_OR_EQUAL(2, maxRunning.load());
+    for (const auto& r : results) {
+        TEST_ASSERT_TRUE(r.success);
+    }
+}
+
+void test_unsafe_tools_run_alone() {
+    ToolRegistry registry;
+    registry.registerTool(makeTool("safe", 30, true));
+    registry.registerTool(makeTool("unsafe", 30, false));
+
+    std::vector<ToolCall> calls = {
+        ToolCall("1", "unsafe", ""), ToolCall("2", "safe", ""),
+        ToolCall("3", "unsafe", ""), ToolCall("4", "safe", "")
+    };
+
+    ParallelToolExecutor executor(4);
+    auto results = executor.execute(registry, calls);
+
+    TEST_ASSERT_EQUAL(2, executor.getLastWorkerCount());
+    TEST_ASSERT_EQUAL_STRING("1", results[0].toolCallId.c_str());
+    TEST_ASSERT_EQUAL_STRING("unsafe:", results[0].result.c_str());
+    TEST_ASSERT_EQUAL_STRING("4", results[3].toolCallId.c_str());
+    // Only the two safe calls ever overlapped
+    TEST_ASSERT_EQUAL(2, maxRunning.load());
+}
+
+void test_zero_workers_runs_sequentially() {
+    ToolRegistry registry;
+    registry.registerTool(makeTool("a", 10, true));
+    registry.registerTool(makeTool("b", 10, true));
+
+    ParallelToolExecutor executor(0);
+    auto results = executor.execute(registry, {ToolCall("1", "a", ""), ToolCall("2", "b", "")});
+
+    TEST_ASSERT_EQUAL(2, results.size());
+    TEST_ASSERT_EQUAL(0, executor.getLastWorkerCount());
+    TEST_ASSERT_EQUAL(1, maxRunning.load());
+}
+
+void test_timeout_returns_error() {
+    auto latch = std::make_shared<Latch>();
+    ToolRegistry registry;
+    registry.registerTool(blockingTool("hang", latch, 30));
+    registry.registerTool(makeTool("ok", 1, true));
+
+    ParallelToolExecutor executor(2);
+    auto start = std::chrono::steady_clock::now();
+    auto results = executor.execute(registry, {ToolCall("1", "hang", ""), ToolCall("2", "ok", "")});
+    uint32_t elapsed = elapsedSince(start);
+
+    TEST_ASSERT_LESS_THAN(200, elapsed);
+    TEST_ASSERT_FALSE(results[0].success);
+    TEST_ASSERT_EQUAL_STRING("1", results[0].toolCallId.c_str());
+    TEST_ASSERT_TRUE(results[0].result.indexOf("timed out") >= 0);
+    TEST_ASSERT_TRUE(results[1].success);
+    TEST_ASSERT_EQUAL(1, executor.getLastTimeoutCount());
+
+    // The registry's destructor waits for the abandoned handler
+    latch->release();
+}
+
+void test_default_timeout_applies() {
+    auto latch = std::make_shared<Latch>();
+    ToolRegistry registry;
+    registry.registerTool(blockingTool("hang", latch, 0));
+
+    ParallelToolExecutor executor(1);
+    executor.setDefaultTimeout(20);
+    TEST_ASSERT_EQUAL(20, executor.getDefaultTimeout());
+
+    auto results = executor.execute(registry, {ToolCall("1", "hang", "")});
+    TEST_ASSERT_FALSE(results[0].success);
+    TEST_ASSERT_EQUAL(1, executor.getLastTimeoutCount());
+
+    latch->release();
+}
+
+void test_timed_out_job_not_started_is_skipped() {
+    auto latch = std::make_shared<Latch>();
+    auto calls = std::make_shared<std::atomic<int>>(0);
+    Tool queued("queued", "d", "{}", [calls](const String&) -> String {
+        ++(*calls);
+        return "ran";
+    });
+    queued.parallelSafe = true;
+    queued.timeoutMs = 20;
+
+    {
+        ToolRegistry registry;
+        registry.registerTool(blockingTool("hang", latch, 20));
+        registry.registerTool(queued);
+
+        // One worker, held by "hang" until both calls have timed out
+        ParallelToolExecutor executor(1);
+        auto results = executor.execute(registry, {ToolCall("1", "hang", ""), ToolCall("2", "queued", "")});
+        TEST_ASSERT_FALSE(results[0].success);
+        TEST_ASSERT_FALSE(results[1].success);
+        TEST_ASSERT_EQUAL(2, executor.getLastTimeoutCount());
+
+        latch->release();
+    }
+    // The worker has been joined, so "queued" had its chance to run
+    TEST_ASSERT_EQUAL(0, calls->load());
+}
+
+void test_registry_waits_for_timed_out_handler() {
+    auto finished = std::make_shared<std::atomic<bool>>(false);
+    {
+        Tool slow("slow", "d", "{}", [finished](const String&) -> String {
+            sleepMs(50);
+            *finished = true;
+            return "done";
+        });
+        slow.parallelSafe = true;
+        slow.timeoutMs = 5;
+
+        ToolRegistry registry;
+        registry.registerTool(slow);
+        ParallelToolExecutor executor(1);
+        auto results = executor.execute(registry, {ToolCall("1", "slow", "")});
+        TEST_ASSERT_FALSE(results[0].success);
+    }
+    TEST_ASSERT_TRUE(finished->load());
+}
+
+// Worker pool
+
+void test_workers_persist_across_calls() {
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    Tool tool("t", "d", "{}", [&mutex, &threads](const String&) -> String {
+        std::lock_guard<std::mutex> guard(mutex);
+        threads.insert(std::this_thread::get_id());
+        return "ok";
+    });
+    tool.parallelSafe = true;
+
+    ToolRegistry registry;
+    registry.registerTool(tool);
+    ParallelToolExecutor executor(2);
+    std::vector<ToolCall> calls;
+    for (int i = 0; i < 4; i++) {
+        calls.push_back(ToolCall(String("id") + String(i), "t", ""));
+    }
+
+    for (int round = 0; round < 5; round++) {
+        auto results = executor.execute(registry, calls);
+        TEST_ASSERT_EQUAL(4, results.size());
+        TEST_ASSERT_EQUAL(2, registry.getWorkerPool().getWorkerCount());
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(2, threads.size());
+    TEST_ASSERT_TRUE(threads.find(std::this_thread::get_id()) == threads.end());
+}
+
+void test_pool_grows_to_largest_request() {
+    ToolRegistry registry;
+    registry.registerTool(makeTool("t", 1, true));
+    TEST_ASSERT_EQUAL(0, registry.getWorkerPool().getWorkerCount());
+
+    ParallelToolExecutor two(2);
+    two.execute(registry, {ToolCall("1", "t", ""), ToolCall("2", "t", "")});
+    TEST_ASSERT_EQUAL(2, registry.getWorkerPool().getWorkerCount());
+
+    ParallelToolExecutor three(3);
+    three.execute(registry, {ToolCall("1", "t", ""), ToolCall("2", "t", ""), ToolCall("3", "t", "")});
+    TEST_ASSERT_EQUAL(3, registry.getWorkerPool().getWorkerCount());
+
+    two.execute(registry, {ToolCall("1", "t", ""), ToolCall("2", "t", "")});
+    TEST_ASSERT_EQUAL(3, registry.getWorkerPool().getWorkerCount());
+}
+
+// Incremental submission
+
+void test_submit_does_not_run_handlers_on_caller() {
+    auto latch = std::make_shared<Latch>();
+    auto serialRuns = std::make_shared<std::atomic<int>>(0);
+    ToolRegistry registry;
+    registry.registerTool(blockingTool("hang", latch, 0));
+    registry.registerTool(Tool("serial", "d", "{}", [serialRuns](const String&) -> String {
+        ++(*serialRuns);
+        return "serial";
+    }));
+
+    ParallelToolExecutor executor(2);
+    executor.submit(registry, ToolCall("1", "hang", ""));
+    executor.submit(registry, ToolCall("2", "serial", ""));
+    // Returned although "hang" is blocked; "serial" waits for collect()
+    TEST_ASSERT_EQUAL(2, executor.getSubmittedCount());
+    TEST_ASSERT_EQUAL(0, serialRuns->load());
+
+    latch->release();
+    auto results = executor.collect();
+    TEST_ASSERT_EQUAL(2, results.size());
+    TEST_ASSERT_EQUAL_STRING("1", results[0].toolCallId.c_str());
+    TEST_ASSERT_EQUAL_STRING("late", results[0].result.c_str());
+    TEST_ASSERT_EQUAL_STRING("2", results[1].toolCallId.c_str());
+    TEST_ASSERT_EQUAL_STRING("serial", results[1].result.c_str());
+    TEST_ASSERT_EQUAL(1, serialRuns->load());
+    TEST_ASSERT_EQUAL(0, executor.getSubmittedCount());
+}
+
+void test_collect_applies_timeouts() {
+    auto latch = std::make_shared<Latch>();
+    ToolRegistry registry;
+    registry.registerTool(blockingTool("hang", latch, 20));
+    registry.registerTool(makeTool("ok", 1, true));
+
+    ParallelToolExecutor executor(2);
+    executor.submit(registry, ToolCall("1", "hang", ""));
+    executor.submit(registry, ToolCall("2", "ok", ""));
+    auto results = executor.collect();
+
+    TEST_ASSERT_FALSE(results[0].success);
+    TEST_ASSERT_TRUE(results[0].result.indexOf("timed out") >= 0);
+    TEST_ASSERT_TRUE(results[1].success);
+    TEST_ASSERT_EQUAL(1, executor.getLastTimeoutCount());
+
+    latch->release();
+}
+
+void test_unknown_tool_reports_error() {
+    ToolRegistry registry;
+    registry.registerTool(makeTool("a", 1, true));
+
+    ParallelToolExecutor executor(2);
+    auto results = executor.execute(registry, {ToolCall("1", "missing", ""), ToolCall("2", "a", "")});
+
+    TEST_ASSERT_FALSE(results[0].success);
+    TEST_ASSERT_EQUAL_STRING("1", results[0].toolCallId.c_str());
+    TEST_ASSERT_TRUE(results[0].result.indexOf("not found") >= 0);
+    TEST_ASSERT_TRUE(results[1].success);
+}
+
+void test_empty_calls() {
+    ToolRegistry registry;
+    ParallelToolExecutor executor;
+    auto results = executor.execute(registry, {});
+    TEST_ASSERT_EQUAL(0, results.size());
+    TEST_ASSERT_EQUAL(0, executor.getLastWorkerCount());
+}
+
+int main() {
+    UNITY_BEGIN();
+
+    // Configuration
+    RUN_TEST(test_tool_parallel_defaults);
+
+    // Parallel execution
+    RUN_TEST(test_parallel_safe_tools_overlap);
+    RUN_TEST(test_results_keep_call_order);
+    RUN_TEST(test_worker_count_is_bounded);
+    RUN_TEST(test_unsafe_tools_run_alone);
+    RUN_TEST(test_zero_workers_runs_sequentially);
+
+    // Timeouts
+    RUN_TEST(test_timeout_returns_error);
+    RUN_TEST(test_default_timeout_applies);
+    RUN_TEST(test_timed_out_job_not_started_is_skipped);
+    RUN_TEST(test_registry_waits_for_timed_out_handler);
+
+    // Worker pool
+    RUN_TEST(test_workers_persist_across_calls);
+    RUN_TEST(test_pool_grows_to_largest_request);
+
+    // Incremental submission
+    RUN_TEST(test_submit_does_not_run_handlers_on_caller);
+    RUN_TEST(test_collect_applies_timeouts);
+
+    // Errors
+    RUN_TEST(test_unknown_tool_reports_error);
+    RUN_TEST(test_empty_calls);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
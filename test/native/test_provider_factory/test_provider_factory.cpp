@@ -23,7 +23,7 @@ public:
 
 protected:
     String buildRequestBody(
-        const std::vector<ESPAI::Message>& messages,
+        ESPAI::MessageView messages,
         const ESPAI::ChatOptions& options
     ) override {
         (void)messages;
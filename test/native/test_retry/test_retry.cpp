@@ -16,7 +16,7 @@ public:
 #endif
 
     String buildRequestBody(
-        const std::vector<Message>&,
+        MessageView,
         const ChatOptions&
     ) override {
         return "{}";
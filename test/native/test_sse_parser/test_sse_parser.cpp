@@ -452,6 +452,63 @@ void test_timeout_configuration() {
     TEST_ASSERT_EQUAL(5000, parser->getTimeout());
 }
 
+// Usage tests
+
+void test_openai_stream_usage_chunk() {
+    parser->setFormat(SSEFormat::OpenAI);
+
+    parser->feed("data: {\"choices\":[{\"delta\":{\"content\":\"Hi\"},\"finish_reason\":null}]}\n\n");
+    parser->feed("data: {\"choices\":[{\"delta\":{},\"finish_reason\":\"stop\"}]}\n\n");
+    parser->feed("data: {\"choices\":[],\"usage\":{\"prompt_tokens\":12,\"completion_tokens\":5,\"total_tokens\":17}}\n\n");
+    parser->feed("data: [DONE]\n\n");
+
+    TEST_ASSERT_TRUE(parser->isDone());
+    TEST_ASSERT_EQUAL(12, parser->getPromptTokens());
+    TEST_ASSERT_EQUAL(5, parser->getCompletionTokens());
+    TEST_ASSERT_EQUAL_STRING("stop", parser->getStopReason().c_str());
+}
+
+void test_anthropic_stream_usage() {
+    parser->setFormat(SSEFormat::Anthropic);
+
+    parser->feed("event: message_start\ndata: {\"type\":\"message_start\",\"message\":{\"usage\":{\"input_tokens\":25,\"output_tokens\":1}}}\n\n");
+    parser->feed("event: content_block_delta\ndata: {\"type\":\"content_block_delta\",\"delta\":{\"type\":\"text_delta\",\"text\":\"Hi\"}}\n\n");
+    TEST_ASSERT_EQUAL(25, parser->getPromptTokens());
+    TEST_ASSERT_EQUAL(1, parser->getCompletionTokens());
+
+    parser->feed("event: message_delta\ndata: {\"type\":\"message_delta\",\"delta\":{\"stop_reason\":\"end_turn\"},\"usage\":{\"output_tokens\":15}}\n\n");
+    parser->feed("event: message_stop\ndata: {\"type\":\"message_stop\"}\n\n");
+
+    TEST_ASSERT_TRUE(parser->isDone());
+    TEST_ASSERT_EQUAL(25, parser->getPromptTokens());
+    TEST_ASSERT_EQUAL(15, parser->getCompletionTokens());
+    TEST_ASSERT_EQUAL_STRING("end_turn", parser->getStopReason().c_str());
+    TEST_ASSERT_EQUAL_STRING("Hi", parser->getAccumulatedContent().c_str());
+}
+
+void test_gemini_stream_usage() {
+    parser->setFormat(SSEFormat::Gemini);
+
+    parser->feed("data: {\"candidates\":[{\"content\":{\"parts\":[{\"text\":\"Hi\"}]}}],\"usageMetadata\":{\"promptTokenCount\":8,\"candidatesTokenCount\":1}}\n\n");
+    parser->feed("data: {\"candidates\":[{\"content\":{\"parts\":[{\"text\":\"!\"}]},\"finishReason\":\"STOP\"}],\"usageMetadata\":{\"promptTokenCount\":8,\"candidatesTokenCount\":3}}\n\n");
+
+    TEST_ASSERT_TRUE(parser->isDone());
+    TEST_ASSERT_EQUAL(8, parser->getPromptTokens());
+    TEST_ASSERT_EQUAL(3, parser->getCompletionTokens());
+    TEST_ASSERT_EQUAL_STRING("STOP", parser->getStopReason().c_str());
+}
+
+void test_usage_cleared_on_reset() {
+    parser->setFormat(SSEFormat::OpenAI);
+    parser->feed("data: {\"choices\":[],\"usage\":{\"prompt_tokens\":3,\"completion_tokens\":4}}\n\n");
+    TEST_ASSERT_EQUAL(3, parser->getPromptTokens());
+
+    parser->reset();
+    TEST_ASSERT_EQUAL(0, parser->getPromptTokens());
+    TEST_ASSERT_EQUAL(0, parser->getCompletionTokens());
+    TEST_ASSERT_TRUE(parser->getStopReason().isEmpty());
+}
+
 #if ESPAI_ENABLE_TOOLS
 
 static std::vector<ToolCall> toolCallResults;
@@ -668,6 +725,118 @@ void test_tool_calls_cleared_on_reset() {
     TEST_ASSERT_EQUAL(0, parser->getToolCalls().size());
 }
 
+// Early tool call reporting
+
+void test_openai_tool_call_reported_when_next_starts() {
+    resetToolCallResults();
+    parser->setFormat(SSEFormat::OpenAI);
+    parser->setToolCallCallback(toolCallCallback);
+
+    parser->feed("data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":0,\"id\":\"call_1\",\"type\":\"function\",\"function\":{\"name\":\"a\",\"arguments\":\"{}\"}}]}}]}\n\n");
+    TEST_ASSERT_EQUAL(0, toolCallResults.size());
+
+    parser->feed("data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":1,\"id\":\"call_2\",\"type\":\"function\",\"function\":{\"name\":\"b\",\"arguments\":\"{}\"}}]}}]}\n\n");
+    TEST_ASSERT_EQUAL(1, toolCallResults.size());
+    TEST_ASSERT_EQUAL_STRING("call_1", toolCallResults[0].id.c_str());
+
+    parser->feed("data: {\"choices\":[{\"delta\":{},\"finish_reason\":\"tool_calls\"}]}\n\n");
+    TEST_ASSERT_EQUAL(2, toolCallResults.size());
+    TEST_ASSERT_EQUAL_STRING("call_2", toolCallResults[1].id.c_str());
+
+    // [DONE] must not report them again
+    parser->feed("data: [DONE]\n\n");
+    TEST_ASSERT_EQUAL(2, toolCallResults.size());
+}
+
+void test_openai_finish_reason_in_same_chunk_as_arguments() {
+    resetToolCallResults();
+    parser->setFormat(SSEFormat::OpenAI);
+    parser->setToolCallCallback(toolCallCallback);
+
+    parser->feed("data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":0,\"id\":\"call_1\",\"type\":\"function\",\"function\":{\"name\":\"a\",\"arguments\":\"{\\\"x\\\"\"}}]}}]}\n\n");
+    parser->feed("data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":0,\"function\":{\"arguments\":\":1}\"}}]},\"finish_reason\":\"tool_calls\"}]}\n\n");
+
+    TEST_ASSERT_EQUAL(1, toolCallResults.size());
+    TEST_ASSERT_EQUAL_STRING("{\"x\":1}", toolCallResults[0].arguments.c_str());
+}
+
+void test_gemini_tool_call_reported_before_finish() {
+    resetToolCallResults();
+    parser->setFormat(SSEFormat::Gemini);
+    parser->setToolCallCallback(toolCallCallback);
+
+    parser->feed("data: {\"candidates\":[{\"content\":{\"parts\":[{\"functionCall\":{\"name\":\"a\",\"args\":{}}}]}}]}\n\n");
+    TEST_ASSERT_EQUAL(1, toolCallResults.size());
+
+    parser->feed("data: {\"candidates\":[{\"content\":{\"parts\":[{\"text\":\"\"}]},\"finishReason\":\"STOP\"}]}\n\n");
+    TEST_ASSERT_EQUAL(1, toolCallResults.size());
+}
+
+// Streaming tool arguments
+
+struct ArgumentField {
+    String id;
+    String key;
+    String value;
+};
+
+static std::vector<ArgumentField> argumentFields;
+
+void toolArgumentCallback(const String& id, const String& name, const String& key, const String& value) {
+    (void)name;
+    argumentFields.push_back({id, key, value});
+}
+
+void test_openai_stream_argument_fields_before_done() {
+    argumentFields.clear();
+    parser->setFormat(SSEFormat::OpenAI);
+    parser->setToolArgumentCallback(toolArgumentCallback);
+
+    parser->feed("data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":0,\"id\":\"call_s\",\"type\":\"function\",\"function\":{\"name\":\"set_led\",\"arguments\":\"\"}}]}}]}\n\n");
+    parser->feed("data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":0,\"function\":{\"arguments\":\"{\\\"color\\\":\\\"re\"}}]}}]}\n\n");
+    TEST_ASSERT_EQUAL(0, argumentFields.size());
+
+    parser->feed("data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":0,\"function\":{\"arguments\":\"d\\\",\\\"level\\\":\"}}]}}]}\n\n");
+    TEST_ASSERT_EQUAL(1, argumentFields.size());
+    TEST_ASSERT_EQUAL_STRING("call_s", argumentFields[0].id.c_str());
+    TEST_ASSERT_EQUAL_STRING("color", argumentFields[0].key.c_str());
+    TEST_ASSERT_EQUAL_STRING("\"red\"", argumentFields[0].value.c_str());
+
+    parser->feed("data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":0,\"function\":{\"arguments\":\"80}\"}}]}}]}\n\n");
+    TEST_ASSERT_EQUAL(2, argumentFields.size());
+    TEST_ASSERT_EQUAL_STRING("level", argumentFields[1].key.c_str());
+    TEST_ASSERT_EQUAL_STRING("80", argumentFields[1].value.c_str());
+    TEST_ASSERT_FALSE(parser->isDone());
+}
+
+void test_anthropic_stream_argument_fields() {
+    argumentFields.clear();
+    parser->setFormat(SSEFormat::Anthropic);
+    parser->setToolArgumentCallback(toolArgumentCallback);
+
+    parser->feed("event: content_block_start\ndata: {\"type\":\"content_block_start\",\"index\":0,\"content_block\":{\"type\":\"tool_use\",\"id\":\"toolu_s\",\"name\":\"move\",\"input\":{}}}\n\n");
+    parser->feed("event: content_block_delta\ndata: {\"type\":\"content_block_delta\",\"index\":0,\"delta\":{\"type\":\"input_json_delta\",\"partial_json\":\"{\\\"servo\\\": {\\\"angle\\\": 90}\"}}\n\n");
+
+    TEST_ASSERT_EQUAL(1, argumentFields.size());
+    TEST_ASSERT_EQUAL_STRING("toolu_s", argumentFields[0].id.c_str());
+    TEST_ASSERT_EQUAL_STRING("servo", argumentFields[0].key.c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"angle\": 90}", argumentFields[0].value.c_str());
+}
+
+void test_gemini_stream_argument_fields() {
+    argumentFields.clear();
+    parser->setFormat(SSEFormat::Gemini);
+    parser->setToolArgumentCallback(toolArgumentCallback);
+
+    parser->feed("data: {\"candidates\":[{\"content\":{\"parts\":[{\"functionCall\":{\"name\":\"set_led\",\"args\":{\"color\":\"blue\",\"on\":true}}}]}}]}\n\n");
+
+    TEST_ASSERT_EQUAL(2, argumentFields.size());
+    TEST_ASSERT_EQUAL_STRING("gemini_tc_0", argumentFields[0].id.c_str());
+    TEST_ASSERT_EQUAL_STRING("\"blue\"", argumentFields[0].value.c_str());
+    TEST_ASSERT_EQUAL_STRING("on", argumentFields[1].key.c_str());
+    TEST_ASSERT_EQUAL_STRING("true", argumentFields[1].value.c_str());
+}
+
 #endif // ESPAI_ENABLE_TOOLS
 
 int main(int argc, char** argv) {
@@ -747,6 +916,12 @@ int main(int argc, char** argv) {
     // Timeout
     RUN_TEST(test_timeout_configuration);
 
+    // Usage
+    RUN_TEST(test_openai_stream_usage_chunk);
+    RUN_TEST(test_anthropic_stream_usage);
+    RUN_TEST(test_gemini_stream_usage);
+    RUN_TEST(test_usage_cleared_on_reset);
+
 #if ESPAI_ENABLE_TOOLS
     // Streaming tool calls - OpenAI
     RUN_TEST(test_openai_stream_single_tool_call);
@@ -766,6 +941,16 @@ int main(int argc, char** argv) {
 
     // Tool call reset
     RUN_TEST(test_tool_calls_cleared_on_reset);
+
+    // Early tool call reporting
+    RUN_TEST(test_openai_tool_call_reported_when_next_starts);
+    RUN_TEST(test_openai_finish_reason_in_same_chunk_as_arguments);
+    RUN_TEST(test_gemini_tool_call_reported_before_finish);
+
+    // Streaming tool arguments
+    RUN_TEST(test_openai_stream_argument_fields_before_done);
+    RUN_TEST(test_anthropic_stream_argument_fields);
+    RUN_TEST(test_gemini_stream_argument_fields);
 #endif
 
     return UNITY_END();
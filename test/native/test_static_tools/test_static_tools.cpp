@@ -0,0 +1,232 @@
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "tools/StaticToolTable.h"
+#include "tools/ToolRegistry.h"
+#include "providers/OpenAIProvider.h"
+#include "providers/AnthropicProvider.h"
+#include <ArduinoJson.h>
+
+using namespace ESPAI;
+
+static bool readTemperature(JsonVariantConst args, JsonObject result) {
+    const char* room = args["room"] | "unknown";
+    result["room"] = room;
+    result["celsius"] = 21.5;
+    return true;
+}
+
+static bool setLed(JsonVariantConst args, JsonObject result) {
+    if (!args["on"].is<bool>()) {
+        result["error"] = "on is required";
+        return false;
+    }
+    result["on"] = args["on"].as<bool>();
+    return true;
+}
+
+constexpr StaticTool kTools[] ESPAI_PROGMEM = {
+    {"get_temperature", "Read a room temperature",
+     R"({"type":"object","properties":{"room":{"type":"string"}}})", readTemperature},
+    {"set_led", "Switch the LED", R"({"type":"object","properties":{"on":{"type":"boolean"}}})", setLed},
+    {"reboot", "Reboot the device", "", nullptr},
+};
+
+constexpr auto kToolTable = makeStaticToolTable(kTools);
+
+// The table is built by the compiler
+static_assert(kToolTable.size() == 3, "table size");
+static_assert(decltype(kToolTable)::kSlots == 8, "slot count");
+
+#define NAME_10(p) p "0", p "1", p "2", p "3", p "4", p "5", p "6", p "7", p "8", p "9"
+constexpr const char* kManyNames[] = {
+    NAME_10("sensor_a"), NAME_10("sensor_b"), NAME_10("relay_"), NAME_10("gpio_"), NAME_10("adc_"),
+    NAME_10("pwm_"), NAME_10("i2c_read_"), NAME_10("i2c_write_"), NAME_10("cfg_get_"), NAME_10("cfg_set_"),
+};
+#define TOOL_1(i) {kManyNames[i], "d", "{}", readTemperature}
+#define TOOLS_10(b) TOOL_1(b + 0), TOOL_1(b + 1), TOOL_1(b + 2), TOOL_1(b + 3), TOOL_1(b + 4), \
+                    TOOL_1(b + 5), TOOL_1(b + 6), TOOL_1(b + 7), TOOL_1(b + 8), TOOL_1(b + 9)
+constexpr StaticTool kManyTools[] = {
+    TOOLS_10(0), TOOLS_10(10), TOOLS_10(20), TOOLS_10(30), TOOLS_10(40),
+    TOOLS_10(50), TOOLS_10(60), TOOLS_10(70), TOOLS_10(80), TOOLS_10(90),
+};
+constexpr auto kManyTable = makeStaticToolTable(kManyTools);
+
+void setUp() {}
+void tearDown() {}
+
+void test_find_each_tool() {
+    TEST_ASSERT_EQUAL_STRING("get_temperature", kToolTable.find("get_temperature")->name);
+    TEST_ASSERT_EQUAL_STRING("set_led", kToolTable.find("set_led")->name);
+    TEST_ASSERT_EQUAL_STRING("reboot", kToolTable.find("reboot")->name);
+}
+
+void test_find_unknown_returns_null() {
+    TEST_ASSERT_NULL(kToolTable.find("missing"));
+    TEST_ASSERT_NULL(kToolTable.find("set_le"));
+    TEST_ASSERT_NULL(kToolTable.find("set_ledd"));
+    TEST_ASSERT_NULL(kToolTable.find(""));
+}
+
+void test_hundred_tools_all_found() {
+    TEST_ASSERT_EQUAL(100, kManyTable.size());
+    for (size_t i = 0; i < 100; i++) {
+        const StaticTool* tool = kManyTable.find(kManyNames[i]);
+        TEST_ASSERT_NOT_NULL(tool);
+        TEST_ASSERT_EQUAL_STRING(kManyNames[i], tool->name);
+    }
+    TEST_ASSERT_NULL(kManyTable.find("sensor_c0"));
+}
+
+void test_to_tool_copies_fields() {
+    Tool tool = kTools[0].toTool();
+    TEST_ASSERT_EQUAL_STRING("get_temperature", tool.name.c_str());
+    TEST_ASSERT_EQUAL_STRING("Read a room temperature", tool.description.c_str());
+    TEST_ASSERT_TRUE(tool.parametersJson.indexOf("room") >= 0);
+}
+
+void test_registry_executes_static_tool() {
+    ToolRegistry registry;
+    registry.setStaticTools(kToolTable.view());
+
+    TEST_ASSERT_TRUE(registry.hasTool("set_led"));
+    TEST_ASSERT_EQUAL(0, registry.toolCount());
+
+    ToolResult result = registry.execute(ToolCall("call_1", "get_temperature", "{\"room\":\"kitchen\"}"));
+    TEST_ASSERT_TRUE(result.success);
+    TEST_ASSERT_EQUAL_STRING("call_1", result.toolCallId.c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"room\":\"kitchen\",\"celsius\":21.5}", result.result.c_str());
+
+    ToolResult failed = registry.execute(ToolCall("call_2", "set_led", "{}"));
+    TEST_ASSERT_FALSE(failed.success);
+
+    TEST_ASSERT_EQUAL_STRING("{\"on\":true}", registry.executeToolCall("set_led", "{\"on\":true}").c_str());
+}
+
+void test_registry_static_tool_without_handler() {
+    ToolRegistry registry;
+    registry.setStaticTools(kToolTable.view());
+
+    ToolResult result = registry.execute(ToolCall("call_1", "reboot", "{}"));
+    TEST_ASSERT_FALSE(result.success);
+    TEST_ASSERT_TRUE(result.result.indexOf("no handler") >= 0);
+}
+
+void test_registry_mixes_runtime_and_static() {
+    ToolRegistry registry;
+    registry.setStaticTools(kToolTable.view());
+    registry.registerTool(Tool("echo", "Echo", "{}", [](const String& args) -> String { return args; }));
+
+    TEST_ASSERT_EQUAL_STRING("{\"x\":1}", registry.executeToolCall("echo", "{\"x\":1}").c_str());
+    TEST_ASSERT_TRUE(registry.execute(ToolCall("1", "get_temperature", "{}")).success);
+
+    // Static names cannot be taken by runtime tools
+    TEST_ASSERT_FALSE(registry.registerTool(Tool("set_led", "Other", "{}")));
+}
+
+void test_registry_schema_includes_static_tools() {
+    ToolRegistry registry;
+    registry.setStaticTools(kToolTable.view());
+    registry.registerTool(Tool("echo", "Echo", "{}"));
+
+    JsonDocument openai;
+    deserializeJson(openai, registry.toOpenAISchema());
+    TEST_ASSERT_EQUAL(4, openai.size());
+    TEST_ASSERT_EQUAL_STRING("echo", openai[0]["function"]["name"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("get_temperature", openai[1]["function"]["name"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("object", openai[1]["function"]["parameters"]["type"].as<const char*>());
+    TEST_ASSERT_TRUE(openai[3]["function"]["parameters"].isNull());
+
+    JsonDocument anthropic;
+    deserializeJson(anthropic, registry.toAnthropicSchema());
+    TEST_ASSERT_EQUAL(4, anthropic.size());
+    TEST_ASSERT_EQUAL_STRING("set_led", anthropic[2]["name"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("object", anthropic[2]["input_schema"]["type"].as<const char*>());
+}
+
+void test_provider_serializes_static_tools_past_cap() {
+    ToolRegistry registry;
+    registry.setStaticTools(kManyTable.view());
+
+    OpenAIProvider provider("key", "gpt-4.1-mini");
+    for (size_t i = 0; i < kManyTable.size(); i++) {
+        provider.addStaticTool(kManyTools[i], registry.getToolSchema(kManyTools[i].name, provider.getSchemaDialect()));
+    }
+    TEST_ASSERT_TRUE(provider.addTool(Tool("echo", "Echo", "{}")));
+
+    std::vector<Message> messages;
+    messages.push_back(Message(Role::User, "Hi"));
+    JsonDocument doc;
+    deserializeJson(doc, provider.buildRequestBody(messages, ChatOptions()));
+    TEST_ASSERT_EQUAL(kManyTable.size() + 1, doc["tools"].size());
+    TEST_ASSERT_EQUAL_STRING("echo", doc["tools"][0]["function"]["name"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("cfg_set_9", doc["tools"][100]["function"]["name"].as<const char*>());
+}
+
+void test_provider_static_tool_fields() {
+    AnthropicProvider provider("key", "claude-sonnet-4-5");
+    provider.addStaticTool(kTools[0], R"({"type":"object","properties":{"room":{"type":"string"}}})");
+    provider.addStaticTool(kTools[2], "");
+
+    std::vector<Message> messages;
+    messages.push_back(Message(Role::User, "Hi"));
+    JsonDocument doc;
+    deserializeJson(doc, provider.buildRequestBody(messages, ChatOptions()));
+    TEST_ASSERT_EQUAL(2, doc["tools"].size());
+    TEST_ASSERT_EQUAL_STRING("get_temperature", doc["tools"][0]["name"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("Read a room temperature", doc["tools"][0]["description"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("object", doc["tools"][0]["input_schema"]["type"].as<const char*>());
+    TEST_ASSERT_TRUE(doc["tools"][1]["input_schema"].isNull());
+
+    provider.clearTools();
+    deserializeJson(doc, provider.buildRequestBody(messages, ChatOptions()));
+    TEST_ASSERT_TRUE(doc["tools"].isNull());
+}
+
+void test_provider_runtime_tools_capped() {
+    OpenAIProvider provider("key", "gpt-4.1-mini");
+    for (int i = 0; i < ESPAI_MAX_TOOLS; i++) {
+        TEST_ASSERT_TRUE(provider.addTool(Tool(String("t") + String(i), "d", "{}")));
+    }
+    TEST_ASSERT_FALSE(provider.addTool(Tool("overflow", "d", "{}")));
+}
+
+void test_empty_view() {
+    StaticToolTableView view;
+    TEST_ASSERT_EQUAL(0, view.size());
+    TEST_ASSERT_NULL(view.find(String("anything")));
+
+    ToolRegistry registry;
+    TEST_ASSERT_EQUAL_STRING("[]", registry.toOpenAISchema().c_str());
+}
+
+int main() {
+    UNITY_BEGIN();
+
+    // Table lookup
+    RUN_TEST(test_find_each_tool);
+    RUN_TEST(test_find_unknown_returns_null);
+    RUN_TEST(test_hundred_tools_all_found);
+    RUN_TEST(test_to_tool_copies_fields);
+
+    // Registry interop
+    RUN_TEST(test_registry_executes_static_tool);
+    RUN_TEST(test_registry_static_tool_without_handler);
+    RUN_TEST(test_registry_mixes_runtime_and_static);
+    RUN_TEST(test_registry_schema_includes_static_tools);
+    RUN_TEST(test_empty_view);
+
+    // Provider declarations
+    RUN_TEST(test_provider_serializes_static_tools_past_cap);
+    RUN_TEST(test_provider_static_tool_fields);
+    RUN_TEST(test_provider_runtime_tools_capped);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
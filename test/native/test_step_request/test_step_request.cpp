@@ -0,0 +1,285 @@
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "providers/OpenAIProvider.h"
+#include "providers/StepRequest.h"
+#include "../../mocks/transport/FakeTransport.h"
+
+using namespace ESPAI;
+
+static const char* CHAT_RESPONSE =
+    "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":\"Hello!\"},"
+    "\"finish_reason\":\"stop\"}],"
+    "\"usage\":{\"prompt_tokens\":8,\"completion_tokens\":2}}";
+
+static const char* STREAM_BODY =
+    "data: {\"choices\":[{\"delta\":{\"content\":\"one \"}}]}\n\n"
+    "data: {\"choices\":[{\"delta\":{\"content\":\"two \"}}]}\n\n"
+    "data: {\"choices\":[{\"delta\":{\"content\":\"three\"}}]}\n\n"
+    "data: {\"choices\":[{\"delta\":{},\"finish_reason\":\"stop\"}],\"usage\":{\"prompt_tokens\":5,\"completion_tokens\":3}}\n\n"
+    "data: [DONE]\n\n";
+
+static FakeTransport* transport = nullptr;
+static OpenAIProvider* provider = nullptr;
+static std::vector<Message> messages;
+
+void setUp() {
+    transport = new FakeTransport();
+    provider = new OpenAIProvider("test-key", "gpt-4o");
+    provider->setTransport(transport);
+    messages.clear();
+    messages.push_back(Message(Role::User, "Hi"));
+}
+
+void tearDown() {
+    delete provider;
+    delete transport;
+    provider = nullptr;
+    transport = nullptr;
+}
+
+static int runToEnd(StepRequest& request, int limit = 10000) {
+    int steps = 0;
+    while (request.step() && steps < limit) {
+        steps++;
+    }
+    return steps;
+}
+
+// Chat
+
+void test_chat_runs_in_steps() {
+    transport->addResponse(200, CHAT_RESPONSE);
+    StepRequest request = provider->beginChat(messages, ChatOptions());
+
+    TEST_ASSERT_EQUAL(StepRequest::Phase::Connecting, request.getPhase());
+    TEST_ASSERT_TRUE(request.step());
+    TEST_ASSERT_EQUAL(StepRequest::Phase::Sending, request.getPhase());
+    TEST_ASSERT_TRUE(request.step());
+    TEST_ASSERT_EQUAL(StepRequest::Phase::Receiving, request.getPhase());
+
+    runToEnd(request);
+
+    TEST_ASSERT_TRUE(request.isDone());
+    TEST_ASSERT_TRUE(request.getResult().success);
+    TEST_ASSERT_EQUAL_STRING("Hello!", request.getResult().content.c_str());
+    TEST_ASSERT_EQUAL(200, request.getResult().httpStatus);
+    TEST_ASSERT_EQUAL(8, request.getResult().promptTokens);
+    // One 16-byte wire slice per step, so the body takes many steps
+    TEST_ASSERT_TRUE(request.getStepCount() > 10);
+    TEST_ASSERT_EQUAL(0, transport->openExchanges);
+}
+
+void test_chat_sends_provider_request() {
+    transport->addResponse(200, CHAT_RESPONSE);
+    StepRequest request = provider->beginChat(messages, ChatOptions());
+    runToEnd(request);
+
+    TEST_ASSERT_EQUAL(1, transport->requests.size());
+    TEST_ASSERT_TRUE(transport->requests[0].body.indexOf("\"model\":\"gpt-4o\"") >= 0);
+    TEST_ASSERT_TRUE(transport->requests[0].body.indexOf("\"stream\"") < 0);
+}
+
+void test_chat_http_error() {
+    transport->addResponse(401, "{\"error\":\"bad key\"}");
+    StepRequest request = provider->beginChat(messages, ChatOptions());
+    runToEnd(request);
+
+    TEST_ASSERT_FALSE(request.getResult().success);
+    TEST_ASSERT_EQUAL(ErrorCode::AuthError, request.getResult().error);
+    TEST_ASSERT_EQUAL(401, request.getResult().httpStatus);
+}
+
+void test_chat_response_too_large() {
+    transport->addResponse(200, String(std::string(ESPAI_MAX_RESPONSE_SIZE + 1, 'x')));
+    transport->streamChunkSize = ESPAI_STEP_BUFFER_SIZE;
+    StepRequest request = provider->beginChat(messages, ChatOptions());
+    runToEnd(request);
+
+    TEST_ASSERT_EQUAL(ErrorCode::ResponseTooLarge, request.getResult().error);
+    TEST_ASSERT_EQUAL(0, transport->openExchanges);
+}
+
+// Streaming
+
+void test_stream_delivers_chunks_from_step() {
+    transport->streams.push_back(STREAM_BODY);
+    String streamed;
+    int doneCount = 0;
+    StepRequest request = provider->beginChatStream(messages, ChatOptions(),
+        [&](const String& chunk, bool done) {
+            streamed += chunk;
+            if (done) {
+                doneCount++;
+            }
+        });
+
+    TEST_ASSERT_TRUE(streamed.isEmpty());
+    runToEnd(request);
+
+    TEST_ASSERT_TRUE(request.getResult().success);
+    TEST_ASSERT_EQUAL_STRING("one two three", streamed.c_str());
+    TEST_ASSERT_EQUAL(1, doneCount);
+    TEST_ASSERT_EQUAL(5, request.getResult().promptTokens);
+    TEST_ASSERT_EQUAL(3, request.getResult().completionTokens);
+    TEST_ASSERT_EQUAL_STRING("stop", request.getResult().stopReason.c_str());
+    TEST_ASSERT_TRUE(transport->requests[0].body.indexOf("\"stream\":true") >= 0);
+}
+
+void test_stream_stop_string_closes_early() {
+    transport->streams.push_back(STREAM_BODY);
+    ChatOptions options;
+    options.stopStrings.push_back("two");
+    String streamed;
+    StepRequest request = provider->beginChatStream(messages, options,
+        [&](const String& chunk, bool done) {
+            (void)done;
+            streamed += chunk;
+        });
+    runToEnd(request);
+
+    TEST_ASSERT_TRUE(request.getResult().success);
+    TEST_ASSERT_EQUAL_STRING("one ", streamed.c_str());
+    TEST_ASSERT_EQUAL_STRING("stop_sequence", request.getResult().stopReason.c_str());
+    TEST_ASSERT_EQUAL(0, transport->openExchanges);
+}
+
+void test_stream_http_error_keeps_body() {
+    transport->rawExchanges.push_back(
+        "HTTP/1.1 429 Too Many Requests\r\nRetry-After: 3\r\nContent-Length: 16\r\n\r\n{\"error\":\"slow\"}");
+    bool called = false;
+    StepRequest request = provider->beginChatStream(messages, ChatOptions(),
+        [&](const String& chunk, bool done) {
+            (void)chunk;
+            (void)done;
+            called = true;
+        });
+    runToEnd(request);
+
+    TEST_ASSERT_FALSE(request.getResult().success);
+    TEST_ASSERT_EQUAL(ErrorCode::RateLimited, request.getResult().error);
+    TEST_ASSERT_EQUAL(429, request.getResult().httpStatus);
+    TEST_ASSERT_FALSE(called);
+}
+
+void test_stream_collects_tool_calls() {
+    transport->streams.push_back(
+        "data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":0,\"id\":\"call_s\",\"type\":\"function\",\"function\":{\"name\":\"get_temp\",\"arguments\":\"{}\"}}]}}]}\n\n"
+        "data: {\"choices\":[{\"delta\":{},\"finish_reason\":\"tool_calls\"}]}\n\n"
+        "data: [DONE]\n\n");
+    StepRequest request = provider->beginChatStream(messages, ChatOptions(),
+        [](const String& chunk, bool done) { (void)chunk; (void)done; });
+    runToEnd(request);
+
+    TEST_ASSERT_TRUE(request.getResult().success);
+    TEST_ASSERT_EQUAL(1, request.getResult().toolCalls.size());
+    TEST_ASSERT_EQUAL_STRING("get_temp", request.getResult().toolCalls[0].name.c_str());
+}
+
+// Lifecycle
+
+void test_cancel_closes_exchange() {
+    transport->streams.push_back(STREAM_BODY);
+    StepRequest request = provider->beginChatStream(messages, ChatOptions(),
+        [](const String& chunk, bool done) { (void)chunk; (void)done; });
+    request.step();
+    TEST_ASSERT_EQUAL(1, transport->openExchanges);
+
+    request.cancel();
+
+    TEST_ASSERT_TRUE(request.isDone());
+    TEST_ASSERT_FALSE(request.step());
+    TEST_ASSERT_FALSE(request.getResult().success);
+    TEST_ASSERT_EQUAL(0, transport->openExchanges);
+}
+
+void test_idle_timeout() {
+    transport->exchangeStalled = true;
+    transport->addResponse(200, CHAT_RESPONSE);
+    provider->setTimeout(20);
+    StepRequest request = provider->beginChat(messages, ChatOptions());
+
+    while (request.step()) {
+    }
+
+    TEST_ASSERT_EQUAL(ErrorCode::Timeout, request.getResult().error);
+}
+
+void test_slow_connect_is_not_a_timeout() {
+    transport->exchangeConnectSteps = 5;
+    transport->addResponse(200, CHAT_RESPONSE);
+    StepRequest request = provider->beginChat(messages, ChatOptions());
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(request.step());
+        TEST_ASSERT_EQUAL(StepRequest::Phase::Connecting, request.getPhase());
+    }
+    runToEnd(request);
+    TEST_ASSERT_TRUE(request.getResult().success);
+}
+
+void test_request_is_movable() {
+    transport->addResponse(200, CHAT_RESPONSE);
+    StepRequest request;
+    TEST_ASSERT_FALSE(request.step());
+    TEST_ASSERT_FALSE(request.isDone());
+
+    request = provider->beginChat(messages, ChatOptions());
+    request.step();
+    StepRequest moved = std::move(request);
+    runToEnd(moved);
+    TEST_ASSERT_TRUE(moved.getResult().success);
+}
+
+void test_fails_without_exchange_support() {
+    transport->exchangeSupported = false;
+    StepRequest request = provider->beginChat(messages, ChatOptions());
+
+    TEST_ASSERT_TRUE(request.isDone());
+    TEST_ASSERT_EQUAL(ErrorCode::NotConfigured, request.getResult().error);
+}
+
+void test_fails_when_not_configured() {
+    OpenAIProvider unconfigured("", "gpt-4o");
+    unconfigured.setTransport(transport);
+    StepRequest request = unconfigured.beginChat(messages, ChatOptions());
+
+    TEST_ASSERT_TRUE(request.isDone());
+    TEST_ASSERT_FALSE(request.step());
+    TEST_ASSERT_EQUAL(ErrorCode::NotConfigured, request.getResult().error);
+    TEST_ASSERT_EQUAL(0, transport->requests.size());
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+
+    // Chat
+    RUN_TEST(test_chat_runs_in_steps);
+    RUN_TEST(test_chat_sends_provider_request);
+    RUN_TEST(test_chat_http_error);
+    RUN_TEST(test_chat_response_too_large);
+
+    // Streaming
+    RUN_TEST(test_stream_delivers_chunks_from_step);
+    RUN_TEST(test_stream_stop_string_closes_early);
+    RUN_TEST(test_stream_http_error_keeps_body);
+    RUN_TEST(test_stream_collects_tool_calls);
+
+    // Lifecycle
+    RUN_TEST(test_cancel_closes_exchange);
+    RUN_TEST(test_idle_timeout);
+    RUN_TEST(test_slow_connect_is_not_a_timeout);
+    RUN_TEST(test_request_is_movable);
+    RUN_TEST(test_fails_without_exchange_support);
+    RUN_TEST(test_fails_when_not_configured);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
@@ -0,0 +1,144 @@
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "async/StreamChunkRing.h"
+#include <thread>
+
+using namespace ESPAI;
+
+void setUp() {}
+void tearDown() {}
+
+// Basic reads and writes
+
+void test_write_then_read() {
+    StreamChunkRing ring(32);
+    TEST_ASSERT_TRUE(ring.write("Hello, "));
+    TEST_ASSERT_TRUE(ring.write("world"));
+    TEST_ASSERT_EQUAL(12, ring.available());
+
+    char buf[16];
+    size_t n = ring.read(buf, 5);
+    TEST_ASSERT_EQUAL(5, n);
+    buf[n] = '\0';
+    TEST_ASSERT_EQUAL_STRING("Hello", buf);
+
+    String rest;
+    TEST_ASSERT_EQUAL(7, ring.read(rest));
+    TEST_ASSERT_EQUAL_STRING(", world", rest.c_str());
+    TEST_ASSERT_EQUAL(0, ring.available());
+    TEST_ASSERT_EQUAL(0, ring.read(buf, sizeof(buf)));
+}
+
+void test_wraps_around() {
+    StreamChunkRing ring(8);
+    char buf[8];
+    TEST_ASSERT_TRUE(ring.write("abcdef"));
+    TEST_ASSERT_EQUAL(6, ring.read(buf, sizeof(buf)));
+
+    // Spans the end of the buffer
+    TEST_ASSERT_TRUE(ring.write("ghijklm"));
+    String out;
+    ring.read(out);
+    TEST_ASSERT_EQUAL_STRING("ghijklm", out.c_str());
+}
+
+// Overflow
+
+void test_full_ring_drops_whole_chunk() {
+    StreamChunkRing ring(8);
+    TEST_ASSERT_TRUE(ring.write("12345"));
+    TEST_ASSERT_FALSE(ring.write("6789"));  // Only 3 bytes free
+    TEST_ASSERT_TRUE(ring.write("678"));
+    TEST_ASSERT_EQUAL(4, ring.getDroppedBytes());
+
+    String out;
+    ring.read(out);
+    TEST_ASSERT_EQUAL_STRING("12345678", out.c_str());
+}
+
+void test_high_water_mark() {
+    StreamChunkRing ring(16);
+    char buf[16];
+    ring.write("abcd");
+    ring.read(buf, sizeof(buf));
+    ring.write("0123456789");
+    ring.write("xy");
+    ring.read(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL(12, ring.getHighWaterMark());
+
+    ring.reset();
+    TEST_ASSERT_EQUAL(0, ring.getHighWaterMark());
+    TEST_ASSERT_EQUAL(0, ring.available());
+}
+
+// Completion
+
+void test_done_after_drain() {
+    StreamChunkRing ring(16);
+    ring.write("tail");
+    ring.markDone();
+    TEST_ASSERT_FALSE(ring.isDone());  // Data still buffered
+
+    String out;
+    ring.read(out);
+    TEST_ASSERT_TRUE(ring.isDone());
+
+    ring.reset();
+    TEST_ASSERT_FALSE(ring.isDone());
+}
+
+// Concurrency
+
+void test_producer_consumer_threads() {
+    StreamChunkRing ring(64);
+    const int kChunks = 2000;
+
+    std::thread producer([&ring]() {
+        for (int i = 0; i < kChunks; i++) {
+            char chunk[2] = {static_cast<char>('a' + i % 26), 0};
+            while (!ring.write(chunk, 1)) {
+                std::this_thread::yield();
+            }
+        }
+        ring.markDone();
+    });
+
+    String received;
+    while (!ring.isDone()) {
+        ring.read(received);
+    }
+    producer.join();
+
+    TEST_ASSERT_EQUAL(kChunks, received.length());
+    for (int i = 0; i < kChunks; i++) {
+        TEST_ASSERT_EQUAL('a' + i % 26, received[i]);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+
+    // Basic reads and writes
+    RUN_TEST(test_write_then_read);
+    RUN_TEST(test_wraps_around);
+
+    // Overflow
+    RUN_TEST(test_full_ring_drops_whole_chunk);
+    RUN_TEST(test_high_water_mark);
+
+    // Completion
+    RUN_TEST(test_done_after_drain);
+
+    // Concurrency
+    RUN_TEST(test_producer_consumer_threads);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
@@ -0,0 +1,308 @@
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "providers/OpenAIProvider.h"
+#include "providers/StreamMultiplexer.h"
+#include "http/HttpResponseParser.h"
+#include "../../mocks/transport/FakeTransport.h"
+
+#include <chrono>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace ESPAI;
+
+// Exchange on one end of a socketpair; the test writes the response into the other
+class SocketExchange : public HttpExchange {
+public:
+    explicit SocketExchange(int fd) : _fd(fd) {}
+    ~SocketExchange() override { close(_fd); }
+
+    Phase step(uint8_t* buffer, size_t size, size_t& received) override {
+        received = 0;
+        steps++;
+        if (_phase == Phase::Connecting) {
+            _phase = Phase::Receiving;
+            return _phase;
+        }
+        ssize_t count = recv(_fd, buffer, size, 0);
+        if (count > 0) {
+            received = _parser.decode(buffer, static_cast<size_t>(count));
+        } else if (count == 0) {
+            _parser.onClosed();
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            _lastError = "recv failed";
+            _phase = Phase::Failed;
+            return _phase;
+        }
+        if (_parser.hasError()) {
+            _lastError = _parser.getError();
+            _phase = Phase::Failed;
+        } else if (_parser.isDone()) {
+            _phase = Phase::Done;
+        }
+        return _phase;
+    }
+
+    int16_t getStatusCode() const override { return _parser.getStatusCode(); }
+    const String& getLastError() const override { return _lastError; }
+    int getSocket() const override { return _fd; }
+
+    static int steps;
+
+private:
+    int _fd;
+    Phase _phase = Phase::Connecting;
+    HttpResponseParser _parser;
+    String _lastError;
+};
+
+int SocketExchange::steps = 0;
+
+class SocketTransport : public FakeTransport {
+public:
+    std::vector<int> peers;
+
+    std::unique_ptr<HttpExchange> openExchange(const HttpRequest& request, bool stream) override {
+        (void)request;
+        (void)stream;
+        int fds[2];
+        socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+        fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+        peers.push_back(fds[1]);
+        return std::unique_ptr<HttpExchange>(new SocketExchange(fds[0]));
+    }
+
+    ~SocketTransport() override {
+        for (int fd : peers) {
+            close(fd);
+        }
+    }
+};
+
+static const char* STREAM_HEAD = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n\r\n";
+
+static String sseBody(const char* text) {
+    return String("data: {\"choices\":[{\"delta\":{\"content\":\"") + text + "\"}}]}\n\ndata: [DONE]\n\n";
+}
+
+static void writeAll(int fd, const String& data) {
+    TEST_ASSERT_EQUAL((ssize_t)data.length(), write(fd, data.c_str(), data.length()));
+}
+
+static uint32_t elapsedMs(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+static std::vector<Message> messages;
+
+void setUp() {
+    messages.clear();
+    messages.push_back(Message(Role::User, "Hi"));
+    SocketExchange::steps = 0;
+}
+
+void tearDown() {}
+
+// Many streams
+
+void test_runs_streams_side_by_side() {
+    FakeTransport transport;
+    transport.streamChunkSize = 8;
+    transport.streams.push_back(sseBody("kitchen"));
+    transport.streams.push_back(sseBody("office"));
+    transport.streams.push_back(sseBody("garage"));
+    OpenAIProvider provider("test-key", "gpt-4o");
+    provider.setTransport(&transport);
+
+    String text[3];
+    StreamMultiplexer hub;
+    for (int i = 0; i < 3; i++) {
+        hub.add(provider.beginChatStream(messages, ChatOptions(), [&text, i](const String& chunk, bool done) {
+            (void)done;
+            text[i] += chunk;
+        }));
+    }
+    TEST_ASSERT_EQUAL(3, transport.openExchanges);
+
+    int polls = 0;
+    while (hub.poll() > 0 && polls < 1000) {
+        polls++;
+    }
+
+    TEST_ASSERT_EQUAL_STRING("kitchen", text[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("office", text[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("garage", text[2].c_str());
+    for (size_t i = 0; i < hub.size(); i++) {
+        TEST_ASSERT_TRUE(hub.at(i).getResult().success);
+    }
+    // Each poll stepped every stream, rather than one stream after another
+    uint32_t steps = hub.at(0).getStepCount() + hub.at(1).getStepCount() + hub.at(2).getStepCount();
+    TEST_ASSERT_TRUE(static_cast<uint32_t>(polls) * 2 < steps);
+    TEST_ASSERT_EQUAL(0, transport.openExchanges);
+}
+
+static String toolCallBody(const char* id, const char* room) {
+    return String("data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":0,\"id\":\"") + id +
+        "\",\"type\":\"function\",\"function\":{\"name\":\"get_temp\",\"arguments\":\"{\\\"room\\\":\\\"" +
+        room + "\\\"}\"}}]}}]}\n\n"
+        "data: {\"choices\":[{\"delta\":{},\"finish_reason\":\"tool_calls\"}]}\n\n"
+        "data: [DONE]\n\n";
+}
+
+void test_streams_keep_their_own_tool_calls() {
+    FakeTransport transport;
+    transport.streamChunkSize = 8;
+    transport.streams.push_back(toolCallBody("call_a", "kitchen"));
+    transport.streams.push_back(toolCallBody("call_b", "office"));
+    OpenAIProvider provider("test-key", "gpt-4o");
+    provider.setTransport(&transport);
+
+    ToolRegistry registry;
+    registry.registerTool(Tool("get_temp", "Read temperature", "{\"type\":\"object\"}",
+        [](const String& args) -> String { return args; }));
+    provider.setEarlyToolDispatch(&registry);
+
+    StreamMultiplexer hub;
+    for (int i = 0; i < 2; i++) {
+        hub.add(provider.beginChatStream(messages, ChatOptions(), [](const String& chunk, bool done) {
+            (void)chunk;
+            (void)done;
+        }));
+    }
+    while (hub.poll() > 0) {
+    }
+
+    const char* ids[] = {"call_a", "call_b"};
+    const char* args[] = {"{\"room\":\"kitchen\"}", "{\"room\":\"office\"}"};
+    for (size_t i = 0; i < 2; i++) {
+        const StepRequest& request = hub.at(i);
+        TEST_ASSERT_TRUE(request.getResult().success);
+        TEST_ASSERT_EQUAL(1, request.getResult().toolCalls.size());
+        TEST_ASSERT_EQUAL_STRING(ids[i], request.getResult().toolCalls[0].id.c_str());
+        TEST_ASSERT_EQUAL(1, request.getToolResults().size());
+        TEST_ASSERT_EQUAL_STRING(ids[i], request.getToolResults()[0].toolCallId.c_str());
+        TEST_ASSERT_EQUAL_STRING(args[i], request.getToolResults()[0].result.c_str());
+    }
+    TEST_ASSERT_FALSE(provider.hasToolCalls());
+}
+
+void test_remove_finished_and_cancel_all() {
+    FakeTransport transport;
+    transport.addResponse(200,
+        "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":\"ok\"},\"finish_reason\":\"stop\"}]}");
+    OpenAIProvider provider("test-key", "gpt-4o");
+    provider.setTransport(&transport);
+
+    StreamMultiplexer hub;
+    hub.add(provider.beginChat(messages, ChatOptions()));
+    while (hub.poll() > 0) {
+    }
+    TEST_ASSERT_TRUE(hub.at(0).getResult().success);
+
+    transport.exchangeStalled = true;
+    transport.addResponse(200, "{}");
+    hub.add(provider.beginChat(messages, ChatOptions()));
+    hub.poll();
+    hub.removeFinished();
+    TEST_ASSERT_EQUAL(1, hub.size());
+    TEST_ASSERT_EQUAL(1, hub.getRunningCount());
+
+    hub.cancelAll();
+    TEST_ASSERT_EQUAL(0, hub.getRunningCount());
+    TEST_ASSERT_EQUAL(0, transport.openExchanges);
+}
+
+// Waiting on sockets
+
+void test_poll_waits_for_a_socket() {
+    SocketTransport transport;
+    OpenAIProvider provider("test-key", "gpt-4o");
+    provider.setTransport(&transport);
+    String text;
+    StreamMultiplexer hub;
+    hub.add(provider.beginChatStream(messages, ChatOptions(), [&text](const String& chunk, bool done) {
+        (void)done;
+        text += chunk;
+    }));
+    hub.poll();     // Connected, now receiving
+
+    auto start = std::chrono::steady_clock::now();
+    TEST_ASSERT_EQUAL(1, hub.poll(50));
+    TEST_ASSERT_TRUE(elapsedMs(start) >= 40);
+
+    writeAll(transport.peers[0], String(STREAM_HEAD) + sseBody("hello"));
+    start = std::chrono::steady_clock::now();
+    while (hub.poll(1000) > 0) {
+    }
+    TEST_ASSERT_TRUE(elapsedMs(start) < 500);
+    TEST_ASSERT_EQUAL_STRING("hello", text.c_str());
+}
+
+void test_steps_only_ready_sockets() {
+    SocketTransport transport;
+    OpenAIProvider provider("test-key", "gpt-4o");
+    provider.setTransport(&transport);
+    auto ignore = [](const String& chunk, bool done) { (void)chunk; (void)done; };
+    StreamMultiplexer hub;
+    hub.add(provider.beginChatStream(messages, ChatOptions(), ignore));
+    hub.add(provider.beginChatStream(messages, ChatOptions(), ignore));
+    hub.poll();
+
+    uint32_t idleSteps = hub.at(1).getStepCount();
+    writeAll(transport.peers[0], String(STREAM_HEAD) + sseBody("a"));
+    close(transport.peers[0]);
+    transport.peers[0] = -1;
+    for (int i = 0; i < 20 && !hub.at(0).isDone(); i++) {
+        hub.poll(100);
+    }
+
+    TEST_ASSERT_TRUE(hub.at(0).getResult().success);
+    TEST_ASSERT_EQUAL(idleSteps, hub.at(1).getStepCount());
+    TEST_ASSERT_FALSE(hub.at(1).isDone());
+}
+
+void test_idle_socket_times_out_without_steps() {
+    SocketTransport transport;
+    OpenAIProvider provider("test-key", "gpt-4o");
+    provider.setTransport(&transport);
+    provider.setTimeout(30);
+    StreamMultiplexer hub;
+    hub.add(provider.beginChat(messages, ChatOptions()));
+    hub.poll();
+    uint32_t steps = hub.at(0).getStepCount();
+
+    for (int i = 0; i < 10 && hub.poll(20) > 0; i++) {
+    }
+
+    TEST_ASSERT_EQUAL(ErrorCode::Timeout, hub.at(0).getResult().error);
+    TEST_ASSERT_EQUAL(steps, hub.at(0).getStepCount());
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+
+    // Many streams
+    RUN_TEST(test_runs_streams_side_by_side);
+    RUN_TEST(test_streams_keep_their_own_tool_calls);
+    RUN_TEST(test_remove_finished_and_cancel_all);
+
+    // Waiting on sockets
+    RUN_TEST(test_poll_waits_for_a_socket);
+    RUN_TEST(test_steps_only_ready_sockets);
+    RUN_TEST(test_idle_socket_times_out_without_steps);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
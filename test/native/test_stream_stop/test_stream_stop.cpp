@@ -0,0 +1,232 @@
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "http/StreamStopDetector.h"
+#include "http/SSEParser.h"
+
+using namespace ESPAI;
+
+static String feedAll(StreamStopDetector& detector, const std::vector<String>& chunks) {
+    String out;
+    for (const auto& chunk : chunks) {
+        if (detector.process(chunk, out)) {
+            return out;
+        }
+    }
+    out += detector.flush();
+    return out;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+// Stop string tests
+
+void test_inactive_by_default() {
+    StreamStopDetector detector;
+    TEST_ASSERT_FALSE(detector.isActive());
+
+    String out;
+    TEST_ASSERT_FALSE(detector.process("Hello", out));
+    TEST_ASSERT_EQUAL_STRING("Hello", out.c_str());
+}
+
+void test_stop_string_in_single_chunk() {
+    StreamStopDetector detector;
+    detector.addStopString("END");
+    TEST_ASSERT_TRUE(detector.isActive());
+
+    String out;
+    TEST_ASSERT_TRUE(detector.process("Hello END world", out));
+    TEST_ASSERT_EQUAL_STRING("Hello ", out.c_str());
+    TEST_ASSERT_TRUE(detector.isStopped());
+    TEST_ASSERT_EQUAL_STRING("stop_sequence", detector.getStopReason());
+}
+
+void test_stop_string_across_chunks() {
+    StreamStopDetector detector;
+    detector.addStopString("</answer>");
+
+    String out = feedAll(detector, {"The result is 4</an", "swe", "r> trailing"});
+    TEST_ASSERT_TRUE(detector.isStopped());
+    TEST_ASSERT_EQUAL_STRING("The result is 4", out.c_str());
+}
+
+void test_partial_match_held_then_released() {
+    StreamStopDetector detector;
+    detector.addStopString("STOP");
+
+    String out;
+    TEST_ASSERT_FALSE(detector.process("abc ST", out));
+    TEST_ASSERT_EQUAL_STRING("abc ", out.c_str());
+
+    TEST_ASSERT_FALSE(detector.process("AND", out));
+    TEST_ASSERT_EQUAL_STRING("abc STAND", out.c_str());
+    TEST_ASSERT_FALSE(detector.isStopped());
+}
+
+void test_flush_releases_held_text() {
+    StreamStopDetector detector;
+    detector.addStopString("STOP");
+
+    String out = feedAll(detector, {"ends with ST", "O"});
+    TEST_ASSERT_FALSE(detector.isStopped());
+    TEST_ASSERT_EQUAL_STRING("ends with STO", out.c_str());
+}
+
+void test_multiple_overlapping_stop_strings() {
+    StreamStopDetector detector;
+    detector.addStopString("abcd");
+    detector.addStopString("bce");
+
+    // "abc" follows the longer pattern, then falls back to "bc" via the failure link
+    String out = feedAll(detector, {"xxab", "ce yy"});
+    TEST_ASSERT_TRUE(detector.isStopped());
+    TEST_ASSERT_EQUAL_STRING("xxa", out.c_str());
+}
+
+void test_stop_string_suffix_of_another() {
+    StreamStopDetector detector;
+    detector.addStopString("hello world");
+    detector.addStopString("wor");
+
+    String out = feedAll(detector, {"say hello wo", "rld"});
+    TEST_ASSERT_TRUE(detector.isStopped());
+    TEST_ASSERT_EQUAL_STRING("say hello ", out.c_str());
+}
+
+void test_empty_stop_string_ignored() {
+    StreamStopDetector detector;
+    detector.addStopString("");
+    TEST_ASSERT_FALSE(detector.isActive());
+}
+
+// Max output bytes tests
+
+void test_max_output_bytes() {
+    StreamStopDetector detector;
+    detector.setMaxOutputBytes(8);
+
+    String out = feedAll(detector, {"Hello", " world", "!"});
+    TEST_ASSERT_TRUE(detector.isStopped());
+    TEST_ASSERT_EQUAL_STRING("Hello wo", out.c_str());
+    TEST_ASSERT_EQUAL(8, detector.getOutputBytes());
+    TEST_ASSERT_EQUAL_STRING("max_output_bytes", detector.getStopReason());
+}
+
+void test_max_output_bytes_keeps_utf8_intact() {
+    StreamStopDetector detector;
+    detector.setMaxOutputBytes(4);
+
+    // "ab" followed by a 3-byte character: cutting at 4 would split it
+    String out;
+    TEST_ASSERT_TRUE(detector.process("ab\xE2\x82\xAC", out));
+    TEST_ASSERT_EQUAL_STRING("ab", out.c_str());
+}
+
+// Predicate tests
+
+void test_predicate_stops_stream() {
+    StreamStopDetector detector;
+    detector.setPredicate([](const String& text) {
+        return text.indexOf('}') >= 0;
+    });
+
+    String out = feedAll(detector, {"{\"a\":", "1}", " extra"});
+    TEST_ASSERT_TRUE(detector.isStopped());
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1}", out.c_str());
+    TEST_ASSERT_EQUAL_STRING("predicate", detector.getStopReason());
+}
+
+void test_options_constructor() {
+    ChatOptions options;
+    options.stopStrings.push_back("###");
+    options.maxOutputBytes = 100;
+
+    StreamStopDetector detector(options);
+    TEST_ASSERT_TRUE(detector.isActive());
+
+    String out = feedAll(detector, {"one ##", "# two"});
+    TEST_ASSERT_EQUAL_STRING("one ", out.c_str());
+}
+
+void test_reset_allows_reuse() {
+    StreamStopDetector detector;
+    detector.addStopString("X");
+
+    String out;
+    TEST_ASSERT_TRUE(detector.process("aXb", out));
+    detector.reset();
+    TEST_ASSERT_FALSE(detector.isStopped());
+
+    out = "";
+    TEST_ASSERT_FALSE(detector.process("abc", out));
+    TEST_ASSERT_EQUAL_STRING("abc", out.c_str());
+}
+
+// Parser integration
+
+void test_detector_cancels_parser() {
+    SSEParser parser(SSEFormat::OpenAI);
+    StreamStopDetector detector;
+    detector.addStopString("DONE.");
+
+    String received;
+    parser.setContentCallback([&](const String& content, bool done) {
+        (void)done;
+        if (detector.isStopped()) {
+            return;
+        }
+        String text;
+        if (detector.process(content, text)) {
+            parser.cancel();
+        }
+        received += text;
+    });
+
+    parser.feed(
+        "data: {\"choices\":[{\"delta\":{\"content\":\"Work DO\"}}]}\n\n"
+        "data: {\"choices\":[{\"delta\":{\"content\":\"NE. more\"}}]}\n\n"
+        "data: {\"choices\":[{\"delta\":{\"content\":\"ignored\"}}]}\n\n");
+
+    TEST_ASSERT_TRUE(parser.isCancelled());
+    TEST_ASSERT_EQUAL_STRING("Work ", received.c_str());
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+
+    // Stop strings
+    RUN_TEST(test_inactive_by_default);
+    RUN_TEST(test_stop_string_in_single_chunk);
+    RUN_TEST(test_stop_string_across_chunks);
+    RUN_TEST(test_partial_match_held_then_released);
+    RUN_TEST(test_flush_releases_held_text);
+    RUN_TEST(test_multiple_overlapping_stop_strings);
+    RUN_TEST(test_stop_string_suffix_of_another);
+    RUN_TEST(test_empty_stop_string_ignored);
+
+    // Max output bytes
+    RUN_TEST(test_max_output_bytes);
+    RUN_TEST(test_max_output_bytes_keeps_utf8_intact);
+
+    // Predicate
+    RUN_TEST(test_predicate_stops_stream);
+    RUN_TEST(test_options_constructor);
+    RUN_TEST(test_reset_allows_reuse);
+
+    // Parser integration
+    RUN_TEST(test_detector_cancels_parser);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
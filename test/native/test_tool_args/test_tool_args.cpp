@@ -0,0 +1,225 @@
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "tools/ToolArgs.h"
+#include "tools/ToolRegistry.h"
+#include "tools/ParallelToolExecutor.h"
+#include <ArduinoJson.h>
+
+using namespace ESPAI;
+
+struct LedArgs {
+    uint8_t pin = 0;
+    bool on = false;
+    String color = "white";
+    float brightness = 1.0f;
+};
+
+static JsonToolHandler ledHandler() {
+    return typedToolHandler<LedArgs>(
+        [](const LedArgs& args, JsonObject result) {
+            result["pin"] = args.pin;
+            result["on"] = args.on;
+            result["color"] = args.color.c_str();
+            result["brightness"] = args.brightness;
+            return true;
+        },
+        toolArg("pin", &LedArgs::pin),
+        toolArg("on", &LedArgs::on),
+        toolArg("color", &LedArgs::color, false),
+        toolArg("brightness", &LedArgs::brightness, false)
+    );
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_decode_all_fields() {
+    JsonDocument doc;
+    deserializeJson(doc, "{\"pin\":5,\"on\":true,\"color\":\"red\",\"brightness\":0.5}");
+
+    LedArgs args;
+    String error;
+    bool ok = decodeToolArgs(doc.as<JsonVariantConst>(), args, error,
+                             toolArg("pin", &LedArgs::pin),
+                             toolArg("on", &LedArgs::on),
+                             toolArg("color", &LedArgs::color),
+                             toolArg("brightness", &LedArgs::brightness));
+
+    TEST_ASSERT_TRUE(ok);
+    TEST_ASSERT_EQUAL(5, args.pin);
+    TEST_ASSERT_TRUE(args.on);
+    TEST_ASSERT_EQUAL_STRING("red", args.color.c_str());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.5f, args.brightness);
+}
+
+void test_decode_optional_keeps_default() {
+    JsonDocument doc;
+    deserializeJson(doc, "{\"pin\":2,\"on\":false}");
+
+    LedArgs args;
+    String error;
+    TEST_ASSERT_TRUE(decodeToolArgs(doc.as<JsonVariantConst>(), args, error,
+                                    toolArg("pin", &LedArgs::pin),
+                                    toolArg("color", &LedArgs::color, false)));
+    TEST_ASSERT_EQUAL_STRING("white", args.color.c_str());
+}
+
+void test_decode_missing_required() {
+    JsonDocument doc;
+    deserializeJson(doc, "{\"on\":true}");
+
+    LedArgs args;
+    String error;
+    TEST_ASSERT_FALSE(decodeToolArgs(doc.as<JsonVariantConst>(), args, error,
+                                     toolArg("pin", &LedArgs::pin)));
+    TEST_ASSERT_EQUAL_STRING("Missing argument: pin", error.c_str());
+}
+
+void test_decode_wrong_type() {
+    JsonDocument doc;
+    deserializeJson(doc, "{\"pin\":\"five\"}");
+
+    LedArgs args;
+    String error;
+    TEST_ASSERT_FALSE(decodeToolArgs(doc.as<JsonVariantConst>(), args, error,
+                                     toolArg("pin", &LedArgs::pin)));
+    TEST_ASSERT_EQUAL_STRING("Invalid type for argument: pin", error.c_str());
+}
+
+void test_decode_out_of_range() {
+    JsonDocument doc;
+    deserializeJson(doc, "{\"pin\":300}");
+
+    LedArgs args;
+    String error;
+    TEST_ASSERT_FALSE(decodeToolArgs(doc.as<JsonVariantConst>(), args, error,
+                                     toolArg("pin", &LedArgs::pin)));
+}
+
+void test_decode_not_object() {
+    JsonDocument doc;
+    deserializeJson(doc, "[1,2]");
+
+    LedArgs args;
+    String error;
+    TEST_ASSERT_FALSE(decodeToolArgs(doc.as<JsonVariantConst>(), args, error,
+                                     toolArg("pin", &LedArgs::pin)));
+    TEST_ASSERT_EQUAL_STRING("Arguments must be a JSON object", error.c_str());
+}
+
+void test_registry_runs_typed_handler() {
+    Tool tool("set_led", "Set an LED", "{}");
+    tool.jsonHandler = ledHandler();
+
+    ToolRegistry registry;
+    registry.registerTool(tool);
+
+    ToolResult result = registry.execute(ToolCall("call_1", "set_led", "{\"pin\":4,\"on\":true}"));
+    TEST_ASSERT_TRUE(result.success);
+    TEST_ASSERT_EQUAL_STRING("call_1", result.toolCallId.c_str());
+
+    JsonDocument doc;
+    deserializeJson(doc, result.result);
+    TEST_ASSERT_EQUAL(4, doc["pin"].as<int>());
+    TEST_ASSERT_TRUE(doc["on"].as<bool>());
+    TEST_ASSERT_EQUAL_STRING("white", doc["color"].as<const char*>());
+}
+
+void test_registry_typed_handler_validation_error() {
+    Tool tool("set_led", "Set an LED", "{}");
+    tool.jsonHandler = ledHandler();
+
+    ToolRegistry registry;
+    registry.registerTool(tool);
+
+    ToolResult result = registry.execute(ToolCall("call_1", "set_led", "{\"on\":true}"));
+    TEST_ASSERT_FALSE(result.success);
+    TEST_ASSERT_EQUAL_STRING("{\"error\":\"Missing argument: pin\"}", result.result.c_str());
+}
+
+void test_registry_invalid_arguments_json() {
+    Tool tool("set_led", "Set an LED", "{}");
+    tool.jsonHandler = ledHandler();
+
+    ToolRegistry registry;
+    registry.registerTool(tool);
+
+    ToolResult result = registry.execute(ToolCall("call_1", "set_led", "{\"pin\":"));
+    TEST_ASSERT_FALSE(result.success);
+    TEST_ASSERT_TRUE(result.result.indexOf("Invalid arguments JSON") >= 0);
+}
+
+void test_raw_json_handler_empty_arguments() {
+    Tool tool("status", "Device status", "{}");
+    tool.jsonHandler = [](JsonVariantConst args, JsonObject result) {
+        result["isObject"] = args.is<JsonObjectConst>();
+        return true;
+    };
+
+    ToolRegistry registry;
+    registry.registerTool(tool);
+
+    TEST_ASSERT_EQUAL_STRING("{\"isObject\":true}", registry.executeToolCall("status", "").c_str());
+}
+
+void test_json_handler_preferred_over_string_handler() {
+    Tool tool("t", "d", "{}", [](const String&) -> String { return "string"; });
+    tool.jsonHandler = [](JsonVariantConst, JsonObject result) {
+        result["from"] = "json";
+        return true;
+    };
+
+    ToolRegistry registry;
+    registry.registerTool(tool);
+
+    TEST_ASSERT_EQUAL_STRING("{\"from\":\"json\"}", registry.executeToolCall("t", "{}").c_str());
+}
+
+void test_parallel_executor_runs_typed_handler() {
+    Tool tool("set_led", "Set an LED", "{}");
+    tool.jsonHandler = ledHandler();
+    tool.parallelSafe = true;
+
+    ToolRegistry registry;
+    registry.registerTool(tool);
+
+    ParallelToolExecutor executor(2);
+    auto results = executor.execute(registry, {
+        ToolCall("1", "set_led", "{\"pin\":1,\"on\":true}"),
+        ToolCall("2", "set_led", "{\"pin\":\"x\",\"on\":true}")
+    });
+
+    TEST_ASSERT_TRUE(results[0].success);
+    TEST_ASSERT_FALSE(results[1].success);
+    TEST_ASSERT_TRUE(results[1].result.indexOf("Invalid type for argument: pin") >= 0);
+}
+
+int main() {
+    UNITY_BEGIN();
+
+    // Field descriptors
+    RUN_TEST(test_decode_all_fields);
+    RUN_TEST(test_decode_optional_keeps_default);
+    RUN_TEST(test_decode_missing_required);
+    RUN_TEST(test_decode_wrong_type);
+    RUN_TEST(test_decode_out_of_range);
+    RUN_TEST(test_decode_not_object);
+
+    // Registry execution
+    RUN_TEST(test_registry_runs_typed_handler);
+    RUN_TEST(test_registry_typed_handler_validation_error);
+    RUN_TEST(test_registry_invalid_arguments_json);
+    RUN_TEST(test_raw_json_handler_empty_arguments);
+    RUN_TEST(test_json_handler_preferred_over_string_handler);
+    RUN_TEST(test_parallel_executor_runs_typed_handler);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
@@ -0,0 +1,176 @@
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "http/ToolArgumentParser.h"
+#include <vector>
+
+using namespace ESPAI;
+
+static ToolArgumentParser* parser = nullptr;
+static std::vector<std::pair<String, String>> fields;
+
+static void onField(const String& key, const String& value) {
+    fields.push_back({key, value});
+}
+
+void setUp() {
+    parser = new ToolArgumentParser();
+    fields.clear();
+}
+
+void tearDown() {
+    delete parser;
+    parser = nullptr;
+}
+
+// Complete input
+
+void test_single_string_field() {
+    parser->feed("{\"color\":\"red\"}", onField);
+
+    TEST_ASSERT_EQUAL(1, fields.size());
+    TEST_ASSERT_EQUAL_STRING("color", fields[0].first.c_str());
+    TEST_ASSERT_EQUAL_STRING("\"red\"", fields[0].second.c_str());
+    TEST_ASSERT_TRUE(parser->isComplete());
+}
+
+void test_all_value_types() {
+    parser->feed("{ \"s\": \"x\", \"n\": -1.5e3, \"b\": false, \"z\": null, \"o\": {\"a\": [1, 2]}, \"a\": [\"}\"] }", onField);
+
+    TEST_ASSERT_EQUAL(6, fields.size());
+    TEST_ASSERT_EQUAL_STRING("\"x\"", fields[0].second.c_str());
+    TEST_ASSERT_EQUAL_STRING("-1.5e3", fields[1].second.c_str());
+    TEST_ASSERT_EQUAL_STRING("false", fields[2].second.c_str());
+    TEST_ASSERT_EQUAL_STRING("null", fields[3].second.c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"a\": [1, 2]}", fields[4].second.c_str());
+    TEST_ASSERT_EQUAL_STRING("[\"}\"]", fields[5].second.c_str());
+    TEST_ASSERT_TRUE(parser->isComplete());
+    TEST_ASSERT_EQUAL(6, parser->getFieldCount());
+}
+
+void test_empty_object() {
+    parser->feed("{}", onField);
+    TEST_ASSERT_EQUAL(0, fields.size());
+    TEST_ASSERT_TRUE(parser->isComplete());
+}
+
+// Fragmented input
+
+void test_string_field_ready_on_closing_quote() {
+    parser->feed("{\"color\":\"re", onField);
+    TEST_ASSERT_EQUAL(0, fields.size());
+
+    parser->feed("d\"", onField);
+    TEST_ASSERT_EQUAL(1, fields.size());
+    TEST_ASSERT_FALSE(parser->isComplete());
+}
+
+void test_number_waits_for_delimiter() {
+    parser->feed("{\"angle\":9", onField);
+    parser->feed("0", onField);
+    TEST_ASSERT_EQUAL(0, fields.size());
+
+    parser->feed("}", onField);
+    TEST_ASSERT_EQUAL(1, fields.size());
+    TEST_ASSERT_EQUAL_STRING("90", fields[0].second.c_str());
+    TEST_ASSERT_TRUE(parser->isComplete());
+}
+
+void test_one_char_at_a_time() {
+    const char* json = "{\"pin\": 4, \"state\": \"on\", \"opts\": {\"x\": \"a\\\"}\"}}";
+    for (const char* p = json; *p; p++) {
+        parser->feed(p, 1, onField);
+    }
+
+    TEST_ASSERT_EQUAL(3, fields.size());
+    TEST_ASSERT_EQUAL_STRING("pin", fields[0].first.c_str());
+    TEST_ASSERT_EQUAL_STRING("4", fields[0].second.c_str());
+    TEST_ASSERT_EQUAL_STRING("\"on\"", fields[1].second.c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"x\": \"a\\\"}\"}", fields[2].second.c_str());
+    TEST_ASSERT_TRUE(parser->isComplete());
+}
+
+void test_escaped_quote_in_string() {
+    parser->feed("{\"text\":\"say \\\"hi\\\"\"}", onField);
+    TEST_ASSERT_EQUAL(1, fields.size());
+    TEST_ASSERT_EQUAL_STRING("\"say \\\"hi\\\"\"", fields[0].second.c_str());
+}
+
+// Errors
+
+void test_not_an_object() {
+    parser->feed("[1,2]", onField);
+    TEST_ASSERT_TRUE(parser->hasError());
+    TEST_ASSERT_EQUAL(0, fields.size());
+}
+
+void test_missing_colon() {
+    parser->feed("{\"a\" 1}", onField);
+    TEST_ASSERT_TRUE(parser->hasError());
+}
+
+void test_nesting_at_limit() {
+    String value;
+    for (int i = 0; i < ESPAI_TOOL_ARG_MAX_DEPTH; i++) value += "[";
+    for (int i = 0; i < ESPAI_TOOL_ARG_MAX_DEPTH; i++) value += "]";
+    parser->feed(String("{\"a\":") + value + ",\"b\":1}", onField);
+    TEST_ASSERT_TRUE(parser->isComplete());
+    TEST_ASSERT_EQUAL(2, fields.size());
+    TEST_ASSERT_EQUAL_STRING(value.c_str(), fields[0].second.c_str());
+}
+
+void test_nesting_too_deep() {
+    // 256 levels would wrap an 8-bit counter back to the top level
+    String value;
+    for (int i = 0; i < 300; i++) value += "[";
+    for (int i = 0; i < 300; i++) value += "]";
+    parser->feed(String("{\"a\":") + value + ",\"b\":1}", onField);
+    TEST_ASSERT_TRUE(parser->hasError());
+    TEST_ASSERT_EQUAL(0, fields.size());
+}
+
+void test_reset() {
+    parser->feed("{\"a\":1}", onField);
+    TEST_ASSERT_TRUE(parser->isComplete());
+
+    parser->reset();
+    TEST_ASSERT_FALSE(parser->isComplete());
+    TEST_ASSERT_EQUAL(0, parser->getFieldCount());
+
+    parser->feed("{\"b\":2}", onField);
+    TEST_ASSERT_EQUAL(2, fields.size());
+    TEST_ASSERT_EQUAL_STRING("b", fields[1].first.c_str());
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+
+    // Complete input
+    RUN_TEST(test_single_string_field);
+    RUN_TEST(test_all_value_types);
+    RUN_TEST(test_empty_object);
+
+    // Fragmented input
+    RUN_TEST(test_string_field_ready_on_closing_quote);
+    RUN_TEST(test_number_waits_for_delimiter);
+    RUN_TEST(test_one_char_at_a_time);
+    RUN_TEST(test_escaped_quote_in_string);
+
+    // Errors
+    RUN_TEST(test_not_an_object);
+    RUN_TEST(test_missing_colon);
+    RUN_TEST(test_nesting_at_limit);
+    RUN_TEST(test_nesting_too_deep);
+    RUN_TEST(test_reset);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
@@ -0,0 +1,250 @@
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "tools/ToolRegistry.h"
+#include "tools/ParallelToolExecutor.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace ESPAI;
+
+static int handlerCalls = 0;
+
+static Tool makeCachedTool(const char* name, uint32_t ttlMs) {
+    Tool tool(name, "test tool", "{}", [](const String& args) -> String {
+        handlerCalls++;
+        return String("{\"calls\":") + String(handlerCalls) + "}";
+    });
+    tool.cacheTtlMs = ttlMs;
+    return tool;
+}
+
+static void sleepMs(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void setUp() {
+    handlerCalls = 0;
+}
+
+void tearDown() {}
+
+void test_canonical_arguments_sorts_keys() {
+    String a = ToolResultCache::canonicalArguments("{\"room\":\"kitchen\",\"unit\":\"c\"}");
+    String b = ToolResultCache::canonicalArguments("{ \"unit\": \"c\", \"room\": \"kitchen\" }");
+    TEST_ASSERT_EQUAL_STRING(a.c_str(), b.c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"room\":\"kitchen\",\"unit\":\"c\"}", a.c_str());
+}
+
+void test_canonical_arguments_nested() {
+    String c = ToolResultCache::canonicalArguments("{\"z\":[{\"b\":1,\"a\":2}],\"a\":{\"y\":true,\"x\":null}}");
+    TEST_ASSERT_EQUAL_STRING("{\"a\":{\"x\":null,\"y\":true},\"z\":[{\"a\":2,\"b\":1}]}", c.c_str());
+}
+
+void test_canonical_arguments_invalid_unchanged() {
+    TEST_ASSERT_EQUAL_STRING("not json", ToolResultCache::canonicalArguments("not json").c_str());
+}
+
+void test_cache_get_put() {
+    ToolResultCache cache;
+    String result;
+    TEST_ASSERT_FALSE(cache.get("t", "{}", result));
+    cache.put("t", "{}", "value", 1000);
+    TEST_ASSERT_TRUE(cache.get("t", "{}", result));
+    TEST_ASSERT_EQUAL_STRING("value", result.c_str());
+    TEST_ASSERT_EQUAL(1, cache.getHits());
+    TEST_ASSERT_EQUAL(1, cache.getMisses());
+    TEST_ASSERT_EQUAL(1, cache.size());
+}
+
+void test_cache_key_includes_tool_name() {
+    ToolResultCache cache;
+    String result;
+    cache.put("a", "{}", "from a", 1000);
+    TEST_ASSERT_FALSE(cache.get("b", "{}", result));
+}
+
+void test_cache_ttl_expires() {
+    ToolResultCache cache;
+    String result;
+    cache.put("t", "{}", "value", 20);
+    TEST_ASSERT_TRUE(cache.get("t", "{}", result));
+    sleepMs(30);
+    TEST_ASSERT_FALSE(cache.get("t", "{}", result));
+    TEST_ASSERT_EQUAL(0, cache.size());
+}
+
+void test_cache_entry_limit_evicts_lru() {
+    ToolResultCache cache(2, 4096);
+    String result;
+    cache.put("t", "1", "one", 1000);
+    cache.put("t", "2", "two", 1000);
+    sleepMs(2);
+    TEST_ASSERT_TRUE(cache.get("t", "1", result));  // "2" is now least recently used
+    cache.put("t", "3", "three", 1000);
+
+    TEST_ASSERT_EQUAL(2, cache.size());
+    TEST_ASSERT_TRUE(cache.get("t", "1", result));
+    TEST_ASSERT_TRUE(cache.get("t", "3", result));
+    TEST_ASSERT_FALSE(cache.get("t", "2", result));
+}
+
+void test_cache_byte_limit() {
+    ToolResultCache cache(16, 26);
+    String result;
+    cache.put("t", "1", "0123456789", 1000);   // 13 bytes with the "t\n1" key
+    cache.put("t", "2", "0123456789", 1000);
+    TEST_ASSERT_EQUAL(26, cache.getBytes());
+    cache.put("t", "3", "0123456789", 1000);
+    TEST_ASSERT_EQUAL(2, cache.size());
+    TEST_ASSERT_EQUAL(26, cache.getBytes());
+
+    cache.put("t", "4", "this result is larger than the whole cache", 1000);
+    TEST_ASSERT_FALSE(cache.get("t", "4", result));
+}
+
+void test_cache_invalidate_and_clear() {
+    ToolResultCache cache;
+    String result;
+    cache.put("temp", "{}", "a", 1000);
+    cache.put("temperature", "{}", "b", 1000);
+    cache.invalidate("temp");
+    TEST_ASSERT_FALSE(cache.get("temp", "{}", result));
+    TEST_ASSERT_TRUE(cache.get("temperature", "{}", result));
+
+    cache.clear();
+    TEST_ASSERT_EQUAL(0, cache.size());
+    TEST_ASSERT_EQUAL(0, cache.getBytes());
+}
+
+void test_cache_shrink_limits() {
+    ToolResultCache cache;
+    cache.put("t", "1", "a", 1000);
+    cache.put("t", "2", "b", 1000);
+    cache.put("t", "3", "c", 1000);
+    cache.setMaxEntries(1);
+    TEST_ASSERT_EQUAL(1, cache.size());
+}
+
+void test_registry_caches_opt_in_tool() {
+    ToolRegistry registry;
+    registry.registerTool(makeCachedTool("get_temperature", 1000));
+
+    String first = registry.executeToolCall("get_temperature", "{\"room\":\"kitchen\"}");
+    String second = registry.executeToolCall("get_temperature", "{ \"room\" : \"kitchen\" }");
+    ToolResult third = registry.execute(ToolCall("c3", "get_temperature", "{\"room\":\"kitchen\"}"));
+
+    TEST_ASSERT_EQUAL(1, handlerCalls);
+    TEST_ASSERT_EQUAL_STRING(first.c_str(), second.c_str());
+    TEST_ASSERT_EQUAL_STRING(first.c_str(), third.result.c_str());
+    TEST_ASSERT_EQUAL_STRING("c3", third.toolCallId.c_str());
+    TEST_ASSERT_EQUAL(2, registry.getCache().getHits());
+    TEST_ASSERT_EQUAL(1, registry.getCache().getMisses());
+
+    registry.executeToolCall("get_temperature", "{\"room\":\"hall\"}");
+    TEST_ASSERT_EQUAL(2, handlerCalls);
+}
+
+void test_registry_uncached_tool_always_runs() {
+    ToolRegistry registry;
+    registry.registerTool(makeCachedTool("t", 0));
+    registry.executeToolCall("t", "{}");
+    registry.executeToolCall("t", "{}");
+    TEST_ASSERT_EQUAL(2, handlerCalls);
+    TEST_ASSERT_EQUAL(0, registry.getCache().getMisses());
+}
+
+void test_registry_unregister_drops_entries() {
+    ToolRegistry registry;
+    registry.registerTool(makeCachedTool("t", 1000));
+    registry.executeToolCall("t", "{}");
+    TEST_ASSERT_EQUAL(1, registry.getCache().size());
+    registry.unregisterTool("t");
+    TEST_ASSERT_EQUAL(0, registry.getCache().size());
+}
+
+void test_parallel_executor_uses_cache() {
+    ToolRegistry registry;
+    Tool tool = makeCachedTool("t", 1000);
+    tool.parallelSafe = true;
+    registry.registerTool(tool);
+
+    ParallelToolExecutor executor(2);
+    executor.execute(registry, {ToolCall("1", "t", "{\"a\":1}")});
+    auto results = executor.execute(registry, {ToolCall("2", "t", "{\"a\":1}"), ToolCall("3", "t", "{\"a\":2}")});
+
+    TEST_ASSERT_EQUAL(2, handlerCalls);
+    TEST_ASSERT_EQUAL_STRING("2", results[0].toolCallId.c_str());
+    TEST_ASSERT_TRUE(results[0].success);
+    TEST_ASSERT_EQUAL_STRING("{\"calls\":1}", results[0].result.c_str());
+    TEST_ASSERT_EQUAL(1, registry.getCache().getHits());
+}
+
+void test_registry_cache_shared_across_tasks() {
+    ToolRegistry registry;
+    static std::atomic<int> runs(0);
+    runs = 0;
+    Tool tool("t", "test tool", "{\"type\":\"object\"}", [](const String& args) -> String {
+        runs++;
+        return args;
+    });
+    tool.cacheTtlMs = 10000;
+    registry.registerTool(tool);
+
+    const int perThread = 200;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&registry, t]() {
+            for (int i = 0; i < perThread; i++) {
+                String args = String("{\"n\":") + String((i + t) % 8) + "}";
+                registry.executeToolCall("t", args);
+                registry.getToolSchema("t", SchemaDialect::Gemini);
+                registry.toAnthropicSchema();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const ToolResultCache& cache = registry.getCache();
+    TEST_ASSERT_EQUAL(4 * perThread, cache.getHits() + cache.getMisses());
+    TEST_ASSERT_EQUAL(8, cache.size());
+    TEST_ASSERT_EQUAL((int)cache.getMisses(), runs.load());
+}
+
+int main() {
+    UNITY_BEGIN();
+
+    // Argument canonicalization
+    RUN_TEST(test_canonical_arguments_sorts_keys);
+    RUN_TEST(test_canonical_arguments_nested);
+    RUN_TEST(test_canonical_arguments_invalid_unchanged);
+
+    // Cache
+    RUN_TEST(test_cache_get_put);
+    RUN_TEST(test_cache_key_includes_tool_name);
+    RUN_TEST(test_cache_ttl_expires);
+    RUN_TEST(test_cache_entry_limit_evicts_lru);
+    RUN_TEST(test_cache_byte_limit);
+    RUN_TEST(test_cache_invalidate_and_clear);
+    RUN_TEST(test_cache_shrink_limits);
+
+    // Registry integration
+    RUN_TEST(test_registry_caches_opt_in_tool);
+    RUN_TEST(test_registry_uncached_tool_always_runs);
+    RUN_TEST(test_registry_unregister_drops_entries);
+    RUN_TEST(test_parallel_executor_uses_cache);
+    RUN_TEST(test_registry_cache_shared_across_tasks);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
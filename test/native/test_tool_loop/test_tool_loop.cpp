@@ -0,0 +1,350 @@
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "providers/OpenAIProvider.h"
+#include "tools/ToolLoop.h"
+#include "../../mocks/transport/FakeTransport.h"
+#include <thread>
+
+using namespace ESPAI;
+
+static const char* TOOL_CALL_RESPONSE =
+    "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":null,"
+    "\"tool_calls\":[{\"id\":\"call_1\",\"type\":\"function\","
+    "\"function\":{\"name\":\"get_temp\",\"arguments\":\"{}\"}}]},"
+    "\"finish_reason\":\"tool_calls\"}],"
+    "\"usage\":{\"prompt_tokens\":10,\"completion_tokens\":5}}";
+
+static const char* FINAL_RESPONSE =
+    "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":\"It is 21C\"},"
+    "\"finish_reason\":\"stop\"}],"
+    "\"usage\":{\"prompt_tokens\":20,\"completion_tokens\":4}}";
+
+static FakeTransport* transport = nullptr;
+static OpenAIProvider* provider = nullptr;
+static ToolRegistry* registry = nullptr;
+static int toolRuns = 0;
+
+void setUp() {
+    transport = new FakeTransport();
+    provider = new OpenAIProvider("test-key", "gpt-4o");
+    provider->setTransport(transport);
+    registry = new ToolRegistry();
+    toolRuns = 0;
+
+    Tool tool;
+    tool.name = "get_temp";
+    tool.description = "Read temperature";
+    tool.parametersJson = "{\"type\":\"object\",\"properties\":{}}";
+    tool.handler = [](const String& args) -> String {
+        (void)args;
+        toolRuns++;
+        return "{\"celsius\":21}";
+    };
+    registry->registerTool(tool);
+}
+
+void tearDown() {
+    delete registry;
+    delete provider;
+    delete transport;
+    registry = nullptr;
+    provider = nullptr;
+    transport = nullptr;
+}
+
+// Blocking loop
+
+void test_loop_runs_tool_then_answers() {
+    transport->addResponse(200, TOOL_CALL_RESPONSE);
+    transport->addResponse(200, FINAL_RESPONSE);
+
+    Conversation conversation;
+    conversation.addUserMessage("How warm is it?");
+
+    ToolLoopResult result = runWithTools(*provider, conversation, *registry);
+
+    TEST_ASSERT_TRUE(result.response.success);
+    TEST_ASSERT_EQUAL_STRING("It is 21C", result.response.content.c_str());
+    TEST_ASSERT_EQUAL(1, toolRuns);
+    TEST_ASSERT_EQUAL(2, result.iterationCount());
+    TEST_ASSERT_EQUAL(1, result.iterations[0].toolCalls);
+    TEST_ASSERT_EQUAL(0, result.iterations[1].toolCalls);
+    TEST_ASSERT_EQUAL(10, result.iterations[0].promptTokens);
+    TEST_ASSERT_EQUAL(30, result.response.promptTokens);
+    TEST_ASSERT_EQUAL(9, result.response.completionTokens);
+}
+
+void test_loop_appends_to_conversation() {
+    transport->addResponse(200, TOOL_CALL_RESPONSE);
+    transport->addResponse(200, FINAL_RESPONSE);
+
+    Conversation conversation;
+    conversation.addUserMessage("How warm is it?");
+    runWithTools(*provider, conversation, *registry);
+
+    const auto& messages = conversation.getMessages();
+    TEST_ASSERT_EQUAL(4, messages.size());
+    TEST_ASSERT_EQUAL(Role::Assistant, messages[1].role);
+    TEST_ASSERT_TRUE(messages[1].hasToolCalls());
+    TEST_ASSERT_EQUAL(Role::Tool, messages[2].role);
+    TEST_ASSERT_EQUAL_STRING("call_1", messages[2].name.c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"celsius\":21}", messages[2].content.c_str());
+    TEST_ASSERT_EQUAL(Role::Assistant, messages[3].role);
+    TEST_ASSERT_EQUAL_STRING("It is 21C", messages[3].content.c_str());
+}
+
+void test_loop_sends_tools_and_results() {
+    transport->addResponse(200, TOOL_CALL_RESPONSE);
+    transport->addResponse(200, FINAL_RESPONSE);
+
+    Conversation conversation;
+    conversation.setSystemPrompt("You are a thermostat");
+    conversation.addUserMessage("How warm is it?");
+    runWithTools(*provider, conversation, *registry);
+
+    TEST_ASSERT_EQUAL(2, transport->requests.size());
+    const String& first = transport->requests[0].body;
+    TEST_ASSERT_TRUE(first.indexOf("get_temp") >= 0);
+    TEST_ASSERT_TRUE(first.indexOf("You are a thermostat") >= 0);
+
+    const String& second = transport->requests[1].body;
+    TEST_ASSERT_TRUE(second.indexOf("\"tool_call_id\":\"call_1\"") >= 0);
+}
+
+void test_loop_stops_at_iteration_limit() {
+    registry->setMaxIterations(2);
+    transport->addResponse(200, TOOL_CALL_RESPONSE);
+    transport->addResponse(200, TOOL_CALL_RESPONSE);
+    transport->addResponse(200, FINAL_RESPONSE);
+
+    Conversation conversation;
+    conversation.addUserMessage("Loop forever");
+    ToolLoopResult result = runWithTools(*provider, conversation, *registry);
+
+    TEST_ASSERT_FALSE(result.response.success);
+    TEST_ASSERT_EQUAL(ErrorCode::ToolLimitReached, result.response.error);
+    TEST_ASSERT_EQUAL(2, result.iterationCount());
+    TEST_ASSERT_EQUAL(2, transport->requests.size());
+    TEST_ASSERT_EQUAL(2, toolRuns);
+}
+
+void test_loop_returns_http_error() {
+    transport->addResponse(200, TOOL_CALL_RESPONSE);
+    transport->addResponse(500, "{\"error\":{\"message\":\"boom\"}}");
+
+    Conversation conversation;
+    conversation.addUserMessage("Hi");
+    ToolLoopResult result = runWithTools(*provider, conversation, *registry);
+
+    TEST_ASSERT_FALSE(result.response.success);
+    TEST_ASSERT_EQUAL(ErrorCode::ServerError, result.response.error);
+    TEST_ASSERT_EQUAL(2, result.iterationCount());
+}
+
+void test_loop_without_tool_calls() {
+    transport->addResponse(200, FINAL_RESPONSE);
+
+    Conversation conversation;
+    conversation.addUserMessage("Hi");
+    ToolLoopResult result = runWithTools(*provider, conversation, *registry);
+
+    TEST_ASSERT_TRUE(result.response.success);
+    TEST_ASSERT_EQUAL(1, result.iterationCount());
+    TEST_ASSERT_EQUAL(0, toolRuns);
+    TEST_ASSERT_EQUAL(2, conversation.size());
+}
+
+// Streaming loop
+
+void test_streaming_loop() {
+    transport->streams.push_back(
+        "data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":0,\"id\":\"call_s\",\"type\":\"function\",\"function\":{\"name\":\"get_temp\",\"arguments\":\"{}\"}}]}}]}\n\n"
+        "data: {\"choices\":[{\"delta\":{},\"finish_reason\":\"tool_calls\"}]}\n\n"
+        "data: [DONE]\n\n");
+    transport->streams.push_back(
+        "data: {\"choices\":[{\"delta\":{\"content\":\"Warm: \"}}]}\n\n"
+        "data: {\"choices\":[{\"delta\":{\"content\":\"21C\"}}]}\n\n"
+        "data: [DONE]\n\n");
+
+    Conversation conversation;
+    conversation.addUserMessage("How warm is it?");
+
+    String streamed;
+    int doneCount = 0;
+    ToolLoopResult result = runWithTools(*provider, conversation, *registry, ChatOptions(),
+        [&](const String& chunk, bool done) {
+            streamed += chunk;
+            if (done) {
+                doneCount++;
+            }
+        });
+
+    TEST_ASSERT_TRUE(result.response.success);
+    TEST_ASSERT_EQUAL_STRING("Warm: 21C", streamed.c_str());
+    TEST_ASSERT_EQUAL_STRING("Warm: 21C", result.response.content.c_str());
+    TEST_ASSERT_EQUAL(1, doneCount);
+    TEST_ASSERT_EQUAL(1, toolRuns);
+    TEST_ASSERT_EQUAL(2, result.iterationCount());
+    TEST_ASSERT_EQUAL(4, conversation.size());
+}
+
+void test_streaming_loop_reuses_early_dispatch_results() {
+    provider->setEarlyToolDispatch(registry);
+    transport->streams.push_back(
+        "data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":0,\"id\":\"call_s\",\"type\":\"function\",\"function\":{\"name\":\"get_temp\",\"arguments\":\"{}\"}}]}}]}\n\n"
+        "data: [DONE]\n\n");
+    transport->streams.push_back(
+        "data: {\"choices\":[{\"delta\":{\"content\":\"OK\"}}]}\n\n"
+        "data: [DONE]\n\n");
+
+    Conversation conversation;
+    conversation.addUserMessage("How warm is it?");
+    ToolLoopResult result = runWithTools(*provider, conversation, *registry, ChatOptions(),
+        [](const String& chunk, bool done) { (void)chunk; (void)done; });
+
+    TEST_ASSERT_TRUE(result.response.success);
+    TEST_ASSERT_EQUAL(1, toolRuns);
+}
+
+static String twoCallStream(const char* tool) {
+    String stream;
+    for (int i = 0; i < 2; i++) {
+        stream += String("data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":") + String(i) +
+            ",\"id\":\"call_" + String(i + 1) + "\",\"type\":\"function\",\"function\":{\"name\":\"" +
+            tool + "\",\"arguments\":\"{}\"}}]}}]}\n\n";
+    }
+    return stream +
+        "data: {\"choices\":[{\"delta\":{\"content\":\"done\"},\"finish_reason\":\"tool_calls\"}]}\n\n"
+        "data: [DONE]\n\n";
+}
+
+void test_early_dispatch_runs_parallel_tools_on_workers() {
+    static std::thread::id handlerThreads[2];
+    static int calls = 0;
+    calls = 0;
+    Tool tool("read_sensor", "Read a sensor", "{\"type\":\"object\"}", [](const String& args) -> String {
+        (void)args;
+        handlerThreads[calls++ % 2] = std::this_thread::get_id();
+        return "{\"ok\":true}";
+    });
+    tool.parallelSafe = true;
+    registry->registerTool(tool);
+    registry->setParallelWorkers(1);
+    provider->setEarlyToolDispatch(registry);
+    transport->streams.push_back(twoCallStream("read_sensor"));
+
+    std::vector<Message> messages;
+    messages.push_back(Message(Role::User, "Read both"));
+    TEST_ASSERT_TRUE(provider->chatStream(messages, ChatOptions(), [](const String& chunk, bool done) {
+        (void)chunk;
+        (void)done;
+    }));
+
+    const std::vector<ToolResult>& results = provider->getLastToolResults();
+    TEST_ASSERT_EQUAL(2, results.size());
+    TEST_ASSERT_EQUAL_STRING("call_1", results[0].toolCallId.c_str());
+    TEST_ASSERT_EQUAL_STRING("call_2", results[1].toolCallId.c_str());
+    TEST_ASSERT_EQUAL(2, calls);
+    TEST_ASSERT_TRUE(handlerThreads[0] != std::this_thread::get_id());
+    TEST_ASSERT_TRUE(handlerThreads[1] != std::this_thread::get_id());
+}
+
+void test_early_dispatch_runs_serial_tools_after_stream() {
+    static bool streamEnded = false;
+    static bool endedBeforeHandler = false;
+    streamEnded = false;
+    endedBeforeHandler = false;
+    registry->registerTool(Tool("set_relay", "Switch a relay", "{\"type\":\"object\"}", [](const String& args) -> String {
+        (void)args;
+        endedBeforeHandler = streamEnded;
+        return "{\"ok\":true}";
+    }));
+    provider->setEarlyToolDispatch(registry);
+    transport->streams.push_back(twoCallStream("set_relay"));
+
+    std::vector<Message> messages;
+    messages.push_back(Message(Role::User, "Switch both"));
+    TEST_ASSERT_TRUE(provider->chatStream(messages, ChatOptions(), [](const String& chunk, bool done) {
+        (void)chunk;
+        if (done) {
+            streamEnded = true;
+        }
+    }));
+
+    TEST_ASSERT_EQUAL(2, provider->getLastToolResults().size());
+    TEST_ASSERT_TRUE(endedBeforeHandler);
+}
+
+// Stream abort
+
+void test_stop_condition_aborts_transport() {
+    transport->streams.push_back(
+        "data: {\"choices\":[{\"delta\":{\"content\":\"one two\"}}]}\n\n"
+        "data: {\"choices\":[{\"delta\":{\"content\":\" three\"}}]}\n\n"
+        "data: [DONE]\n\n");
+
+    ChatOptions options;
+    options.stopStrings.push_back("two");
+
+    std::vector<Message> messages;
+    messages.push_back(Message(Role::User, "Count"));
+    String streamed;
+    bool ok = provider->chatStream(messages, options, [&](const String& chunk, bool done) {
+        (void)done;
+        streamed += chunk;
+    });
+
+    TEST_ASSERT_TRUE(ok);
+    TEST_ASSERT_TRUE(transport->streamAborted);
+    TEST_ASSERT_EQUAL_STRING("one ", streamed.c_str());
+    TEST_ASSERT_EQUAL_STRING("stop_sequence", provider->getLastStreamResponse().stopReason.c_str());
+}
+
+void test_normal_stream_end_keeps_connection() {
+    transport->streams.push_back(
+        "data: {\"choices\":[{\"delta\":{\"content\":\"hi\"}}]}\n\n"
+        "data: [DONE]\n\n");
+
+    std::vector<Message> messages;
+    messages.push_back(Message(Role::User, "Hi"));
+    provider->chatStream(messages, ChatOptions(), [](const String& chunk, bool done) {
+        (void)chunk;
+        (void)done;
+    });
+
+    TEST_ASSERT_FALSE(transport->streamAborted);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+
+    // Blocking loop
+    RUN_TEST(test_loop_runs_tool_then_answers);
+    RUN_TEST(test_loop_appends_to_conversation);
+    RUN_TEST(test_loop_sends_tools_and_results);
+    RUN_TEST(test_loop_stops_at_iteration_limit);
+    RUN_TEST(test_loop_returns_http_error);
+    RUN_TEST(test_loop_without_tool_calls);
+
+    // Streaming loop
+    RUN_TEST(test_streaming_loop);
+    RUN_TEST(test_streaming_loop_reuses_early_dispatch_results);
+    RUN_TEST(test_early_dispatch_runs_parallel_tools_on_workers);
+    RUN_TEST(test_early_dispatch_runs_serial_tools_after_stream);
+
+    // Stream abort
+    RUN_TEST(test_stop_condition_aborts_transport);
+    RUN_TEST(test_normal_stream_end_keeps_connection);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
@@ -184,21 +184,21 @@ void test_register_multiple_tools() {
 }
 
 void test_max_tools_limit() {
-    for (int i = 0; i < ESPAI_MAX_TOOLS; i++) {
+    for (int i = 0; i < ESPAI_MAX_REGISTRY_TOOLS; i++) {
         Tool tool;
         tool.name = "tool_" + String(i);
         bool result = registry->registerTool(tool);
         TEST_ASSERT_TRUE(result);
     }
 
-    TEST_ASSERT_EQUAL(ESPAI_MAX_TOOLS, registry->toolCount());
+    TEST_ASSERT_EQUAL(ESPAI_MAX_REGISTRY_TOOLS, registry->toolCount());
 
     Tool extraTool;
     extraTool.name = "extra_tool";
     bool result = registry->registerTool(extraTool);
 
     TEST_ASSERT_FALSE(result);
-    TEST_ASSERT_EQUAL(ESPAI_MAX_TOOLS, registry->toolCount());
+    TEST_ASSERT_EQUAL(ESPAI_MAX_REGISTRY_TOOLS, registry->toolCount());
 }
 
 void test_find_tool_exists() {
@@ -402,6 +402,23 @@ void test_execute_tool_calls_with_failure() {
     TEST_ASSERT_FALSE(results[1].success);
 }
 
+void test_execute_single_returns_result() {
+    Tool tool;
+    tool.name = "echo";
+    tool.handler = [](const String& args) { return args; };
+    registry->registerTool(tool);
+
+    ToolResult result = registry->execute(ToolCall("id_e", "echo", "{\"x\":1}"));
+    TEST_ASSERT_TRUE(result.success);
+    TEST_ASSERT_EQUAL_STRING("id_e", result.toolCallId.c_str());
+    TEST_ASSERT_EQUAL_STRING("echo", result.toolName.c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"x\":1}", result.result.c_str());
+
+    ToolResult missing = registry->execute(ToolCall("id_m", "missing", "{}"));
+    TEST_ASSERT_FALSE(missing.success);
+    TEST_ASSERT_TRUE(missing.result.indexOf("Tool not found") >= 0);
+}
+
 void test_to_openai_schema_empty() {
     String schema = registry->toOpenAISchema();
 
@@ -670,6 +687,7 @@ int main(int argc, char** argv) {
     RUN_TEST(test_execute_tool_call_struct);
     RUN_TEST(test_execute_multiple_tool_calls);
     RUN_TEST(test_execute_tool_calls_with_failure);
+    RUN_TEST(test_execute_single_returns_result);
 
     RUN_TEST(test_to_openai_schema_empty);
     RUN_TEST(test_to_openai_schema_single_tool);
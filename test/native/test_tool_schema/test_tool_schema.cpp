@@ -0,0 +1,211 @@
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "tools/ToolSchema.h"
+#include "tools/ToolRegistry.h"
+#include "providers/GeminiProvider.h"
+#include "providers/AnthropicProvider.h"
+#include <ArduinoJson.h>
+
+using namespace ESPAI;
+
+static const char* kLedSchema = R"({
+    "$schema": "http://json-schema.org/draft-07/schema#",
+    "type": "object",
+    "additionalProperties": false,
+    "properties": {
+        "pin": {"type": "integer", "minimum": 0, "maximum": 39, "$comment": "GPIO"},
+        "mode": {"type": ["string", "null"], "enum": ["on", "off"]},
+        "pattern": {
+            "type": "array",
+            "items": {"type": "object", "additionalProperties": false, "properties": {"ms": {"type": "integer"}}}
+        }
+    },
+    "required": ["pin"]
+})";
+
+void setUp() {}
+void tearDown() {}
+
+// normalizeToolSchema
+
+void test_empty_schema_is_valid() {
+    String output = "stale";
+    TEST_ASSERT_TRUE(normalizeToolSchema("", SchemaDialect::OpenAI, output));
+    TEST_ASSERT_EQUAL_STRING("", output.c_str());
+}
+
+void test_openai_minifies_and_drops_schema_keyword() {
+    String output;
+    TEST_ASSERT_TRUE(normalizeToolSchema(kLedSchema, SchemaDialect::OpenAI, output));
+    TEST_ASSERT_EQUAL(-1, output.indexOf(' '));
+    TEST_ASSERT_EQUAL(-1, output.indexOf("$schema"));
+    TEST_ASSERT_TRUE(output.indexOf("\"additionalProperties\":false") >= 0);
+
+    String anthropic;
+    TEST_ASSERT_TRUE(normalizeToolSchema(kLedSchema, SchemaDialect::Anthropic, anthropic));
+    TEST_ASSERT_EQUAL_STRING(output.c_str(), anthropic.c_str());
+}
+
+void test_gemini_strips_unsupported_keywords() {
+    String output;
+    TEST_ASSERT_TRUE(normalizeToolSchema(kLedSchema, SchemaDialect::Gemini, output));
+    TEST_ASSERT_EQUAL(-1, output.indexOf("$schema"));
+    TEST_ASSERT_EQUAL(-1, output.indexOf("additionalProperties"));
+    TEST_ASSERT_EQUAL(-1, output.indexOf("$comment"));
+
+    JsonDocument doc;
+    deserializeJson(doc, output);
+    TEST_ASSERT_EQUAL_STRING("object", doc["type"].as<const char*>());
+    TEST_ASSERT_EQUAL(39, doc["properties"]["pin"]["maximum"].as<int>());
+    TEST_ASSERT_EQUAL_STRING("pin", doc["required"][0].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("integer", doc["properties"]["pattern"]["items"]["properties"]["ms"]["type"].as<const char*>());
+}
+
+void test_gemini_nullable_type() {
+    String output;
+    TEST_ASSERT_TRUE(normalizeToolSchema(kLedSchema, SchemaDialect::Gemini, output));
+
+    JsonDocument doc;
+    deserializeJson(doc, output);
+    TEST_ASSERT_EQUAL_STRING("string", doc["properties"]["mode"]["type"].as<const char*>());
+    TEST_ASSERT_TRUE(doc["properties"]["mode"]["nullable"].as<bool>());
+    TEST_ASSERT_EQUAL(2, doc["properties"]["mode"]["enum"].size());
+}
+
+void test_gemini_drops_empty_object() {
+    String output = "stale";
+    TEST_ASSERT_TRUE(normalizeToolSchema(R"({"type":"object","properties":{}})", SchemaDialect::Gemini, output));
+    TEST_ASSERT_EQUAL_STRING("", output.c_str());
+    TEST_ASSERT_TRUE(normalizeToolSchema("{}", SchemaDialect::Gemini, output));
+    TEST_ASSERT_EQUAL_STRING("", output.c_str());
+
+    TEST_ASSERT_TRUE(normalizeToolSchema("{}", SchemaDialect::OpenAI, output));
+    TEST_ASSERT_EQUAL_STRING("{}", output.c_str());
+}
+
+void test_invalid_schemas_rejected() {
+    String output;
+    String error;
+    TEST_ASSERT_FALSE(normalizeToolSchema("{\"type\":", SchemaDialect::OpenAI, output, &error));
+    TEST_ASSERT_EQUAL_STRING("Invalid parameters JSON", error.c_str());
+    TEST_ASSERT_FALSE(normalizeToolSchema("[1,2]", SchemaDialect::OpenAI, output, &error));
+    TEST_ASSERT_EQUAL_STRING("Parameters schema must be a JSON object", error.c_str());
+    TEST_ASSERT_FALSE(normalizeToolSchema(R"({"type":"string"})", SchemaDialect::Gemini, output, &error));
+    TEST_ASSERT_FALSE(normalizeToolSchema(R"({"properties":[]})", SchemaDialect::OpenAI, output, &error));
+    TEST_ASSERT_FALSE(normalizeToolSchema(R"({"required":"pin"})", SchemaDialect::OpenAI, output));
+}
+
+// ToolRegistry
+
+void test_registry_rejects_invalid_schema() {
+    ToolRegistry registry;
+    TEST_ASSERT_FALSE(registry.registerTool(Tool("bad", "Broken", "{not json")));
+    TEST_ASSERT_FALSE(registry.hasTool("bad"));
+    TEST_ASSERT_TRUE(registry.registerTool(Tool("good", "Fine", kLedSchema)));
+}
+
+void test_registry_gemini_schema() {
+    ToolRegistry registry;
+    registry.registerTool(Tool("set_led", "Switch an LED", kLedSchema));
+    registry.registerTool(Tool("reboot", "Reboot", "{}"));
+
+    JsonDocument doc;
+    deserializeJson(doc, registry.toGeminiSchema());
+    JsonArray declarations = doc[0]["functionDeclarations"];
+    TEST_ASSERT_EQUAL(2, declarations.size());
+    TEST_ASSERT_EQUAL_STRING("set_led", declarations[0]["name"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("Switch an LED", declarations[0]["description"].as<const char*>());
+    TEST_ASSERT_TRUE(declarations[0]["parameters"]["additionalProperties"].isNull());
+    TEST_ASSERT_TRUE(declarations[1]["parameters"].isNull());
+
+    ToolRegistry empty;
+    TEST_ASSERT_EQUAL_STRING("[]", empty.toGeminiSchema().c_str());
+}
+
+void test_registry_schema_cache_follows_changes() {
+    ToolRegistry registry;
+    registry.registerTool(Tool("a", "A", "{}"));
+    String first = registry.toOpenAISchema();
+    TEST_ASSERT_EQUAL_STRING(first.c_str(), registry.toOpenAISchema().c_str());
+
+    registry.registerTool(Tool("b", "B", "{}"));
+    JsonDocument doc;
+    deserializeJson(doc, registry.toOpenAISchema());
+    TEST_ASSERT_EQUAL(2, doc.size());
+
+    registry.unregisterTool("a");
+    deserializeJson(doc, registry.toAnthropicSchema());
+    TEST_ASSERT_EQUAL(1, doc.size());
+    TEST_ASSERT_EQUAL_STRING("b", doc[0]["name"].as<const char*>());
+}
+
+void test_registry_tool_schema_per_dialect() {
+    ToolRegistry registry;
+    registry.registerTool(Tool("set_led", "Switch an LED", kLedSchema));
+
+    String openai = registry.getToolSchema("set_led", SchemaDialect::OpenAI);
+    String gemini = registry.getToolSchema("set_led", SchemaDialect::Gemini);
+    TEST_ASSERT_TRUE(openai.indexOf("additionalProperties") >= 0);
+    TEST_ASSERT_EQUAL(-1, gemini.indexOf("additionalProperties"));
+    TEST_ASSERT_EQUAL_STRING("", registry.getToolSchema("missing", SchemaDialect::OpenAI).c_str());
+}
+
+// Providers
+
+void test_gemini_provider_uses_normalized_schema() {
+    GeminiProvider provider("test-api-key", "gemini-2.5-flash");
+    TEST_ASSERT_TRUE(provider.addTool(Tool("set_led", "Switch an LED", kLedSchema)));
+    TEST_ASSERT_FALSE(provider.addTool(Tool("bad", "Broken", "{not json")));
+
+    std::vector<Message> messages = {Message(Role::User, "Blink")};
+    JsonDocument doc;
+    deserializeJson(doc, provider.buildRequestBody(messages, ChatOptions()));
+    JsonArray declarations = doc["tools"][0]["functionDeclarations"];
+    TEST_ASSERT_EQUAL(1, declarations.size());
+    TEST_ASSERT_TRUE(declarations[0]["parameters"]["additionalProperties"].isNull());
+    TEST_ASSERT_TRUE(declarations[0]["parameters"]["properties"]["mode"]["nullable"].as<bool>());
+}
+
+void test_anthropic_provider_keeps_full_schema() {
+    AnthropicProvider provider("test-api-key", "claude-sonnet-4-5");
+    provider.addTool(Tool("set_led", "Switch an LED", kLedSchema));
+
+    std::vector<Message> messages = {Message(Role::User, "Blink")};
+    JsonDocument doc;
+    deserializeJson(doc, provider.buildRequestBody(messages, ChatOptions()));
+    TEST_ASSERT_FALSE(doc["tools"][0]["input_schema"]["additionalProperties"].as<bool>());
+    TEST_ASSERT_FALSE(doc["tools"][0]["input_schema"]["additionalProperties"].isNull());
+    TEST_ASSERT_TRUE(doc["tools"][0]["input_schema"]["$schema"].isNull());
+}
+
+int main() {
+    UNITY_BEGIN();
+
+    // normalizeToolSchema
+    RUN_TEST(test_empty_schema_is_valid);
+    RUN_TEST(test_openai_minifies_and_drops_schema_keyword);
+    RUN_TEST(test_gemini_strips_unsupported_keywords);
+    RUN_TEST(test_gemini_nullable_type);
+    RUN_TEST(test_gemini_drops_empty_object);
+    RUN_TEST(test_invalid_schemas_rejected);
+
+    // ToolRegistry
+    RUN_TEST(test_registry_rejects_invalid_schema);
+    RUN_TEST(test_registry_gemini_schema);
+    RUN_TEST(test_registry_schema_cache_follows_changes);
+    RUN_TEST(test_registry_tool_schema_per_dialect);
+
+    // Providers
+    RUN_TEST(test_gemini_provider_uses_normalized_schema);
+    RUN_TEST(test_anthropic_provider_keeps_full_schema);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
@@ -0,0 +1,297 @@
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "providers/OpenAIProvider.h"
+#include "tools/ToolSelector.h"
+#include "tools/ToolLoop.h"
+#include "../../mocks/transport/FakeTransport.h"
+#include <ArduinoJson.h>
+
+using namespace ESPAI;
+
+static String reply(const String& args) {
+    (void)args;
+    return "{\"ok\":true}";
+}
+
+static ToolRegistry* registry = nullptr;
+
+void setUp() {
+    registry = new ToolRegistry();
+    registry->registerTool(Tool("get_temperature", "Read the temperature of a room", "{}", reply));
+    registry->registerTool(Tool("set_light", "Switch a light on or off", "{}", reply));
+    registry->registerTool(Tool("play_music", "Play a song on the speaker", "{}", reply));
+    registry->registerTool(Tool("get_weather", "Weather forecast for a city", "{}", reply));
+    registry->registerTool(Tool("open_door", "Unlock the front door", "{}", reply));
+}
+
+void tearDown() {
+    delete registry;
+    registry = nullptr;
+}
+
+static bool contains(const std::vector<String>& names, const char* name) {
+    for (const auto& n : names) {
+        if (n == name) return true;
+    }
+    return false;
+}
+
+void test_tokenize() {
+    auto tokens = ToolSelector::tokenize("Turn ON the Kitchen light, please! a1 xyz");
+    TEST_ASSERT_EQUAL(6, tokens.size());
+    TEST_ASSERT_EQUAL_STRING("turn", tokens[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("the", tokens[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("kitchen", tokens[2].c_str());
+    TEST_ASSERT_EQUAL_STRING("xyz", tokens[5].c_str());
+}
+
+void test_keyword_match_ranks_first() {
+    ToolSelector selector(2);
+    auto names = selector.select(*registry, "What is the temperature in the kitchen?");
+    TEST_ASSERT_EQUAL(2, names.size());
+    TEST_ASSERT_EQUAL_STRING("get_temperature", names[0].c_str());
+}
+
+void test_name_words_are_indexed() {
+    ToolSelector selector(1);
+    auto names = selector.select(*registry, "music");
+    TEST_ASSERT_EQUAL_STRING("play_music", names[0].c_str());
+}
+
+void test_top_k_limits_selection() {
+    ToolSelector selector(3);
+    TEST_ASSERT_EQUAL(3, selector.select(*registry, "hello").size());
+    selector.setMaxTools(10);
+    TEST_ASSERT_EQUAL(5, selector.select(*registry, "hello").size());
+}
+
+void test_no_match_keeps_registration_order() {
+    ToolSelector selector(2);
+    auto names = selector.select(*registry, "zzz");
+    TEST_ASSERT_EQUAL_STRING("get_temperature", names[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("set_light", names[1].c_str());
+}
+
+void test_tags_outweigh_description() {
+    ToolSelector selector(1);
+    selector.setTags("open_door", "lock, entrance, light");
+    // "light" is in set_light's name (weight 1) and open_door's tags (weight 2)
+    auto names = selector.select(*registry, "light");
+    TEST_ASSERT_EQUAL_STRING("open_door", names[0].c_str());
+}
+
+void test_pinned_always_included() {
+    ToolSelector selector(2);
+    selector.pin("open_door");
+    TEST_ASSERT_TRUE(selector.isPinned("open_door"));
+
+    auto names = selector.select(*registry, "temperature");
+    TEST_ASSERT_EQUAL(2, names.size());
+    TEST_ASSERT_EQUAL_STRING("open_door", names[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("get_temperature", names[1].c_str());
+
+    selector.unpin("open_door");
+    TEST_ASSERT_FALSE(contains(selector.select(*registry, "temperature"), "open_door"));
+}
+
+void test_pins_count_against_max_tools() {
+    ToolSelector selector(2);
+    selector.pin("open_door");
+    selector.pin("play_music");
+    selector.pin("get_weather");
+
+    auto names = selector.select(*registry, "temperature");
+    TEST_ASSERT_EQUAL(2, names.size());
+    TEST_ASSERT_EQUAL_STRING("play_music", names[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("get_weather", names[1].c_str());
+    TEST_ASSERT_EQUAL(1, selector.getDropped().size());
+    TEST_ASSERT_EQUAL_STRING("open_door", selector.getDropped()[0].c_str());
+
+    selector.unpin("get_weather");
+    selector.select(*registry, "temperature");
+    TEST_ASSERT_TRUE(selector.getDropped().empty());
+}
+
+void test_conversation_pins_are_separate() {
+    ToolSelector selector(2);
+    selector.pin(1, "open_door");
+    TEST_ASSERT_TRUE(selector.isPinned(1, "open_door"));
+    TEST_ASSERT_FALSE(selector.isPinned(2, "open_door"));
+    TEST_ASSERT_FALSE(selector.isPinned("open_door"));
+
+    TEST_ASSERT_TRUE(contains(selector.select(*registry, "temperature", 1), "open_door"));
+    TEST_ASSERT_FALSE(contains(selector.select(*registry, "temperature", 2), "open_door"));
+    TEST_ASSERT_FALSE(contains(selector.select(*registry, "temperature"), "open_door"));
+
+    selector.clearPins(1);
+    TEST_ASSERT_FALSE(selector.isPinned(1, "open_door"));
+}
+
+void test_conversation_pins_evict_oldest() {
+    ToolSelector selector(2);
+    for (uint32_t id = 1; id <= ESPAI_TOOL_SELECT_CONVERSATIONS + 1; id++) {
+        selector.pin(id, "open_door");
+    }
+    TEST_ASSERT_FALSE(selector.isPinned(1, "open_door"));
+    TEST_ASSERT_TRUE(selector.isPinned(2, "open_door"));
+    TEST_ASSERT_TRUE(selector.isPinned(ESPAI_TOOL_SELECT_CONVERSATIONS + 1, "open_door"));
+}
+
+void test_usage_history_breaks_ties() {
+    ToolSelector selector(1);
+    selector.recordUse("get_weather");
+    selector.recordUse("get_weather");
+    TEST_ASSERT_EQUAL(2, selector.getUseCount("get_weather"));
+
+    auto names = selector.select(*registry, "zzz");
+    TEST_ASSERT_EQUAL_STRING("get_weather", names[0].c_str());
+}
+
+void test_custom_scorer() {
+    ToolSelector selector(1);
+    selector.setScorer([](const String& query, const String& name, const String& description) -> float {
+        (void)query;
+        (void)description;
+        return name == "play_music" ? 5.0f : 0.0f;
+    });
+    auto names = selector.select(*registry, "temperature");
+    TEST_ASSERT_EQUAL_STRING("play_music", names[0].c_str());
+}
+
+void test_index_follows_registry_changes() {
+    ToolSelector selector(1);
+    TEST_ASSERT_EQUAL_STRING("get_temperature", selector.select(*registry, "humidity").at(0).c_str());
+
+    registry->registerTool(Tool("get_humidity", "Relative humidity", "{}", reply));
+    TEST_ASSERT_EQUAL_STRING("get_humidity", selector.select(*registry, "humidity").at(0).c_str());
+}
+
+static bool staticHandler(JsonVariantConst args, JsonObject result) {
+    (void)args;
+    result["ok"] = true;
+    return true;
+}
+
+constexpr StaticTool kTools[] = {
+    {"read_co2", "Carbon dioxide level", "{}", staticHandler},
+};
+constexpr auto kToolTable = makeStaticToolTable(kTools);
+
+void test_static_tools_are_candidates() {
+    registry->setStaticTools(kToolTable.view());
+    ToolSelector selector(1);
+    auto names = selector.select(*registry, "What's the CO2 level?");
+    TEST_ASSERT_EQUAL_STRING("read_co2", names[0].c_str());
+}
+
+void test_apply_sets_provider_tools() {
+    FakeTransport transport;
+    OpenAIProvider provider("test-key", "gpt-4o");
+    provider.setTransport(&transport);
+    transport.addResponse(200,
+        "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":\"ok\"},\"finish_reason\":\"stop\"}]}");
+
+    ToolSelector selector(2);
+    selector.apply(provider, *registry, "light");
+    std::vector<Message> messages = {Message(Role::User, "Turn on the light")};
+    provider.chat(messages, ChatOptions());
+
+    JsonDocument body;
+    deserializeJson(body, transport.requests[0].body);
+    TEST_ASSERT_EQUAL(2, body["tools"].size());
+    TEST_ASSERT_EQUAL_STRING("set_light", body["tools"][0]["function"]["name"].as<const char*>());
+}
+
+void test_apply_reports_tools_past_provider_cap() {
+    for (int i = 0; i < ESPAI_MAX_TOOLS; i++) {
+        registry->registerTool(Tool(String("extra_") + String(i), "Extra", "{}", reply));
+    }
+    OpenAIProvider provider("test-key", "gpt-4o");
+    ToolSelector selector(ESPAI_MAX_TOOLS + 2);
+    selector.apply(provider, *registry, "zzz");
+
+    TEST_ASSERT_EQUAL(2, selector.getDropped().size());
+    TEST_ASSERT_EQUAL_STRING("extra_5", selector.getDropped()[0].c_str());
+}
+
+void test_tool_loop_pins_called_tools() {
+    FakeTransport transport;
+    OpenAIProvider provider("test-key", "gpt-4o");
+    provider.setTransport(&transport);
+    transport.addResponse(200,
+        "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":null,"
+        "\"tool_calls\":[{\"id\":\"call_1\",\"type\":\"function\","
+        "\"function\":{\"name\":\"play_music\",\"arguments\":\"{}\"}}]},"
+        "\"finish_reason\":\"tool_calls\"}]}");
+    transport.addResponse(200,
+        "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":\"Playing\"},\"finish_reason\":\"stop\"}]}");
+    transport.addResponse(200,
+        "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":\"18C\"},\"finish_reason\":\"stop\"}]}");
+
+    ToolSelector selector(2);
+    registry->setSelector(&selector);
+
+    Conversation conversation;
+    conversation.addUserMessage("Play a song");
+    TEST_ASSERT_TRUE(runWithTools(provider, conversation, *registry).response.success);
+    TEST_ASSERT_TRUE(selector.isPinned(conversation.getId(), "play_music"));
+    TEST_ASSERT_FALSE(selector.isPinned("play_music"));
+    TEST_ASSERT_EQUAL(1, selector.getUseCount("play_music"));
+
+    // Next turn is about temperature, but the music tool stays in the request
+    conversation.addUserMessage("How warm is the room?");
+    TEST_ASSERT_TRUE(runWithTools(provider, conversation, *registry).response.success);
+
+    JsonDocument body;
+    deserializeJson(body, transport.requests[2].body);
+    TEST_ASSERT_EQUAL(2, body["tools"].size());
+    TEST_ASSERT_EQUAL_STRING("play_music", body["tools"][0]["function"]["name"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("get_temperature", body["tools"][1]["function"]["name"].as<const char*>());
+
+    // Another conversation does not inherit the pin
+    transport.addResponse(200,
+        "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":\"Open\"},\"finish_reason\":\"stop\"}]}");
+    Conversation other;
+    other.addUserMessage("weather temperature");
+    TEST_ASSERT_TRUE(runWithTools(provider, other, *registry).response.success);
+
+    deserializeJson(body, transport.requests[3].body);
+    TEST_ASSERT_EQUAL(2, body["tools"].size());
+    TEST_ASSERT_EQUAL_STRING("get_temperature", body["tools"][0]["function"]["name"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("get_weather", body["tools"][1]["function"]["name"].as<const char*>());
+}
+
+int main() {
+    UNITY_BEGIN();
+
+    // Scoring
+    RUN_TEST(test_tokenize);
+    RUN_TEST(test_keyword_match_ranks_first);
+    RUN_TEST(test_name_words_are_indexed);
+    RUN_TEST(test_top_k_limits_selection);
+    RUN_TEST(test_no_match_keeps_registration_order);
+    RUN_TEST(test_tags_outweigh_description);
+    RUN_TEST(test_pinned_always_included);
+    RUN_TEST(test_pins_count_against_max_tools);
+    RUN_TEST(test_conversation_pins_are_separate);
+    RUN_TEST(test_conversation_pins_evict_oldest);
+    RUN_TEST(test_usage_history_breaks_ties);
+    RUN_TEST(test_custom_scorer);
+    RUN_TEST(test_index_follows_registry_changes);
+    RUN_TEST(test_static_tools_are_candidates);
+
+    // Provider and tool loop
+    RUN_TEST(test_apply_sets_provider_tools);
+    RUN_TEST(test_apply_reports_tools_past_provider_cap);
+    RUN_TEST(test_tool_loop_pins_called_tools);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
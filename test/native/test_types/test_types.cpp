@@ -148,6 +148,7 @@ void test_error_code_to_string() {
     TEST_ASSERT_EQUAL_STRING("ParseError", ESPAI::errorCodeToString(ESPAI::ErrorCode::ParseError));
     TEST_ASSERT_EQUAL_STRING("OutOfMemory", ESPAI::errorCodeToString(ESPAI::ErrorCode::OutOfMemory));
     TEST_ASSERT_EQUAL_STRING("ResponseTooLarge", ESPAI::errorCodeToString(ESPAI::ErrorCode::ResponseTooLarge));
+    TEST_ASSERT_EQUAL_STRING("ToolLimitReached", ESPAI::errorCodeToString(ESPAI::ErrorCode::ToolLimitReached));
 }
 
 void test_response_too_large_error() {
@@ -4,6 +4,7 @@
 #include <freertos/task.h>
 #include <freertos/semphr.h>
 
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
@@ -49,12 +50,11 @@ BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
     if (!sem) return pdFAIL;
     auto* s = static_cast<MockSemaphore*>(sem);
 
-    {
-        std::lock_guard<std::mutex> lock(s->mtx);
-        // Cap at 1 to emulate binary semaphore / mutex behavior
-        if (s->count < 1) {
-            s->count++;
-        }
+    // Notify under the lock so the semaphore can be deleted as soon as it is taken
+    std::lock_guard<std::mutex> lock(s->mtx);
+    // Cap at 1 to emulate binary semaphore / mutex behavior
+    if (s->count < 1) {
+        s->count++;
     }
     s->cv.notify_one();
     return pdPASS;
@@ -65,6 +65,25 @@ void vSemaphoreDelete(SemaphoreHandle_t sem) {
     delete static_cast<MockSemaphore*>(sem);
 }
 
+struct MockTask {
+    uint32_t stackDepth;
+};
+
+static thread_local MockTask* currentTask = nullptr;
+static std::atomic<uint32_t> tasksCreated{0};
+static std::atomic<uint32_t> staticTasksCreated{0};
+
+static TaskHandle_t startMockTask(TaskFunction_t code, void* params, uint32_t stackDepth) {
+    auto* task = new MockTask{stackDepth};
+    std::thread t([code, params, task]() {
+        currentTask = task;
+        code(params);
+    });
+    t.detach();
+    tasksCreated++;
+    return static_cast<TaskHandle_t>(task);
+}
+
 BaseType_t xTaskCreatePinnedToCore(
     TaskFunction_t pvTaskCode,
     const char* pcName,
@@ -75,24 +94,55 @@ BaseType_t xTaskCreatePinnedToCore(
     BaseType_t xCoreID
 ) {
     (void)pcName;
-    (void)usStackDepth;
     (void)uxPriority;
     (void)xCoreID;
 
-    std::thread t(pvTaskCode, pvParameters);
-    t.detach();
-
-    // Non-null sentinel so AsyncTaskRunner knows a task exists
+    TaskHandle_t handle = startMockTask(pvTaskCode, pvParameters, usStackDepth);
     if (pxCreatedTask) {
-        *pxCreatedTask = reinterpret_cast<TaskHandle_t>(0x1);
+        *pxCreatedTask = handle;
     }
 
     return pdPASS;
 }
 
+TaskHandle_t xTaskCreateStaticPinnedToCore(
+    TaskFunction_t pxTaskCode,
+    const char* pcName,
+    const uint32_t ulStackDepth,
+    void* pvParameters,
+    UBaseType_t uxPriority,
+    StackType_t* const puxStackBuffer,
+    StaticTask_t* const pxTaskBuffer,
+    const BaseType_t xCoreID
+) {
+    (void)pcName;
+    (void)uxPriority;
+    (void)xCoreID;
+
+    if (!puxStackBuffer || !pxTaskBuffer) return nullptr;
+    staticTasksCreated++;
+    return startMockTask(pxTaskCode, pvParameters, ulStackDepth);
+}
+
 void vTaskDelete(TaskHandle_t xTask) {
-    // No-op: std::thread returns naturally after signalDone()
-    (void)xTask;
+    // std::thread returns naturally after the task function; only free its record
+    if (xTask == nullptr) {
+        delete currentTask;
+        currentTask = nullptr;
+    }
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask) {
+    MockTask* task = xTask ? static_cast<MockTask*>(xTask) : currentTask;
+    return task ? task->stackDepth / 2 : 0;
+}
+
+uint32_t mockTaskCreateCount() {
+    return tasksCreated.load();
+}
+
+uint32_t mockStaticTaskCreateCount() {
+    return staticTasksCreated.load();
 }
 
 #endif // NATIVE_TEST
@@ -5,10 +5,16 @@
 
 #include <unity.h>
 #include "async/AsyncTaskRunner.h"
+#include "async/AsyncRequestQueue.h"
+#include "async/ChatFuture.h"
+#include "providers/OpenAIProvider.h"
+#include "../../mocks/transport/FakeTransport.h"
 
 #include <thread>
 #include <chrono>
 #include <atomic>
+#include <mutex>
+#include <vector>
 
 using namespace ESPAI;
 
@@ -180,6 +186,39 @@ void test_stream_launch() {
     TEST_ASSERT_TRUE(streamDone);
 }
 
+void test_stream_launch_with_response() {
+    AsyncTaskRunner runner;
+
+    StreamCallback streamCb = [](const String& chunk, bool done) {
+        (void)chunk;
+        (void)done;
+    };
+
+    bool launched = runner.launchStream(
+        [](StreamCallback cb) -> Response {
+            cb("chunk", false);
+            cb("", true);
+            Response r = Response::ok("");
+            r.promptTokens = 12;
+            r.completionTokens = 34;
+            r.stopReason = "stop";
+            return r;
+        },
+        streamCb
+    );
+
+    TEST_ASSERT_TRUE(launched);
+
+    ChatRequest* req = runner.getRequest();
+    TEST_ASSERT_TRUE_MESSAGE(spinWaitComplete(req), "Stream task did not complete in time");
+
+    Response result = req->getResult();
+    TEST_ASSERT_TRUE(result.success);
+    TEST_ASSERT_EQUAL(12, result.promptTokens);
+    TEST_ASSERT_EQUAL(34, result.completionTokens);
+    TEST_ASSERT_EQUAL_STRING("stop", result.stopReason.c_str());
+}
+
 void test_stream_cancel() {
     AsyncTaskRunner runner;
 
@@ -262,6 +301,601 @@ void test_relaunch_after_complete() {
     TEST_ASSERT_EQUAL_STRING("second_run", r2.content.c_str());
 }
 
+// AsyncRequestQueue
+
+static int ownerA = 0;
+static int ownerB = 0;
+static int ownerC = 0;
+
+// Task that blocks until *gate is set, recording concurrency
+static AsyncRequestQueue::Task gatedTask(std::atomic<bool>* gate, std::atomic<int>* running,
+                                         std::atomic<int>* maxRunning, const char* reply) {
+    String out(reply);
+    return [gate, running, maxRunning, out](const ChatRequest& req) -> Response {
+        int now = ++(*running);
+        int prev = maxRunning->load();
+        while (now > prev && !maxRunning->compare_exchange_weak(prev, now)) {}
+        while (!gate->load() && !req.isCancelled()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        --(*running);
+        return Response::ok(out);
+    };
+}
+
+static AsyncRequestQueue::Task recordingTask(std::vector<String>* order, std::mutex* mtx, const char* name) {
+    String out(name);
+    return [order, mtx, out](const ChatRequest&) -> Response {
+        std::lock_guard<std::mutex> guard(*mtx);
+        order->push_back(out);
+        return Response::ok(out);
+    };
+}
+
+static bool spinWaitStatus(ChatRequest* req, AsyncStatus status, int timeoutMs = 5000) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (req->getStatus() != status) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void test_queue_submit_and_complete() {
+    AsyncRequestQueue queue(2);
+    int callbackCount = 0;
+
+    ChatRequest* req = queue.submit(&ownerA, [](const ChatRequest&) { return Response::ok("queued"); },
+                                    [&](const Response& r) { callbackCount++; });
+    TEST_ASSERT_NOT_NULL(req);
+    TEST_ASSERT_TRUE_MESSAGE(spinWaitComplete(req), "Request did not complete in time");
+
+    TEST_ASSERT_EQUAL(AsyncStatus::Completed, req->getStatus());
+    TEST_ASSERT_EQUAL_STRING("queued", req->getResult().content.c_str());
+    TEST_ASSERT_TRUE(req->poll());
+    TEST_ASSERT_EQUAL(1, callbackCount);
+    TEST_ASSERT_FALSE(queue.isBusy());
+}
+
+void test_queue_runs_owners_concurrently() {
+    AsyncRequestQueue queue(2);
+    std::atomic<bool> gate{false};
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+
+    ChatRequest* a = queue.submit(&ownerA, gatedTask(&gate, &running, &maxRunning, "a"));
+    ChatRequest* b = queue.submit(&ownerB, gatedTask(&gate, &running, &maxRunning, "b"));
+    ChatRequest* c = queue.submit(&ownerC, gatedTask(&gate, &running, &maxRunning, "c"));
+    TEST_ASSERT_NOT_NULL(c);
+
+    TEST_ASSERT_TRUE(spinWaitStatus(a, AsyncStatus::Running));
+    TEST_ASSERT_TRUE(spinWaitStatus(b, AsyncStatus::Running));
+    TEST_ASSERT_EQUAL(AsyncStatus::Queued, c->getStatus());  // Only 2 workers
+    TEST_ASSERT_EQUAL(3, queue.pendingCount());
+    TEST_ASSERT_EQUAL(2, queue.getActiveWorkers());
+
+    gate = true;
+    TEST_ASSERT_TRUE(spinWaitComplete(a));
+    TEST_ASSERT_TRUE(spinWaitComplete(b));
+    TEST_ASSERT_TRUE(spinWaitComplete(c));
+    TEST_ASSERT_EQUAL(2, maxRunning.load());
+}
+
+void test_queue_serializes_one_owner() {
+    AsyncRequestQueue queue(3);
+    std::atomic<bool> gate{false};
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+
+    ChatRequest* first = queue.submit(&ownerA, gatedTask(&gate, &running, &maxRunning, "1"));
+    ChatRequest* second = queue.submit(&ownerA, gatedTask(&gate, &running, &maxRunning, "2"));
+    TEST_ASSERT_TRUE(spinWaitStatus(first, AsyncStatus::Running));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    TEST_ASSERT_EQUAL(AsyncStatus::Queued, second->getStatus());
+    TEST_ASSERT_TRUE(queue.isBusy(&ownerA));
+    TEST_ASSERT_FALSE(queue.isBusy(&ownerB));
+
+    gate = true;
+    TEST_ASSERT_TRUE(spinWaitComplete(second));
+    TEST_ASSERT_EQUAL(1, maxRunning.load());
+}
+
+void test_queue_priority_order() {
+    AsyncRequestQueue queue(1);
+    std::atomic<bool> gate{false};
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+    std::vector<String> order;
+    std::mutex mtx;
+
+    ChatRequest* blocker = queue.submit(&ownerA, gatedTask(&gate, &running, &maxRunning, "blocker"));
+    TEST_ASSERT_TRUE(spinWaitStatus(blocker, AsyncStatus::Running));
+
+    queue.submit(&ownerB, recordingTask(&order, &mtx, "low"), nullptr, AsyncRequestOptions(0));
+    queue.submit(&ownerB, recordingTask(&order, &mtx, "high"), nullptr, AsyncRequestOptions(5));
+    ChatRequest* last = queue.submit(&ownerB, recordingTask(&order, &mtx, "low2"), nullptr, AsyncRequestOptions(0));
+
+    gate = true;
+    TEST_ASSERT_TRUE(spinWaitComplete(last));
+    TEST_ASSERT_EQUAL(3, order.size());
+    TEST_ASSERT_EQUAL_STRING("high", order[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("low", order[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("low2", order[2].c_str());
+}
+
+void test_queue_conversation_fifo() {
+    AsyncRequestQueue queue(2);
+    std::atomic<bool> gate{false};
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+
+    // Same conversation on two owners: the second waits despite a free worker and higher priority
+    ChatRequest* first = queue.submit(&ownerA, gatedTask(&gate, &running, &maxRunning, "1"),
+                                      nullptr, AsyncRequestOptions(0, 42));
+    ChatRequest* second = queue.submit(&ownerB, gatedTask(&gate, &running, &maxRunning, "2"),
+                                       nullptr, AsyncRequestOptions(9, 42));
+    ChatRequest* other = queue.submit(&ownerC, gatedTask(&gate, &running, &maxRunning, "3"),
+                                      nullptr, AsyncRequestOptions(0, 7));
+
+    TEST_ASSERT_TRUE(spinWaitStatus(first, AsyncStatus::Running));
+    TEST_ASSERT_TRUE(spinWaitStatus(other, AsyncStatus::Running));
+    TEST_ASSERT_EQUAL(AsyncStatus::Queued, second->getStatus());
+
+    gate = true;
+    TEST_ASSERT_TRUE(spinWaitComplete(second));
+    TEST_ASSERT_EQUAL(AsyncStatus::Completed, second->getStatus());
+}
+
+void test_queue_cancel_queued_request() {
+    AsyncRequestQueue queue(1);
+    std::atomic<bool> gate{false};
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+    std::atomic<bool> ran{false};
+
+    ChatRequest* blocker = queue.submit(&ownerA, gatedTask(&gate, &running, &maxRunning, "blocker"));
+    TEST_ASSERT_TRUE(spinWaitStatus(blocker, AsyncStatus::Running));
+    ChatRequest* queued = queue.submit(&ownerB, [&ran](const ChatRequest&) {
+        ran = true;
+        return Response::ok("never");
+    });
+
+    queue.cancelAll(&ownerB);
+    TEST_ASSERT_EQUAL(AsyncStatus::Cancelled, queued->getStatus());
+    TEST_ASSERT_FALSE(queued->getResult().success);
+    TEST_ASSERT_EQUAL(AsyncStatus::Running, blocker->getStatus());
+
+    gate = true;
+    TEST_ASSERT_TRUE(spinWaitComplete(blocker));
+    TEST_ASSERT_FALSE(ran.load());
+}
+
+void test_queue_full_and_slot_reuse() {
+    AsyncRequestQueue queue(1);
+    std::atomic<bool> gate{false};
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+
+    std::vector<ChatRequest*> requests;
+    for (int i = 0; i < ESPAI_ASYNC_QUEUE_SIZE; i++) {
+        ChatRequest* req = queue.submit(&ownerA, gatedTask(&gate, &running, &maxRunning, "r"));
+        TEST_ASSERT_NOT_NULL(req);
+        requests.push_back(req);
+    }
+    TEST_ASSERT_NULL(queue.submit(&ownerA, gatedTask(&gate, &running, &maxRunning, "overflow")));
+
+    gate = true;
+    TEST_ASSERT_TRUE(spinWaitComplete(requests.back()));
+    ChatRequest* reused = queue.submit(&ownerA, [](const ChatRequest&) { return Response::ok("again"); });
+    TEST_ASSERT_NOT_NULL(reused);
+    TEST_ASSERT_TRUE(requests.front() == reused);  // Finished longest ago
+    TEST_ASSERT_TRUE(spinWaitComplete(reused));
+}
+
+void test_queue_detach_waits_for_running() {
+    AsyncRequestQueue queue(2);
+    std::atomic<bool> gate{false};
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+
+    ChatRequest* req = queue.submit(&ownerA, gatedTask(&gate, &running, &maxRunning, "a"));
+    TEST_ASSERT_TRUE(spinWaitStatus(req, AsyncStatus::Running));
+
+    queue.detach(&ownerA);  // Cancels; the gated task returns on cancel
+    TEST_ASSERT_EQUAL(AsyncStatus::Cancelled, req->getStatus());
+    TEST_ASSERT_EQUAL(0, running.load());
+    TEST_ASSERT_FALSE(queue.isBusy(&ownerA));
+}
+
+void test_queue_workers_persist() {
+    AsyncRequestQueue queue(2);
+    uint32_t createdBefore = mockTaskCreateCount();
+
+    for (int i = 0; i < 10; i++) {
+        ChatRequest* req = queue.submit(&ownerA, [](const ChatRequest&) { return Response::ok("x"); });
+        TEST_ASSERT_TRUE(spinWaitComplete(req));
+    }
+    TEST_ASSERT_EQUAL(1, mockTaskCreateCount() - createdBefore);
+    TEST_ASSERT_EQUAL(1, queue.getWorkerCount());
+    TEST_ASSERT_EQUAL(0, queue.getActiveWorkers());
+}
+
+void test_queue_static_stack_buffer() {
+    static uint8_t stacks[2 * 4096];
+    AsyncRequestQueue queue(2);
+    TEST_ASSERT_TRUE(queue.setStackSize(4096));
+    TEST_ASSERT_TRUE(queue.setStackBuffer(stacks, sizeof(stacks)));
+    uint32_t staticBefore = mockStaticTaskCreateCount();
+
+    ChatRequest* req = queue.submit(&ownerA, [](const ChatRequest&) { return Response::ok("x"); });
+    TEST_ASSERT_TRUE(spinWaitComplete(req));
+    TEST_ASSERT_EQUAL(1, mockStaticTaskCreateCount() - staticBefore);
+
+    // Stack settings are fixed once a worker runs
+    TEST_ASSERT_FALSE(queue.setStackSize(8192));
+    TEST_ASSERT_FALSE(queue.setStackBuffer(nullptr, 0));
+    TEST_ASSERT_EQUAL(4096, queue.getStackSize());
+}
+
+void test_queue_psram_stacks_are_static() {
+    AsyncRequestQueue queue(1);
+    TEST_ASSERT_TRUE(queue.setStackInPSRAM(true));
+    uint32_t staticBefore = mockStaticTaskCreateCount();
+
+    ChatRequest* req = queue.submit(&ownerA, [](const ChatRequest&) { return Response::ok("x"); });
+    TEST_ASSERT_TRUE(spinWaitComplete(req));
+    TEST_ASSERT_EQUAL(1, mockStaticTaskCreateCount() - staticBefore);
+}
+
+void test_queue_reports_stack_high_water() {
+    AsyncRequestQueue queue(1);
+    TEST_ASSERT_EQUAL(0, queue.getMinFreeStack());
+    TEST_ASSERT_TRUE(queue.setStackSize(8192));
+
+    ChatRequest* req = queue.submit(&ownerA, [](const ChatRequest&) { return Response::ok("x"); });
+    TEST_ASSERT_TRUE(spinWaitComplete(req));
+    TEST_ASSERT_EQUAL(4096, req->getStackHighWaterMark());  // Mock: half the stack
+    TEST_ASSERT_EQUAL(4096, queue.getMinFreeStack());
+}
+
+// Buffered streaming
+
+static const char* STREAM_BODY =
+    "data: {\"choices\":[{\"delta\":{\"content\":\"Hello \"}}]}\n\n"
+    "data: {\"choices\":[{\"delta\":{\"content\":\"from the ring\"}}]}\n\n"
+    "data: [DONE]\n\n";
+
+void test_stream_chunks_buffered_for_reader() {
+    AsyncRequestQueue queue(1);
+    FakeTransport transport;
+    transport.streams.push_back(STREAM_BODY);
+    OpenAIProvider provider("test-key", "gpt-4o");
+    provider.setTransport(&transport);
+    provider.setAsyncQueue(&queue);
+
+    AsyncRequestOptions queueOptions;
+    queueOptions.streamBufferSize = 64;
+    std::vector<Message> messages = {Message(Role::User, "Hi")};
+    ChatRequest* req = provider.chatStreamAsync(messages, ChatOptions(), nullptr, nullptr, queueOptions);
+    TEST_ASSERT_NOT_NULL(req);
+    TEST_ASSERT_NOT_NULL(req->getStreamBuffer());
+
+    String text;
+    char buf[8];
+    while (!req->isComplete()) {
+        size_t n = req->readChunks(buf, sizeof(buf) - 1);
+        buf[n] = '\0';
+        text += buf;
+    }
+    req->readChunks(text);
+
+    TEST_ASSERT_EQUAL(AsyncStatus::Completed, req->getStatus());
+    TEST_ASSERT_EQUAL_STRING("Hello from the ring", text.c_str());
+    TEST_ASSERT_TRUE(req->getStreamBuffer()->isDone());
+    TEST_ASSERT_EQUAL(0, req->getStreamBuffer()->getDroppedBytes());
+}
+
+// Reads until the ring reports the end, without looking at the request
+static String drainRing(ChatRequest* req, int timeoutMs = 5000) {
+    StreamChunkRing* ring = req->getStreamBuffer();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    String text;
+    while (!ring->isDone() && std::chrono::steady_clock::now() < deadline) {
+        ring->read(text);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return text;
+}
+
+void test_stream_buffer_done_from_chat_stream_async() {
+    AsyncRequestQueue queue(1);
+    FakeTransport transport;
+    transport.streams.push_back(STREAM_BODY);
+    OpenAIProvider provider("test-key", "gpt-4o");
+    provider.setTransport(&transport);
+    provider.setAsyncQueue(&queue);
+
+    AsyncRequestOptions queueOptions;
+    queueOptions.streamBufferSize = 64;
+    std::vector<Message> messages = {Message(Role::User, "Hi")};
+    ChatRequest* req = provider.chatStreamAsync(messages, ChatOptions(), nullptr, nullptr, queueOptions);
+    TEST_ASSERT_EQUAL_STRING("Hello from the ring", drainRing(req).c_str());
+    TEST_ASSERT_TRUE(req->getStreamBuffer()->isDone());
+    TEST_ASSERT_TRUE(spinWaitComplete(req));
+    TEST_ASSERT_EQUAL(AsyncStatus::Completed, req->getStatus());
+
+    // No scripted stream left: the request fails, and the ring still ends
+    req = provider.chatStreamAsync(messages, ChatOptions(), nullptr, nullptr, queueOptions);
+    TEST_ASSERT_EQUAL_STRING("", drainRing(req).c_str());
+    TEST_ASSERT_TRUE(req->getStreamBuffer()->isDone());
+    TEST_ASSERT_TRUE(spinWaitComplete(req));
+    TEST_ASSERT_EQUAL(AsyncStatus::Error, req->getStatus());
+}
+
+void test_stream_buffer_done_on_running_cancel() {
+    AsyncRequestQueue queue(1);
+    FakeTransport transport;
+    transport.streamChunkSize = 8;
+    transport.streamChunkDelayMs = 5;
+    transport.streams.push_back(STREAM_BODY);
+    OpenAIProvider provider("test-key", "gpt-4o");
+    provider.setTransport(&transport);
+    provider.setAsyncQueue(&queue);
+
+    AsyncRequestOptions queueOptions;
+    queueOptions.streamBufferSize = 64;
+    std::vector<Message> messages = {Message(Role::User, "Hi")};
+    ChatRequest* req = provider.chatStreamAsync(messages, ChatOptions(), nullptr, nullptr, queueOptions);
+    TEST_ASSERT_TRUE(spinWaitStatus(req, AsyncStatus::Running));
+    req->cancel();
+
+    drainRing(req);
+    TEST_ASSERT_TRUE(req->getStreamBuffer()->isDone());
+    TEST_ASSERT_TRUE(spinWaitComplete(req));
+    TEST_ASSERT_EQUAL(AsyncStatus::Cancelled, req->getStatus());
+}
+
+void test_stream_buffer_only_when_requested() {
+    AsyncRequestQueue queue(1);
+    ChatRequest* req = queue.submit(&ownerA, [](const ChatRequest&) { return Response::ok("x"); });
+    TEST_ASSERT_TRUE(spinWaitComplete(req));
+    TEST_ASSERT_NULL(req->getStreamBuffer());
+
+    char buf[4];
+    TEST_ASSERT_EQUAL(0, req->readChunks(buf, sizeof(buf)));
+}
+
+void test_stream_buffer_done_on_cancel() {
+    AsyncRequestQueue queue(1);
+    std::atomic<bool> gate{false};
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+
+    AsyncRequestOptions queueOptions;
+    queueOptions.streamBufferSize = 16;
+    ChatRequest* blocker = queue.submit(&ownerA, gatedTask(&gate, &running, &maxRunning, "b"));
+    ChatRequest* req = queue.submit(&ownerB, [](const ChatRequest&) { return Response::ok(""); },
+                                    nullptr, queueOptions);
+    TEST_ASSERT_TRUE(spinWaitStatus(blocker, AsyncStatus::Running));
+
+    queue.cancelAll(&ownerB);
+    TEST_ASSERT_TRUE(req->getStreamBuffer()->isDone());
+
+    gate = true;
+    TEST_ASSERT_TRUE(spinWaitComplete(blocker));
+}
+
+// ChatFuture
+
+static AsyncRequestQueue::Task replyTask(const char* reply, bool success = true) {
+    String out(reply);
+    return [out, success](const ChatRequest&) -> Response {
+        return success ? Response::ok(out) : Response::fail(ErrorCode::ServerError, out);
+    };
+}
+
+void test_future_ready() {
+    ChatFuture invalid;
+    TEST_ASSERT_FALSE(invalid.valid());
+    TEST_ASSERT_FALSE(invalid.get().success);
+
+    ChatFuture future = ChatFuture::ready(Response::ok("now"));
+    TEST_ASSERT_TRUE(future.isReady());
+    TEST_ASSERT_TRUE(future.waitFor(1));
+    TEST_ASSERT_EQUAL_STRING("now", future.get().content.c_str());
+}
+
+void test_future_resolves_from_queue() {
+    AsyncRequestQueue queue(1);
+    ChatFuture future = queue.submitFuture(&ownerA, replyTask("done"));
+    TEST_ASSERT_TRUE(future.waitFor(5000));
+    TEST_ASSERT_EQUAL_STRING("done", future.get().content.c_str());
+}
+
+void test_future_wait_times_out() {
+    AsyncRequestQueue queue(1);
+    std::atomic<bool> gate{false};
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+
+    ChatFuture future = queue.submitFuture(&ownerA, gatedTask(&gate, &running, &maxRunning, "late"));
+    TEST_ASSERT_FALSE(future.waitFor(30));
+    TEST_ASSERT_FALSE(future.isReady());
+
+    gate = true;
+    TEST_ASSERT_TRUE(future.waitFor(5000));
+    TEST_ASSERT_EQUAL_STRING("late", future.get().content.c_str());
+}
+
+void test_future_then_chains_on_worker() {
+    AsyncRequestQueue queue(1);
+    std::thread::id mainThread = std::this_thread::get_id();
+    std::atomic<bool> continuationOnWorker{false};
+
+    ChatFuture answer = queue.submitFuture(&ownerA, replyTask("summary"))
+        .then([&](const Response& summary) {
+            continuationOnWorker = (std::this_thread::get_id() != mainThread);
+            String question = summary.content + " -> answer";
+            return queue.submitFuture(&ownerA, [question](const ChatRequest&) {
+                return Response::ok(question);
+            });
+        });
+
+    TEST_ASSERT_TRUE(answer.waitFor(5000));
+    TEST_ASSERT_TRUE(answer.get().success);
+    TEST_ASSERT_EQUAL_STRING("summary -> answer", answer.get().content.c_str());
+    TEST_ASSERT_TRUE(continuationOnWorker.load());
+}
+
+void test_future_then_transform() {
+    AsyncRequestQueue queue(1);
+    ChatFuture wrapped = queue.submitFuture(&ownerA, replyTask("abc"))
+        .then([](const Response& r) {
+            return Response::ok("[" + r.content + "]");
+        });
+    TEST_ASSERT_TRUE(wrapped.waitFor(5000));
+    TEST_ASSERT_EQUAL_STRING("[abc]", wrapped.get().content.c_str());
+}
+
+void test_future_then_skipped_on_failure() {
+    AsyncRequestQueue queue(1);
+    std::atomic<bool> ran{false};
+    ChatFuture chained = queue.submitFuture(&ownerA, replyTask("boom", false))
+        .then([&ran](const Response& r) {
+            ran = true;
+            return Response::ok("unreachable");
+        });
+    TEST_ASSERT_TRUE(chained.waitFor(5000));
+    TEST_ASSERT_FALSE(chained.get().success);
+    TEST_ASSERT_EQUAL_STRING("boom", chained.get().errorMessage.c_str());
+    TEST_ASSERT_FALSE(ran.load());
+}
+
+void test_future_cancel_queued() {
+    AsyncRequestQueue queue(1);
+    std::atomic<bool> gate{false};
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+    std::atomic<bool> ran{false};
+
+    ChatFuture blocker = queue.submitFuture(&ownerA, gatedTask(&gate, &running, &maxRunning, "b"));
+    ChatFuture queued = queue.submitFuture(&ownerA, [&ran](const ChatRequest&) {
+        ran = true;
+        return Response::ok("x");
+    });
+    queued.cancel();
+    TEST_ASSERT_TRUE(queued.isReady());
+    TEST_ASSERT_FALSE(queued.get().success);
+
+    gate = true;
+    TEST_ASSERT_TRUE(blocker.waitFor(5000));
+    TEST_ASSERT_FALSE(ran.load());
+}
+
+void test_future_cancel_chain_reaches_running_step() {
+    AsyncRequestQueue queue(1);
+    std::atomic<bool> gate{false};
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+
+    ChatFuture chained = queue.submitFuture(&ownerA, replyTask("first"))
+        .then([&](const Response&) {
+            return queue.submitFuture(&ownerA, gatedTask(&gate, &running, &maxRunning, "second"));
+        });
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (running.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    chained.cancel();  // The gated task returns once cancelled
+    TEST_ASSERT_TRUE(chained.waitFor(5000));
+    TEST_ASSERT_FALSE(chained.get().success);
+    TEST_ASSERT_EQUAL_STRING("Request cancelled", chained.get().errorMessage.c_str());
+}
+
+void test_future_when_all() {
+    AsyncRequestQueue queue(2);
+    std::vector<ChatFuture> futures = {
+        queue.submitFuture(&ownerA, replyTask("a")),
+        queue.submitFuture(&ownerB, replyTask("b")),
+    };
+    ChatFuture all = ChatFuture::whenAll(futures);
+    TEST_ASSERT_TRUE(all.waitFor(5000));
+    TEST_ASSERT_TRUE(all.get().success);
+    TEST_ASSERT_TRUE(futures[0].isReady());
+    TEST_ASSERT_TRUE(futures[1].isReady());
+    TEST_ASSERT_EQUAL_STRING("b", futures[1].get().content.c_str());
+
+    ChatFuture failed = ChatFuture::whenAll({
+        queue.submitFuture(&ownerA, replyTask("ok")),
+        queue.submitFuture(&ownerB, replyTask("bad", false)),
+    });
+    TEST_ASSERT_TRUE(failed.waitFor(5000));
+    TEST_ASSERT_EQUAL_STRING("bad", failed.get().errorMessage.c_str());
+
+    TEST_ASSERT_TRUE(ChatFuture::whenAll({}).get().success);
+}
+
+void test_future_when_any() {
+    AsyncRequestQueue queue(2);
+    std::atomic<bool> gate{false};
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+
+    ChatFuture slow = queue.submitFuture(&ownerA, gatedTask(&gate, &running, &maxRunning, "slow"));
+    ChatFuture fast = queue.submitFuture(&ownerB, replyTask("fast"));
+    ChatFuture any = ChatFuture::whenAny({slow, fast});
+    TEST_ASSERT_TRUE(any.waitFor(5000));
+    TEST_ASSERT_EQUAL_STRING("fast", any.get().content.c_str());
+
+    gate = true;
+    TEST_ASSERT_TRUE(slow.waitFor(5000));
+}
+
+void test_future_queue_full() {
+    AsyncRequestQueue queue(1);
+    std::atomic<bool> gate{false};
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+
+    std::vector<ChatFuture> futures;
+    for (int i = 0; i < ESPAI_ASYNC_QUEUE_SIZE; i++) {
+        futures.push_back(queue.submitFuture(&ownerA, gatedTask(&gate, &running, &maxRunning, "r")));
+    }
+    ChatFuture overflow = queue.submitFuture(&ownerA, replyTask("x"));
+    TEST_ASSERT_TRUE(overflow.isReady());
+    TEST_ASSERT_EQUAL(ErrorCode::OutOfMemory, overflow.get().error);
+
+    gate = true;
+    TEST_ASSERT_TRUE(ChatFuture::whenAll(futures).waitFor(5000));
+}
+
+void test_provider_chat_future() {
+    AsyncRequestQueue queue(1);
+    FakeTransport transport;
+    transport.addResponse(200,
+        "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":\"Short\"},"
+        "\"finish_reason\":\"stop\"}]}");
+    transport.addResponse(200,
+        "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":\"Answer\"},"
+        "\"finish_reason\":\"stop\"}]}");
+    OpenAIProvider provider("test-key", "gpt-4o");
+    provider.setTransport(&transport);
+    provider.setAsyncQueue(&queue);
+
+    std::vector<Message> messages = {Message(Role::User, "Summarize")};
+    ChatFuture answer = provider.chatFuture(messages, ChatOptions())
+        .then([&provider](const Response& summary) {
+            std::vector<Message> next = {Message(Role::User, summary.content)};
+            return provider.chatFuture(next, ChatOptions());
+        });
+
+    TEST_ASSERT_TRUE(answer.waitFor(5000));
+    TEST_ASSERT_EQUAL_STRING("Answer", answer.get().content.c_str());
+    TEST_ASSERT_EQUAL(2, transport.requests.size());
+    TEST_ASSERT_TRUE(transport.requests[1].body.indexOf("Short") >= 0);
+}
+
 int main(int argc, char** argv) {
     (void)argc;
     (void)argv;
@@ -276,10 +910,46 @@ int main(int argc, char** argv) {
     RUN_TEST(test_busy_during_execution);
     RUN_TEST(test_double_launch_rejected);
     RUN_TEST(test_stream_launch);
+    RUN_TEST(test_stream_launch_with_response);
     RUN_TEST(test_stream_cancel);
     RUN_TEST(test_callback_invoked_once);
     RUN_TEST(test_relaunch_after_complete);
 
+    // AsyncRequestQueue
+    RUN_TEST(test_queue_submit_and_complete);
+    RUN_TEST(test_queue_runs_owners_concurrently);
+    RUN_TEST(test_queue_serializes_one_owner);
+    RUN_TEST(test_queue_priority_order);
+    RUN_TEST(test_queue_conversation_fifo);
+    RUN_TEST(test_queue_cancel_queued_request);
+    RUN_TEST(test_queue_full_and_slot_reuse);
+    RUN_TEST(test_queue_detach_waits_for_running);
+    RUN_TEST(test_queue_workers_persist);
+    RUN_TEST(test_queue_static_stack_buffer);
+    RUN_TEST(test_queue_psram_stacks_are_static);
+    RUN_TEST(test_queue_reports_stack_high_water);
+
+    // Buffered streaming
+    RUN_TEST(test_stream_chunks_buffered_for_reader);
+    RUN_TEST(test_stream_buffer_done_from_chat_stream_async);
+    RUN_TEST(test_stream_buffer_done_on_running_cancel);
+    RUN_TEST(test_stream_buffer_only_when_requested);
+    RUN_TEST(test_stream_buffer_done_on_cancel);
+
+    // ChatFuture
+    RUN_TEST(test_future_ready);
+    RUN_TEST(test_future_resolves_from_queue);
+    RUN_TEST(test_future_wait_times_out);
+    RUN_TEST(test_future_then_chains_on_worker);
+    RUN_TEST(test_future_then_transform);
+    RUN_TEST(test_future_then_skipped_on_failure);
+    RUN_TEST(test_future_cancel_queued);
+    RUN_TEST(test_future_cancel_chain_reaches_running_step);
+    RUN_TEST(test_future_when_all);
+    RUN_TEST(test_future_when_any);
+    RUN_TEST(test_future_queue_full);
+    RUN_TEST(test_provider_chat_future);
+
     return UNITY_END();
 }
 
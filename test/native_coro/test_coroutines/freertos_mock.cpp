@@ -0,0 +1,2 @@
+// Shares the FreeRTOS mock of the async suite
+#include "../../native_async/test_async/freertos_mock.cpp"
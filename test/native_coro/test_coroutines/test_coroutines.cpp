@@ -0,0 +1,189 @@
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "async/AsyncRequestQueue.h"
+#include "async/ChatCoroutine.h"
+#include "providers/OpenAIProvider.h"
+#include "../../mocks/transport/FakeTransport.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace ESPAI;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static int ownerA;
+
+static const char* SUMMARY_BODY =
+    "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":\"Short\"},"
+    "\"finish_reason\":\"stop\"}]}";
+static const char* ANSWER_BODY =
+    "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":\"Answer\"},"
+    "\"finish_reason\":\"stop\"}]}";
+static const char* STREAM_BODY =
+    "data: {\"choices\":[{\"delta\":{\"content\":\"Hello \"}}]}\n\n"
+    "data: {\"choices\":[{\"delta\":{\"content\":\"from a \"}}]}\n\n"
+    "data: {\"choices\":[{\"delta\":{\"content\":\"coroutine\"}}]}\n\n"
+    "data: [DONE]\n\n";
+
+// Awaiting futures
+
+static ChatTask awaitReady(bool* resumedInline) {
+    Response response = co_await ChatFuture::ready(Response::ok("now"));
+    *resumedInline = true;
+    co_return response;
+}
+
+void test_ready_future_does_not_suspend() {
+    bool resumedInline = false;
+    ChatTask task = awaitReady(&resumedInline);
+    TEST_ASSERT_TRUE(resumedInline);
+    TEST_ASSERT_TRUE(task.isReady());
+    TEST_ASSERT_EQUAL_STRING("now", task.get().content.c_str());
+}
+
+static ChatTask summarizeThenAsk(AIProvider* provider, std::thread::id* resumedOn) {
+    std::vector<Message> messages = {Message(Role::User, "Summarize")};
+    Response summary = co_await provider->chatCo(messages, ChatOptions());
+    *resumedOn = std::this_thread::get_id();
+    if (!summary.success) {
+        co_return summary;
+    }
+    std::vector<Message> next = {Message(Role::User, summary.content)};
+    co_return co_await provider->chatCo(next, ChatOptions());
+}
+
+void test_chat_steps_resume_on_worker() {
+    AsyncRequestQueue queue(1);
+    FakeTransport transport;
+    transport.addResponse(200, SUMMARY_BODY);
+    transport.addResponse(200, ANSWER_BODY);
+    OpenAIProvider provider("test-key", "gpt-4o");
+    provider.setTransport(&transport);
+    provider.setAsyncQueue(&queue);
+
+    uint32_t createdBefore = mockTaskCreateCount();
+    // Holds the worker until the coroutine has suspended, so the first step
+    // cannot finish early and resume it inline on this thread
+    std::atomic<bool> release(false);
+    provider.launchAsync([&release](const ChatRequest& request) {
+        (void)request;
+        while (!release.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return Response::ok("");
+    });
+    std::thread::id resumedOn;
+    ChatFuture answer = summarizeThenAsk(&provider, &resumedOn);
+    release = true;
+
+    TEST_ASSERT_TRUE(answer.waitFor(5000));
+    TEST_ASSERT_EQUAL_STRING("Answer", answer.get().content.c_str());
+    TEST_ASSERT_TRUE(resumedOn != std::this_thread::get_id());
+    TEST_ASSERT_EQUAL(2, transport.requests.size());
+    TEST_ASSERT_TRUE(transport.requests[1].body.indexOf("Short") >= 0);
+    // Both steps ran on the one persistent worker
+    TEST_ASSERT_EQUAL(1, mockTaskCreateCount() - createdBefore);
+}
+
+static ChatTask failingStep(AsyncRequestQueue* queue) {
+    co_return co_await queue->submitFuture(&ownerA, [](const ChatRequest&) {
+        return Response::fail(ErrorCode::ServerError, "boom");
+    });
+}
+
+static ChatTask outerStep(AsyncRequestQueue* queue, bool* continued) {
+    Response inner = co_await failingStep(queue);
+    *continued = true;
+    co_return inner;
+}
+
+void test_nested_task_passes_failure() {
+    AsyncRequestQueue queue(1);
+    bool continued = false;
+    ChatTask task = outerStep(&queue, &continued);
+
+    TEST_ASSERT_TRUE(task.waitFor(5000));
+    TEST_ASSERT_TRUE(continued);
+    TEST_ASSERT_FALSE(task.get().success);
+    TEST_ASSERT_EQUAL(ErrorCode::ServerError, task.get().error);
+}
+
+// Stream generator
+
+static ChatTask collectStream(AIProvider* provider, int* chunkCount) {
+    std::vector<Message> messages = {Message(Role::User, "Hi")};
+    ChatStream stream = provider->chatStreamCo(messages, ChatOptions());
+    String text;
+    while (auto chunk = co_await stream.next()) {
+        text += *chunk;
+        (*chunkCount)++;
+    }
+    Response final = stream.result();
+    if (!final.success) {
+        co_return final;
+    }
+    co_return Response::ok(text);
+}
+
+void test_stream_generator_yields_chunks() {
+    AsyncRequestQueue queue(1);
+    FakeTransport transport;
+    transport.streams.push_back(STREAM_BODY);
+    OpenAIProvider provider("test-key", "gpt-4o");
+    provider.setTransport(&transport);
+    provider.setAsyncQueue(&queue);
+
+    int chunkCount = 0;
+    ChatTask task = collectStream(&provider, &chunkCount);
+
+    TEST_ASSERT_TRUE(task.waitFor(5000));
+    Response response = task.get();
+    TEST_ASSERT_TRUE(response.success);
+    TEST_ASSERT_EQUAL_STRING("Hello from a coroutine", response.content.c_str());
+    TEST_ASSERT_TRUE(chunkCount >= 1);
+}
+
+void test_stream_generator_ends_on_failure() {
+    AsyncRequestQueue queue(1);
+    FakeTransport transport;  // No scripted stream
+    OpenAIProvider provider("test-key", "gpt-4o");
+    provider.setTransport(&transport);
+    provider.setAsyncQueue(&queue);
+
+    int chunkCount = 0;
+    ChatTask task = collectStream(&provider, &chunkCount);
+
+    TEST_ASSERT_TRUE(task.waitFor(5000));
+    TEST_ASSERT_FALSE(task.get().success);
+    TEST_ASSERT_EQUAL(0, chunkCount);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+
+    // Awaiting futures
+    RUN_TEST(test_ready_future_does_not_suspend);
+    RUN_TEST(test_chat_steps_resume_on_worker);
+    RUN_TEST(test_nested_task_passes_failure);
+
+    // Stream generator
+    RUN_TEST(test_stream_generator_yields_chunks);
+    RUN_TEST(test_stream_generator_ends_on_failure);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
@@ -0,0 +1,284 @@
+// Async API on the std::thread backend (src/async/AsyncOS.cpp), no FreeRTOS mock.
+// Run under ThreadSanitizer with: pio test -e native_threads_tsan
+
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "async/AsyncOS.h"
+#include "async/AsyncTaskRunner.h"
+#include "async/AsyncRequestQueue.h"
+#include "async/ChatFuture.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace ESPAI;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static bool spinWaitComplete(ChatRequest* req, int timeoutMs = 5000) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!req->isComplete()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// Submits until the queue has room
+static ChatFuture submitWhenRoom(AsyncRequestQueue& queue, const void* owner, AsyncRequestQueue::Task task) {
+    while (true) {
+        ChatFuture future = queue.submitFuture(owner, task);
+        if (!future.isReady() || future.get().error != ErrorCode::OutOfMemory) {
+            return future;
+        }
+        std::this_thread::yield();
+    }
+}
+
+// OS layer
+
+void test_binary_semaphore_gives_once() {
+    SemaphoreHandle_t sem = xSemaphoreCreateBinary();
+    TEST_ASSERT_EQUAL(pdFAIL, xSemaphoreTake(sem, 0));
+    TEST_ASSERT_EQUAL(pdPASS, xSemaphoreGive(sem));
+    TEST_ASSERT_EQUAL(pdFAIL, xSemaphoreGive(sem));
+    TEST_ASSERT_EQUAL(pdPASS, xSemaphoreTake(sem, 0));
+
+    auto start = std::chrono::steady_clock::now();
+    TEST_ASSERT_EQUAL(pdFAIL, xSemaphoreTake(sem, pdMS_TO_TICKS(20)));
+    auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    TEST_ASSERT_TRUE(waited >= 15);
+    vSemaphoreDelete(sem);
+}
+
+void test_mutex_excludes_tasks() {
+    SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+    long counter = 0;  // Plain long: only the mutex keeps it consistent
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([mutex, &counter]() {
+            for (int i = 0; i < 5000; i++) {
+                xSemaphoreTake(mutex, portMAX_DELAY);
+                counter++;
+                xSemaphoreGive(mutex);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    TEST_ASSERT_EQUAL(20000, counter);
+    vSemaphoreDelete(mutex);
+}
+
+struct TaskProbe {
+    std::thread::id ranOn;
+    SemaphoreHandle_t done;
+};
+
+static void probeTask(void* param) {
+    auto* probe = static_cast<TaskProbe*>(param);
+    probe->ranOn = std::this_thread::get_id();
+    xSemaphoreGive(probe->done);
+    vTaskDelete(nullptr);
+}
+
+void test_task_runs_on_own_thread() {
+    TaskProbe probe;
+    probe.done = xSemaphoreCreateBinary();
+    TaskHandle_t handle = nullptr;
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreatePinnedToCore(probeTask, "probe", 4096, &probe, 1, &handle, tskNO_AFFINITY));
+    TEST_ASSERT_NOT_NULL(handle);
+    TEST_ASSERT_EQUAL(pdPASS, xSemaphoreTake(probe.done, pdMS_TO_TICKS(5000)));
+    TEST_ASSERT_TRUE(probe.ranOn != std::this_thread::get_id());
+    TEST_ASSERT_EQUAL(0, uxTaskGetStackHighWaterMark(nullptr));  // Unknown on threads
+    vSemaphoreDelete(probe.done);
+}
+
+// Request lifecycle
+
+void test_runner_launch_and_poll() {
+    AsyncTaskRunner runner;
+    std::atomic<int> callbacks{0};
+    TEST_ASSERT_TRUE(runner.launch(
+        []() { return Response::ok("threaded"); },
+        [&callbacks](const Response&) { callbacks++; }
+    ));
+
+    ChatRequest* req = runner.getRequest();
+    TEST_ASSERT_TRUE(spinWaitComplete(req));
+    TEST_ASSERT_TRUE(req->poll());
+    TEST_ASSERT_TRUE(req->poll());
+    TEST_ASSERT_EQUAL(1, callbacks.load());  // Delivered once
+    TEST_ASSERT_EQUAL_STRING("threaded", req->getResult().content.c_str());
+}
+
+void test_queue_stress_serializes_each_owner() {
+    const int kProducers = 4;
+    const int kOwnersPerProducer = 2;
+    const int kRequestsPerProducer = 200;
+
+    AsyncRequestQueue queue(ESPAI_ASYNC_MAX_WORKERS);
+    int owners[kProducers * kOwnersPerProducer];
+    std::atomic<int> inFlight[kProducers * kOwnersPerProducer];
+    for (auto& count : inFlight) count = 0;
+    std::atomic<int> overlaps{0};
+    std::atomic<int> maxConcurrent{0};
+    std::atomic<int> running{0};
+
+    std::vector<std::vector<ChatFuture>> futures(kProducers);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; p++) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < kRequestsPerProducer; i++) {
+                int index = p * kOwnersPerProducer + i % kOwnersPerProducer;
+                futures[p].push_back(submitWhenRoom(queue, &owners[index], [&, index](const ChatRequest&) {
+                    if (inFlight[index].fetch_add(1) != 0) overlaps++;
+                    int now = ++running;
+                    int seen = maxConcurrent.load();
+                    while (now > seen && !maxConcurrent.compare_exchange_weak(seen, now)) {}
+                    std::this_thread::yield();
+                    running--;
+                    inFlight[index].fetch_sub(1);
+                    return Response::ok("x");
+                }));
+            }
+        });
+    }
+    for (auto& producer : producers) producer.join();
+
+    int completed = 0;
+    for (auto& list : futures) {
+        for (auto& future : list) {
+            TEST_ASSERT_TRUE(future.waitFor(10000));
+            if (future.get().success) completed++;
+        }
+    }
+    TEST_ASSERT_EQUAL(kProducers * kRequestsPerProducer, completed);
+    TEST_ASSERT_EQUAL(0, overlaps.load());
+    TEST_ASSERT_TRUE(maxConcurrent.load() <= ESPAI_ASYNC_MAX_WORKERS);
+    TEST_ASSERT_FALSE(queue.isBusy());
+}
+
+void test_queue_cancel_storm_drains() {
+    AsyncRequestQueue queue(2);
+    int owners[4];
+    std::vector<ChatFuture> futures;
+    std::vector<std::thread> cancellers;
+
+    for (int i = 0; i < 200; i++) {
+        futures.push_back(submitWhenRoom(queue, &owners[i % 4], [](const ChatRequest& request) {
+            for (int step = 0; step < 20 && !request.isCancelled(); step++) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            return Response::ok("finished");
+        }));
+        if (i % 3 == 0) {
+            ChatFuture victim = futures.back();
+            cancellers.emplace_back([victim]() mutable { victim.cancel(); });
+        }
+    }
+
+    for (auto& canceller : cancellers) canceller.join();
+
+    // Every request ends, finished or cancelled, however the cancel raced it
+    TEST_ASSERT_TRUE(ChatFuture::whenAll(futures).waitFor(20000));
+    for (auto& future : futures) {
+        Response result = future.get();
+        TEST_ASSERT_TRUE(result.success || result.error == ErrorCode::NetworkError);
+    }
+    queue.detach(nullptr);
+    TEST_ASSERT_FALSE(queue.isBusy());
+    TEST_ASSERT_EQUAL(0, queue.getActiveWorkers());
+}
+
+void test_held_owner_requests_wait() {
+    AsyncRequestQueue queue(2);
+    int owner;
+    int other;
+    std::atomic<bool> slowDone(false);
+
+    // A hold waits for the owner's running request
+    ChatFuture slow = queue.submitFuture(&owner, [&slowDone](const ChatRequest&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        slowDone = true;
+        return Response::ok("slow");
+    });
+    while (queue.getActiveWorkers() == 0 && !slow.isReady()) {
+        std::this_thread::yield();
+    }
+    queue.holdOwner(&owner);
+    TEST_ASSERT_TRUE(slowDone.load());
+
+    {
+        // Queued requests of the held owner wait; other owners still run
+        ChatFuture held = queue.submitFuture(&owner, [](const ChatRequest&) { return Response::ok("held"); });
+        ChatFuture unheld = queue.submitFuture(&other, [](const ChatRequest&) { return Response::ok("free"); });
+        TEST_ASSERT_TRUE(unheld.waitFor(2000));
+        TEST_ASSERT_FALSE(held.waitFor(50));
+
+        queue.releaseOwner(&owner);
+        TEST_ASSERT_TRUE(held.waitFor(2000));
+        TEST_ASSERT_EQUAL_STRING("held", held.get().content.c_str());
+    }
+
+    {
+        AsyncRequestQueue::OwnerLock lock(queue, &owner);
+        ChatFuture held = queue.submitFuture(&owner, [](const ChatRequest&) { return Response::ok("scoped"); });
+        TEST_ASSERT_FALSE(held.waitFor(30));
+        queue.cancelAll(&owner);
+        TEST_ASSERT_TRUE(held.isReady());
+    }
+    queue.detach(nullptr);
+}
+
+void test_queue_round_trip_throughput() {
+    const int kRequests = 2000;
+    AsyncRequestQueue queue(1);
+    int owner;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRequests; i++) {
+        ChatFuture future = submitWhenRoom(queue, &owner, [](const ChatRequest&) { return Response::ok(""); });
+        TEST_ASSERT_TRUE(future.waitFor(5000));
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    char message[96];
+    snprintf(message, sizeof(message), "%d submit/complete round trips: %.1f us each",
+             kRequests, seconds * 1e6 / kRequests);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL(1, queue.getWorkerCount());
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    UNITY_BEGIN();
+
+    // OS layer
+    RUN_TEST(test_binary_semaphore_gives_once);
+    RUN_TEST(test_mutex_excludes_tasks);
+    RUN_TEST(test_task_runs_on_own_thread);
+
+    // Request lifecycle
+    RUN_TEST(test_runner_launch_and_poll);
+    RUN_TEST(test_queue_stress_serializes_each_owner);
+    RUN_TEST(test_queue_cancel_storm_drains);
+    RUN_TEST(test_held_owner_requests_wait);
+    RUN_TEST(test_queue_round_trip_throughput);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
@@ -0,0 +1,240 @@
+// Conversation compaction: background summaries through the async queue on
+// the std::thread backend, applied on the caller's next add.
+
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "conversation/Conversation.h"
+#include "providers/OpenAIProvider.h"
+#include "tools/ToolLoop.h"
+#include "../../mocks/transport/FakeTransport.h"
+
+#include <chrono>
+#include <thread>
+
+using namespace ESPAI;
+
+static FakeTransport* transport = nullptr;
+static OpenAIProvider* provider = nullptr;
+
+void setUp(void) {
+    transport = new FakeTransport();
+    provider = new OpenAIProvider("test-key", "gpt-4o");
+    provider->setTransport(transport);
+}
+
+void tearDown(void) {
+    // Waits for a cancelled summary still running; ~AIProvider would only
+    // do so after the OpenAIProvider part is gone
+    provider->getAsyncQueue().detach(provider);
+    delete provider;
+    delete transport;
+    provider = nullptr;
+    transport = nullptr;
+}
+
+static void addSummaryResponse(const char* summary) {
+    String body = String("{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":\"") + summary +
+                  "\"},\"finish_reason\":\"stop\"}],\"usage\":{\"prompt_tokens\":40,\"completion_tokens\":12}}";
+    transport->addResponse(200, body);
+}
+
+static CompactionPolicy policy(size_t trigger, size_t compact) {
+    CompactionPolicy p;
+    p.triggerMessages = trigger;
+    p.compactMessages = compact;
+    p.summaryPrefix = "Summary: ";
+    return p;
+}
+
+static void addTurns(Conversation& conv, int first, int count) {
+    for (int i = first; i < first + count; i++) {
+        conv.addMessage(i % 2 == 0 ? Role::User : Role::Assistant, String("m") + String(i));
+    }
+}
+
+void test_summary_replaces_oldest_messages() {
+    addSummaryResponse("User said hello twice");
+    Conversation conv;
+    conv.setCompaction(provider, policy(6, 4));
+
+    addTurns(conv, 0, 5);
+    TEST_ASSERT_FALSE(conv.isCompacting());
+    addTurns(conv, 5, 1);
+    TEST_ASSERT_TRUE(conv.isCompacting());
+    TEST_ASSERT_TRUE(conv.waitForCompaction(2000));
+
+    TEST_ASSERT_EQUAL(3, conv.size());
+    TEST_ASSERT_EQUAL(Role::User, conv.getMessages()[0].role);
+    TEST_ASSERT_EQUAL_STRING("Summary: User said hello twice", conv.getMessages()[0].content.c_str());
+    TEST_ASSERT_EQUAL_STRING("m4", conv.getMessages()[1].content.c_str());
+    TEST_ASSERT_EQUAL_STRING("m5", conv.getMessages()[2].content.c_str());
+
+    const CompactionStats& stats = conv.getCompactionStats();
+    TEST_ASSERT_EQUAL(1, stats.runs);
+    TEST_ASSERT_EQUAL(4, stats.messagesCompacted);
+    TEST_ASSERT_EQUAL(40, stats.promptTokens);
+    TEST_ASSERT_EQUAL(12, stats.completionTokens);
+
+    // The request carried the oldest messages as a transcript
+    TEST_ASSERT_EQUAL(1, transport->requests.size());
+    const String& body = transport->requests[0].body;
+    TEST_ASSERT_TRUE(body.indexOf("user: m0\\nassistant: m1") >= 0);
+    TEST_ASSERT_TRUE(body.indexOf("m4") < 0);
+}
+
+void test_adding_does_not_wait_for_summary() {
+    transport->executeDelayMs = 150;
+    addSummaryResponse("Earlier turns");
+    Conversation conv;
+    conv.setCompaction(provider, policy(4, 2));
+
+    auto start = std::chrono::steady_clock::now();
+    addTurns(conv, 0, 6);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    TEST_ASSERT_TRUE(elapsed < 100);
+    TEST_ASSERT_TRUE(conv.isCompacting());
+    TEST_ASSERT_EQUAL(6, conv.size());
+
+    // Messages added while the summary ran are kept behind it
+    TEST_ASSERT_TRUE(conv.waitForCompaction(2000));
+    TEST_ASSERT_EQUAL(5, conv.size());
+    TEST_ASSERT_EQUAL_STRING("Summary: Earlier turns", conv.getMessages()[0].content.c_str());
+    TEST_ASSERT_EQUAL_STRING("m2", conv.getMessages()[1].content.c_str());
+    TEST_ASSERT_EQUAL_STRING("m5", conv.getMessages()[4].content.c_str());
+}
+
+void test_summary_applies_after_ring_pruned_its_messages() {
+    transport->executeDelayMs = 100;
+    addSummaryResponse("Old context");
+    Conversation conv(6);
+    conv.setCompaction(provider, policy(6, 4));
+
+    addTurns(conv, 0, 6);
+    TEST_ASSERT_TRUE(conv.isCompacting());
+    // m0..m2 fall out of the ring before the summary arrives
+    addTurns(conv, 6, 3);
+    TEST_ASSERT_EQUAL_STRING("m3", conv.getMessages()[0].content.c_str());
+
+    TEST_ASSERT_TRUE(conv.waitForCompaction(2000));
+    TEST_ASSERT_EQUAL(6, conv.size());
+    TEST_ASSERT_EQUAL_STRING("Summary: Old context", conv.getMessages()[0].content.c_str());
+    TEST_ASSERT_EQUAL_STRING("m4", conv.getMessages()[1].content.c_str());
+    TEST_ASSERT_EQUAL_STRING("m8", conv.getMessages()[5].content.c_str());
+    TEST_ASSERT_EQUAL(1, conv.getCompactionStats().messagesCompacted);
+}
+
+void test_failed_summary_keeps_history() {
+    transport->addResponse(400, "{\"error\":{\"message\":\"bad request\"}}");
+    addSummaryResponse("Second try");
+    Conversation conv;
+    conv.setCompaction(provider, policy(3, 2));
+
+    addTurns(conv, 0, 3);
+    TEST_ASSERT_FALSE(conv.waitForCompaction(2000));
+    TEST_ASSERT_EQUAL(3, conv.size());
+    TEST_ASSERT_EQUAL(1, conv.getCompactionStats().failures);
+
+    // Still over the threshold: the next add starts another summary
+    addTurns(conv, 3, 1);
+    TEST_ASSERT_TRUE(conv.waitForCompaction(2000));
+    TEST_ASSERT_EQUAL_STRING("Summary: Second try", conv.getMessages()[0].content.c_str());
+    TEST_ASSERT_EQUAL(3, conv.size());
+}
+
+void test_tool_results_stay_with_their_call() {
+    addSummaryResponse("Checked the weather");
+    Conversation conv;
+    conv.setCompaction(provider, policy(5, 2));
+
+    conv.addUserMessage("Weather?");
+    Message call(Role::Assistant, "");
+    call.toolCallsJson = "[{\"id\":\"c1\"},{\"id\":\"c2\"}]";
+    conv.addMessage(call);
+    conv.addMessage(Message(Role::Tool, "sunny", "c1"));
+    conv.addMessage(Message(Role::Tool, "warm", "c2"));
+    conv.addAssistantMessage("Sunny and warm");
+
+    TEST_ASSERT_TRUE(conv.waitForCompaction(2000));
+    TEST_ASSERT_EQUAL(2, conv.size());
+    TEST_ASSERT_EQUAL_STRING("Summary: Checked the weather", conv.getMessages()[0].content.c_str());
+    TEST_ASSERT_EQUAL_STRING("Sunny and warm", conv.getMessages()[1].content.c_str());
+    TEST_ASSERT_EQUAL(4, conv.getCompactionStats().messagesCompacted);
+    TEST_ASSERT_TRUE(transport->requests[0].body.indexOf("[tool calls: ") >= 0);
+}
+
+void test_clear_discards_running_summary() {
+    transport->executeDelayMs = 50;
+    addSummaryResponse("Stale");
+    Conversation conv;
+    conv.setCompaction(provider, policy(3, 2));
+
+    addTurns(conv, 0, 3);
+    TEST_ASSERT_TRUE(conv.isCompacting());
+    conv.clear();
+    TEST_ASSERT_FALSE(conv.isCompacting());
+
+    conv.addUserMessage("Fresh start");
+    TEST_ASSERT_FALSE(conv.waitForCompaction(500));
+    TEST_ASSERT_EQUAL(1, conv.size());
+    TEST_ASSERT_EQUAL_STRING("Fresh start", conv.getMessages()[0].content.c_str());
+}
+
+void test_tool_loop_shares_provider_with_summary() {
+    transport->executeDelayMs = 20;
+    transport->addResponse(200,
+        "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":null,"
+        "\"tool_calls\":[{\"id\":\"call_1\",\"type\":\"function\","
+        "\"function\":{\"name\":\"play_music\",\"arguments\":\"{}\"}}]},"
+        "\"finish_reason\":\"tool_calls\"}]}");
+    transport->addResponse(200,
+        "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":\"Playing\"},\"finish_reason\":\"stop\"}]}");
+    addSummaryResponse("User asked for music");
+
+    ToolRegistry registry;
+    registry.registerTool(Tool("play_music", "Play a song", "{}", [](const String&) -> String {
+        // Leaves the queue time to run the summary, were the provider not held
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        return "{\"ok\":true}";
+    }));
+
+    Conversation conv;
+    conv.setCompaction(provider, policy(3, 1));
+    conv.addUserMessage("Play a song");
+
+    // The tool result reaches the threshold mid-loop; the summary starts after the loop
+    ToolLoopResult result = runWithTools(*provider, conv, registry);
+    TEST_ASSERT_TRUE(result.response.success);
+    TEST_ASSERT_EQUAL_STRING("Playing", result.response.content.c_str());
+    TEST_ASSERT_EQUAL(2, result.iterations.size());
+
+    TEST_ASSERT_TRUE(conv.waitForCompaction(2000));
+    TEST_ASSERT_EQUAL(3, transport->requests.size());
+    TEST_ASSERT_TRUE(transport->requests[1].body.indexOf("Summarize the conversation") < 0);
+    TEST_ASSERT_TRUE(transport->requests[2].body.indexOf("user: Play a song") >= 0);
+    TEST_ASSERT_EQUAL_STRING("Summary: User asked for music", conv.getMessages()[0].content.c_str());
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+
+    RUN_TEST(test_summary_replaces_oldest_messages);
+    RUN_TEST(test_adding_does_not_wait_for_summary);
+    RUN_TEST(test_summary_applies_after_ring_pruned_its_messages);
+    RUN_TEST(test_failed_summary_keeps_history);
+    RUN_TEST(test_tool_results_stay_with_their_call);
+    RUN_TEST(test_clear_discards_running_summary);
+    RUN_TEST(test_tool_loop_shares_provider_with_summary);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif
@@ -0,0 +1,243 @@
+// Two-stage chatStream() pipeline on the std::thread backend, with a benchmark
+// of a slow callback against simulated network time.
+
+#ifdef NATIVE_TEST
+
+#include <unity.h>
+#include "async/AsyncOS.h"
+#include "async/StreamPipeline.h"
+#include "providers/OpenAIProvider.h"
+#include "../../mocks/transport/FakeTransport.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+using namespace ESPAI;
+
+static FakeTransport* transport = nullptr;
+static OpenAIProvider* provider = nullptr;
+static std::vector<Message> messages;
+
+void setUp(void) {
+    transport = new FakeTransport();
+    provider = new OpenAIProvider("test-key", "gpt-4o");
+    provider->setTransport(transport);
+    messages.clear();
+    messages.push_back(Message(Role::User, "Hi"));
+}
+
+void tearDown(void) {
+    delete provider;
+    delete transport;
+    provider = nullptr;
+    transport = nullptr;
+}
+
+// count events of equal length, "t00 t01 ...", then usage and [DONE]
+static String numberedStream(int count, size_t& eventLength) {
+    String body;
+    for (int i = 0; i < count; i++) {
+        char event[96];
+        snprintf(event, sizeof(event), "data: {\"choices\":[{\"delta\":{\"content\":\"t%02d \"}}]}\n\n", i);
+        eventLength = strlen(event);
+        body += event;
+    }
+    body += "data: {\"choices\":[{\"delta\":{},\"finish_reason\":\"stop\"}],\"usage\":{\"prompt_tokens\":4,\"completion_tokens\":9}}\n\n";
+    body += "data: [DONE]\n\n";
+    return body;
+}
+
+static StreamPipelineConfig pipelineOn(size_t bufferSize = ESPAI_PIPELINE_BUFFER_SIZE) {
+    StreamPipelineConfig config;
+    config.enabled = true;
+    config.bufferSize = bufferSize;
+    return config;
+}
+
+static uint32_t elapsedMs(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+// OS layer
+
+void test_stream_buffer_wraps_in_order() {
+    StreamBufferHandle_t buffer = xStreamBufferCreate(8, 1);
+    uint8_t out[8];
+
+    TEST_ASSERT_EQUAL(6, xStreamBufferSend(buffer, "abcdef", 6, 0));
+    TEST_ASSERT_EQUAL(4, xStreamBufferReceive(buffer, out, 4, 0));
+    TEST_ASSERT_EQUAL(0, memcmp(out, "abcd", 4));
+    TEST_ASSERT_EQUAL(6, xStreamBufferSend(buffer, "ghijkl", 6, 0));
+    TEST_ASSERT_EQUAL(0, xStreamBufferSpacesAvailable(buffer));
+    TEST_ASSERT_EQUAL(8, xStreamBufferReceive(buffer, out, 8, 0));
+    TEST_ASSERT_EQUAL(0, memcmp(out, "efghijkl", 8));
+    vStreamBufferDelete(buffer);
+}
+
+void test_stream_buffer_blocks_until_room() {
+    StreamBufferHandle_t buffer = xStreamBufferCreate(4, 1);
+    TEST_ASSERT_EQUAL(4, xStreamBufferSend(buffer, "full", 4, 0));
+
+    auto start = std::chrono::steady_clock::now();
+    TEST_ASSERT_EQUAL(0, xStreamBufferSend(buffer, "x", 1, pdMS_TO_TICKS(20)));
+    TEST_ASSERT_TRUE(elapsedMs(start) >= 15);
+
+    std::thread reader([buffer]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        uint8_t out[4];
+        xStreamBufferReceive(buffer, out, 4, portMAX_DELAY);
+    });
+    TEST_ASSERT_EQUAL(1, xStreamBufferSend(buffer, "x", 1, portMAX_DELAY));
+    reader.join();
+    vStreamBufferDelete(buffer);
+}
+
+// Pipeline
+
+void test_pipeline_matches_inline() {
+    size_t eventLength = 0;
+    String body = numberedStream(10, eventLength);
+    transport->streams.push_back(body);
+    transport->streams.push_back(body);
+
+    String inlineText;
+    TEST_ASSERT_TRUE(provider->chatStream(messages, ChatOptions(), [&](const String& chunk, bool done) {
+        (void)done;
+        inlineText += chunk;
+    }));
+    Response inlineResult = provider->getLastStreamResponse();
+    TEST_ASSERT_EQUAL(0, provider->getLastPipelineStats().bytes);
+
+    provider->setStreamPipeline(pipelineOn());
+    String pipedText;
+    TEST_ASSERT_TRUE(provider->chatStream(messages, ChatOptions(), [&](const String& chunk, bool done) {
+        (void)done;
+        pipedText += chunk;
+    }));
+
+    TEST_ASSERT_EQUAL_STRING(inlineText.c_str(), pipedText.c_str());
+    TEST_ASSERT_EQUAL(inlineResult.completionTokens, provider->getLastStreamResponse().completionTokens);
+    TEST_ASSERT_EQUAL_STRING("stop", provider->getLastStreamResponse().stopReason.c_str());
+    TEST_ASSERT_EQUAL(body.length(), provider->getLastPipelineStats().bytes);
+    TEST_ASSERT_FALSE(transport->streamAborted);
+}
+
+void test_slow_callback_overlaps_network() {
+    const int kEvents = 40;
+    static const int kCallbackMs = 2;
+    size_t eventLength = 0;
+    String body = numberedStream(kEvents, eventLength);
+    transport->streams.push_back(body);
+    transport->streams.push_back(body);
+    transport->streamChunkSize = eventLength;
+    transport->streamChunkDelayMs = 2;
+    auto slowCallback = [](const String& chunk, bool done) {
+        (void)done;
+        if (!chunk.isEmpty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(kCallbackMs));
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    TEST_ASSERT_TRUE(provider->chatStream(messages, ChatOptions(), slowCallback));
+    uint32_t inlineMs = elapsedMs(start);
+
+    provider->setStreamPipeline(pipelineOn());
+    start = std::chrono::steady_clock::now();
+    TEST_ASSERT_TRUE(provider->chatStream(messages, ChatOptions(), slowCallback));
+    uint32_t pipedMs = elapsedMs(start);
+
+    const StreamPipelineStats& stats = provider->getLastPipelineStats();
+    char message[160];
+    snprintf(message, sizeof(message),
+             "%d events, 2 ms network + %d ms callback each: inline %u ms, pipelined %u ms "
+             "(peak %u B buffered, %u stalls, parser starved %u times)",
+             kEvents, kCallbackMs, (unsigned)inlineMs, (unsigned)pipedMs,
+             (unsigned)stats.peakBuffered, (unsigned)stats.readerStalls, (unsigned)stats.parserStarved);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(pipedMs * 10 < inlineMs * 8);
+}
+
+void test_full_buffer_stalls_reader() {
+    size_t eventLength = 0;
+    transport->streams.push_back(numberedStream(20, eventLength));
+    provider->setStreamPipeline(pipelineOn(64));
+
+    String text;
+    TEST_ASSERT_TRUE(provider->chatStream(messages, ChatOptions(), [&](const String& chunk, bool done) {
+        (void)done;
+        text += chunk;
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+    }));
+
+    const StreamPipelineStats& stats = provider->getLastPipelineStats();
+    TEST_ASSERT_EQUAL(64, stats.bufferSize);
+    TEST_ASSERT_TRUE(stats.readerStalls > 0);
+    TEST_ASSERT_TRUE(stats.readerStallMs > 0);
+    TEST_ASSERT_TRUE(stats.peakBuffered > 0 && stats.peakBuffered <= 64);
+    TEST_ASSERT_EQUAL(0, text.indexOf("t00 t01 "));
+    TEST_ASSERT_TRUE(text.indexOf("t19 ") > 0);
+}
+
+void test_stop_string_aborts_through_pipeline() {
+    size_t eventLength = 0;
+    String body = numberedStream(20, eventLength);
+    transport->streams.push_back(body);
+    transport->streamChunkDelayMs = 1;
+    provider->setStreamPipeline(pipelineOn());
+    ChatOptions options;
+    options.stopStrings.push_back("t03");
+
+    String text;
+    TEST_ASSERT_TRUE(provider->chatStream(messages, options, [&](const String& chunk, bool done) {
+        (void)done;
+        text += chunk;
+    }));
+
+    TEST_ASSERT_EQUAL_STRING("t00 t01 t02 ", text.c_str());
+    TEST_ASSERT_EQUAL_STRING("stop_sequence", provider->getLastStreamResponse().stopReason.c_str());
+    TEST_ASSERT_TRUE(transport->streamAborted);
+    TEST_ASSERT_TRUE(provider->getLastPipelineStats().bytes < body.length());
+}
+
+void test_tool_calls_cross_to_caller() {
+    transport->streams.push_back(
+        "data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":0,\"id\":\"call_p\",\"type\":\"function\",\"function\":{\"name\":\"get_temp\",\"arguments\":\"{}\"}}]}}]}\n\n"
+        "data: {\"choices\":[{\"delta\":{},\"finish_reason\":\"tool_calls\"}]}\n\n"
+        "data: [DONE]\n\n");
+    provider->setStreamPipeline(pipelineOn());
+
+    TEST_ASSERT_TRUE(provider->chatStream(messages, ChatOptions(),
+        [](const String& chunk, bool done) { (void)chunk; (void)done; }));
+
+    TEST_ASSERT_EQUAL(1, provider->getLastToolCalls().size());
+    TEST_ASSERT_EQUAL_STRING("call_p", provider->getLastStreamResponse().toolCalls[0].id.c_str());
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+
+    // OS layer
+    RUN_TEST(test_stream_buffer_wraps_in_order);
+    RUN_TEST(test_stream_buffer_blocks_until_room);
+
+    // Pipeline
+    RUN_TEST(test_pipeline_matches_inline);
+    RUN_TEST(test_slow_callback_overlaps_network);
+    RUN_TEST(test_full_buffer_stalls_reader);
+    RUN_TEST(test_stop_string_aborts_through_pipeline);
+    RUN_TEST(test_tool_calls_cross_to_caller);
+
+    return UNITY_END();
+}
+
+#else
+// For ESP32 - empty file
+void setUp(void) {}
+void tearDown(void) {}
+int main(void) { return 0; }
+#endif